@@ -24,6 +24,10 @@
 #include "sensor_config.h"
 
 #define MCLK_FREQ_MHZ 8                     // MCLK = 8MHz
+#define SAMPLE_TICKS_PER_SECOND 16          // tick of the autonomous sampling, Timer1_A on ACLK (32768Hz)
+#define SAMPLE_RING_SIZE 32                 // samples kept in RAM until the mainboard drains them
+#define SAMPLE_BURST_MAX 10                 // samples per CMD_GET_SAMPLES: 1 + 10 * 12 bytes fit the 128 byte buffer of the mainboard
+#define SAMPLE_RECORD_SIZE 12               // age in ms, value 1, value 2 (low 32 bits each)
 unsigned char getOwnI2CAddress(void);
 void setPins(void);
 
@@ -68,6 +72,87 @@ volatile float   floatToSet = 0.0;
 // Sensor WakeUp Time
 uint16_t sensorWakeUpTime = 0;
 
+// Autonomous sampling: the board converts on its own timer into a ring buffer,
+// the mainboard drains it with CMD_GET_SAMPLES / CMD_REMOVE_SAMPLES
+typedef struct {
+    uint32_t tick;       // tickCount at the conversion
+    uint32_t value[2];   // low 32 bits of the calculated values (float bits)
+} Sample;
+
+Sample sampleRing[SAMPLE_RING_SIZE];
+volatile uint8_t  sampleHead        = 0;     // index of the oldest sample
+volatile uint8_t  sampleCount       = 0;
+volatile uint8_t  samplesDropped    = 0;     // oldest samples overwritten because the ring was full, saturates at 255
+volatile uint32_t tickCount         = 0;
+volatile uint32_t sampleIntervalTicks = 0;   // 0: autonomous sampling off
+volatile uint32_t nextSampleTick    = 0;
+volatile bool     sampleDue         = false;
+volatile bool     isIdle            = false; // main loop is about to sleep, the sample timer may wake it
+
+// answer of CMD_GET_SAMPLES in wire order, sent before res[]
+volatile uint8_t burst[1 + SAMPLE_BURST_MAX * SAMPLE_RECORD_SIZE];
+volatile uint8_t burstLength = 0;
+volatile uint8_t burstIndex  = 0;
+
+void setSampleInterval(uint32_t intervalMs)
+{
+    TA1CTL = TACLR;                         // stop timer
+    sampleHead = 0;
+    sampleCount = 0;
+    samplesDropped = 0;
+    sampleDue = false;
+    if (intervalMs == 0)
+    {
+        sampleIntervalTicks = 0;
+        return;
+    }
+    sampleIntervalTicks = (intervalMs * SAMPLE_TICKS_PER_SECOND + 500) / 1000;
+    if (sampleIntervalTicks == 0)
+        sampleIntervalTicks = 1;            // not faster than the tick
+    nextSampleTick = tickCount + 1;         // first sample on the next tick
+    if (sleepOrWarmup)
+        wakeUp = true;                      // a sensor in low power mode takes no samples
+    TA1CCR0 = 32768 / SAMPLE_TICKS_PER_SECOND - 1;
+    TA1CCTL0 = CCIE;
+    TA1CTL = TASSEL__ACLK | MC__UP | TACLR;
+}
+
+void pushSample(uint32_t tick, int64_t *sampleValues)
+{
+    unsigned short interruptState = __get_interrupt_state();
+    __disable_interrupt();                  // the i2c isr reads the ring
+    uint8_t index = (sampleHead + sampleCount) % SAMPLE_RING_SIZE;
+    if (sampleCount == SAMPLE_RING_SIZE)
+    {
+        sampleHead = (sampleHead + 1) % SAMPLE_RING_SIZE;   // overwrite oldest
+        if (samplesDropped < 0xFF)
+            samplesDropped++;
+    }
+    else
+        sampleCount++;
+    sampleRing[index].tick = tick;
+    sampleRing[index].value[0] = (uint32_t)sampleValues[0];
+    sampleRing[index].value[1] = (uint32_t)sampleValues[1];
+    __set_interrupt_state(interruptState);
+}
+
+uint32_t getTickCount(void)
+{
+    unsigned short interruptState = __get_interrupt_state();
+    __disable_interrupt();                  // 32 bit read is not atomic
+    uint32_t tick = tickCount;
+    __set_interrupt_state(interruptState);
+    return tick;
+}
+
+void putBurstWord(uint8_t *index, uint32_t word)
+{
+    burst[(*index)++] = (word >> 24) & 0xFF;
+    burst[(*index)++] = (word >> 16) & 0xFF;
+    burst[(*index)++] = (word >> 8) & 0xFF;
+    burst[(*index)++] = word & 0xFF;
+}
+
 void process_cmd(unsigned char cmd, unsigned char* par0)
 {
     res[0] = RES_ERROR;
@@ -209,6 +294,51 @@ void process_cmd(unsigned char cmd, unsigned char* par0)
         WDTCTL = 0xDEAD;
     break;
 
+    case CMD_SET_SAMPLE_INTERVAL:
+        setSampleInterval(((uint32_t)par[0] << 24) | ((uint32_t)par[1] << 16) | ((uint32_t)par[2] << 8) | par[3]);
+        break;
+
+    case CMD_GET_SAMPLE_COUNT:
+        byteCount = 2;
+        res[1] = sampleCount;
+        res[0] = samplesDropped;
+        break;
+
+    case CMD_GET_SAMPLES:
+    {
+        //count, then the oldest samples, they stay in the ring until CMD_REMOVE_SAMPLES
+        uint8_t n = par[0];
+        if (n > sampleCount)
+            n = sampleCount;
+        if (n > SAMPLE_BURST_MAX)
+            n = SAMPLE_BURST_MAX;
+        uint8_t index = 0;
+        burst[index++] = n;
+        for (uint8_t i = 0; i < n; i++)
+        {
+            Sample *sample = &sampleRing[(sampleHead + i) % SAMPLE_RING_SIZE];
+            putBurstWord(&index, (tickCount - sample->tick) * 1000UL / SAMPLE_TICKS_PER_SECOND);
+            putBurstWord(&index, sample->value[0]);
+            putBurstWord(&index, sample->value[1]);
+        }
+        burstLength = index;
+        burstIndex = 0;
+        byteCount = 0;
+        break;
+    }
+
+    case CMD_REMOVE_SAMPLES:
+    {
+        uint8_t n = par[0];
+        if (n > sampleCount)
+            n = sampleCount;
+        sampleHead = (sampleHead + n) % SAMPLE_RING_SIZE;
+        sampleCount -= n;
+        if (sampleCount == 0)
+            samplesDropped = 0;
+        break;
+    }
+
 
     case CMD_GET_SENSORVOLTAGE:
         byteCount = 1;
@@ -251,6 +381,7 @@ void receive_cb(unsigned char receive)
     //if command is still unknown, the byte should be a command
     if(cmd == CMD_UNKNOWN) {
         byteCount=1;
+        burstLength = 0;
         //save command in cmd
         cmd = receive;
 
@@ -270,7 +401,8 @@ void receive_cb(unsigned char receive)
             cmd == CMD_GET_CALIBRATED ||
             cmd == CMD_GET_SENSOR_WAKEUP_TIME ||
             cmd == CMD_GET_FW_VERSION ||
-            cmd == CMD_SOFTWARE_RESET
+            cmd == CMD_SOFTWARE_RESET ||
+            cmd == CMD_GET_SAMPLE_COUNT
             )
         {
             process_cmd(cmd, (uint8_t *)par);
@@ -282,12 +414,12 @@ void receive_cb(unsigned char receive)
         byteCount++;
         //byte is a parameter of the command
         //process 2 byte commands (1 byte command, 1 byte parameter)
-        if (cmd == CMD_1ByteDummyTest)
+        if (cmd == CMD_1ByteDummyTest || cmd == CMD_GET_SAMPLES || cmd == CMD_REMOVE_SAMPLES)
         {
             par[0] = receive;
             process_cmd(cmd, (uint8_t *)par);
         }
-        else if (cmd == CMD_SET_TEMP)
+        else if (cmd == CMD_SET_TEMP || cmd == CMD_SET_SAMPLE_INTERVAL)
         {
             //process 5 byte commands (1 byte command, 4 byte parameter)
             if (byteCount==5)
@@ -334,7 +466,11 @@ void receive_cb(unsigned char receive)
 
 void transmit_cb(unsigned char volatile *byte)
 {
-    if (byteCount>0)
+    if (burstIndex < burstLength)
+    {
+        *byte = burst[burstIndex++];
+    }
+    else if (byteCount>0)
     {
         byteCount--;
         *byte = res[byteCount];
@@ -403,7 +539,9 @@ int main(void)
 
 	while(1) //endless loop waiting for i2c command
 	{
-        LPM0; //Wait for stop bit in LPM0
+        isIdle = true;
+        LPM0; //Wait for stop bit or due sample in LPM0
+        isIdle = false;
         while (UCB0CTL1 & UCTXSTP); // Ensure stop condition exists
         //check I2C command
 
@@ -471,11 +609,50 @@ int main(void)
                 startConversion = 1;
             }
          }
+        if (sampleDue && sleepOrWarmup)
+        {
+            //sensor switched off, the sample is skipped so the timer does not wake the loop on every tick
+            sampleDue = false;
+        }
+        if (sampleDue && startConversion != 0)
+        {
+            //autonomous sample, values[] of CMD_CONVERT stay untouched
+            int64_t sampleValues[2] = {0, 0};
+            int64_t sampleRawValues[2] = {0, 0};
+            uint32_t sampleTick = getTickCount();
+            sampleDue = false;
+            if (sensor.startConversion() && sensor.getRAWValue(sampleRawValues) && sensor.getCalculatedValue(sampleValues))
+            {
+                pushSample(sampleTick, sampleValues);
+            }
+        }
 
 	}
 	//return 0;
 }
 
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector = TIMER1_A0_VECTOR
+__interrupt void sampleTimer_ISR(void)
+#elif defined(__GNUC__)
+void __attribute__ ((interrupt(TIMER1_A0_VECTOR))) sampleTimer_ISR (void)
+#else
+#error Compiler not supported!
+#endif
+{
+    tickCount++;
+    if (sampleIntervalTicks != 0 && (int32_t)(tickCount - nextSampleTick) >= 0)
+    {
+        sampleDue = true;
+        nextSampleTick += sampleIntervalTicks;
+        if ((int32_t)(tickCount - nextSampleTick) >= 0) //conversion slower than the interval, skip the missed samples
+            nextSampleTick = tickCount + sampleIntervalTicks;
+    }
+    //drivers wait in LPM0 as well, only wake the main loop when it is idle; checked again on every tick
+    if (sampleDue && isIdle)
+        LPM0_EXIT;
+}
+
 void Software_Trim()
 {
     unsigned int oldDcoTap = 0xffff;
@@ -180,6 +180,18 @@ int16_t BMS_IC::getCell4_I()
     return value;
 }
 
+// Reads DAStatus1 in one block: cell voltages 1-4 in mV and cell currents 1-4 in mA
+bool BMS_IC::getDAStatus1(uint16_t *cellVoltage, int16_t *cellCurrent)
+{
+    uint8_t numBytes = this->_SMBus.read_Word(Register_Cell_V, 21);
+    for (int cell = 0; cell < 4; cell++)
+    {
+        cellVoltage[cell] = (this->i2c_Buffer[2 + 2 * cell] << 8) | this->i2c_Buffer[1 + 2 * cell];
+        cellCurrent[cell] = (this->i2c_Buffer[14 + 2 * cell] << 8) | this->i2c_Buffer[13 + 2 * cell];
+    }
+    return numBytes == 21;
+}
+
 uint16_t BMS_IC::getStateofHealth()
 {
     this->_SMBus.read_Word(Register_StateofHealth, 2);
@@ -299,6 +311,24 @@ uint16_t BMS_IC::getSafetyStatusCD()
     return value;
 }
 
+// Reads SafetyAlert AB and CD in one block
+bool BMS_IC::getSafetyAlert(uint16_t &alertAB, uint16_t &alertCD)
+{
+    uint8_t numBytes = this->_SMBus.read_Word(CMD_SafetyAlert, 5);
+    alertAB = (this->i2c_Buffer[2] << 8) | this->i2c_Buffer[1];
+    alertCD = (this->i2c_Buffer[4] << 8) | this->i2c_Buffer[3];
+    return numBytes == 5;
+}
+
+// Reads SafetyStatus AB and CD in one block
+bool BMS_IC::getSafetyStatus(uint16_t &statusAB, uint16_t &statusCD)
+{
+    uint8_t numBytes = this->_SMBus.read_Word(CMD_SafetyStatus, 5);
+    statusAB = (this->i2c_Buffer[2] << 8) | this->i2c_Buffer[1];
+    statusCD = (this->i2c_Buffer[4] << 8) | this->i2c_Buffer[3];
+    return numBytes == 5;
+}
+
 uint16_t BMS_IC::getPFAlertAB()
 {
     this->_SMBus.read_Word(CMD_PFAlert, 4);
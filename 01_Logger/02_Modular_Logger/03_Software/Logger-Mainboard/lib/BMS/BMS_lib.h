@@ -57,6 +57,9 @@ public:
     int16_t getCell2_I();
     int16_t getCell3_I();
     int16_t getCell4_I();
+    bool getDAStatus1(uint16_t *cellVoltage, int16_t *cellCurrent);
+    bool getSafetyAlert(uint16_t &alertAB, uint16_t &alertCD);
+    bool getSafetyStatus(uint16_t &statusAB, uint16_t &statusCD);
     uint16_t getBATpinVoltage();
     uint16_t getPACKpinVoltage();
     uint16_t getStateofHealth();
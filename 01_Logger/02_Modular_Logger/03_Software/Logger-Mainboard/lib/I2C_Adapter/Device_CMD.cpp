@@ -33,6 +33,10 @@ enum CMD_LIST
   CMD_GET_SENSOR_WAKEUP_TIME = 0x19,
   CMD_GET_FW_VERSION = 0x20,
   CMD_SOFTWARE_RESET = 0x21,
+  CMD_SET_SAMPLE_INTERVAL = 0x22, // 5 bytes: cmd, 4 byte interval in ms (big-endian), 0 stops the autonomous sampling
+  CMD_GET_SAMPLE_COUNT = 0x23,    // answer 2 bytes: samples in the ring, samples dropped because the ring was full
+  CMD_GET_SAMPLES = 0x24,         // 2 bytes: cmd, max. samples; answer: count, then per sample age in ms, value 1, value 2 (4 bytes each, big-endian)
+  CMD_REMOVE_SAMPLES = 0x25,      // 2 bytes: cmd, number of the oldest samples to remove after they were read
   CMD_PING = 0xAA,      // master wants a answer byte (seems to be unnecessary, because of getver)
 
   CMD_1ByteDummyTest = 0xFE,
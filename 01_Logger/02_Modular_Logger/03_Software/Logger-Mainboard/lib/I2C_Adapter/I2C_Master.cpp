@@ -314,6 +314,96 @@ void I2C_Master::setCalib(uint8_t address, uint8_t index, float calib)
   this->WriteNByte(CMD_SET_CALIB, data, 5, address);
 }
 
+/**
+ * @brief Starts the autonomous sampling of an interface board. The board converts on its own timer into
+ *        a ring buffer, independent of the wake-ups of the mainboard. Clears the ring.
+ * @param address Bus address of the interface board
+ * @param intervalMs Sample interval in ms (resolution 62.5 ms), 0 stops the sampling
+ * @return endTransmission code, 0 on success
+ */
+uint8_t I2C_Master::setSampleInterval(uint8_t address, uint32_t intervalMs)
+{
+  uint8_t data[4];
+  data[0] = (intervalMs >> 24) & 0xFF;
+  data[1] = (intervalMs >> 16) & 0xFF;
+  data[2] = (intervalMs >> 8) & 0xFF;
+  data[3] = intervalMs & 0xFF;
+  return this->WriteNByte(CMD_SET_SAMPLE_INTERVAL, data, 4, address);
+}
+
+/**
+ * @brief Reads the fill level of the sample ring of an interface board.
+ * @param count Samples in the ring
+ * @param dropped Samples overwritten since the ring was last emptied
+ * @return true on success
+ */
+bool I2C_Master::getSampleCount(uint8_t address, uint8_t *count, uint8_t *dropped)
+{
+  uint8_t buffer[2];
+
+  if (this->WriteRead(CMD_GET_SAMPLE_COUNT, address, buffer, 2) != 0)
+  {
+    return false;
+  }
+  *count = buffer[0];
+  *dropped = buffer[1];
+  return true;
+}
+
+/**
+ * @brief Reads the oldest samples of an interface board in one burst. The samples stay in the ring
+ *        until removeSamples, so a failed read loses nothing.
+ * @param samples Buffer for at least maxSamples samples
+ * @param maxSamples Samples to read, at most INTERFACE_SAMPLE_BURST_MAX
+ * @return Number of samples read, -1 on a bus error
+ */
+int I2C_Master::readSamples(uint8_t address, InterfaceSample *samples, uint8_t maxSamples)
+{
+  uint8_t buffer[1 + INTERFACE_SAMPLE_BURST_MAX * 12];
+
+  if (maxSamples > INTERFACE_SAMPLE_BURST_MAX)
+  {
+    maxSamples = INTERFACE_SAMPLE_BURST_MAX;
+  }
+  if (this->WriteNByte(CMD_GET_SAMPLES, &maxSamples, 1, address) != 0)
+  {
+    return -1;
+  }
+
+  size_t length = 1 + maxSamples * 12;
+  if (_i2cPort->requestFrom((uint16_t)address, length, true) != length)
+  {
+    return -1;
+  }
+  for (size_t i = 0; i < length; i++)
+  {
+    buffer[i] = _i2cPort->read();
+  }
+
+  uint8_t count = buffer[0];
+  if (count > maxSamples)
+  {
+    return -1; // Not a sample burst, e.g. firmware without autonomous sampling
+  }
+  for (uint8_t i = 0; i < count; i++)
+  {
+    const uint8_t *record = &buffer[1 + i * 12];
+    samples[i].ageMs = ((uint32_t)record[0] << 24) | ((uint32_t)record[1] << 16) | ((uint32_t)record[2] << 8) | record[3];
+    samples[i].value1 = ((uint32_t)record[4] << 24) | ((uint32_t)record[5] << 16) | ((uint32_t)record[6] << 8) | record[7];
+    samples[i].value2 = ((uint32_t)record[8] << 24) | ((uint32_t)record[9] << 16) | ((uint32_t)record[10] << 8) | record[11];
+  }
+  return count;
+}
+
+/**
+ * @brief Removes the oldest samples from the ring of an interface board after they were read.
+ * @return endTransmission code, 0 on success
+ */
+uint8_t I2C_Master::removeSamples(uint8_t address, uint8_t count)
+{
+  return this->WriteNByte(CMD_REMOVE_SAMPLES, &count, 1, address);
+}
+
 uint8_t I2C_Master::Write(uint8_t command, uint8_t address)
 {
   uint8_t ret;
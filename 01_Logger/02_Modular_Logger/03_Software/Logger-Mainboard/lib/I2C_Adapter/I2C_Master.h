@@ -14,6 +14,19 @@
 
 #include <Wire.h>
 
+#define INTERFACE_SAMPLE_BURST_MAX 10 // Samples per CMD_GET_SAMPLES, 1 + 10 * 12 bytes fit the Wire buffer
+#define INTERFACE_SAMPLE_RING_SIZE 32 // Samples an interface board keeps until they are drained (SAMPLE_RING_SIZE of the board)
+
+/**
+ * @brief Sample taken autonomously by an interface board, see I2C_Master::setSampleInterval.
+ */
+struct InterfaceSample
+{
+  uint32_t ageMs;  // Age at the time of the read
+  uint32_t value1; // Low 32 bits of the calculated values (float bits)
+  uint32_t value2;
+};
+
 class I2C_Master
 {
 public:
@@ -42,6 +55,10 @@ public:
   void sensorWakeup(uint8_t address);
   void sendTemperature(uint8_t address, float temperature);
   void setCalib(uint8_t address, uint8_t index, float calib);
+  uint8_t setSampleInterval(uint8_t address, uint32_t intervalMs);
+  bool getSampleCount(uint8_t address, uint8_t *count, uint8_t *dropped);
+  int readSamples(uint8_t address, InterfaceSample *samples, uint8_t maxSamples);
+  uint8_t removeSamples(uint8_t address, uint8_t count);
 
   void begin_I2C();
 
@@ -10,6 +10,7 @@
  */
 
 #include "LoggerHER.h"
+#include "../../src/DebuggingSDLog.h"
 #include <Wire.h>
 LoggerHER Logger;
 enum SensorValueType
@@ -254,6 +255,37 @@ void LoggerHER::setCalib(uint8_t address, uint8_t index, float calib)
   this->AdapterBus.setCalib(address, index, calib);
 }
 
+uint8_t LoggerHER::setSampleInterval(uint8_t address, uint32_t intervalMs)
+{
+  return this->AdapterBus.setSampleInterval(address, intervalMs);
+}
+
+/**
+ * @brief Drains the sample ring of an interface board in bursts of INTERFACE_SAMPLE_BURST_MAX samples.
+ *        Each burst is removed from the ring only after it was read completely.
+ * @param samples Buffer for at least maxSamples samples, oldest first
+ * @return Number of samples drained, -1 if the first burst failed
+ */
+int LoggerHER::drainSamples(uint8_t address, InterfaceSample *samples, int maxSamples)
+{
+  int drained = 0;
+  while (drained < maxSamples)
+  {
+    int burst = this->AdapterBus.readSamples(address, &samples[drained], (uint8_t)std::min(maxSamples - drained, INTERFACE_SAMPLE_BURST_MAX));
+    if (burst < 0)
+    {
+      Log(LogCategorySensors, LogLevelERROR, "Reading the samples of the interface board failed, bus address: ", String(address));
+      return drained > 0 ? drained : -1;
+    }
+    if (burst == 0 || this->AdapterBus.removeSamples(address, (uint8_t)burst) != 0)
+    {
+      break;
+    }
+    drained += burst;
+  }
+  return drained;
+}
+
 int64_t LoggerHER::getAdapterSensorRawValue(uint8_t address)
 {
   return this->AdapterSensorRawValue[address];
@@ -66,6 +66,8 @@ public:
   void sensorWakeupDetection(uint8_t address);
   void sendTemperature(uint8_t address, float temperature);
   void setCalib(uint8_t address, uint8_t index, float calib);
+  uint8_t setSampleInterval(uint8_t address, uint32_t intervalMs);
+  int drainSamples(uint8_t address, InterfaceSample *samples, int maxSamples);
 
   int64_t getAdapterSensorRawValue(uint8_t address);
   int64_t getAdapterSensorCalcValue(uint8_t address);
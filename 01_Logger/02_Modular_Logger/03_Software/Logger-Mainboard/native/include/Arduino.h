@@ -0,0 +1,174 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the Arduino-ESP32 core
+ */
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "Print.h"
+#include "Stream.h"
+#include "WString.h"
+#include "esp_err.h"
+#include "esp_sleep.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+using std::max;
+using std::min;
+
+// The RTC memory of the host build is the section .rtc.data, collected by native/rtc_data.ld.
+// Every variable gets its own input section, as in the ESP-IDF, so inline variables in headers
+// and plain variables of one translation unit do not conflict.
+#define RTC_ATTR_STRINGIFY2(x) #x
+#define RTC_ATTR_STRINGIFY(x) RTC_ATTR_STRINGIFY2(x)
+#define RTC_DATA_ATTR __attribute__((section(".rtc.data." RTC_ATTR_STRINGIFY(__COUNTER__))))
+#define RTC_NOINIT_ATTR RTC_DATA_ATTR
+#define IRAM_ATTR
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define INPUT_PULLDOWN 0x09
+
+// esp_bit_defs.h
+#define BIT0 (1UL << 0)
+#define BIT1 (1UL << 1)
+#define BIT2 (1UL << 2)
+#define BIT3 (1UL << 3)
+#define BIT4 (1UL << 4)
+#define BIT5 (1UL << 5)
+#define BIT6 (1UL << 6)
+#define BIT7 (1UL << 7)
+#define BIT8 (1UL << 8)
+#define BIT9 (1UL << 9)
+#define BIT10 (1UL << 10)
+#define BIT11 (1UL << 11)
+#define BIT12 (1UL << 12)
+#define BIT13 (1UL << 13)
+#define BIT14 (1UL << 14)
+#define BIT15 (1UL << 15)
+#define BIT16 (1UL << 16)
+#define BIT17 (1UL << 17)
+#define BIT18 (1UL << 18)
+#define BIT19 (1UL << 19)
+#define BIT20 (1UL << 20)
+#define BIT21 (1UL << 21)
+#define BIT22 (1UL << 22)
+#define BIT23 (1UL << 23)
+#define BIT24 (1UL << 24)
+#define BIT25 (1UL << 25)
+#define BIT26 (1UL << 26)
+#define BIT27 (1UL << 27)
+#define BIT28 (1UL << 28)
+#define BIT29 (1UL << 29)
+#define BIT30 (1UL << 30)
+#define BIT31 (1UL << 31)
+
+#define F(text) (text)
+#define PROGMEM
+#define constrain(value, low, high) ((value) < (low) ? (low) : ((value) > (high) ? (high) : (value)))
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+typedef enum
+{
+  GPIO_NUM_NC = -1,
+  GPIO_NUM_0 = 0, GPIO_NUM_1, GPIO_NUM_2, GPIO_NUM_3, GPIO_NUM_4, GPIO_NUM_5, GPIO_NUM_6, GPIO_NUM_7,
+  GPIO_NUM_8, GPIO_NUM_9, GPIO_NUM_10, GPIO_NUM_11, GPIO_NUM_12, GPIO_NUM_13, GPIO_NUM_14, GPIO_NUM_15,
+  GPIO_NUM_16, GPIO_NUM_17, GPIO_NUM_18, GPIO_NUM_19, GPIO_NUM_20, GPIO_NUM_21, GPIO_NUM_26 = 26, GPIO_NUM_27,
+  GPIO_NUM_28, GPIO_NUM_29, GPIO_NUM_30, GPIO_NUM_31, GPIO_NUM_32, GPIO_NUM_33, GPIO_NUM_34, GPIO_NUM_35,
+  GPIO_NUM_36, GPIO_NUM_37, GPIO_NUM_38, GPIO_NUM_39, GPIO_NUM_40, GPIO_NUM_41, GPIO_NUM_42, GPIO_NUM_43,
+  GPIO_NUM_44, GPIO_NUM_45, GPIO_NUM_46, GPIO_NUM_47, GPIO_NUM_48, GPIO_NUM_MAX
+} gpio_num_t;
+
+// Simulated time: delay() advances the clock of the simulation instead of waiting
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+esp_err_t gpio_hold_en(gpio_num_t pin);
+esp_err_t gpio_hold_dis(gpio_num_t pin);
+void gpio_deep_sleep_hold_en();
+void gpio_deep_sleep_hold_dis();
+
+bool setCpuFrequencyMhz(uint32_t mhz);
+uint32_t getCpuFrequencyMhz();
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server1, const char *server2 = nullptr, const char *server3 = nullptr);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+// The C library of the ESP-IDF has strlcpy, glibc only since 2.38
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+#define SIM_STRLCPY
+size_t strlcpy(char *destination, const char *source, size_t size);
+size_t strlcat(char *destination, const char *source, size_t size);
+#endif
+
+class HardwareSerial : public Stream
+{
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  void end() {}
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  void flush() override;
+  operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+class EspClass
+{
+public:
+  [[noreturn]] void restart();
+  uint64_t getEfuseMac();
+  uint32_t getFreeHeap() { return 200000; }
+  uint32_t getMinFreeHeap() { return 150000; }
+  uint32_t getHeapSize() { return 320000; }
+  uint32_t getCpuFreqMHz() { return getCpuFrequencyMhz(); }
+  const char *getSdkVersion() { return "native"; }
+  const char *getChipModel() { return "ESP32-S3 (simulated)"; }
+};
+
+extern EspClass ESP;
+
+void setup();
+void loop();
+
+#endif
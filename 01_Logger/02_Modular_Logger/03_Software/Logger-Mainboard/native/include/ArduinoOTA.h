@@ -0,0 +1,29 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the network firmware update
+ */
+
+#ifndef ARDUINOOTA_H
+#define ARDUINOOTA_H
+
+#include "Update.h"
+#include "WiFi.h"
+
+class ArduinoOTAClass
+{
+public:
+  void setHostname(const char *hostname) { (void)hostname; }
+  void begin() {}
+  void end() {}
+  void handle() {}
+};
+
+extern ArduinoOTAClass ArduinoOTA;
+
+#endif
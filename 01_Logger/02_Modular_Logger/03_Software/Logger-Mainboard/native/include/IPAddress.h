@@ -0,0 +1,40 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the Arduino IPAddress class
+ */
+
+#ifndef IPADDRESS_H
+#define IPADDRESS_H
+
+#include <stdint.h>
+
+#include "WString.h"
+
+// IPv4 address, stored in network order as in the Arduino core (the first octet is the low byte)
+class IPAddress
+{
+public:
+  IPAddress() : address(0) {}
+  IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth)
+      : address((uint32_t)first | (uint32_t)second << 8 | (uint32_t)third << 16 | (uint32_t)fourth << 24) {}
+  IPAddress(uint32_t address) : address(address) {}
+
+  operator uint32_t() const { return address; }
+  uint8_t operator[](int index) const { return (address >> (8 * index)) & 0xFF; }
+  bool operator==(const IPAddress &other) const { return address == other.address; }
+  bool operator!=(const IPAddress &other) const { return address != other.address; }
+
+  bool fromString(const char *text);
+  String toString() const;
+
+private:
+  uint32_t address;
+};
+
+#endif
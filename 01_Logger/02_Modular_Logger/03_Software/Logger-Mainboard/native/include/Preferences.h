@@ -0,0 +1,37 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the NVS preferences, one file per key
+ */
+
+#ifndef PREFERENCES_H
+#define PREFERENCES_H
+
+#include "Arduino.h"
+
+// The namespaces are directories below the NVS directory of the scenario
+class Preferences
+{
+public:
+  bool begin(const char *name, bool readOnly = false, const char *partitionLabel = nullptr);
+  void end();
+  bool clear();
+  bool remove(const char *key);
+  bool isKey(const char *key);
+  size_t putBytes(const char *key, const void *value, size_t length);
+  size_t getBytes(const char *key, void *buffer, size_t maxLength);
+  size_t getBytesLength(const char *key);
+
+private:
+  String keyPath(const char *key) const;
+  String directory;
+  bool isOpen = false;
+  bool isReadOnly = true;
+};
+
+#endif
@@ -0,0 +1,50 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the DS3231 RTC of RTClib
+ */
+
+#ifndef RTCLIB_H
+#define RTCLIB_H
+
+#include "Arduino.h"
+#include "Wire.h"
+
+// Date and time in UTC, as far as the firmware uses it
+class DateTime
+{
+public:
+  DateTime(uint32_t unixTime = 0);
+  DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour = 0, uint8_t minute = 0, uint8_t second = 0);
+  uint16_t year() const { return yearValue; }
+  uint8_t month() const { return monthValue; }
+  uint8_t day() const { return dayValue; }
+  uint8_t hour() const { return hourValue; }
+  uint8_t minute() const { return minuteValue; }
+  uint8_t second() const { return secondValue; }
+  uint32_t unixtime() const { return unixTime; }
+
+private:
+  uint32_t unixTime;
+  uint16_t yearValue;
+  uint8_t monthValue, dayValue, hourValue, minuteValue, secondValue;
+};
+
+// The RTC runs with the drift of the scenario against the simulated clock and keeps the time
+// in deep sleep
+class RTC_DS3231
+{
+public:
+  bool begin(TwoWire *wire = &Wire);
+  void adjust(const DateTime &time);
+  DateTime now();
+  bool lostPower() { return false; }
+  float getTemperature() { return 20.0f; }
+};
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the SD card, backed by a directory of the scenario
+ */
+
+#ifndef SD_H
+#define SD_H
+
+#include "FS.h"
+#include "SPI.h"
+
+typedef enum
+{
+  CARD_NONE,
+  CARD_MMC,
+  CARD_SD,
+  CARD_SDHC,
+  CARD_UNKNOWN
+} sdcard_type_t;
+
+namespace fs
+{
+
+class SDFS : public FS
+{
+public:
+  bool begin(uint8_t ssPin = 5, SPIClass &spi = SPI, uint32_t frequency = 4000000, const char *mountpoint = "/sd", uint8_t maxFiles = 5, bool formatIfEmpty = false);
+  void end();
+  sdcard_type_t cardType() { return isMounted ? CARD_SDHC : CARD_NONE; }
+  uint64_t cardSize();
+  uint64_t totalBytes() { return cardSize(); }
+  uint64_t usedBytes();
+};
+
+} // namespace fs
+
+extern fs::SDFS SD;
+
+using namespace fs;
+
+#endif
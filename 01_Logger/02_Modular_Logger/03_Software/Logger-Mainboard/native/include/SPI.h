@@ -0,0 +1,36 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the Arduino SPIClass, the SD card is a directory
+ */
+
+#ifndef SPI_H
+#define SPI_H
+
+#include "Arduino.h"
+
+#define FSPI 0
+#define HSPI 1
+
+class SPIClass
+{
+public:
+  SPIClass(uint8_t spiBus = HSPI) { (void)spiBus; }
+  void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1)
+  {
+    (void)sck;
+    (void)miso;
+    (void)mosi;
+    (void)ss;
+  }
+  void end() {}
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the Arduino Stream class
+ */
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "Print.h"
+
+// Files and sockets answer at once, so the read functions do not wait for the timeout
+class Stream : public Print
+{
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeoutMs) { this->timeoutMs = timeoutMs; }
+  unsigned long getTimeout() const { return timeoutMs; }
+
+  virtual size_t readBytes(char *buffer, size_t length);
+  size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+  size_t readBytesUntil(char terminator, char *buffer, size_t length);
+  size_t readBytesUntil(char terminator, uint8_t *buffer, size_t length) { return readBytesUntil(terminator, (char *)buffer, length); }
+  String readString();
+  String readStringUntil(char terminator);
+
+protected:
+  unsigned long timeoutMs = 1000;
+};
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the firmware update, the image is only counted
+ */
+
+#ifndef UPDATE_H
+#define UPDATE_H
+
+#include "Arduino.h"
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+
+// Accepts the image without writing it, the simulated firmware stays the same
+class UpdateClass
+{
+public:
+  bool begin(size_t size = UPDATE_SIZE_UNKNOWN);
+  size_t write(uint8_t *data, size_t length);
+  size_t writeStream(Stream &data);
+  bool end(bool evenIfRemaining = false);
+  bool isFinished() { return isComplete; }
+  bool hasError() { return false; }
+  uint8_t getError() { return 0; }
+
+private:
+  size_t expectedSize = 0;
+  size_t writtenSize = 0;
+  bool isComplete = false;
+};
+
+extern UpdateClass Update;
+
+#endif
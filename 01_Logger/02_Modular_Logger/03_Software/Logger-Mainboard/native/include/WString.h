@@ -0,0 +1,124 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the Arduino String class
+ */
+
+#ifndef WSTRING_H
+#define WSTRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+// The subset of the Arduino String API the firmware uses, backed by std::string.
+// As in the Arduino core the numeric constructors are explicit.
+class String
+{
+public:
+  String(const char *text = "");
+  String(const char *text, size_t length);
+  String(const String &other) = default;
+  String(String &&other) = default;
+  explicit String(char c);
+  explicit String(unsigned char value, unsigned char base = 10);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(long long value, unsigned char base = 10);
+  explicit String(unsigned long long value, unsigned char base = 10);
+  explicit String(float value, unsigned int decimalPlaces = 2);
+  explicit String(double value, unsigned int decimalPlaces = 2);
+
+  String &operator=(const String &other) = default;
+  String &operator=(String &&other) = default;
+  String &operator=(const char *text);
+
+  unsigned int length() const { return (unsigned int)text.size(); }
+  bool isEmpty() const { return text.empty(); }
+  const char *c_str() const { return text.c_str(); }
+  bool reserve(unsigned int size);
+
+  bool concat(const String &other);
+  bool concat(const char *other);
+  bool concat(char c);
+  String &operator+=(const String &other);
+  String &operator+=(const char *other);
+  String &operator+=(char c);
+  String &operator+=(int value);
+  String &operator+=(unsigned int value);
+  String &operator+=(long value);
+  String &operator+=(unsigned long value);
+  String &operator+=(long long value);
+  String &operator+=(unsigned long long value);
+  String &operator+=(float value);
+  String &operator+=(double value);
+
+  int compareTo(const String &other) const;
+  bool equals(const String &other) const { return text == other.text; }
+  bool equals(const char *other) const { return text == (other ? other : ""); }
+  bool equalsIgnoreCase(const String &other) const;
+  bool operator==(const String &other) const { return equals(other); }
+  bool operator==(const char *other) const { return equals(other); }
+  bool operator!=(const String &other) const { return !equals(other); }
+  bool operator!=(const char *other) const { return !equals(other); }
+  bool operator<(const String &other) const { return compareTo(other) < 0; }
+  bool operator>(const String &other) const { return compareTo(other) > 0; }
+  bool startsWith(const String &prefix) const;
+  bool startsWith(const String &prefix, unsigned int offset) const;
+  bool endsWith(const String &suffix) const;
+
+  char charAt(unsigned int index) const;
+  void setCharAt(unsigned int index, char c);
+  char operator[](unsigned int index) const { return charAt(index); }
+  char &operator[](unsigned int index);
+  void getBytes(unsigned char *buffer, unsigned int bufferSize, unsigned int index = 0) const;
+  void toCharArray(char *buffer, unsigned int bufferSize, unsigned int index = 0) const;
+
+  int indexOf(char c, unsigned int fromIndex = 0) const;
+  int indexOf(const String &other, unsigned int fromIndex = 0) const;
+  int lastIndexOf(char c) const;
+  int lastIndexOf(char c, unsigned int fromIndex) const;
+  int lastIndexOf(const String &other) const;
+  int lastIndexOf(const String &other, unsigned int fromIndex) const;
+  String substring(unsigned int beginIndex) const;
+  String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+  void replace(char find, char replacement);
+  void replace(const String &find, const String &replacement);
+  void remove(unsigned int index);
+  void remove(unsigned int index, unsigned int count);
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+
+  long toInt() const;
+  float toFloat() const;
+  double toDouble() const;
+
+private:
+  std::string text;
+};
+
+String operator+(const String &left, const String &right);
+String operator+(const String &left, const char *right);
+String operator+(const char *left, const String &right);
+String operator+(const String &left, char right);
+String operator+(const String &left, int right);
+String operator+(const String &left, unsigned int right);
+String operator+(const String &left, long right);
+String operator+(const String &left, unsigned long right);
+String operator+(const String &left, long long right);
+String operator+(const String &left, unsigned long long right);
+String operator+(const String &left, float right);
+String operator+(const String &left, double right);
+inline bool operator==(const char *left, const String &right) { return right.equals(left); }
+inline bool operator!=(const char *left, const String &right) { return !right.equals(left); }
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the WiFi station and the TCP client
+ */
+
+#ifndef WIFI_H
+#define WIFI_H
+
+#include "Arduino.h"
+#include "Client.h"
+#include "IPAddress.h"
+
+typedef enum
+{
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum
+{
+  WIFI_OFF = 0,
+  WIFI_STA = 1,
+  WIFI_AP = 2,
+  WIFI_AP_STA = 3
+} wifi_mode_t;
+
+// The access points of the scenario are in range while the logger is at the surface.
+// The connection completes after the connection time of the scenario, a third of it with
+// the BSSID and channel of a known access point (no scan).
+class WiFiClass
+{
+public:
+  wl_status_t begin(const char *ssid, const char *passphrase = nullptr, int32_t channel = 0, const uint8_t *bssid = nullptr, bool connect = true);
+  bool config(IPAddress localIp, IPAddress gateway, IPAddress subnet, IPAddress dns1 = (uint32_t)0, IPAddress dns2 = (uint32_t)0);
+  bool disconnect(bool wifiOff = false, bool eraseAp = false);
+  bool mode(wifi_mode_t mode) { (void)mode; return true; }
+  bool setSleep(bool enabled) { (void)enabled; return true; }
+  wl_status_t status();
+  bool isConnected() { return status() == WL_CONNECTED; }
+
+  uint8_t *BSSID();
+  int32_t channel();
+  int8_t RSSI();
+  String SSID();
+  String macAddress();
+  IPAddress localIP();
+  IPAddress gatewayIP();
+  IPAddress subnetMask();
+  IPAddress dnsIP(uint8_t index = 0);
+};
+
+extern WiFiClass WiFi;
+
+// TCP connection of the host, the MQTT client reaches a local broker through it
+class WiFiClient : public Client
+{
+public:
+  WiFiClient() {}
+  ~WiFiClient();
+  WiFiClient(const WiFiClient &) = delete;
+  WiFiClient &operator=(const WiFiClient &) = delete;
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char *host, uint16_t port) override;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int read(uint8_t *buffer, size_t size) override;
+  int peek() override;
+  void flush() override {}
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return connected(); }
+
+protected:
+  int socketFd = -1;
+};
+
+#endif
@@ -0,0 +1,26 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the TLS client, without TLS
+ */
+
+#ifndef WIFICLIENTSECURE_H
+#define WIFICLIENTSECURE_H
+
+#include "WiFi.h"
+#include "mbedtls/md.h" // Included by the TLS client of the core
+
+// The simulation connects in plain TCP, the certificates are ignored
+class WiFiClientSecure : public WiFiClient
+{
+public:
+  void setCACert(const char *rootCa) { (void)rootCa; }
+  void setInsecure() {}
+};
+
+#endif
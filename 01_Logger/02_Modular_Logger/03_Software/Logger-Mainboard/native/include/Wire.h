@@ -0,0 +1,66 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the Arduino TwoWire (I2C) class
+ */
+
+#ifndef WIRE_H
+#define WIRE_H
+
+#include "Arduino.h"
+
+#define I2C_BUFFER_LENGTH 128
+
+// The transactions go to the simulated devices of the bus (native/src/simDevices.cpp):
+// bus 0 holds the interface boards of the scenario, bus 1 the BMS.
+class TwoWire : public Stream
+{
+public:
+  TwoWire(uint8_t busNumber);
+
+  bool begin(int sdaPin = -1, int sclPin = -1, uint32_t frequency = 0);
+  bool end();
+  bool setClock(uint32_t frequency);
+
+  void beginTransmission(uint16_t address);
+  void beginTransmission(uint8_t address) { beginTransmission((uint16_t)address); }
+  void beginTransmission(int address) { beginTransmission((uint16_t)address); }
+  uint8_t endTransmission(bool sendStop = true);
+
+  size_t requestFrom(uint16_t address, size_t size, bool sendStop = true);
+  uint8_t requestFrom(uint8_t address, uint8_t size) { return (uint8_t)requestFrom((uint16_t)address, (size_t)size); }
+  uint8_t requestFrom(int address, int size) { return (uint8_t)requestFrom((uint16_t)address, (size_t)size); }
+  uint8_t requestFrom(uint16_t address, uint8_t size) { return (uint8_t)requestFrom(address, (size_t)size); }
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  size_t write(unsigned long n) { return write((uint8_t)n); }
+  size_t write(long n) { return write((uint8_t)n); }
+  size_t write(unsigned int n) { return write((uint8_t)n); }
+  size_t write(int n) { return write((uint8_t)n); }
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+  void flush() override {}
+
+private:
+  uint8_t busNumber;
+  uint16_t txAddress = 0;
+  uint8_t txBuffer[I2C_BUFFER_LENGTH];
+  size_t txLength = 0;
+  bool isTxOverflow = false;
+  uint8_t rxBuffer[I2C_BUFFER_LENGTH];
+  size_t rxLength = 0;
+  size_t rxIndex = 0;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif
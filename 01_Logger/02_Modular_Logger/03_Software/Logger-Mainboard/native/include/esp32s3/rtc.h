@@ -0,0 +1,20 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the ESP32-S3 RTC counter
+ */
+
+#ifndef ESP32S3_RTC_H
+#define ESP32S3_RTC_H
+
+#include <stdint.h>
+
+// Simulated microseconds of the RTC counter since the power-on, not stepped by SNTP
+uint64_t esp_rtc_get_time_us(void);
+
+#endif
@@ -0,0 +1,19 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the ESP-IDF power management
+ */
+
+#ifndef ESP_PM_H
+#define ESP_PM_H
+
+#include "esp_err.h"
+
+// CONFIG_PM_ENABLE is not defined, src/cpuClock.cpp sets the levels with setCpuFrequencyMhz
+
+#endif
@@ -0,0 +1,20 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the CRC functions of the ESP32 ROM
+ */
+
+#ifndef ESP_ROM_CRC_H
+#define ESP_ROM_CRC_H
+
+#include <stdint.h>
+
+// CRC-32 (polynomial 0xEDB88320), the same result as the ROM function
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buffer, uint32_t length);
+
+#endif
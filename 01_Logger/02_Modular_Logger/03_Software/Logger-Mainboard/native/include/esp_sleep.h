@@ -0,0 +1,50 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the ESP-IDF sleep modes
+ */
+
+#ifndef ESP_SLEEP_H
+#define ESP_SLEEP_H
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef enum
+{
+  ESP_SLEEP_WAKEUP_UNDEFINED,
+  ESP_SLEEP_WAKEUP_ALL,
+  ESP_SLEEP_WAKEUP_EXT0,
+  ESP_SLEEP_WAKEUP_EXT1,
+  ESP_SLEEP_WAKEUP_TIMER,
+  ESP_SLEEP_WAKEUP_TOUCHPAD,
+  ESP_SLEEP_WAKEUP_ULP,
+  ESP_SLEEP_WAKEUP_GPIO
+} esp_sleep_source_t;
+
+typedef esp_sleep_source_t esp_sleep_wakeup_cause_t;
+
+typedef enum
+{
+  ESP_EXT1_WAKEUP_ANY_LOW = 0,
+  ESP_EXT1_WAKEUP_ANY_HIGH = 1,
+  ESP_EXT1_WAKEUP_ALL_LOW = 0
+} esp_sleep_ext1_wakeup_mode_t;
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs);
+esp_err_t esp_sleep_enable_ext1_wakeup(uint64_t pinMask, esp_sleep_ext1_wakeup_mode_t mode);
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source);
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause();
+
+// Ends the wake-up: the simulation keeps the RTC memory and starts the next one after the timer
+[[noreturn]] void esp_deep_sleep_start();
+// Advances the simulated clock by the timer
+esp_err_t esp_light_sleep_start();
+
+#endif
@@ -0,0 +1,27 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the SNTP client
+ */
+
+#ifndef ESP_SNTP_H
+#define ESP_SNTP_H
+
+typedef enum
+{
+  SNTP_SYNC_STATUS_RESET,
+  SNTP_SYNC_STATUS_COMPLETED,
+  SNTP_SYNC_STATUS_IN_PROGRESS
+} sntp_sync_status_t;
+
+// configTime() starts the request, it completes while WiFi is connected and sets the system
+// time to the true time of the simulation
+void sntp_set_sync_status(sntp_sync_status_t status);
+sntp_sync_status_t sntp_get_sync_status();
+
+#endif
@@ -0,0 +1,31 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the FreeRTOS tasks, one host thread per task
+ */
+
+#ifndef FREERTOS_TASK_H
+#define FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *);
+typedef struct SimTask *TaskHandle_t;
+
+// The tasks run in host threads, the core is ignored. The delays of a task pass in real time
+// (shortened by time_scale of the scenario) and do not advance the simulated clock, the loop
+// task catches up with the time it waited for them.
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackDepth, void *parameters, UBaseType_t priority,
+                                   TaskHandle_t *handle, BaseType_t coreId);
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stackDepth, void *parameters, UBaseType_t priority, TaskHandle_t *handle);
+void vTaskDelete(TaskHandle_t task); // Only NULL, a task ends itself
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+BaseType_t xPortGetCoreID();
+
+#endif
@@ -0,0 +1,45 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation stand-in of the mbedTLS message digest, SHA-256 only
+ */
+
+#ifndef MBEDTLS_MD_H
+#define MBEDTLS_MD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum
+{
+  MBEDTLS_MD_NONE = 0,
+  MBEDTLS_MD_SHA256 = 6
+} mbedtls_md_type_t;
+
+typedef struct
+{
+  mbedtls_md_type_t type;
+} mbedtls_md_info_t;
+
+typedef struct
+{
+  uint32_t state[8];
+  uint64_t length; // Bytes hashed
+  uint8_t block[64];
+  size_t blockLength;
+} mbedtls_md_context_t;
+
+const mbedtls_md_info_t *mbedtls_md_info_from_type(mbedtls_md_type_t type);
+void mbedtls_md_init(mbedtls_md_context_t *ctx);
+int mbedtls_md_setup(mbedtls_md_context_t *ctx, const mbedtls_md_info_t *info, int hmac);
+int mbedtls_md_starts(mbedtls_md_context_t *ctx);
+int mbedtls_md_update(mbedtls_md_context_t *ctx, const unsigned char *input, size_t length);
+int mbedtls_md_finish(mbedtls_md_context_t *ctx, unsigned char *output);
+void mbedtls_md_free(mbedtls_md_context_t *ctx);
+
+#endif
@@ -0,0 +1,611 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation: Arduino core classes (String, Print, Stream, Serial, GPIO)
+ */
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <esp_rom_crc.h>
+
+#include "simulation.h"
+
+HardwareSerial Serial;
+
+static bool isPinLow[GPIO_NUM_MAX]; // All pins read high until an output is set low
+static unsigned long randomState = 1;
+
+// String
+
+static std::string formatInteger(unsigned long long value, bool isNegative, unsigned char base)
+{
+  if (base < 2 || base > 36)
+  {
+    base = 10;
+  }
+  char digits[66];
+  int position = sizeof(digits) - 1;
+  digits[position] = '\0';
+  do
+  {
+    unsigned digit = value % base;
+    digits[--position] = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    value /= base;
+  } while (value > 0);
+  if (isNegative)
+  {
+    digits[--position] = '-';
+  }
+  return std::string(digits + position);
+}
+
+static std::string formatSigned(long long value, unsigned char base)
+{
+  if (base == 10)
+  {
+    return formatInteger(value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value, value < 0, 10);
+  }
+  return formatInteger((unsigned long long)value, false, base); // Two's complement as in the Arduino core
+}
+
+static std::string formatFloat(double value, unsigned int decimalPlaces)
+{
+  if (isnan(value))
+  {
+    return "nan";
+  }
+  if (isinf(value))
+  {
+    return value > 0 ? "inf" : "-inf";
+  }
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.*f", (int)decimalPlaces, value);
+  return std::string(buffer);
+}
+
+String::String(const char *text) : text(text ? text : "") {}
+String::String(const char *text, size_t length) : text(text ? std::string(text, length) : std::string()) {}
+String::String(char c) : text(1, c) {}
+String::String(unsigned char value, unsigned char base) : text(formatInteger(value, false, base)) {}
+String::String(int value, unsigned char base) : text(base == 10 ? formatSigned(value, base) : formatInteger((unsigned int)value, false, base)) {}
+String::String(unsigned int value, unsigned char base) : text(formatInteger(value, false, base)) {}
+String::String(long value, unsigned char base) : text(base == 10 ? formatSigned(value, base) : formatInteger((unsigned long)value, false, base)) {}
+String::String(unsigned long value, unsigned char base) : text(formatInteger(value, false, base)) {}
+String::String(long long value, unsigned char base) : text(formatSigned(value, base)) {}
+String::String(unsigned long long value, unsigned char base) : text(formatInteger(value, false, base)) {}
+String::String(float value, unsigned int decimalPlaces) : text(formatFloat(value, decimalPlaces)) {}
+String::String(double value, unsigned int decimalPlaces) : text(formatFloat(value, decimalPlaces)) {}
+
+String &String::operator=(const char *text)
+{
+  this->text = text ? text : "";
+  return *this;
+}
+
+bool String::reserve(unsigned int size)
+{
+  text.reserve(size);
+  return true;
+}
+
+bool String::concat(const String &other)
+{
+  text += other.text;
+  return true;
+}
+
+bool String::concat(const char *other)
+{
+  if (other == nullptr)
+  {
+    return false;
+  }
+  text += other;
+  return true;
+}
+
+bool String::concat(char c)
+{
+  text += c;
+  return true;
+}
+
+String &String::operator+=(const String &other) { concat(other); return *this; }
+String &String::operator+=(const char *other) { concat(other); return *this; }
+String &String::operator+=(char c) { concat(c); return *this; }
+String &String::operator+=(int value) { return *this += String(value); }
+String &String::operator+=(unsigned int value) { return *this += String(value); }
+String &String::operator+=(long value) { return *this += String(value); }
+String &String::operator+=(unsigned long value) { return *this += String(value); }
+String &String::operator+=(long long value) { return *this += String(value); }
+String &String::operator+=(unsigned long long value) { return *this += String(value); }
+String &String::operator+=(float value) { return *this += String(value); }
+String &String::operator+=(double value) { return *this += String(value); }
+
+int String::compareTo(const String &other) const
+{
+  return text.compare(other.text);
+}
+
+bool String::equalsIgnoreCase(const String &other) const
+{
+  return text.size() == other.text.size() && strcasecmp(text.c_str(), other.text.c_str()) == 0;
+}
+
+bool String::startsWith(const String &prefix) const
+{
+  return text.compare(0, prefix.text.size(), prefix.text) == 0 && text.size() >= prefix.text.size();
+}
+
+bool String::startsWith(const String &prefix, unsigned int offset) const
+{
+  return offset <= text.size() && text.size() - offset >= prefix.text.size() && text.compare(offset, prefix.text.size(), prefix.text) == 0;
+}
+
+bool String::endsWith(const String &suffix) const
+{
+  return text.size() >= suffix.text.size() && text.compare(text.size() - suffix.text.size(), suffix.text.size(), suffix.text) == 0;
+}
+
+char String::charAt(unsigned int index) const
+{
+  return index < text.size() ? text[index] : '\0';
+}
+
+void String::setCharAt(unsigned int index, char c)
+{
+  if (index < text.size())
+  {
+    text[index] = c;
+  }
+}
+
+char &String::operator[](unsigned int index)
+{
+  static char dummy;
+  if (index >= text.size())
+  {
+    dummy = '\0';
+    return dummy;
+  }
+  return text[index];
+}
+
+void String::getBytes(unsigned char *buffer, unsigned int bufferSize, unsigned int index) const
+{
+  if (bufferSize == 0 || buffer == nullptr)
+  {
+    return;
+  }
+  if (index >= text.size())
+  {
+    buffer[0] = '\0';
+    return;
+  }
+  size_t count = std::min<size_t>(bufferSize - 1, text.size() - index);
+  memcpy(buffer, text.data() + index, count);
+  buffer[count] = '\0';
+}
+
+void String::toCharArray(char *buffer, unsigned int bufferSize, unsigned int index) const
+{
+  getBytes((unsigned char *)buffer, bufferSize, index);
+}
+
+int String::indexOf(char c, unsigned int fromIndex) const
+{
+  size_t position = text.find(c, fromIndex);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::indexOf(const String &other, unsigned int fromIndex) const
+{
+  size_t position = text.find(other.text, fromIndex);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::lastIndexOf(char c) const
+{
+  size_t position = text.rfind(c);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::lastIndexOf(char c, unsigned int fromIndex) const
+{
+  size_t position = text.rfind(c, fromIndex);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::lastIndexOf(const String &other) const
+{
+  size_t position = text.rfind(other.text);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::lastIndexOf(const String &other, unsigned int fromIndex) const
+{
+  size_t position = text.rfind(other.text, fromIndex);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+String String::substring(unsigned int beginIndex) const
+{
+  return substring(beginIndex, (unsigned int)text.size());
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const
+{
+  if (beginIndex > endIndex)
+  {
+    std::swap(beginIndex, endIndex);
+  }
+  if (beginIndex >= text.size())
+  {
+    return String();
+  }
+  endIndex = std::min<unsigned int>(endIndex, (unsigned int)text.size());
+  return String(text.c_str() + beginIndex, endIndex - beginIndex);
+}
+
+void String::replace(char find, char replacement)
+{
+  for (char &c : text)
+  {
+    if (c == find)
+    {
+      c = replacement;
+    }
+  }
+}
+
+void String::replace(const String &find, const String &replacement)
+{
+  if (find.text.empty())
+  {
+    return;
+  }
+  size_t position = 0;
+  while ((position = text.find(find.text, position)) != std::string::npos)
+  {
+    text.replace(position, find.text.size(), replacement.text);
+    position += replacement.text.size();
+  }
+}
+
+void String::remove(unsigned int index)
+{
+  if (index < text.size())
+  {
+    text.erase(index);
+  }
+}
+
+void String::remove(unsigned int index, unsigned int count)
+{
+  if (index < text.size())
+  {
+    text.erase(index, count);
+  }
+}
+
+void String::toLowerCase()
+{
+  for (char &c : text)
+  {
+    c = (char)tolower((unsigned char)c);
+  }
+}
+
+void String::toUpperCase()
+{
+  for (char &c : text)
+  {
+    c = (char)toupper((unsigned char)c);
+  }
+}
+
+void String::trim()
+{
+  size_t begin = text.find_first_not_of(" \t\r\n\f\v");
+  if (begin == std::string::npos)
+  {
+    text.clear();
+    return;
+  }
+  size_t end = text.find_last_not_of(" \t\r\n\f\v");
+  text = text.substr(begin, end - begin + 1);
+}
+
+long String::toInt() const
+{
+  return atol(text.c_str());
+}
+
+float String::toFloat() const
+{
+  return (float)atof(text.c_str());
+}
+
+double String::toDouble() const
+{
+  return atof(text.c_str());
+}
+
+String operator+(const String &left, const String &right)
+{
+  String sum(left);
+  sum.concat(right);
+  return sum;
+}
+
+String operator+(const String &left, const char *right) { return left + String(right); }
+String operator+(const char *left, const String &right) { return String(left) + right; }
+String operator+(const String &left, char right) { return left + String(right); }
+String operator+(const String &left, int right) { return left + String(right); }
+String operator+(const String &left, unsigned int right) { return left + String(right); }
+String operator+(const String &left, long right) { return left + String(right); }
+String operator+(const String &left, unsigned long right) { return left + String(right); }
+String operator+(const String &left, long long right) { return left + String(right); }
+String operator+(const String &left, unsigned long long right) { return left + String(right); }
+String operator+(const String &left, float right) { return left + String(right); }
+String operator+(const String &left, double right) { return left + String(right); }
+
+// Print
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+  size_t n = 0;
+  while (size-- > 0 && write(*buffer++) == 1)
+  {
+    n++;
+  }
+  return n;
+}
+
+size_t Print::write(const char *text)
+{
+  return text == nullptr ? 0 : write((const uint8_t *)text, strlen(text));
+}
+
+size_t Print::printf(const char *format, ...)
+{
+  char stackBuffer[128];
+  va_list arguments;
+  va_start(arguments, format);
+  int length = vsnprintf(stackBuffer, sizeof(stackBuffer), format, arguments);
+  va_end(arguments);
+  if (length < 0)
+  {
+    return 0;
+  }
+  if ((size_t)length < sizeof(stackBuffer))
+  {
+    return write((const uint8_t *)stackBuffer, length);
+  }
+  std::string buffer(length + 1, '\0');
+  va_start(arguments, format);
+  vsnprintf(&buffer[0], buffer.size(), format, arguments);
+  va_end(arguments);
+  return write((const uint8_t *)buffer.data(), length);
+}
+
+size_t Print::print(const String &text) { return write((const uint8_t *)text.c_str(), text.length()); }
+size_t Print::print(const char *text) { return write(text); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char value, int base) { return print(String(value, (unsigned char)base)); }
+size_t Print::print(int value, int base) { return print(String(value, (unsigned char)base)); }
+size_t Print::print(unsigned int value, int base) { return print(String(value, (unsigned char)base)); }
+size_t Print::print(long value, int base) { return print(String(value, (unsigned char)base)); }
+size_t Print::print(unsigned long value, int base) { return print(String(value, (unsigned char)base)); }
+size_t Print::print(long long value, int base) { return print(String(value, (unsigned char)base)); }
+size_t Print::print(unsigned long long value, int base) { return print(String(value, (unsigned char)base)); }
+size_t Print::print(double value, int digits) { return print(String(value, (unsigned int)digits)); }
+
+size_t Print::println()
+{
+  return write((const uint8_t *)"\r\n", 2);
+}
+
+// Stream
+
+size_t Stream::readBytes(char *buffer, size_t length)
+{
+  size_t count = 0;
+  while (count < length)
+  {
+    int c = read();
+    if (c < 0)
+    {
+      break;
+    }
+    buffer[count++] = (char)c;
+  }
+  return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length)
+{
+  size_t count = 0;
+  while (count < length)
+  {
+    int c = read();
+    if (c < 0 || c == terminator)
+    {
+      break;
+    }
+    buffer[count++] = (char)c;
+  }
+  return count;
+}
+
+String Stream::readString()
+{
+  std::string text;
+  int c;
+  while ((c = read()) >= 0)
+  {
+    text += (char)c;
+  }
+  return String(text.c_str(), text.size());
+}
+
+String Stream::readStringUntil(char terminator)
+{
+  std::string text;
+  int c;
+  while ((c = read()) >= 0 && c != terminator)
+  {
+    text += (char)c;
+  }
+  return String(text.c_str(), text.size());
+}
+
+// Serial, to stdout if enabled in the scenario
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+  if (simScenario.isSerialEnabled)
+  {
+    fwrite(buffer, 1, size, stdout);
+  }
+  return size;
+}
+
+void HardwareSerial::flush()
+{
+  fflush(stdout);
+}
+
+// GPIO: the inputs read high (no power supply, no configuration button), outputs read back
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  if (pin < GPIO_NUM_MAX && (mode & OUTPUT) != OUTPUT)
+  {
+    isPinLow[pin] = false;
+  }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  if (pin < GPIO_NUM_MAX)
+  {
+    isPinLow[pin] = value == LOW;
+  }
+}
+
+int digitalRead(uint8_t pin)
+{
+  return pin < GPIO_NUM_MAX && isPinLow[pin] ? LOW : HIGH;
+}
+
+esp_err_t gpio_hold_en(gpio_num_t pin)
+{
+  (void)pin;
+  return ESP_OK;
+}
+
+esp_err_t gpio_hold_dis(gpio_num_t pin)
+{
+  (void)pin;
+  return ESP_OK;
+}
+
+void gpio_deep_sleep_hold_en() {}
+void gpio_deep_sleep_hold_dis() {}
+
+// Miscellaneous
+
+long random(long max)
+{
+  return max <= 0 ? 0 : random(0, max);
+}
+
+long random(long min, long max)
+{
+  if (min >= max)
+  {
+    return min;
+  }
+  randomState = randomState * 1103515245UL + 12345UL;
+  return min + (long)((randomState >> 16) % (unsigned long)(max - min));
+}
+
+void randomSeed(unsigned long seed)
+{
+  randomState = seed != 0 ? seed : 1;
+}
+
+#ifdef SIM_STRLCPY
+size_t strlcpy(char *destination, const char *source, size_t size)
+{
+  size_t length = strlen(source);
+  if (size > 0)
+  {
+    size_t count = length < size - 1 ? length : size - 1;
+    memcpy(destination, source, count);
+    destination[count] = '\0';
+  }
+  return length;
+}
+
+size_t strlcat(char *destination, const char *source, size_t size)
+{
+  size_t length = strnlen(destination, size);
+  if (length == size)
+  {
+    return size + strlen(source);
+  }
+  return length + strlcpy(destination + length, source, size - length);
+}
+#endif
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buffer, uint32_t length)
+{
+  crc = ~crc;
+  while (length-- > 0)
+  {
+    crc ^= *buffer++;
+    for (int bit = 0; bit < 8; bit++)
+    {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+bool IPAddress::fromString(const char *text)
+{
+  unsigned octet[4];
+  char end;
+  if (text == nullptr || sscanf(text, "%u.%u.%u.%u%c", &octet[0], &octet[1], &octet[2], &octet[3], &end) != 4 ||
+      octet[0] > 255 || octet[1] > 255 || octet[2] > 255 || octet[3] > 255)
+  {
+    return false;
+  }
+  *this = IPAddress(octet[0], octet[1], octet[2], octet[3]);
+  return true;
+}
+
+String IPAddress::toString() const
+{
+  char text[16];
+  snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+  return String(text);
+}
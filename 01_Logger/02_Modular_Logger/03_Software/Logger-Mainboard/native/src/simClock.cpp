@@ -0,0 +1,236 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation: simulated clock, sleep modes and resets
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
+
+#include <Arduino.h>
+#include <esp32s3/rtc.h>
+#include <esp_sleep.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+
+#include "simulation.h"
+
+static thread_local bool isTaskThread = false;
+static uint32_t cpuFrequencyMhz = 240;
+
+int64_t simTrueTimeUs()
+{
+  return simState->trueTimeUs.load();
+}
+
+int64_t simUptimeUs()
+{
+  return simTrueTimeUs() - simState->wakeStartUs;
+}
+
+void simAdvanceUs(int64_t us)
+{
+  if (us > 0)
+  {
+    simState->trueTimeUs.fetch_add(us);
+  }
+  if (simIsLoopThread() && simTrueTimeUs() >= simScenarioEndUs())
+  {
+    simEndWakeUp(SIM_EXIT_SCENARIO_END); // E.g. an endless alarm blinking
+  }
+}
+
+bool simIsLoopThread()
+{
+  return !isTaskThread;
+}
+
+/**
+ * @brief Marks the calling thread as a FreeRTOS task, its delays do not advance the clock.
+ */
+void simMarkTaskThread()
+{
+  isTaskThread = true;
+}
+
+int64_t simRealTimeUs()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Waits for the delay of a task in real time, shortened by time_scale.
+ */
+void simWaitTaskDelay(uint32_t ms)
+{
+  std::this_thread::sleep_for(std::chrono::microseconds((int64_t)(ms * 1000.0 / simScenario.timeScale)));
+}
+
+/**
+ * @brief Advances the clock by the real time the loop task was blocked on a task, scaled
+ *        with time_scale like the delays of the task.
+ * @param realStartUs simRealTimeUs() at the start of the wait.
+ */
+void simCatchUp(int64_t realStartUs)
+{
+  if (simIsLoopThread())
+  {
+    simAdvanceUs((int64_t)((simRealTimeUs() - realStartUs) * simScenario.timeScale));
+  }
+}
+
+/**
+ * @brief Ends the process of the wake-up, the parent continues with the next one.
+ * @param exit Deep sleep (the RTC memory is kept) or restart.
+ */
+void simEndWakeUp(SimExit exit)
+{
+  Serial.flush();
+  fflush(stdout);
+  memcpy(simState->rtcMemory, __rtc_data_start, simState->rtcMemorySize);
+  simState->exit = exit;
+  _exit(0);
+}
+
+unsigned long millis()
+{
+  return (unsigned long)(simUptimeUs() / 1000);
+}
+
+unsigned long micros()
+{
+  return (unsigned long)simUptimeUs();
+}
+
+void delay(uint32_t ms)
+{
+  if (simIsLoopThread())
+  {
+    simAdvanceUs((int64_t)ms * 1000);
+  }
+  else
+  {
+    simWaitTaskDelay(ms);
+  }
+}
+
+void delayMicroseconds(uint32_t us)
+{
+  if (simIsLoopThread())
+  {
+    simAdvanceUs(us);
+  }
+}
+
+void yield()
+{
+  std::this_thread::yield();
+}
+
+int64_t esp_timer_get_time()
+{
+  return simUptimeUs();
+}
+
+uint64_t esp_rtc_get_time_us(void)
+{
+  return (uint64_t)(simTrueTimeUs() - simScenario.startTime * 1000000); // Powered on at the start of the scenario
+}
+
+// Replaces the function of the C library for the firmware: the system time of the ESP32 keeps
+// running in deep sleep and is set by SNTP
+extern "C" int gettimeofday(struct timeval *tv, void *tz) noexcept
+{
+  (void)tz;
+  int64_t systemTimeUs = simTrueTimeUs() + simState->systemOffsetUs;
+  tv->tv_sec = (time_t)(systemTimeUs / 1000000);
+  tv->tv_usec = (suseconds_t)(systemTimeUs % 1000000);
+  return 0;
+}
+
+bool setCpuFrequencyMhz(uint32_t mhz)
+{
+  cpuFrequencyMhz = mhz;
+  return true;
+}
+
+uint32_t getCpuFrequencyMhz()
+{
+  return cpuFrequencyMhz;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs)
+{
+  simState->sleepUs = (int64_t)timeUs;
+  simState->lightSleepUs = (int64_t)timeUs;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_ext1_wakeup(uint64_t pinMask, esp_sleep_ext1_wakeup_mode_t mode)
+{
+  (void)pinMask; // The simulated pins stay high, they never wake the logger
+  (void)mode;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source)
+{
+  if (source == ESP_SLEEP_WAKEUP_TIMER || source == ESP_SLEEP_WAKEUP_ALL)
+  {
+    simState->sleepUs = -1;
+    simState->lightSleepUs = -1;
+  }
+  return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause()
+{
+  return simState->resetReason == ESP_RST_DEEPSLEEP ? ESP_SLEEP_WAKEUP_TIMER : ESP_SLEEP_WAKEUP_UNDEFINED;
+}
+
+void esp_deep_sleep_start()
+{
+  simEndWakeUp(SIM_EXIT_DEEP_SLEEP);
+}
+
+esp_err_t esp_light_sleep_start()
+{
+  if (simState->lightSleepUs < 0)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+  simAdvanceUs(simState->lightSleepUs);
+  return ESP_OK;
+}
+
+esp_reset_reason_t esp_reset_reason()
+{
+  return simState->resetReason;
+}
+
+void esp_restart()
+{
+  simEndWakeUp(SIM_EXIT_RESTART);
+}
+
+void EspClass::restart()
+{
+  simEndWakeUp(SIM_EXIT_RESTART);
+}
+
+uint64_t EspClass::getEfuseMac()
+{
+  return simScenario.efuseMac;
+}
+
+EspClass ESP;
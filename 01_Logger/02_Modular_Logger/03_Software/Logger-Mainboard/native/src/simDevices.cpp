@@ -0,0 +1,566 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation: I2C buses with the interface boards, the BMS and the DS3231
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <Arduino.h>
+#include <RTClib.h>
+#include <Wire.h>
+
+#include "simulation.h"
+
+TwoWire Wire(0);
+TwoWire Wire1(1);
+
+static const int64_t i2cByteUs = 90; // One byte with ACK at 100 kHz
+static const uint8_t bmsAddress = 0x0B;
+
+// Commands of the interface boards (lib/I2C_Adapter/I2C_Master.h)
+enum
+{
+  BOARD_GETVER = 0x00,
+  BOARD_GETVALUE1 = 0x03,
+  BOARD_GETVALUE2 = 0x04,
+  BOARD_CONVERT = 0x05,
+  BOARD_SLEEP = 0x06,
+  BOARD_WAKEUP = 0x07,
+  BOARD_SET_TEMP = 0x08,
+  BOARD_GET_SENSORVOLTAGE = 0x09,
+  BOARD_GETRAWVALUE1 = 0x13,
+  BOARD_GETRAWVALUE2 = 0x14,
+  BOARD_GET_PARAMETER = 0x15,
+  BOARD_GET_RDY = 0x16,
+  BOARD_GET_CALIBRATED = 0x18,
+  BOARD_GET_SENSOR_WAKEUP_TIME = 0x19,
+  BOARD_GET_FW_VERSION = 0x20,
+  BOARD_SOFTWARE_RESET = 0x21,
+  BOARD_SET_SAMPLE_INTERVAL = 0x22,
+  BOARD_GET_SAMPLE_COUNT = 0x23,
+  BOARD_GET_SAMPLES = 0x24,
+  BOARD_REMOVE_SAMPLES = 0x25
+};
+
+static const int64_t sampleTickUs = 62500; // Timer tick of the autonomous sampling
+static const int64_t sampleRingSize = 32;
+static const int sampleBurstMax = 10;
+
+// Registers of the BQ40Z50 (lib/BMS/BMS_lib.h)
+enum
+{
+  BMS_VOLTAGE = 0x09,
+  BMS_CURRENT = 0x0A,
+  BMS_RSOC = 0x0D,
+  BMS_REMAINING_CAPACITY = 0x0F,
+  BMS_DA_STATUS_1 = 0x71,
+  BMS_DA_STATUS_2 = 0x72
+};
+
+static uint8_t bmsRegister = 0;
+
+/**
+ * @brief Advances the clock by the transfer time of a number of bytes on the bus.
+ */
+static void spendBusTime(size_t bytes)
+{
+  if (simIsLoopThread())
+  {
+    simAdvanceUs((int64_t)(bytes + 1) * i2cByteUs);
+  }
+}
+
+/**
+ * @brief Finds the interface board of an address.
+ * @return Index in simScenario.boards, -1 if no board answers.
+ */
+static int findBoard(uint16_t address)
+{
+  for (size_t i = 0; i < simScenario.boards.size() && i < SIM_MAX_BOARDS; i++)
+  {
+    if (simScenario.boards[i].address == address)
+    {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Measured value of a parameter at a depth (< 0 out of the water).
+ */
+static float measureParameter(uint8_t parameter, double depthM)
+{
+  bool isInWater = depthM >= 0;
+  switch (parameter)
+  {
+  case 1: // Temperature in degC, a thermocline of 0.1 K/m
+    return isInWater ? (float)(15.0 - 0.1 * depthM) : 20.0f;
+  case 2: // Pressure in mbar
+    return (float)(1013.25 + (isInWater ? 100.5 * depthM : 0.0));
+  case 3: // Oxygen partial pressure in mbar
+    return 210.0f;
+  case 4: // Conductivity in mS/cm, the wet and dry detection
+    return isInWater ? 40.0f : 0.0f;
+  case 5: // Turbidity in NTU
+    return isInWater ? 1.0f : 0.0f;
+  default:
+    return 0.0f;
+  }
+}
+
+/**
+ * @brief Writes a value as the interface board does: 8 bytes big-endian, the float bits in the
+ *        low 32 bits (see floatingPointConvert()).
+ */
+static void putValue(uint8_t *buffer, float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  memset(buffer, 0, 4);
+  buffer[4] = (uint8_t)(bits >> 24);
+  buffer[5] = (uint8_t)(bits >> 16);
+  buffer[6] = (uint8_t)(bits >> 8);
+  buffer[7] = (uint8_t)bits;
+}
+
+/**
+ * @brief Moves the samples the ring of a board cannot hold anymore to the dropped samples.
+ *        A board takes no samples after its sensor was switched off (resuming after a wake-up is not modelled).
+ * @return Number of samples in the ring.
+ */
+static int64_t updateSamples(SimBoardState &state, int64_t now)
+{
+  int64_t end = state.sampleStopUs >= 0 ? std::min(now, state.sampleStopUs) : now;
+  if (state.firstSampleUs < 0 || end < state.firstSampleUs)
+  {
+    return 0;
+  }
+  int64_t taken = (end - state.firstSampleUs) / state.sampleIntervalUs + 1;
+  if (taken - state.samplesRemoved > sampleRingSize)
+  {
+    state.samplesDropped = (uint8_t)std::min<int64_t>(255, state.samplesDropped + taken - state.samplesRemoved - sampleRingSize);
+    state.samplesRemoved = taken - sampleRingSize;
+  }
+  return taken - state.samplesRemoved;
+}
+
+static void putWord(uint8_t *buffer, uint32_t word)
+{
+  buffer[0] = (uint8_t)(word >> 24);
+  buffer[1] = (uint8_t)(word >> 16);
+  buffer[2] = (uint8_t)(word >> 8);
+  buffer[3] = (uint8_t)word;
+}
+
+static uint8_t writeBoard(int index, const uint8_t *data, size_t length)
+{
+  const SimBoard &board = simScenario.boards[index];
+  SimBoardState &state = simState->boards[index];
+  int64_t now = simTrueTimeUs();
+  state.lastCommand = data[0];
+  state.lastParameter = length >= 2 ? data[1] : 0;
+
+  switch (data[0])
+  {
+  case BOARD_WAKEUP:
+    if (!state.isAwake)
+    {
+      state.isAwake = true;
+      state.readyUs = now + board.wakeMs * 1000LL;
+    }
+    break;
+  case BOARD_SLEEP:
+    state.isAwake = false;
+    if (state.firstSampleUs >= 0 && state.sampleStopUs < 0)
+    {
+      state.sampleStopUs = now;
+    }
+    break;
+  case BOARD_CONVERT:
+    state.conversionUs = std::max<int64_t>(now, state.isAwake ? state.readyUs : now + board.wakeMs * 1000LL);
+    state.value[0] = measureParameter(board.parameter, simDepthM(now));
+    state.value[1] = measureParameter(1, simDepthM(now)); // The second value is the temperature of the sensor
+    break;
+  case BOARD_SET_TEMP:
+    if (length >= 5)
+    {
+      uint32_t bits = ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 8) | data[4];
+      memcpy(&state.temperature, &bits, sizeof(bits));
+    }
+    break;
+  case BOARD_SOFTWARE_RESET:
+    state.isAwake = false;
+    state.conversionUs = -1;
+    state.firstSampleUs = -1;
+    break;
+  case BOARD_SET_SAMPLE_INTERVAL:
+    if (length >= 5)
+    {
+      uint32_t intervalMs = ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 8) | data[4];
+      state.sampleIntervalUs = std::max<int64_t>(sampleTickUs, intervalMs * 1000LL);
+      state.firstSampleUs = intervalMs > 0 ? now + sampleTickUs : -1;
+      state.sampleStopUs = -1;
+      state.samplesRemoved = 0;
+      if (intervalMs > 0 && !state.isAwake)
+      {
+        state.isAwake = true; // The board switches the sensor on to sample
+        state.readyUs = now + board.wakeMs * 1000LL;
+      }
+      state.samplesDropped = 0;
+    }
+    break;
+  case BOARD_REMOVE_SAMPLES:
+    if (length >= 2)
+    {
+      state.samplesRemoved += std::min<int64_t>(data[1], updateSamples(state, now));
+      if (updateSamples(state, now) == 0)
+      {
+        state.samplesDropped = 0;
+      }
+    }
+    break;
+  default:
+    break;
+  }
+  return 0;
+}
+
+static size_t readBoard(int index, uint8_t *buffer, size_t length)
+{
+  const SimBoard &board = simScenario.boards[index];
+  SimBoardState &state = simState->boards[index];
+  int64_t now = simTrueTimeUs();
+  uint8_t answer[1 + sampleBurstMax * 12] = {0};
+
+  switch (state.lastCommand)
+  {
+  case BOARD_GETVER:
+    answer[0] = 1;
+    answer[3] = board.typeId;
+    break;
+  case BOARD_GET_SENSORVOLTAGE:
+    answer[0] = board.voltage;
+    break;
+  case BOARD_GET_PARAMETER:
+    answer[0] = board.parameter;
+    break;
+  case BOARD_GET_RDY:
+    answer[0] = state.conversionUs >= 0 && simTrueTimeUs() >= state.conversionUs + board.conversionMs * 1000LL ? 1 : 0;
+    break;
+  case BOARD_GET_CALIBRATED:
+    answer[0] = 1;
+    break;
+  case BOARD_GET_FW_VERSION:
+    answer[0] = 1;
+    break;
+  case BOARD_GET_SENSOR_WAKEUP_TIME:
+    answer[0] = (uint8_t)(board.wakeMs >> 8);
+    answer[1] = (uint8_t)board.wakeMs;
+    break;
+  case BOARD_GETVALUE1:
+  case BOARD_GETRAWVALUE1:
+    putValue(answer, state.value[0]);
+    break;
+  case BOARD_GETVALUE2:
+  case BOARD_GETRAWVALUE2:
+    putValue(answer, state.value[1]);
+    break;
+  case BOARD_GET_SAMPLE_COUNT:
+    answer[0] = (uint8_t)updateSamples(state, now);
+    answer[1] = state.samplesDropped;
+    break;
+  case BOARD_GET_SAMPLES:
+  {
+    // The samples stay in the ring until BOARD_REMOVE_SAMPLES, the values at the depth of their time
+    int64_t count = std::min<int64_t>({(int64_t)state.lastParameter, updateSamples(state, now), (int64_t)sampleBurstMax});
+    answer[0] = (uint8_t)count;
+    for (int64_t i = 0; i < count; i++)
+    {
+      int64_t sampleUs = state.firstSampleUs + (state.samplesRemoved + i) * state.sampleIntervalUs;
+      float values[2] = {measureParameter(board.parameter, simDepthM(sampleUs)), measureParameter(1, simDepthM(sampleUs))};
+      uint32_t bits[2];
+      memcpy(bits, values, sizeof(bits));
+      putWord(&answer[1 + i * 12], (uint32_t)((now - sampleUs) / 1000));
+      putWord(&answer[5 + i * 12], bits[0]);
+      putWord(&answer[9 + i * 12], bits[1]);
+    }
+    break;
+  }
+  default:
+    break;
+  }
+
+  size_t count = std::min(length, sizeof(answer));
+  memcpy(buffer, answer, count);
+  memset(buffer + count, 0, length - count);
+  return length;
+}
+
+/**
+ * @brief Answers a register of the BMS from the battery of the scenario. The safety alerts and
+ *        states stay 0.
+ */
+static size_t readBms(uint8_t *buffer, size_t length)
+{
+  double remainingMah = simBatteryRemainingMah();
+  double relative = std::max(0.0, std::min(1.0, remainingMah / simScenario.batteryCapacityMah));
+  uint16_t cellMv = (uint16_t)(3000 + 1200 * relative); // Linear between empty and full
+  int16_t currentMa = (int16_t)-lround(simScenario.awakeCurrentMa);
+  uint8_t answer[32] = {0};
+
+  switch (bmsRegister)
+  {
+  case BMS_VOLTAGE:
+    answer[0] = (uint8_t)(4 * cellMv);
+    answer[1] = (uint8_t)((4 * cellMv) >> 8);
+    break;
+  case BMS_CURRENT:
+    answer[0] = (uint8_t)currentMa;
+    answer[1] = (uint8_t)((uint16_t)currentMa >> 8);
+    break;
+  case BMS_RSOC:
+    answer[0] = (uint8_t)lround(100 * relative);
+    break;
+  case BMS_REMAINING_CAPACITY:
+    answer[0] = (uint8_t)lround(remainingMah);
+    answer[1] = (uint8_t)(lround(remainingMah) >> 8);
+    break;
+  case BMS_DA_STATUS_1:
+    answer[0] = 32; // Block length
+    for (int cell = 0; cell < 4; cell++)
+    {
+      answer[1 + 2 * cell] = (uint8_t)cellMv;
+      answer[2 + 2 * cell] = (uint8_t)(cellMv >> 8);
+      answer[13 + 2 * cell] = (uint8_t)currentMa;
+      answer[14 + 2 * cell] = (uint8_t)((uint16_t)currentMa >> 8);
+    }
+    break;
+  case BMS_DA_STATUS_2:
+    answer[0] = 16;
+    answer[3] = (uint8_t)2931; // TS1 20 degC in 0.1 K
+    answer[4] = (uint8_t)(2931 >> 8);
+    break;
+  default:
+    break;
+  }
+
+  size_t count = std::min(length, sizeof(answer));
+  memcpy(buffer, answer, count);
+  memset(buffer + count, 0, length - count);
+  return length;
+}
+
+/**
+ * @brief Writes a transaction to a device.
+ * @return 0 ACK, 2 NACK on the address (as TwoWire::endTransmission()).
+ */
+uint8_t simI2cWrite(uint8_t busNumber, uint16_t address, const uint8_t *data, size_t length)
+{
+  spendBusTime(length);
+  if (busNumber == 0)
+  {
+    int index = findBoard(address);
+    if (index < 0)
+    {
+      return 2;
+    }
+    return length > 0 ? writeBoard(index, data, length) : 0;
+  }
+  if (busNumber == 1 && address == bmsAddress)
+  {
+    if (length > 0)
+    {
+      bmsRegister = data[0];
+    }
+    return 0;
+  }
+  return 2;
+}
+
+/**
+ * @brief Reads from a device.
+ * @return Number of bytes read, 0 if no device answers.
+ */
+size_t simI2cRead(uint8_t busNumber, uint16_t address, uint8_t *buffer, size_t length)
+{
+  spendBusTime(length);
+  if (busNumber == 0)
+  {
+    int index = findBoard(address);
+    return index < 0 ? 0 : readBoard(index, buffer, length);
+  }
+  if (busNumber == 1 && address == bmsAddress)
+  {
+    return readBms(buffer, length);
+  }
+  return 0;
+}
+
+// TwoWire
+
+TwoWire::TwoWire(uint8_t busNumber) : busNumber(busNumber)
+{
+}
+
+bool TwoWire::begin(int sdaPin, int sclPin, uint32_t frequency)
+{
+  (void)sdaPin;
+  (void)sclPin;
+  (void)frequency;
+  return true;
+}
+
+bool TwoWire::end()
+{
+  return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency)
+{
+  (void)frequency;
+  return true;
+}
+
+void TwoWire::beginTransmission(uint16_t address)
+{
+  txAddress = address;
+  txLength = 0;
+  isTxOverflow = false;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+  (void)sendStop;
+  if (isTxOverflow)
+  {
+    return 1;
+  }
+  uint8_t result = simI2cWrite(busNumber, txAddress, txBuffer, txLength);
+  txLength = 0;
+  return result;
+}
+
+size_t TwoWire::requestFrom(uint16_t address, size_t size, bool sendStop)
+{
+  (void)sendStop;
+  rxIndex = 0;
+  rxLength = simI2cRead(busNumber, address, rxBuffer, std::min(size, sizeof(rxBuffer)));
+  return rxLength;
+}
+
+size_t TwoWire::write(uint8_t c)
+{
+  if (txLength >= sizeof(txBuffer))
+  {
+    isTxOverflow = true;
+    return 0;
+  }
+  txBuffer[txLength++] = c;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *buffer, size_t size)
+{
+  size_t written = 0;
+  while (written < size && write(buffer[written]) == 1)
+  {
+    written++;
+  }
+  return written;
+}
+
+int TwoWire::available()
+{
+  return (int)(rxLength - rxIndex);
+}
+
+int TwoWire::read()
+{
+  return rxIndex < rxLength ? rxBuffer[rxIndex++] : -1;
+}
+
+int TwoWire::peek()
+{
+  return rxIndex < rxLength ? rxBuffer[rxIndex] : -1;
+}
+
+// DS3231
+
+/**
+ * @brief Converts days since 1970-01-01 into the civil date (H. Hinnant's algorithm).
+ */
+static void civilFromDays(int64_t days, int *year, unsigned *month, unsigned *day)
+{
+  days += 719468;
+  int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  unsigned dayOfEra = (unsigned)(days - era * 146097);
+  unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+  unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+  unsigned monthPrime = (5 * dayOfYear + 2) / 153;
+  *day = dayOfYear - (153 * monthPrime + 2) / 5 + 1;
+  *month = monthPrime < 10 ? monthPrime + 3 : monthPrime - 9;
+  *year = (int)(yearOfEra + era * 400 + (*month <= 2));
+}
+
+static int64_t daysFromCivil(int year, unsigned month, unsigned day)
+{
+  year -= month <= 2;
+  int64_t era = (year >= 0 ? year : year - 399) / 400;
+  unsigned yearOfEra = (unsigned)(year - era * 400);
+  unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  return era * 146097 + (int64_t)dayOfEra - 719468;
+}
+
+DateTime::DateTime(uint32_t unixTime) : unixTime(unixTime)
+{
+  int year;
+  unsigned month, day;
+  civilFromDays(unixTime / 86400, &year, &month, &day);
+  yearValue = (uint16_t)year;
+  monthValue = (uint8_t)month;
+  dayValue = (uint8_t)day;
+  hourValue = (uint8_t)(unixTime % 86400 / 3600);
+  minuteValue = (uint8_t)(unixTime % 3600 / 60);
+  secondValue = (uint8_t)(unixTime % 60);
+}
+
+DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second)
+    : DateTime((uint32_t)(daysFromCivil(year < 100 ? year + 2000 : year, month, day) * 86400 + hour * 3600 + minute * 60 + second))
+{
+}
+
+/**
+ * @brief Time of the drifting oscillator of the DS3231, equal to the true time at the start.
+ */
+static double rtcOscillatorSec()
+{
+  double elapsedSec = (simTrueTimeUs() - simScenario.startTime * 1000000) / 1e6;
+  return simScenario.startTime + elapsedSec * (1 + simScenario.rtcDriftPpm * 1e-6);
+}
+
+bool RTC_DS3231::begin(TwoWire *wire)
+{
+  (void)wire;
+  return true;
+}
+
+void RTC_DS3231::adjust(const DateTime &time)
+{
+  spendBusTime(8);
+  simState->rtcOffsetSec = time.unixtime() - rtcOscillatorSec();
+}
+
+DateTime RTC_DS3231::now()
+{
+  spendBusTime(8);
+  return DateTime((uint32_t)floor(rtcOscillatorSec() + simState->rtcOffsetSec));
+}
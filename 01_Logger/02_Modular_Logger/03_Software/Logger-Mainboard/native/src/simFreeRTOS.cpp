@@ -0,0 +1,269 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation: FreeRTOS tasks, queues, mutexes and event groups on host threads
+ */
+
+#include <string.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "simulation.h"
+
+struct SimTask
+{
+  TaskFunction_t function;
+  void *parameters;
+};
+
+struct SimQueue
+{
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<std::vector<uint8_t>> items;
+  size_t length;
+  size_t itemSize;
+};
+
+struct SimMutex
+{
+  std::timed_mutex mutex;
+};
+
+struct SimEventGroup
+{
+  std::mutex mutex;
+  std::condition_variable changed;
+  EventBits_t bits = 0;
+};
+
+struct SimTaskExit
+{
+};
+
+/**
+ * @brief Waits on a condition for ticks, portMAX_DELAY forever. The loop task catches up with
+ *        the real time it waited (see simCatchUp).
+ * @return true if the condition is met.
+ */
+template <typename Predicate>
+static bool waitFor(std::condition_variable &changed, std::unique_lock<std::mutex> &lock, TickType_t ticks, Predicate isDone)
+{
+  int64_t realStartUs = simRealTimeUs();
+  bool isMet;
+  if (ticks == portMAX_DELAY)
+  {
+    changed.wait(lock, isDone);
+    isMet = true;
+  }
+  else
+  {
+    auto timeout = std::chrono::microseconds((int64_t)(ticks * 1000.0 / simScenario.timeScale));
+    isMet = changed.wait_for(lock, timeout, isDone);
+  }
+  simCatchUp(realStartUs);
+  return isMet;
+}
+
+static void runTask(SimTask task)
+{
+  simMarkTaskThread();
+  try
+  {
+    task.function(task.parameters);
+  }
+  catch (const SimTaskExit &)
+  {
+  }
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackDepth, void *parameters, UBaseType_t priority,
+                                   TaskHandle_t *handle, BaseType_t coreId)
+{
+  (void)name;
+  (void)stackDepth;
+  (void)priority;
+  (void)coreId;
+  std::thread(runTask, SimTask{function, parameters}).detach();
+  if (handle != nullptr)
+  {
+    *handle = nullptr; // The tasks cannot be addressed from outside
+  }
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stackDepth, void *parameters, UBaseType_t priority, TaskHandle_t *handle)
+{
+  return xTaskCreatePinnedToCore(function, name, stackDepth, parameters, priority, handle, 0);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+  if (task == nullptr && !simIsLoopThread())
+  {
+    throw SimTaskExit(); // Unwinds to runTask, the thread ends
+  }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+  delay(ticks * portTICK_PERIOD_MS);
+}
+
+TickType_t xTaskGetTickCount()
+{
+  return (TickType_t)millis();
+}
+
+BaseType_t xPortGetCoreID()
+{
+  return simIsLoopThread() ? 1 : 0;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+  SimQueue *queue = new SimQueue();
+  queue->length = length;
+  queue->itemSize = itemSize;
+  return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+  delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticksToWait)
+{
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (!waitFor(queue->changed, lock, ticksToWait, [queue] { return queue->items.size() < queue->length; }))
+  {
+    return errQUEUE_FULL;
+  }
+  const uint8_t *bytes = (const uint8_t *)item;
+  queue->items.emplace_back(bytes, bytes + queue->itemSize);
+  queue->changed.notify_all();
+  return pdPASS;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void *item, TickType_t ticksToWait)
+{
+  return xQueueSend(queue, item, ticksToWait);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticksToWait)
+{
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (!waitFor(queue->changed, lock, ticksToWait, [queue] { return !queue->items.empty(); }))
+  {
+    return errQUEUE_EMPTY;
+  }
+  memcpy(item, queue->items.front().data(), queue->itemSize);
+  queue->items.pop_front();
+  queue->changed.notify_all();
+  return pdPASS;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  queue->items.clear();
+  queue->changed.notify_all();
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  return (UBaseType_t)queue->items.size();
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+  return new SimMutex();
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t mutex)
+{
+  delete mutex;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticksToWait)
+{
+  int64_t realStartUs = simRealTimeUs();
+  bool isTaken;
+  if (ticksToWait == portMAX_DELAY)
+  {
+    mutex->mutex.lock();
+    isTaken = true;
+  }
+  else
+  {
+    isTaken = mutex->mutex.try_lock_for(std::chrono::microseconds((int64_t)(ticksToWait * 1000.0 / simScenario.timeScale)));
+  }
+  simCatchUp(realStartUs);
+  return isTaken ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex)
+{
+  mutex->mutex.unlock();
+  return pdTRUE;
+}
+
+EventGroupHandle_t xEventGroupCreate()
+{
+  return new SimEventGroup();
+}
+
+void vEventGroupDelete(EventGroupHandle_t group)
+{
+  delete group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+  std::lock_guard<std::mutex> lock(group->mutex);
+  group->bits |= bits;
+  group->changed.notify_all();
+  return group->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+  std::lock_guard<std::mutex> lock(group->mutex);
+  EventBits_t previous = group->bits;
+  group->bits &= ~bits;
+  return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+  std::lock_guard<std::mutex> lock(group->mutex);
+  return group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clearOnExit, BaseType_t waitForAll, TickType_t ticksToWait)
+{
+  std::unique_lock<std::mutex> lock(group->mutex);
+  auto isSet = [group, bits, waitForAll] { return waitForAll ? (group->bits & bits) == bits : (group->bits & bits) != 0; };
+  waitFor(group->changed, lock, ticksToWait, isSet);
+  EventBits_t result = group->bits;
+  if (isSet() && clearOnExit)
+  {
+    group->bits &= ~bits;
+  }
+  return result;
+}
@@ -0,0 +1,511 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation: SD card, preferences and firmware update on host directories
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <ftw.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+#include <ArduinoOTA.h>
+#include <Preferences.h>
+#include <SD.h>
+#include <SPI.h>
+#include <Update.h>
+
+#include "simulation.h"
+
+fs::SDFS SD;
+SPIClass SPI;
+UpdateClass Update;
+ArduinoOTAClass ArduinoOTA;
+
+static const uint64_t sdCardSize = 16ULL * 1024 * 1024 * 1024;
+static uint64_t usedBytesSum = 0;
+
+/**
+ * @brief Creates a directory and its parents, as mkdir -p.
+ */
+static bool makeDirectories(const std::string &path)
+{
+  for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1))
+  {
+    ::mkdir(path.substr(0, slash).c_str(), 0755);
+  }
+  return ::mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+namespace fs
+{
+
+class FileImpl
+{
+public:
+  ~FileImpl() { close(); }
+
+  void close()
+  {
+    if (file != nullptr)
+    {
+      fclose(file);
+      file = nullptr;
+    }
+    directoryEntries.clear();
+    isOpen = false;
+  }
+
+  std::string path;     // Path on the SD card
+  std::string hostPath; // Path on the host
+  std::string name;     // Last component of path
+  FILE *file = nullptr;
+  bool isDirectory = false;
+  bool isOpen = false;
+  bool isWritable = false;
+  std::vector<std::string> directoryEntries; // Sorted, read at the first openNextFile
+  size_t nextEntry = 0;
+  bool hasEntries = false;
+};
+
+size_t File::write(uint8_t c)
+{
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t *buffer, size_t size)
+{
+  if (!impl || impl->file == nullptr || !impl->isWritable)
+  {
+    return 0;
+  }
+  return fwrite(buffer, 1, size, impl->file);
+}
+
+int File::available()
+{
+  if (!impl || impl->file == nullptr)
+  {
+    return 0;
+  }
+  return (int)(size() - position());
+}
+
+int File::read()
+{
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::peek()
+{
+  if (!impl || impl->file == nullptr)
+  {
+    return -1;
+  }
+  int c = fgetc(impl->file);
+  if (c != EOF)
+  {
+    ungetc(c, impl->file);
+  }
+  return c == EOF ? -1 : c;
+}
+
+void File::flush()
+{
+  if (impl && impl->file != nullptr)
+  {
+    fflush(impl->file);
+  }
+}
+
+size_t File::read(uint8_t *buffer, size_t size)
+{
+  if (!impl || impl->file == nullptr)
+  {
+    return 0;
+  }
+  return fread(buffer, 1, size, impl->file);
+}
+
+bool File::seek(uint32_t position, SeekMode mode)
+{
+  if (!impl || impl->file == nullptr)
+  {
+    return false;
+  }
+  int origin = mode == SeekCur ? SEEK_CUR : (mode == SeekEnd ? SEEK_END : SEEK_SET);
+  return fseek(impl->file, (long)position, origin) == 0;
+}
+
+size_t File::position() const
+{
+  if (!impl || impl->file == nullptr)
+  {
+    return 0;
+  }
+  long position = ftell(impl->file);
+  return position < 0 ? 0 : (size_t)position;
+}
+
+size_t File::size() const
+{
+  if (!impl || !impl->isOpen || impl->isDirectory)
+  {
+    return 0;
+  }
+  if (impl->file != nullptr)
+  {
+    fflush(impl->file);
+  }
+  struct stat info;
+  return stat(impl->hostPath.c_str(), &info) == 0 ? (size_t)info.st_size : 0;
+}
+
+void File::close()
+{
+  if (impl)
+  {
+    impl->close();
+  }
+}
+
+File::operator bool() const
+{
+  return impl && impl->isOpen;
+}
+
+const char *File::path() const
+{
+  return impl ? impl->path.c_str() : nullptr;
+}
+
+const char *File::name() const
+{
+  return impl ? impl->name.c_str() : nullptr;
+}
+
+time_t File::getLastWrite()
+{
+  struct stat info;
+  return impl && stat(impl->hostPath.c_str(), &info) == 0 ? info.st_mtime : 0;
+}
+
+bool File::isDirectory() const
+{
+  return impl && impl->isOpen && impl->isDirectory;
+}
+
+File File::openNextFile(const char *mode)
+{
+  if (!isDirectory())
+  {
+    return File();
+  }
+  if (!impl->hasEntries)
+  {
+    DIR *directory = opendir(impl->hostPath.c_str());
+    if (directory != nullptr)
+    {
+      while (struct dirent *entry = readdir(directory))
+      {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+        {
+          impl->directoryEntries.push_back(entry->d_name);
+        }
+      }
+      closedir(directory);
+    }
+    std::sort(impl->directoryEntries.begin(), impl->directoryEntries.end());
+    impl->hasEntries = true;
+  }
+  if (impl->nextEntry >= impl->directoryEntries.size())
+  {
+    return File();
+  }
+  std::string path = impl->path == "/" ? "/" : impl->path + "/";
+  return SD.open((path + impl->directoryEntries[impl->nextEntry++]).c_str(), mode);
+}
+
+void File::rewindDirectory()
+{
+  if (impl)
+  {
+    impl->directoryEntries.clear();
+    impl->nextEntry = 0;
+    impl->hasEntries = false;
+  }
+}
+
+String FS::hostPath(const char *path) const
+{
+  if (path == nullptr)
+  {
+    return root;
+  }
+  return path[0] == '/' ? root + path : root + "/" + path;
+}
+
+File FS::open(const char *path, const char *mode, const bool create)
+{
+  (void)create;
+  if (!isMounted || path == nullptr || mode == nullptr)
+  {
+    return File();
+  }
+  std::shared_ptr<FileImpl> impl = std::make_shared<FileImpl>();
+  impl->path = path[0] == '/' ? path : std::string("/") + path;
+  while (impl->path.size() > 1 && impl->path.back() == '/')
+  {
+    impl->path.pop_back();
+  }
+  impl->hostPath = hostPath(impl->path.c_str()).c_str();
+  impl->name = impl->path.substr(impl->path.rfind('/') + 1);
+
+  struct stat info;
+  if (stat(impl->hostPath.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+  {
+    impl->isDirectory = true;
+    impl->isOpen = true;
+    return File(impl);
+  }
+
+  const char *hostMode = mode[0] == 'w' ? "wb" : (mode[0] == 'a' ? "ab+" : "rb");
+  impl->file = fopen(impl->hostPath.c_str(), hostMode);
+  if (impl->file == nullptr)
+  {
+    return File();
+  }
+  impl->isWritable = mode[0] == 'w' || mode[0] == 'a' || strchr(mode, '+') != nullptr;
+  impl->isOpen = true;
+  return File(impl);
+}
+
+bool FS::exists(const char *path)
+{
+  struct stat info;
+  return isMounted && path != nullptr && stat(hostPath(path).c_str(), &info) == 0;
+}
+
+bool FS::remove(const char *path)
+{
+  return isMounted && path != nullptr && unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char *pathFrom, const char *pathTo)
+{
+  if (!isMounted || pathFrom == nullptr || pathTo == nullptr || !exists(pathFrom) || exists(pathTo))
+  {
+    return false; // FATFS does not replace an existing file
+  }
+  return ::rename(hostPath(pathFrom).c_str(), hostPath(pathTo).c_str()) == 0;
+}
+
+bool FS::mkdir(const char *path)
+{
+  return isMounted && path != nullptr && ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const char *path)
+{
+  return isMounted && path != nullptr && ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+bool SDFS::begin(uint8_t ssPin, SPIClass &spi, uint32_t frequency, const char *mountpoint, uint8_t maxFiles, bool formatIfEmpty)
+{
+  (void)ssPin;
+  (void)spi;
+  (void)frequency;
+  (void)mountpoint;
+  (void)maxFiles;
+  (void)formatIfEmpty;
+  root = simScenario.sdDirectory.c_str();
+  isMounted = makeDirectories(simScenario.sdDirectory);
+  return isMounted;
+}
+
+void SDFS::end()
+{
+  isMounted = false;
+}
+
+uint64_t SDFS::cardSize()
+{
+  return isMounted ? sdCardSize : 0;
+}
+
+static int addFileSize(const char *path, const struct stat *info, int type, struct FTW *ftw)
+{
+  (void)path;
+  (void)ftw;
+  if (type == FTW_F)
+  {
+    usedBytesSum += ((uint64_t)info->st_size + 4095) / 4096 * 4096; // Clusters of 4 KB
+  }
+  return 0;
+}
+
+uint64_t SDFS::usedBytes()
+{
+  if (!isMounted)
+  {
+    return 0;
+  }
+  usedBytesSum = 0;
+  nftw(root.c_str(), addFileSize, 16, FTW_PHYS);
+  return usedBytesSum;
+}
+
+} // namespace fs
+
+// Preferences
+
+bool Preferences::begin(const char *name, bool readOnly, const char *partitionLabel)
+{
+  (void)partitionLabel;
+  if (isOpen || name == nullptr)
+  {
+    return false;
+  }
+  directory = String(simScenario.nvsDirectory.c_str()) + "/" + name;
+  struct stat info;
+  bool exists = stat(directory.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+  if (!exists && (readOnly || !makeDirectories(directory.c_str())))
+  {
+    return false; // As the NVS, a read-only namespace must exist
+  }
+  isReadOnly = readOnly;
+  isOpen = true;
+  return true;
+}
+
+void Preferences::end()
+{
+  isOpen = false;
+}
+
+String Preferences::keyPath(const char *key) const
+{
+  return directory + "/" + key;
+}
+
+bool Preferences::clear()
+{
+  if (!isOpen || isReadOnly)
+  {
+    return false;
+  }
+  DIR *dir = opendir(directory.c_str());
+  if (dir == nullptr)
+  {
+    return false;
+  }
+  while (struct dirent *entry = readdir(dir))
+  {
+    if (entry->d_name[0] != '.')
+    {
+      unlink(keyPath(entry->d_name).c_str());
+    }
+  }
+  closedir(dir);
+  return true;
+}
+
+bool Preferences::remove(const char *key)
+{
+  return isOpen && !isReadOnly && unlink(keyPath(key).c_str()) == 0;
+}
+
+bool Preferences::isKey(const char *key)
+{
+  struct stat info;
+  return isOpen && stat(keyPath(key).c_str(), &info) == 0;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t length)
+{
+  if (!isOpen || isReadOnly)
+  {
+    return 0;
+  }
+  FILE *file = fopen(keyPath(key).c_str(), "wb");
+  if (file == nullptr)
+  {
+    return 0;
+  }
+  size_t written = fwrite(value, 1, length, file);
+  fclose(file);
+  return written;
+}
+
+size_t Preferences::getBytesLength(const char *key)
+{
+  struct stat info;
+  return isOpen && stat(keyPath(key).c_str(), &info) == 0 ? (size_t)info.st_size : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *buffer, size_t maxLength)
+{
+  size_t length = getBytesLength(key);
+  if (length == 0 || length > maxLength)
+  {
+    return 0; // As the NVS, a too small buffer reads nothing
+  }
+  FILE *file = fopen(keyPath(key).c_str(), "rb");
+  if (file == nullptr)
+  {
+    return 0;
+  }
+  size_t read = fread(buffer, 1, length, file);
+  fclose(file);
+  return read;
+}
+
+// Firmware update
+
+bool UpdateClass::begin(size_t size)
+{
+  expectedSize = size;
+  writtenSize = 0;
+  isComplete = false;
+  return true;
+}
+
+size_t UpdateClass::write(uint8_t *data, size_t length)
+{
+  (void)data;
+  writtenSize += length;
+  return length;
+}
+
+size_t UpdateClass::writeStream(Stream &data)
+{
+  uint8_t buffer[512];
+  size_t written = 0;
+  size_t length;
+  while ((length = data.readBytes(buffer, sizeof(buffer))) > 0)
+  {
+    written += write(buffer, length);
+  }
+  return written;
+}
+
+bool UpdateClass::end(bool evenIfRemaining)
+{
+  isComplete = writtenSize > 0 && (evenIfRemaining || expectedSize == UPDATE_SIZE_UNKNOWN || writtenSize == expectedSize);
+  fprintf(stderr, "sim: firmware image of %zu B %s\n", writtenSize, isComplete ? "accepted, the firmware stays the same" : "incomplete");
+  return isComplete;
+}
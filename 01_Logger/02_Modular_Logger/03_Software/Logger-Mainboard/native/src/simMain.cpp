@@ -0,0 +1,160 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation: runs the wake-ups of a deployment scenario
+ *
+ * Build and run (from the Logger-Mainboard directory):
+ *   pio run -e native
+ *   .pio/build/native/program [scenario, default native/scenario.txt]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <new>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "simulation.h"
+
+SimState *simState = nullptr;
+
+/**
+ * @brief Creates the state shared with the processes of the wake-ups.
+ */
+static SimState *createSharedState(size_t rtcMemorySize)
+{
+  void *memory = mmap(nullptr, sizeof(SimState) + rtcMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED)
+  {
+    return nullptr;
+  }
+  SimState *state = new (memory) SimState();
+  state->trueTimeUs = simScenario.startTime * 1000000;
+  state->systemOffsetUs = -state->trueTimeUs.load(); // The system time starts at 1970 until SNTP sets it
+  state->rtcOffsetSec = 0;                           // The DS3231 was set before the deployment
+  state->sntpCompleteUs = -1;
+  state->resetReason = ESP_RST_POWERON;
+  state->rtcMemorySize = rtcMemorySize;
+  for (SimBoardState &board : state->boards)
+  {
+    board.conversionUs = -1;
+    board.firstSampleUs = -1;
+    board.sampleStopUs = -1;
+  }
+  return state;
+}
+
+/**
+ * @brief Runs one wake-up in a child process until it sleeps or restarts.
+ * @return true if the child ended with esp_deep_sleep_start() or a restart.
+ */
+static bool runWakeUp()
+{
+  simState->wakeStartUs = simState->trueTimeUs;
+  simState->sleepUs = -1;
+  simState->lightSleepUs = -1;
+  simState->exit = SIM_EXIT_NONE;
+  fflush(stdout);
+
+  pid_t child = fork();
+  if (child < 0)
+  {
+    perror("sim: fork");
+    return false;
+  }
+  if (child == 0)
+  {
+    setup();
+    while (true)
+    {
+      loop(); // The loop ends with the deep sleep, the process ends in esp_deep_sleep_start()
+    }
+  }
+
+  int status = 0;
+  waitpid(child, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || simState->exit == SIM_EXIT_NONE)
+  {
+    fprintf(stderr, "sim: wake-up %u ended abnormally (status 0x%x)\n", simState->wakeCount, status);
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  const char *scenarioPath = argc > 1 ? argv[1] : "native/scenario.txt";
+  if (!simLoadScenario(scenarioPath))
+  {
+    return 1;
+  }
+
+  size_t rtcMemorySize = __rtc_data_end - __rtc_data_start;
+  std::vector<uint8_t> initialRtcMemory(__rtc_data_start, __rtc_data_end); // Loaded again after a restart
+  simState = createSharedState(rtcMemorySize);
+  if (simState == nullptr)
+  {
+    perror("sim: mmap");
+    return 1;
+  }
+
+  int64_t endUs = simScenarioEndUs();
+  int64_t realStartUs = simRealTimeUs();
+  uint32_t restarts = 0;
+  fprintf(stderr, "sim: %s, %zu boards, %zu deployments, %zu B RTC memory\n", scenarioPath, simScenario.boards.size(),
+          simScenario.deployments.size(), rtcMemorySize);
+
+  while (simState->trueTimeUs < endUs)
+  {
+    if (!runWakeUp())
+    {
+      return 1;
+    }
+    simState->wakeCount++;
+    int64_t awakeUs = simState->trueTimeUs - simState->wakeStartUs;
+    simState->awakeUs += awakeUs;
+    simState->chargeUsedMah += awakeUs / 3.6e9 * simScenario.awakeCurrentMa;
+
+    if (simState->exit == SIM_EXIT_SCENARIO_END)
+    {
+      fprintf(stderr, "sim: the scenario ended during wake-up %u, awake for %.1f s\n", simState->wakeCount, awakeUs / 1e6);
+      break;
+    }
+    if (simState->exit == SIM_EXIT_RESTART)
+    {
+      memcpy(__rtc_data_start, initialRtcMemory.data(), rtcMemorySize);
+      simState->resetReason = ESP_RST_SW;
+      restarts++;
+      continue;
+    }
+
+    memcpy(__rtc_data_start, simState->rtcMemory, rtcMemorySize);
+    simState->resetReason = ESP_RST_DEEPSLEEP;
+    if (simState->sleepUs < 0)
+    {
+      fprintf(stderr, "sim: deep sleep without a wake-up source after wake-up %u\n", simState->wakeCount);
+      break;
+    }
+    simState->trueTimeUs += simState->sleepUs;
+    simState->chargeUsedMah += simState->sleepUs / 3.6e9 * simScenario.sleepCurrentMa;
+  }
+
+  simState->wakeStartUs = simState->trueTimeUs; // The remaining charge without an open wake-up
+  double simulatedHours = (simState->trueTimeUs - simScenario.startTime * 1000000) / 3.6e9;
+  fprintf(stderr, "sim: %u wake-ups (%u restarts) in %.1f h simulated, %.1f s real\n", simState->wakeCount, restarts, simulatedHours,
+          (simRealTimeUs() - realStartUs) / 1e6);
+  fprintf(stderr, "sim: awake %.1f s (%.3f %%), %.1f mAh used, %.1f mAh left\n", simState->awakeUs / 1e6,
+          simulatedHours > 0 ? 100 * simState->awakeUs / 3.6e9 / simulatedHours : 0.0, simState->chargeUsedMah, simBatteryRemainingMah());
+  return 0;
+}
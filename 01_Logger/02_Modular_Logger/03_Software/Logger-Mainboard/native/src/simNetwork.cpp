@@ -0,0 +1,364 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation: WiFi, SNTP and the TCP connection to the MQTT broker
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_sntp.h>
+
+#include "simulation.h"
+
+WiFiClass WiFi;
+
+static const int tcpConnectTimeoutMs = 3000;
+static const int64_t idlePollUs = 1000; // Clock advance of a poll without data, so that the timeouts of the MQTT client expire
+
+static uint8_t accessPointBssid[6] = {0x02, 0x48, 0x79, 0x46, 0x69, 0x56};
+static const int32_t accessPointChannel = 6;
+
+static std::string connectingSsid;
+static int64_t connectedAtUs = -1; // True time at which the connection completes, -1 = none
+static IPAddress staticLocalIp;
+
+/**
+ * @brief Advances the clock of the loop task by the real time of a network wait.
+ */
+static void spendNetworkTime(int64_t realStartUs, int64_t minimumUs)
+{
+  if (simIsLoopThread())
+  {
+    simAdvanceUs(std::max(simRealTimeUs() - realStartUs, minimumUs));
+  }
+}
+
+bool simIsWifiConnected()
+{
+  return WiFi.status() == WL_CONNECTED;
+}
+
+// WiFi
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *passphrase, int32_t channel, const uint8_t *bssid, bool connect)
+{
+  (void)passphrase;
+  connectingSsid = ssid != nullptr ? ssid : "";
+  connectedAtUs = -1;
+  uint32_t connectMs;
+  if (connect && simIsNetworkInRange(connectingSsid.c_str(), &connectMs))
+  {
+    bool isKnownAccessPoint = bssid != nullptr && channel == accessPointChannel && memcmp(bssid, accessPointBssid, sizeof(accessPointBssid)) == 0;
+    connectedAtUs = simTrueTimeUs() + (isKnownAccessPoint ? connectMs / 3 : connectMs) * 1000LL;
+  }
+  return status();
+}
+
+bool WiFiClass::config(IPAddress localIp, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2)
+{
+  (void)gateway;
+  (void)subnet;
+  (void)dns1;
+  (void)dns2;
+  staticLocalIp = localIp; // 0 = DHCP
+  return true;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp)
+{
+  (void)wifiOff;
+  (void)eraseAp;
+  connectingSsid.clear();
+  connectedAtUs = -1;
+  return true;
+}
+
+wl_status_t WiFiClass::status()
+{
+  if (connectedAtUs < 0)
+  {
+    return connectingSsid.empty() ? WL_DISCONNECTED : WL_NO_SSID_AVAIL;
+  }
+  if (simTrueTimeUs() < connectedAtUs)
+  {
+    return WL_DISCONNECTED;
+  }
+  return simIsNetworkInRange(connectingSsid.c_str(), nullptr) ? WL_CONNECTED : WL_CONNECTION_LOST;
+}
+
+uint8_t *WiFiClass::BSSID()
+{
+  return status() == WL_CONNECTED ? accessPointBssid : nullptr;
+}
+
+int32_t WiFiClass::channel()
+{
+  return accessPointChannel;
+}
+
+int8_t WiFiClass::RSSI()
+{
+  return status() == WL_CONNECTED ? -60 : 0;
+}
+
+String WiFiClass::SSID()
+{
+  return status() == WL_CONNECTED ? String(connectingSsid.c_str()) : String();
+}
+
+String WiFiClass::macAddress()
+{
+  char text[18];
+  uint64_t mac = simScenario.efuseMac;
+  snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", (uint8_t)mac, (uint8_t)(mac >> 8), (uint8_t)(mac >> 16), (uint8_t)(mac >> 24),
+           (uint8_t)(mac >> 32), (uint8_t)(mac >> 40));
+  return String(text);
+}
+
+IPAddress WiFiClass::localIP()
+{
+  return (uint32_t)staticLocalIp != 0 ? staticLocalIp : IPAddress(192, 168, 1, 50);
+}
+
+IPAddress WiFiClass::gatewayIP()
+{
+  return IPAddress(192, 168, 1, 1);
+}
+
+IPAddress WiFiClass::subnetMask()
+{
+  return IPAddress(255, 255, 255, 0);
+}
+
+IPAddress WiFiClass::dnsIP(uint8_t index)
+{
+  (void)index;
+  return IPAddress(192, 168, 1, 1);
+}
+
+// SNTP
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server1, const char *server2, const char *server3)
+{
+  (void)gmtOffsetSec;
+  (void)daylightOffsetSec;
+  (void)server1;
+  (void)server2;
+  (void)server3;
+  if (simIsWifiConnected())
+  {
+    simState->sntpCompleteUs = simTrueTimeUs() + 50000; // One round trip to the NTP server
+    simState->sntpStatus = SNTP_SYNC_STATUS_IN_PROGRESS;
+  }
+}
+
+void sntp_set_sync_status(sntp_sync_status_t status)
+{
+  simState->sntpStatus = status;
+}
+
+sntp_sync_status_t sntp_get_sync_status()
+{
+  if (simState->sntpStatus == SNTP_SYNC_STATUS_IN_PROGRESS && simTrueTimeUs() >= simState->sntpCompleteUs && simIsWifiConnected())
+  {
+    simState->systemOffsetUs = 0;
+    simState->sntpStatus = SNTP_SYNC_STATUS_COMPLETED;
+  }
+  return (sntp_sync_status_t)simState->sntpStatus;
+}
+
+// WiFiClient
+
+WiFiClient::~WiFiClient()
+{
+  stop();
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port)
+{
+  return connect(ip.toString().c_str(), port);
+}
+
+int WiFiClient::connect(const char *host, uint16_t port)
+{
+  stop();
+  if (!simIsWifiConnected())
+  {
+    return 0;
+  }
+  if (!simScenario.brokerHost.empty())
+  {
+    host = simScenario.brokerHost.c_str();
+    port = simScenario.brokerPort;
+  }
+
+  int64_t realStartUs = simRealTimeUs();
+  struct addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo *addresses = nullptr;
+  if (getaddrinfo(host, std::to_string(port).c_str(), &hints, &addresses) != 0 || addresses == nullptr)
+  {
+    spendNetworkTime(realStartUs, 0);
+    return 0;
+  }
+
+  int fd = socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+  bool isConnected = false;
+  if (fd >= 0)
+  {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    if (::connect(fd, addresses->ai_addr, addresses->ai_addrlen) == 0)
+    {
+      isConnected = true;
+    }
+    else if (errno == EINPROGRESS)
+    {
+      struct pollfd request = {fd, POLLOUT, 0};
+      int error = 0;
+      socklen_t length = sizeof(error);
+      isConnected = poll(&request, 1, tcpConnectTimeoutMs) == 1 && getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0;
+    }
+  }
+  freeaddrinfo(addresses);
+  spendNetworkTime(realStartUs, 0);
+
+  if (!isConnected)
+  {
+    if (fd >= 0)
+    {
+      close(fd);
+    }
+    return 0;
+  }
+  socketFd = fd;
+  return 1;
+}
+
+size_t WiFiClient::write(const uint8_t *buffer, size_t size)
+{
+  if (socketFd < 0 || !simIsWifiConnected())
+  {
+    return 0;
+  }
+  int64_t realStartUs = simRealTimeUs();
+  size_t written = 0;
+  while (written < size)
+  {
+    ssize_t sent = send(socketFd, buffer + written, size - written, MSG_NOSIGNAL);
+    if (sent > 0)
+    {
+      written += (size_t)sent;
+    }
+    else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+      struct pollfd request = {socketFd, POLLOUT, 0};
+      poll(&request, 1, 100);
+    }
+    else
+    {
+      stop();
+      break;
+    }
+  }
+  spendNetworkTime(realStartUs, 0);
+  return written;
+}
+
+int WiFiClient::available()
+{
+  if (socketFd < 0)
+  {
+    return 0;
+  }
+  int64_t realStartUs = simRealTimeUs();
+  int count = 0;
+  if (ioctl(socketFd, FIONREAD, &count) != 0 || count == 0)
+  {
+    struct pollfd request = {socketFd, POLLIN, 0};
+    poll(&request, 1, (int)(idlePollUs / 1000));
+    if (ioctl(socketFd, FIONREAD, &count) != 0)
+    {
+      count = 0;
+    }
+    spendNetworkTime(realStartUs, count == 0 ? idlePollUs : 0);
+  }
+  return count;
+}
+
+int WiFiClient::read()
+{
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t *buffer, size_t size)
+{
+  if (socketFd < 0)
+  {
+    return -1;
+  }
+  ssize_t received = recv(socketFd, buffer, size, MSG_DONTWAIT);
+  if (received == 0)
+  {
+    stop(); // Closed by the broker
+  }
+  return received > 0 ? (int)received : -1;
+}
+
+int WiFiClient::peek()
+{
+  uint8_t c;
+  if (socketFd < 0 || recv(socketFd, &c, 1, MSG_DONTWAIT | MSG_PEEK) != 1)
+  {
+    return -1;
+  }
+  return c;
+}
+
+void WiFiClient::stop()
+{
+  if (socketFd >= 0)
+  {
+    close(socketFd);
+    socketFd = -1;
+  }
+}
+
+uint8_t WiFiClient::connected()
+{
+  if (socketFd < 0)
+  {
+    return 0;
+  }
+  if (!simIsWifiConnected())
+  {
+    stop(); // Out of range of the access point
+    return 0;
+  }
+  uint8_t c;
+  ssize_t received = recv(socketFd, &c, 1, MSG_DONTWAIT | MSG_PEEK);
+  if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+  {
+    stop();
+    return 0;
+  }
+  return 1;
+}
@@ -0,0 +1,232 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation: scenario file and the simulated world (deployments, networks, battery)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fstream>
+#include <sstream>
+
+#include "simulation.h"
+
+static const double descentRateMps = 0.5; // Winch speed of the fishing gear
+
+SimScenario simScenario = {
+    1717200000, // 2024-06-01 00:00:00 UTC
+    24,
+    "native/sd",
+    "native/nvs",
+    "",
+    1883,
+    2.0,
+    3000,
+    100,
+    40,
+    0.15,
+    100,
+    true,
+    0x0000A1B2C3D4E5F6ULL,
+    {},
+    {},
+    {},
+};
+
+/**
+ * @brief Reads the scenario, one setting per line, # starts a comment (see native/scenario.txt).
+ * @param path Scenario file.
+ * @return true if the file was read and every line is valid.
+ */
+bool simLoadScenario(const char *path)
+{
+  std::ifstream file(path);
+  if (!file)
+  {
+    fprintf(stderr, "sim: scenario %s could not be opened\n", path);
+    return false;
+  }
+
+  std::string line;
+  int lineNumber = 0;
+  while (std::getline(file, line))
+  {
+    lineNumber++;
+    size_t comment = line.find('#');
+    if (comment != std::string::npos)
+    {
+      line.erase(comment);
+    }
+    std::istringstream fields(line);
+    std::string key;
+    if (!(fields >> key))
+    {
+      continue;
+    }
+
+    bool isValid = true;
+    if (key == "start")
+    {
+      isValid = (bool)(fields >> simScenario.startTime);
+    }
+    else if (key == "duration_h")
+    {
+      isValid = (bool)(fields >> simScenario.durationHours);
+    }
+    else if (key == "sd_dir")
+    {
+      isValid = (bool)(fields >> simScenario.sdDirectory);
+    }
+    else if (key == "nvs_dir")
+    {
+      isValid = (bool)(fields >> simScenario.nvsDirectory);
+    }
+    else if (key == "broker")
+    {
+      isValid = (bool)(fields >> simScenario.brokerHost >> simScenario.brokerPort);
+    }
+    else if (key == "rtc_drift_ppm")
+    {
+      isValid = (bool)(fields >> simScenario.rtcDriftPpm);
+    }
+    else if (key == "battery")
+    {
+      isValid = (bool)(fields >> simScenario.batteryCapacityMah >> simScenario.batteryInitialPercent);
+    }
+    else if (key == "current_ma")
+    {
+      isValid = (bool)(fields >> simScenario.awakeCurrentMa >> simScenario.sleepCurrentMa);
+    }
+    else if (key == "time_scale")
+    {
+      isValid = (bool)(fields >> simScenario.timeScale) && simScenario.timeScale > 0;
+    }
+    else if (key == "serial")
+    {
+      isValid = (bool)(fields >> simScenario.isSerialEnabled);
+    }
+    else if (key == "mac")
+    {
+      std::string mac;
+      isValid = (bool)(fields >> mac);
+      simScenario.efuseMac = strtoull(mac.c_str(), nullptr, 16);
+    }
+    else if (key == "board")
+    {
+      unsigned address, typeId, parameter, voltage, wakeMs, conversionMs;
+      isValid = (bool)(fields >> address >> typeId >> parameter >> voltage >> wakeMs >> conversionMs) && simScenario.boards.size() < SIM_MAX_BOARDS;
+      simScenario.boards.push_back({(uint8_t)address, (uint8_t)typeId, (uint8_t)parameter, (uint8_t)voltage, (uint16_t)wakeMs, (uint16_t)conversionMs});
+    }
+    else if (key == "deployment")
+    {
+      SimDeployment deployment;
+      isValid = (bool)(fields >> deployment.startHours >> deployment.durationMin >> deployment.maxDepthM);
+      simScenario.deployments.push_back(deployment);
+    }
+    else if (key == "wifi")
+    {
+      SimNetwork network;
+      isValid = (bool)(fields >> network.ssid >> network.connectMs);
+      simScenario.networks.push_back(network);
+    }
+    else
+    {
+      isValid = false;
+    }
+
+    if (!isValid)
+    {
+      fprintf(stderr, "sim: %s:%d: invalid line\n", path, lineNumber);
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Returns the depth of the logger: down with the descent rate, at the maximum depth,
+ *        up with the same rate at the end of the deployment.
+ * @param trueTimeUs True time.
+ * @return double Depth in m, < 0 if the logger is out of the water.
+ */
+double simDepthM(int64_t trueTimeUs)
+{
+  double hours = (trueTimeUs / 1e6 - simScenario.startTime) / 3600.0;
+  for (const SimDeployment &deployment : simScenario.deployments)
+  {
+    double elapsedSec = (hours - deployment.startHours) * 3600;
+    double durationSec = deployment.durationMin * 60;
+    if (elapsedSec < 0 || elapsedSec >= durationSec)
+    {
+      continue;
+    }
+    double descentSec = deployment.maxDepthM / descentRateMps;
+    if (descentSec > durationSec / 2)
+    {
+      descentSec = durationSec / 2; // Short deployment, the logger does not reach the maximum depth
+    }
+    double depth = deployment.maxDepthM;
+    if (elapsedSec < descentSec)
+    {
+      depth = elapsedSec * descentRateMps;
+    }
+    else if (durationSec - elapsedSec < descentSec)
+    {
+      depth = (durationSec - elapsedSec) * descentRateMps;
+    }
+    return depth < 0.2 ? 0.2 : depth; // Wet from the first second
+  }
+  return -1;
+}
+
+/**
+ * @brief Checks whether a network of the scenario is in range, only at the surface.
+ * @param ssid SSID of WiFi.begin.
+ * @param connectMs Connection time of the network.
+ * @return true if the network is in range.
+ */
+bool simIsNetworkInRange(const char *ssid, uint32_t *connectMs)
+{
+  if (ssid == nullptr || simDepthM(simTrueTimeUs()) >= 0)
+  {
+    return false;
+  }
+  for (const SimNetwork &network : simScenario.networks)
+  {
+    if (network.ssid == ssid)
+    {
+      if (connectMs != nullptr)
+      {
+        *connectMs = network.connectMs;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Returns the true time at which the scenario ends.
+ */
+int64_t simScenarioEndUs()
+{
+  return (simScenario.startTime + (int64_t)(simScenario.durationHours * 3600)) * 1000000;
+}
+
+/**
+ * @brief Returns the remaining charge: the initial charge minus the awake and sleep currents
+ *        of the scenario over the simulated time.
+ */
+double simBatteryRemainingMah()
+{
+  double awakeMah = (simTrueTimeUs() - simState->wakeStartUs) / 3.6e9 * simScenario.awakeCurrentMa;
+  double remaining = simScenario.batteryCapacityMah * simScenario.batteryInitialPercent / 100 - simState->chargeUsedMah - awakeMah;
+  return remaining > 0 ? remaining : 0;
+}
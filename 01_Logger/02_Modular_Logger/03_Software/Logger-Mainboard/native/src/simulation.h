@@ -0,0 +1,157 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation of the mainboard: scenario, simulated clock and shared state
+ */
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "esp_system.h"
+
+// Every wake-up runs setup() and loop() in a child process, forked from the untouched image of
+// the program (native/src/simMain.cpp). esp_deep_sleep_start() copies the RTC memory into the
+// state shared with the parent and ends the child, the parent copies it into its own RTC memory
+// and forks the next wake-up at the end of the sleep. So everything outside RTC_DATA_ATTR
+// starts from its initial value as on the ESP32.
+//
+// Time: the simulated clock only advances with delay(), the sleeps, the I2C transfers and the
+// waits for the network, not with the computation. The true time is the Unix time of the
+// simulated world; the system time (gettimeofday) and the DS3231 keep their own offset to it.
+
+#define SIM_MAX_BOARDS 16
+
+typedef struct
+{
+  uint8_t address;       // Bus address, the sensor bus_address of the configuration
+  uint8_t typeId;        // CMD_GETVER byte 3, sensor_type_id of the configuration
+  uint8_t parameter;     // CMD_GET_PARAMETER: 1 temperature, 2 pressure, 3 oxygen, 4 conductivity, 5 turbidity
+  uint8_t voltage;       // CMD_GET_SENSORVOLTAGE: 1 3.3 V, 3 + 5 V, 5 + 12 V, 7 all
+  uint16_t wakeMs;       // CMD_GET_SENSOR_WAKEUP_TIME, and the time until a conversion after a wake-up
+  uint16_t conversionMs; // Time from CMD_CONVERT until CMD_GET_RDY answers 1
+} SimBoard;
+
+typedef struct
+{
+  double startHours;  // Since the start of the simulation
+  double durationMin; // From entering until leaving the water
+  double maxDepthM;
+} SimDeployment;
+
+typedef struct
+{
+  std::string ssid;
+  uint32_t connectMs; // Scan and DHCP, a third of it with a known BSSID and IP lease
+} SimNetwork;
+
+typedef struct
+{
+  int64_t startTime; // Unix time of the first wake-up
+  double durationHours;
+  std::string sdDirectory;
+  std::string nvsDirectory;
+  std::string brokerHost; // Replaces the MQTT host of the firmware, empty = keep it
+  uint16_t brokerPort;
+  double rtcDriftPpm;
+  double batteryCapacityMah;
+  double batteryInitialPercent;
+  double awakeCurrentMa;
+  double sleepCurrentMa;
+  double timeScale; // Speed-up of the real time delays of tasks
+  bool isSerialEnabled;
+  uint64_t efuseMac;
+  std::vector<SimBoard> boards;
+  std::vector<SimDeployment> deployments;
+  std::vector<SimNetwork> networks;
+} SimScenario;
+
+typedef enum
+{
+  SIM_EXIT_NONE,
+  SIM_EXIT_DEEP_SLEEP,
+  SIM_EXIT_RESTART,
+  SIM_EXIT_SCENARIO_END // The wake-up was still awake at the end of the scenario
+} SimExit;
+
+typedef struct
+{
+  bool isAwake;
+  int64_t readyUs;       // True time at which the sensor is awake
+  int64_t conversionUs;  // True time of the last CMD_CONVERT, -1 = none
+  float value[2];        // Values of the last conversion
+  float temperature;     // Last CMD_SET_TEMP
+  uint8_t lastCommand;
+  uint8_t lastParameter; // Second byte of the last command
+  int64_t firstSampleUs; // True time of the first autonomous sample, -1 = sampling off
+  int64_t sampleIntervalUs;
+  int64_t sampleStopUs;   // True time at which the sensor was switched off while sampling, -1 = running
+  int64_t samplesRemoved; // Samples since firstSampleUs that left the ring (removed or overwritten)
+  uint8_t samplesDropped;
+} SimBoardState;
+
+// Shared between the parent and the process of the wake-up
+typedef struct
+{
+  std::atomic<int64_t> trueTimeUs;
+  int64_t wakeStartUs;      // True time of the wake-up
+  int64_t systemOffsetUs;   // System time (gettimeofday) - true time
+  double rtcOffsetSec;      // DS3231 time - time of its drifting oscillator
+  double chargeUsedMah;     // Until wakeStartUs
+  int64_t sleepUs;          // Timer of the deep sleep, -1 = no wake-up source
+  int64_t lightSleepUs;     // Timer of the next light sleep
+  int64_t sntpCompleteUs;   // True time at which the SNTP request completes, -1 = none
+  int sntpStatus;           // sntp_sync_status_t
+  SimExit exit;
+  esp_reset_reason_t resetReason;
+  uint32_t wakeCount;
+  int64_t awakeUs;          // Sum over all wake-ups
+  SimBoardState boards[SIM_MAX_BOARDS];
+  size_t rtcMemorySize;
+  uint8_t rtcMemory[];      // Copy of the RTC memory over the deep sleep
+} SimState;
+
+extern SimScenario simScenario;
+extern SimState *simState;
+
+// RTC memory, the section .rtc.data of native/rtc_data.ld
+extern "C" uint8_t __rtc_data_start[];
+extern "C" uint8_t __rtc_data_end[];
+
+// Scenario (native/src/simScenario.cpp)
+bool simLoadScenario(const char *path);
+int64_t simScenarioEndUs();
+double simDepthM(int64_t trueTimeUs); // < 0 out of the water
+bool simIsNetworkInRange(const char *ssid, uint32_t *connectMs);
+double simBatteryRemainingMah();
+
+// Clock (native/src/simClock.cpp)
+int64_t simTrueTimeUs();
+int64_t simUptimeUs();
+void simAdvanceUs(int64_t us);
+bool simIsLoopThread();
+void simMarkTaskThread();
+void simWaitTaskDelay(uint32_t ms);
+void simCatchUp(int64_t realStartUs);
+int64_t simRealTimeUs();
+[[noreturn]] void simEndWakeUp(SimExit exit);
+
+// Devices (native/src/simDevices.cpp)
+uint8_t simI2cWrite(uint8_t busNumber, uint16_t address, const uint8_t *data, size_t length);
+size_t simI2cRead(uint8_t busNumber, uint16_t address, uint8_t *buffer, size_t length);
+
+// Network (native/src/simNetwork.cpp)
+bool simIsWifiConnected();
+
+#endif
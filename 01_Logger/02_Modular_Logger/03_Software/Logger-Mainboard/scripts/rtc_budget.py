@@ -0,0 +1,36 @@
+# CopyrightText: (C) 2024 Hensel Elektronik GmbH
+#
+# License-Identifier: MPL-2.0
+#
+# Project: Hydrography on Fishing Vessels
+# Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+#
+# Description: Reports the RTC slow memory used by RTC_DATA_ATTR variables and
+#              fails the build when it exceeds custom_rtc_data_budget
+
+import subprocess
+
+Import("env")
+
+# Output sections placed in the RTC slow memory of the ESP32-S3
+RTC_SLOW_SECTIONS = (".rtc.data", ".rtc.bss", ".rtc_noinit", ".rtc.force_slow")
+
+
+def check_rtc_budget(source, target, env):
+    budget = int(env.GetProjectOption("custom_rtc_data_budget", "6144"))
+    elf = str(target[0])
+
+    output = subprocess.check_output([env.subst("$SIZETOOL"), "-A", elf], universal_newlines=True)
+    used = 0
+    for line in output.splitlines():
+        columns = line.split()
+        if len(columns) >= 2 and columns[0] in RTC_SLOW_SECTIONS:
+            used += int(columns[1])
+
+    print("RTC memory: %d of %d bytes used (%.1f%%)" % (used, budget, 100.0 * used / budget))
+    if used > budget:
+        print("Error: RTC memory budget exceeded by %d bytes" % (used - budget))
+        env.Exit(1)
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", check_rtc_budget)
@@ -8,6 +8,8 @@
  *
  * Description: Battery Management System (BMS) functionality
  */
+#include <esp_timer.h>
+
 #include "BMS.h"
 #include "BMS_lib.h"
 #include "DS3231TimeNtp.h"
@@ -34,38 +36,107 @@ void initBmsAndRtc()
   initRTC(&i2c);                                    // DS3231 initialisieren
 }
 
+static BmsSnapshot snapshot;
+static bool hasSnapshot = false;
+
+/**
+ * @brief Reads all BMS values that the loop needs in one sequence.
+ *        The cell voltages and currents come from one DAStatus1 block and the safety
+ *        registers A-D from one block each, so every register is read once per loop
+ *        (8 SMBus transactions instead of 22 in logBmsStatus alone).
+ * @return const BmsSnapshot& The new snapshot.
+ */
+const BmsSnapshot &readBmsSnapshot()
+{
+  int64_t startUs = esp_timer_get_time();
+
+  snapshot.voltage = BMS.getSumCellVoltage();
+  snapshot.current = BMS.getCurrent();
+  snapshot.rsoc = BMS.getRSOC();
+  snapshot.remainingCapacity = BMS.getRemainingCapacity();
+  snapshot.ts1Temperature = BMS.getTS1Temp();
+  bool valid = BMS.getDAStatus1(snapshot.cellVoltage, snapshot.cellCurrent);
+  valid &= BMS.getSafetyAlert(snapshot.safetyAlertAB, snapshot.safetyAlertCD);
+  valid &= BMS.getSafetyStatus(snapshot.safetyStatusAB, snapshot.safetyStatusCD);
+
+  snapshot.transactions = 8;
+  snapshot.readTimeUs = (uint32_t)(esp_timer_get_time() - startUs);
+  snapshot.valid = valid;
+  hasSnapshot = true;
+
+  if (!valid)
+  {
+    Log(LogCategoryBMS, LogLevelERROR, "BMS snapshot incomplete");
+  }
+  Log(LogCategoryBMS, LogLevelDEBUG, "BMS snapshot transactions: ", String(snapshot.transactions), " time[us]: ", String(snapshot.readTimeUs));
+  return snapshot;
+}
+
+/**
+ * @brief Returns the latest snapshot, it is read if there is none in this wake-up yet.
+ * @return const BmsSnapshot& The latest snapshot.
+ */
+const BmsSnapshot &bmsSnapshot()
+{
+  if (!hasSnapshot)
+  {
+    readBmsSnapshot();
+  }
+  return snapshot;
+}
+
+/**
+ * @brief Returns true if one of the safety alert or status registers is set.
+ */
+static bool hasSafetyEvent(const BmsSnapshot &bms)
+{
+  return bms.safetyAlertAB != 0 || bms.safetyStatusAB != 0 || bms.safetyAlertCD != 0 || bms.safetyStatusCD != 0;
+}
+
+/**
+ * @brief Logs the status, safety registers and cell values of a snapshot.
+ * @param bms Snapshot to log.
+ * @param level Log level of the lines.
+ */
+static void logBmsSnapshot(const BmsSnapshot &bms, LogLevel level)
+{
+  Log(LogCategoryBMS, level, "BMS ", "Status: ", " CellVoltage[mV]: ", String(bms.voltage), " Remaining[%]: ", String(bms.rsoc), " Capacity[mAh]: ", String(bms.remainingCapacity), " Temperature Battery[degC]: ", String((bms.ts1Temperature / 10) - 273.15));
+  Log(LogCategoryBMS, level, "BMS ", "Log: ", "getSafetyAlertAB: ", String(bms.safetyAlertAB), " getSafetyStatusAB: ", String(bms.safetyStatusAB), " getSafetyAlertCD: ", String(bms.safetyAlertCD), " getSafetyStatusCD: ", String(bms.safetyStatusCD));
+  Log(LogCategoryBMS, level, "BMS ", "Log: ", "getCell1_V: ", String(bms.cellVoltage[0]), " getCell2_V: ", String(bms.cellVoltage[1]), " getCell3_V: ", String(bms.cellVoltage[2]), " getCell4_V: ", String(bms.cellVoltage[3]));
+  Log(LogCategoryBMS, level, "BMS ", "Log: ", "getCell1_I: ", String(bms.cellCurrent[0]), " getCell2_I: ", String(bms.cellCurrent[1]), " getCell3_I: ", String(bms.cellCurrent[2]), " getCell4_I: ", String(bms.cellCurrent[3]));
+}
+
 /**
  * @brief Checks if current of all cells is below 100mA
  * @return true if all cells are below 100mA, false otherwise
  */
 bool getCellCurrent()
 {
-  if (BMS.getCell1_I() < 100 && BMS.getCell2_I() < 100 && BMS.getCell3_I() < 100 && BMS.getCell4_I() < 100)
-  {
-    return true;
-  }
-  else
+  const BmsSnapshot &bms = bmsSnapshot();
+  for (int cell = 0; cell < 4; cell++)
   {
-    return false;
+    if (bms.cellCurrent[cell] >= 100)
+    {
+      return false;
+    }
   }
+  return true;
 }
 
 /**
  * @brief Checks for battery errors and performs necessary actions.
+ *        Reads the BMS snapshot of this loop.
  */
 void logBmsStatus()
 {
   uint8_t ERROR_THRESHOLD = 3;
-  Log(LogCategoryBMS, LogLevelDEBUG, "BMS ", "Status: ", " CellVoltage[mV]: ", String(getTotalBatteryCellVoltage()), " :Remaining[%]: ", String(getRemainingBatteryPercentage()), " :Capacity[mAh]: ", String(getRemainingBatteryCapacity()), " :Temperature Battery[degC]: ", String((BMS.getTS1Temp() / 10) - 273.15), " :getSafetyAlertAB: ", String(BMS.getSafetyAlertAB()), " :getSafetyStatusAB: ", String(BMS.getSafetyStatusAB()), " :getSafetyAlertCD: ", String(BMS.getSafetyAlertCD()), " :getSafetyStatusCD: ", String(BMS.getSafetyStatusCD()), " :getCell1_V: ", String(BMS.getCell1_V()), " :getCell2_V: ", String(BMS.getCell2_V()), " :getCell3_V: ", String(BMS.getCell3_V()), " :getCell4_V: ", String(BMS.getCell4_V()), " :getCell1_I: ", String(BMS.getCell1_I()), " :getCell2_I: ", String(BMS.getCell2_I()), " :getCell3_I: ", String(BMS.getCell3_I()), " :getCell4_I: ", String(BMS.getCell4_I()));
+  const BmsSnapshot &bms = readBmsSnapshot();
+  logBmsSnapshot(bms, LogLevelDEBUG);
 
-  if (BMS.getSafetyAlertAB() == 16384 || BMS.getSafetyStatusAB() == 16384)
+  if (bms.safetyAlertAB == 16384 || bms.safetyStatusAB == 16384)
   {
-    if (getRemainingBatteryPercentage() <= 15)
+    if (bms.rsoc <= 15)
     {
-      Log(LogCategoryBMS, LogLevelDEBUG, "BMS ", "Status: ", " CellVoltage[mV]: ", String(getTotalBatteryCellVoltage()), " Remaining[%]: ", String(getRemainingBatteryPercentage()), " Capacity[mAh]: ", String(getRemainingBatteryCapacity()), " Temperature Battery[degC]: ", String((BMS.getTS1Temp() / 10) - 273.15));
-      Log(LogCategoryBMS, LogLevelDEBUG, "BMS ", "Log: ", "getSafetyAlertAB: ", String(BMS.getSafetyAlertAB()), " getSafetyStatusAB: ", String(BMS.getSafetyStatusAB()), " getSafetyAlertCD: ", String(BMS.getSafetyAlertCD()), " getSafetyStatusCD: ", String(BMS.getSafetyStatusCD()));
-      Log(LogCategoryBMS, LogLevelDEBUG, "BMS ", "Log: ", "getCell1_V: ", String(BMS.getCell1_V()), " getCell2_V: ", String(BMS.getCell2_V()), " getCell3_V: ", String(BMS.getCell3_V()), " getCell4_V: ", String(BMS.getCell4_V()));
-      Log(LogCategoryBMS, LogLevelDEBUG, "BMS ", "Log: ", "getCell1_I: ", String(BMS.getCell1_I()), " getCell2_I: ", String(BMS.getCell2_I()), " getCell3_I: ", String(BMS.getCell3_I()), " getCell4_I: ", String(BMS.getCell4_I()));
       //* Battery management
       batteryCompletelyCharged();
       connectionOfPowerSupplyBeginChargingOfBatteries();
@@ -74,19 +145,16 @@ void logBmsStatus()
     }
   }
 
-  if (BMS.getSafetyAlertAB() != 0 || BMS.getSafetyStatusAB() != 0 || BMS.getSafetyAlertCD() != 0 || BMS.getSafetyStatusCD() != 0)
+  if (hasSafetyEvent(bms))
   {
     bmsErrorCounter++;
     if (bmsErrorCounter >= ERROR_THRESHOLD)
     {
-      Log(LogCategoryBMS, LogLevelINFO, "BMS ", "Status: ", " CellVoltage[mV]: ", String(getTotalBatteryCellVoltage()), " Remaining[%]: ", String(getRemainingBatteryPercentage()), " Capacity[mAh]: ", String(getRemainingBatteryCapacity()), " Temperature Battery[degC]: ", String((BMS.getTS1Temp() / 10) - 273.15));
-      Log(LogCategoryBMS, LogLevelINFO, "BMS ", "Log: ", "getSafetyAlertAB: ", String(BMS.getSafetyAlertAB()), " getSafetyStatusAB: ", String(BMS.getSafetyStatusAB()), " getSafetyAlertCD: ", String(BMS.getSafetyAlertCD()), " getSafetyStatusCD: ", String(BMS.getSafetyStatusCD()));
-      Log(LogCategoryBMS, LogLevelINFO, "BMS ", "Log: ", "getCell1_V: ", String(BMS.getCell1_V()), " getCell2_V: ", String(BMS.getCell2_V()), " getCell3_V: ", String(BMS.getCell3_V()), " getCell4_V: ", String(BMS.getCell4_V()));
-      Log(LogCategoryBMS, LogLevelINFO, "BMS ", "Log: ", "getCell1_I: ", String(BMS.getCell1_I()), " getCell2_I: ", String(BMS.getCell2_I()), " getCell3_I: ", String(BMS.getCell3_I()), " getCell4_I: ", String(BMS.getCell4_I()));
+      logBmsSnapshot(bms, LogLevelINFO);
 
       disable3V();
       Log(LogCategoryBMS, LogLevelINFO, "BMS: charging process aborted");
-      batteryCompletlyCharged = true;
+      rtcStatus.batteryCompletlyCharged = true;
       bmsErrorCounter = 0;
       // generalAlarmLed();
     }
@@ -110,19 +178,17 @@ void checkForBatteryErrors()
 
   BMS.setUndervoltageProtection();
 
-  Log(LogCategoryBMS, LogLevelINFO, "BMS ", "Status: ", " CellVoltage[mV]: ", String(getTotalBatteryCellVoltage()), " Remaining[%]: ", String(getRemainingBatteryPercentage()), " Capacity[mAh]: ", String(getRemainingBatteryCapacity()), " Temperature Battery[degC]: ", String((BMS.getTS1Temp() / 10) - 273.15));
-  Log(LogCategoryBMS, LogLevelINFO, "BMS ", "Log: ", "getSafetyAlertAB: ", String(BMS.getSafetyAlertAB()), " getSafetyStatusAB: ", String(BMS.getSafetyStatusAB()), " getSafetyAlertCD: ", String(BMS.getSafetyAlertCD()), " getSafetyStatusCD: ", String(BMS.getSafetyStatusCD()));
-  Log(LogCategoryBMS, LogLevelINFO, "BMS ", "Log: ", "getCell1_V: ", String(BMS.getCell1_V()), " getCell2_V: ", String(BMS.getCell2_V()), " getCell3_V: ", String(BMS.getCell3_V()), " getCell4_V: ", String(BMS.getCell4_V()));
-  Log(LogCategoryBMS, LogLevelINFO, "BMS ", "Log: ", "getCell1_I: ", String(BMS.getCell1_I()), " getCell2_I: ", String(BMS.getCell2_I()), " getCell3_I: ", String(BMS.getCell3_I()), " getCell4_I: ", String(BMS.getCell4_I()));
-  
+  const BmsSnapshot &bms = readBmsSnapshot();
+  logBmsSnapshot(bms, LogLevelINFO);
+
   pinMode(20, INPUT);
   int pin20Status_ = digitalRead(20);
   if (pin20Status_ == LOW) // NT angeschloßen
   {
-    if (BMS.getSafetyAlertAB() != 0 || BMS.getSafetyStatusAB() != 0 || BMS.getSafetyAlertCD() != 0 || BMS.getSafetyStatusCD() != 0)
+    if (hasSafetyEvent(bms))
     {
-      Log(LogCategoryBMS, LogLevelERROR, "BMS ", "Status: ", " CellVoltage[mV]: ", String(getTotalBatteryCellVoltage()), " Remaining[%]: ", String(getRemainingBatteryPercentage()), " Capacity[mAh]: ", String(getRemainingBatteryCapacity()), " Temperature Battery[degC]: ", String((BMS.getTS1Temp() / 10) - 273.15));
-      Log(LogCategoryBMS, LogLevelERROR, "BMS ", "Error Log: ", "getSafetyAlertAB: ", String(BMS.getSafetyAlertAB()), " getSafetyStatusAB: ", String(BMS.getSafetyStatusAB()), " getSafetyAlertCD: ", String(BMS.getSafetyAlertCD()), " getSafetyStatusCD: ", String(BMS.getSafetyStatusCD()));
+      Log(LogCategoryBMS, LogLevelERROR, "BMS ", "Status: ", " CellVoltage[mV]: ", String(bms.voltage), " Remaining[%]: ", String(bms.rsoc), " Capacity[mAh]: ", String(bms.remainingCapacity), " Temperature Battery[degC]: ", String((bms.ts1Temperature / 10) - 273.15));
+      Log(LogCategoryBMS, LogLevelERROR, "BMS ", "Error Log: ", "getSafetyAlertAB: ", String(bms.safetyAlertAB), " getSafetyStatusAB: ", String(bms.safetyStatusAB), " getSafetyAlertCD: ", String(bms.safetyAlertCD), " getSafetyStatusCD: ", String(bms.safetyStatusCD));
 
       BMS.setRESET();
       Log(LogCategoryBMS, LogLevelERROR, "BMS RESET");
@@ -146,31 +212,38 @@ void bmsReset()
 }
 
 /**
- * @brief Gets the remaining battery percentage.
+ * @brief Gets the remaining battery percentage of the BMS snapshot.
  * @return float The remaining battery percentage.
  */
 float getRemainingBatteryPercentage()
 {
-  float getRSOC = BMS.getRSOC();
-  return getRSOC;
+  return bmsSnapshot().rsoc;
 }
 
 /**
- * @brief Gets the total battery cell voltage.
+ * @brief Gets the total battery cell voltage of the BMS snapshot.
  * @return uint16_t The total battery cell voltage in mV.
  */
 uint16_t getTotalBatteryCellVoltage()
 {
-  uint16_t SumCellVoltage = BMS.getSumCellVoltage();
-  return SumCellVoltage;
+  return bmsSnapshot().voltage;
 }
 
 /**
- * @brief Gets the remaining battery capacity.
+ * @brief Gets the remaining battery capacity of the BMS snapshot.
  * @return uint16_t The remaining battery capacity in mAh.
  */
 uint16_t getRemainingBatteryCapacity()
 {
-  uint16_t RemainingCapacity = BMS.getRemainingCapacity();
-  return RemainingCapacity;
+  return bmsSnapshot().remainingCapacity;
+}
+
+/**
+ * @brief Gets the battery current, read directly (e.g. for the energy of a cast profile).
+ * @return int16_t The battery current in mA (negative while discharging).
+ */
+int16_t getBatteryCurrent()
+{
+  int16_t Current = BMS.getCurrent();
+  return Current;
 }
@@ -16,7 +16,28 @@
 
 extern TwoWire i2c;
 
+// BMS values of one loop, read in one batched sequence by readBmsSnapshot
+typedef struct
+{
+  uint16_t voltage;           // Sum of the cell voltages in mV
+  int16_t current;            // in mA, negative while discharging
+  uint16_t remainingCapacity; // in mAh
+  uint16_t ts1Temperature;    // in 0.1 K
+  uint16_t cellVoltage[4];    // in mV
+  int16_t cellCurrent[4];     // in mA
+  uint16_t safetyAlertAB;
+  uint16_t safetyAlertCD;
+  uint16_t safetyStatusAB;
+  uint16_t safetyStatusCD;
+  uint8_t rsoc;         // Relative state of charge in %
+  uint8_t transactions; // SMBus transactions of the read
+  uint32_t readTimeUs;  // Duration of the read
+  bool valid;           // All block reads returned their length
+} BmsSnapshot;
+
 void initBmsAndRtc();
+const BmsSnapshot &readBmsSnapshot();
+const BmsSnapshot &bmsSnapshot();
 void logBmsStatus();
 void saveBatteryErrorLog();
 void checkForBatteryErrors();
@@ -26,6 +47,7 @@ float getRemainingBatteryPercentage();
 
 uint16_t getTotalBatteryCellVoltage();
 uint16_t getRemainingBatteryCapacity();
+int16_t getBatteryCurrent();
 
 bool getCellCurrent();
 
@@ -10,6 +10,8 @@
  */
 
 #include <Wire.h>
+#include <esp_sntp.h>
+#include <sys/time.h>
 
 #include "DS3231TimeNtp.h"
 #include "DebuggingSDLog.h"
@@ -35,8 +37,19 @@ bool initRTC(TwoWire *wireInstance)
   return true;
 }
 
+/**
+ * @brief Reads the RTC without the drift correction.
+ * @return uint32_t Unix time of the DS3231.
+ */
+static uint32_t readRawRtcTime()
+{
+  return rtcDS3231.now().unixtime();
+}
+
 /**
  * @brief Synchronizes the time with an NTP server.
+ *        The offset of the RTC before the synchronisation is added to the drift model. The RTC
+ *        is set on the next full second, writing the seconds resets the divider of the DS3231.
  * @return true if synchronization was successful, false otherwise.
  */
 bool synchronizeTimeWithNTP()
@@ -47,27 +60,37 @@ bool synchronizeTimeWithNTP()
     const long gmtOffset_sec = 0;
     const int daylightOffset_sec = 0;
 
+    // The system time survives the deep sleep, so only a completed SNTP request is an NTP time
+    sntp_set_sync_status(SNTP_SYNC_STATUS_RESET);
     configTime(gmtOffset_sec, daylightOffset_sec, ntpServer);
 
-    struct tm timeinfo;
-    int attempts = 0;
-
-    while (!getLocalTime(&timeinfo))
+    uint32_t startMs = millis();
+    while (sntp_get_sync_status() != SNTP_SYNC_STATUS_COMPLETED)
     {
-      Serial.print(".");
-      delay(500);
-      attempts++;
-
-      if (attempts >= 2)
+      if (millis() - startMs >= ntpSyncTimeoutMs)
       {
         Log(LogCategoryRTC, LogLevelERROR, "Time could not be synchronized.");
         isNtpSynchronized = false;
         return false;
       }
+      delay(50);
     }
 
-    Log(LogCategoryRTC, LogLevelDEBUG, "Time synchronized.");
-    rtcDS3231.adjust(DateTime(timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday, timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec));
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    uint32_t rawRtcTime = readRawRtcTime();
+    // The RTC reads whole seconds, its mean is half a second later
+    float offsetSec = (float)((int64_t)rawRtcTime - now.tv_sec) + 0.5f - now.tv_usec / 1e6f;
+
+    delay(1000 - now.tv_usec / 1000);
+    gettimeofday(&now, NULL);
+    uint32_t ntpTime = now.tv_sec + (now.tv_usec >= 500000 ? 1 : 0);
+    rtcDS3231.adjust(DateTime(ntpTime));
+    rtcDriftSynchronized(rtcDriftModel, offsetSec, ntpTime);
+    isNtpSyncRequested = false;
+
+    Log(LogCategoryRTC, LogLevelDEBUG, "Time synchronized, RTC offset [s]: ", String(offsetSec, 2), " drift [ppm]: ", String(rtcDriftModel.driftPpm, 2),
+        " +- ", String(rtcDriftModel.uncertaintyPpm, 2));
     isNtpSynchronized = true;
     return true;
   }
@@ -80,13 +103,30 @@ bool synchronizeTimeWithNTP()
 }
 
 /**
- * @brief Gets the current time from the RTC as a Unix timestamp.
+ * @brief Synchronizes the time with NTP if it was requested (power-on, end of a deployment)
+ *        or if the predicted error of the drift corrected RTC exceeds ntpDriftBudgetSec.
+ * @return true if the time is synchronized or still within the budget, false otherwise.
+ */
+bool synchronizeTimeIfDue()
+{
+  uint32_t rawRtcTime = readRawRtcTime();
+  if (isNtpSyncRequested || rtcDriftIsSyncDue(rtcDriftModel, rawRtcTime, ntpDriftBudgetSec))
+  {
+    return synchronizeTimeWithNTP();
+  }
+
+  Log(LogCategoryRTC, LogLevelDEBUG, "NTP synchronization not due, predicted error [s]: ", String(rtcDriftPredictedErrorSec(rtcDriftModel, rawRtcTime), 2));
+  isNtpSynchronized = true;
+  return true;
+}
+
+/**
+ * @brief Gets the current time from the RTC as a Unix timestamp, corrected with the drift model.
  * @return unsigned long The current time as a Unix timestamp.
  */
 unsigned long getCurrentTimeFromRTC()
 {
-  DateTime now = rtcDS3231.now();
-  return now.unixtime();
+  return rtcDriftCorrect(rtcDriftModel, readRawRtcTime());
 }
 
 /**
@@ -95,9 +135,19 @@ unsigned long getCurrentTimeFromRTC()
  */
 String formatLocalTimeAsISOString()
 {
-  DateTime now = rtcDS3231.now();
+  return formatTimeAsISOString(getCurrentTimeFromRTC());
+}
+
+/**
+ * @brief Formats a Unix timestamp as an ISO 8601 string.
+ * @param unixTime Unix timestamp, e.g. from getCurrentTimeFromRTC().
+ * @return String The formatted time string.
+ */
+String formatTimeAsISOString(uint32_t unixTime)
+{
+  DateTime time(unixTime);
   char buffer[30];
-  snprintf(buffer, sizeof(buffer), "%04d-%02d-%02dT%02d:%02d:%02dZ", now.year(), now.month(), now.day(), now.hour(), now.minute(), now.second());
+  snprintf(buffer, sizeof(buffer), "%04d-%02d-%02dT%02d:%02d:%02dZ", time.year(), time.month(), time.day(), time.hour(), time.minute(), time.second());
   return String(buffer);
 }
 
@@ -107,7 +157,7 @@ String formatLocalTimeAsISOString()
  */
 String getLocalTimeAsStringBackup()
 {
-  DateTime now = rtcDS3231.now();
+  DateTime now(getCurrentTimeFromRTC());
   char buffer[30];
   snprintf(buffer, sizeof(buffer), "%04d%02d%02d%02d%02d%02d", now.year(), now.month(), now.day(), now.hour(), now.minute(), now.second());
   return String(buffer);
@@ -119,7 +169,7 @@ String getLocalTimeAsStringBackup()
  */
 String getLocalTimeAsStringLog()
 {
-  DateTime now = rtcDS3231.now();
+  DateTime now(getCurrentTimeFromRTC());
   char buffer[30];
   snprintf(buffer, sizeof(buffer), "%04d.%02d.%02d;%02d:%02d:%02d", now.year(), now.month(), now.day(), now.hour(), now.minute(), now.second());
   return String(buffer);
@@ -16,10 +16,12 @@
 
 bool initRTC(TwoWire *wireInstance);
 bool synchronizeTimeWithNTP();
+bool synchronizeTimeIfDue();
 
 unsigned long getCurrentTimeFromRTC();
 
 String formatLocalTimeAsISOString();
+String formatTimeAsISOString(uint32_t unixTime);
 String getLocalTimeAsStringBackup();
 String getLocalTimeAsStringLog();
 
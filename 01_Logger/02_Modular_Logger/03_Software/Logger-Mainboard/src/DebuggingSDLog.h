@@ -22,6 +22,7 @@
 
 #include "DS3231TimeNtp.h"
 #include "Utility.h"
+#include "cpuClock.h"
 #include "loggerConfig.h"
 
 // Log-Levels
@@ -151,11 +152,15 @@ void Log(LogCategory category, LogLevel level, const std::string &message, Args.
 
     std::string logMessage = logStream.str() + "\n";
 
+    // The SD card and the serial output need the APB clock of the active level
+    CpuClockLevel previousClock = raiseCpuClockLevel(CPU_CLOCK_ACTIVE);
+
     File file = SD.open("/log/log.txt", FILE_APPEND);
     if (!file)
     {
       Serial.println("Error opening the file /log/log.txt");
       moveFileToDestination("/log", "log.txt", "/backup/log_error", true);
+      setCpuClockLevel(previousClock);
       return;
     }
 
@@ -173,6 +178,11 @@ void Log(LogCategory category, LogLevel level, const std::string &message, Args.
     file.close();
 
     Serial.print(logMessage.c_str());
+    if (previousClock < CPU_CLOCK_ACTIVE)
+    {
+      Serial.flush(); // The UART sends from its buffer, at the low level the baud rate would be wrong
+    }
+    setCpuClockLevel(previousClock);
   }
 }
 
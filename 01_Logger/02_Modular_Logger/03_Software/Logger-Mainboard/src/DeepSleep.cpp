@@ -10,8 +10,19 @@
  */
 
 #include <Arduino.h>
+#include <esp_idf_version.h>
+#include <esp_timer.h>
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include <esp_rtc_time.h>
+#else
+#include <esp32s3/rtc.h>
+#endif
 
+#include "BMS.h"
+#include "DS3231TimeNtp.h"
 #include "DeepSleep.h"
+#include "SystemVariables.h"
+#include "energyAccounting.h"
 
 #define uS_TO_S_FACTOR 1000000UL
 
@@ -21,10 +32,80 @@
  */
 void espDeepSleepSec(uint32_t sleepTimeSec)
 {
+  enterEnergyPhase(ENERGY_PHASE_SLEEP);
   esp_sleep_enable_timer_wakeup(sleepTimeSec * uS_TO_S_FACTOR);
   esp_deep_sleep_start();
 }
 
+/**
+ * @brief Returns the time of the RTC counter in milliseconds. It counts from the power-on, keeps
+ *        counting in deep and light sleep and is never stepped, unlike the system time that SNTP
+ *        sets. Used for durations that span a time synchronisation.
+ * @return uint32_t Time in ms, wraps around after about 49 days.
+ */
+uint32_t getMonotonicMs()
+{
+  return (uint32_t)(esp_rtc_get_time_us() / 1000);
+}
+
+/**
+ * @brief Returns the battery discharge current for the energy accounting.
+ * @return float Current in mA, -1 if it is not measured or the battery is charged.
+ */
+static float batteryDischargeCurrent()
+{
+  if (!energyMeasureCurrent)
+  {
+    return -1;
+  }
+  int16_t current = getBatteryCurrent(); // Negative while discharging
+  return current < 0 ? -current : -1;
+}
+
+/**
+ * @brief Starts the energy accounting of a wake-up, called after the RTC is initialised.
+ *        The time since the last boundary before the deep sleep is accounted as sleep,
+ *        the boot phase starts at the wake-up (esp_timer counts from the wake-up).
+ */
+void beginEnergyAccounting()
+{
+  uint32_t wakeMs = getMonotonicMs() - (uint32_t)(esp_timer_get_time() / 1000);
+  if (!energyTotals.valid)
+  {
+    energyAccountingReset(energyTotals, ENERGY_PHASE_BOOT, wakeMs, getCurrentTimeFromRTC());
+    return;
+  }
+  energyTotals.phase = ENERGY_PHASE_SLEEP;
+  energyAccountingBoundary(energyTotals, ENERGY_PHASE_BOOT, wakeMs, -1, energyModelCurrentMa, true);
+}
+
+/**
+ * @brief Marks the beginning of a phase.
+ * @param phase The phase that begins.
+ * @return EnergyPhase The phase before, to be resumed with leaveEnergyPhase.
+ */
+EnergyPhase enterEnergyPhase(EnergyPhase phase)
+{
+  EnergyPhase previous = (EnergyPhase)energyTotals.phase;
+  if (phase != previous)
+  {
+    energyAccountingBoundary(energyTotals, phase, getMonotonicMs(), batteryDischargeCurrent(), energyModelCurrentMa, true);
+  }
+  return previous;
+}
+
+/**
+ * @brief Marks the end of a phase, the enclosing phase is resumed.
+ * @param previous The return value of the matching enterEnergyPhase.
+ */
+void leaveEnergyPhase(EnergyPhase previous)
+{
+  if (previous != energyTotals.phase)
+  {
+    energyAccountingBoundary(energyTotals, previous, getMonotonicMs(), batteryDischargeCurrent(), energyModelCurrentMa, false);
+  }
+}
+
 int64_t activePinMask = 0;
 /**
  * @brief Enables an external wake-up source on a specific pin.
@@ -12,7 +12,13 @@
 #ifndef DEEPSLEEP_H
 #define DEEPSLEEP_H
 
+#include "energyAccounting.h"
+
 void espDeepSleepSec(uint32_t sleepTimeSec);
+uint32_t getMonotonicMs();
+void beginEnergyAccounting();
+EnergyPhase enterEnergyPhase(EnergyPhase phase);
+void leaveEnergyPhase(EnergyPhase previous);
 void enableExternalWakeup(uint8_t);
 void disableWakeupPin(uint8_t);
 
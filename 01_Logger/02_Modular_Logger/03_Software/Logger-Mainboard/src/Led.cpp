@@ -9,10 +9,15 @@
  * Description: LED control and status indication
  */
 
+#include <freertos/event_groups.h>
+
 #include "Led.h"
 #include "SystemVariables.h"
 #include "SensorManagement.h"
 
+#define LED_EVENT_MEASUREMENT_DONE BIT0 // The LED of the measurement is off and held
+
+static EventGroupHandle_t ledEvents = NULL;
 
 const uint32_t LedUltraShort = 100;      // 100 ms
 const uint32_t LedShort = 500;           // 500 ms
@@ -145,6 +150,23 @@ void ledTask(void *pvParameters)
   }
 }
 
+/**
+ * @brief Shows a measurement with a 250 ms LED pulse and holds the LED off in deep sleep.
+ */
+static void measurementLedPulse()
+{
+  pinMode(GPIO_NUM_42, OUTPUT);
+  gpio_hold_dis(GPIO_NUM_42);
+
+  turnOnLed();
+  delay(250);
+  turnOffLed();
+
+  digitalWrite(42, LOW);
+  gpio_hold_en(GPIO_NUM_42);
+  gpio_deep_sleep_hold_en();
+}
+
 /**
  * @brief Task function for blinking LED during initial measurements.
  * @param pvParameters Pointer to the total measurement count.
@@ -154,18 +176,9 @@ void blinkLEDForFirstMeasurements(void *pvParameters)
   totalMeasurementCount = *(int *)pvParameters;
   if (totalMeasurementCount <= maxMeasurementCountForLed)
   {
-    pinMode(GPIO_NUM_42, OUTPUT);
-    gpio_hold_dis(GPIO_NUM_42);
-
-    turnOnLed();
-    delay(250);
-    ledOff.store(true);
-    turnOffLed();
-
-    digitalWrite(42, LOW);
-    gpio_hold_en(GPIO_NUM_42);
-    gpio_deep_sleep_hold_en();
+    measurementLedPulse();
   }
+  xEventGroupSetBits(ledEvents, LED_EVENT_MEASUREMENT_DONE);
   vTaskDelete(NULL);
 }
 
@@ -180,18 +193,38 @@ void firstBootLed()
 
 /**
  * @brief Starts the LED blink task for initial measurements.
+ *        Without the event group or the task the pulse is shown before returning.
  */
 void startLEDBlinkTaskForInitialMeasurements()
 {
-  TaskHandle_t ledTaskHandle = NULL;
-  BaseType_t ledTaskCreated = pdFALSE;
+  if (ledEvents == NULL)
+  {
+    ledEvents = xEventGroupCreate();
+  }
+  if (ledEvents == NULL)
+  {
+    if (totalMeasurementCount <= maxMeasurementCountForLed)
+    {
+      measurementLedPulse();
+    }
+    return;
+  }
+  xEventGroupClearBits(ledEvents, LED_EVENT_MEASUREMENT_DONE);
 
-  if (totalMeasurementCount <= maxMeasurementCountForLed)
+  if (totalMeasurementCount > maxMeasurementCountForLed ||
+      xTaskCreatePinnedToCore(blinkLEDForFirstMeasurements, "blinkLEDForFirstMeasurements", 1024, (void *)&totalMeasurementCount, 1, NULL, 1) != pdPASS)
   {
-    ledTaskCreated = xTaskCreatePinnedToCore(blinkLEDForFirstMeasurements, "blinkLEDForFirstMeasurements", 1024, (void *)&totalMeasurementCount, 1, &ledTaskHandle, 1);
+    xEventGroupSetBits(ledEvents, LED_EVENT_MEASUREMENT_DONE);
   }
-  else
+}
+
+/**
+ * @brief Blocks until the LED of the measurement is off, the core idles meanwhile.
+ */
+void waitForLEDBlinkTaskCompletion()
+{
+  if (ledEvents != NULL)
   {
-    ledMeasurementsOff.store(true);
+    xEventGroupWaitBits(ledEvents, LED_EVENT_MEASUREMENT_DONE, pdFALSE, pdTRUE, portMAX_DELAY);
   }
-}
\ No newline at end of file
+}
@@ -17,14 +17,18 @@
 #include "BMS.h"
 #include "DS3231TimeNtp.h"
 #include "DebuggingSDLog.h"
+#include "DeepSleep.h"
 #include "Led.h"
 #include "MQTTManager.h"
 #include "SensorManagement.h"
 #include "SystemVariables.h"
 #include "Utility.h"
 #include "WifiNetwork.h"
+#include "cpuClock.h"
 #include "firmwareUpdate.h"
 #include "loggerConfig.h"
+#include "phaseProfiler.h"
+#include "uploadPipeline.h"
 
 #define MMMS 1024 // MAX_MQTT_MESSAGE_SIZE
 
@@ -55,19 +59,19 @@ bool transmitUpdateMessage(const char *updateInfo, const char *mqtt_topic)
       {
         if (client.publish(mqtt_topic, updateInfo, false, 2) == 0)
         {
-          hasTransmissionUpdateError = true;
+          rtcStatus.hasTransmissionUpdateError = true;
           Log(LogCategoryMQTT, LogLevelDEBUG, "The message could not be sent");
         }
         else
         {
-          hasTransmissionUpdateError = false;
+          rtcStatus.hasTransmissionUpdateError = false;
           Log(LogCategoryMQTT, LogLevelDEBUG, "The message was sent successfully");
           return true;
         }
       }
       else
       {
-        hasTransmissionUpdateError = true;
+        rtcStatus.hasTransmissionUpdateError = true;
         Log(LogCategoryMQTT, LogLevelDEBUG, "MQTT client is not connected");
       }
     }
@@ -86,6 +90,67 @@ bool transmitUpdateMessage(const char *updateInfo, const char *mqtt_topic)
   }
 }
 
+/**
+ * @brief Adds the energy totals per phase to the status document.
+ *        Per phase the time in s, the charge in mAh, the energy in J (at the present battery
+ *        voltage) and the number of times the phase was entered.
+ * @param doc The status document.
+ */
+static void addEnergyTotals(JsonDocument &doc)
+{
+  float batteryVoltage = getTotalBatteryCellVoltage() / 1000.0f;
+  JsonObject energy = doc.createNestedObject("energy");
+  energy["since"] = energyTotals.sinceTime;
+  energy["model_s"] = (uint32_t)(energyTotals.modelMs / 1000); // Time without a measured current
+  energy["cpu_clock"] = cpuClockPolicyName();                   // The totals are compared per clock policy
+
+  for (int phase = 0; phase < ENERGY_PHASE_COUNT; phase++)
+  {
+    float chargeMilliAmpHour = energyTotals.chargeMicroAmpSec[phase] / 3600000.0f;
+    JsonObject entry = energy.createNestedObject(energyPhaseName((EnergyPhase)phase));
+    entry["s"] = (uint32_t)(energyTotals.durationMs[phase] / 1000);
+    entry["mAh"] = String(chargeMilliAmpHour, 3);
+    entry["J"] = String(chargeMilliAmpHour * 3.6f * batteryVoltage, 1);
+    entry["n"] = energyTotals.count[phase];
+  }
+}
+
+/**
+ * @brief Adds the time-to-connect histogram of the WiFi connections to the status.
+ * @param doc Status document.
+ */
+static void addWifiConnectStats(JsonDocument &doc)
+{
+  JsonObject wifiStats = doc.createNestedObject("wifi");
+  wifiStats["fast"] = wifiConnectStats.fastConnects;
+  wifiStats["scan"] = wifiConnectStats.scanConnects;
+  wifiStats["fail"] = wifiConnectStats.failures;
+  JsonArray connectMs = wifiStats.createNestedArray("connect_ms"); // < 250, 500, 1000, 2000, 4000 ms, longer
+  for (int bin = 0; bin < WIFI_CONNECT_BINS; bin++)
+  {
+    connectMs.add(wifiConnectStats.connectMs[bin]);
+  }
+}
+
+#ifdef PHASE_PROFILER
+/**
+ * @brief Publishes the phase histograms, prints them to the serial interface and clears them.
+ */
+static void uploadPhaseProfile()
+{
+  char payload[MMMS];
+  if (phaseProfilerToJson(payload, sizeof(payload)) == 0)
+  {
+    return;
+  }
+  phaseProfilerDump();
+  if (client.publish("hyfive/profile", payload, false, 1))
+  {
+    phaseProfilerClear();
+  }
+}
+#endif
+
 /**
  * @brief Uploads the logger status via MQTT.
  */
@@ -93,12 +158,16 @@ void uploadStatus()
 {
   char mqtt_topic[] = "hyfive/status";
 
-  StaticJsonDocument<200> doc;
+  StaticJsonDocument<1536> doc;
 
   doc["logger_id"] = configRTC.logger_id;
   doc["battery_remaining"] = getRemainingBatteryPercentage();
   doc["memory_capacity_total"] = sdCardSpaceTotal();
   doc["memory_capacity_used"] = sdCardSpaceUsed();
+  addEnergyTotals(doc);
+  addWifiConnectStats(doc);
+  doc["rtc_drift_ppm"] = String(rtcDriftModel.driftPpm, 2);
+  doc["rtc_sync"] = rtcDriftModel.syncTime;
 
   char payload[MMMS];
 
@@ -112,20 +181,23 @@ void uploadStatus()
       if (client.publish(mqtt_topic, payload, false, 2) == 0)
       {
         Log(LogCategoryMQTT, LogLevelDEBUG, "statusUpload could not be transmitted");
-        hasStatusUploadError = true;
+        rtcStatus.hasStatusUploadError = true;
         return;
       }
       else
       {
-        hasStatusUploadError = false;
+        rtcStatus.hasStatusUploadError = false;
         Log(LogCategoryMQTT, LogLevelDEBUG, "statusUpload successfully transferred");
+#ifdef PHASE_PROFILER
+        uploadPhaseProfile();
+#endif
         return;
       }
     }
     else
     {
       Log(LogCategoryMQTT, LogLevelDEBUG, "statusUpload could not be transmitted");
-      hasStatusUploadError = true;
+      rtcStatus.hasStatusUploadError = true;
       return;
     }
   }
@@ -607,6 +679,10 @@ void moveMeasurementAndData()
 
     // Move the measurement file to the MQTT measurements directory
     moveFileToDestination("/measurements", "measurement.json", "/measurements/mqtt_measurements", true);
+    moveFileToDestination("/measurements", "measurement_delta.json", "/measurements/mqtt_measurements", true);
+
+    // Move the profile summary to the MQTT summary directory
+    moveFileToDestination("/measurements", "summary.json", "/measurements/mqtt_summary", true);
   }
 }
 
@@ -618,8 +694,11 @@ void processAndTransmitMeasurementData()
   moveMeasurementAndData();
 
   // Check if there are any files in the MQTT header or measurements or log directories
-  if (checkFileProperties("/measurements/mqtt_header", 0, ".json") || checkFileProperties("/measurements/mqtt_measurements", 0, ".json") || checkFileProperties("/log", 0, ".txt"))
+  if (checkFileProperties("/measurements/mqtt_header", 0, ".json") || checkFileProperties("/measurements/mqtt_summary", 0, ".json") ||
+      checkFileProperties("/measurements/mqtt_measurements", 0, ".json") || checkFileProperties("/log", 0, ".txt"))
   {
+    EnergyPhase previous = enterEnergyPhase(ENERGY_PHASE_MQTT);
+    CpuClockLevel previousClock = raiseCpuClockLevel(CPU_CLOCK_BOOST); // Reading, serializing and sending the files
     while (checkWetSensorAndNodeRed())
     {
       // Transmit all header data while header files are present
@@ -631,6 +710,15 @@ void processAndTransmitMeasurementData()
         }
       }
 
+      // Transmit the profile summaries before the full-rate data, for the quick-look
+      if (checkFileProperties("/measurements/mqtt_summary", 0, ".json"))
+      {
+        if (connectToMqtt())
+        {
+          transmitSummaryViaMqtt();
+        }
+      }
+
       // Transmit all measurement data while measurement files are present
       if (checkFileProperties("/measurements/mqtt_measurements", 0, ".json"))
       {
@@ -650,7 +738,8 @@ void processAndTransmitMeasurementData()
       }
 
       // Check if there are not measurement JSON files in the "/measurements" directory
-      if (!checkFileProperties("/measurements/mqtt_header", 0, ".json") && !checkFileProperties("/measurements/mqtt_measurements", 0, ".json"))
+      if (!checkFileProperties("/measurements/mqtt_header", 0, ".json") && !checkFileProperties("/measurements/mqtt_summary", 0, ".json") &&
+          !checkFileProperties("/measurements/mqtt_measurements", 0, ".json"))
       {
         Log(LogCategoryMQTT, LogLevelDEBUG, "Data successfully transmitted");
         loggerTransmittedMeasurementDataLED();
@@ -662,6 +751,8 @@ void processAndTransmitMeasurementData()
         break;
       }
     }
+    setCpuClockLevel(previousClock);
+    leaveEnergyPhase(previous);
   }
 }
 
@@ -840,7 +931,7 @@ bool transmitHeaderViaMqtt()
         Log(LogCategoryMQTT, LogLevelDEBUG, "MQTT Disconnection: ", "filename: ", String(headerState.filename), " | ", String(headerState.lineNumber), "/", String(headerState.totalLines));
         pass = false;
         saveHeaderTransmissionState(headerState);
-        hasMqttHeaderError = true;
+        rtcStatus.hasMqttHeaderError = true;
         mqttErrorCounter++;
         break;
       }
@@ -848,7 +939,7 @@ bool transmitHeaderViaMqtt()
       {
         headerState.lineNumber++;
         saveHeaderTransmissionState(headerState);
-        hasMqttHeaderError = false;
+        rtcStatus.hasMqttHeaderError = false;
       }
     }
     else
@@ -954,7 +1045,7 @@ bool transmitLogViaMqtt()
         Log(LogCategoryMQTT, LogLevelDEBUG, "MQTT Disconnection: ", "filename: ", String(LogState.filename), " | ", String(LogState.lineNumber), "/", String(LogState.totalLines));
         pass = false;
         saveLogTransmissionState(LogState);
-        hasMqttLogError = true;
+        rtcStatus.hasMqttLogError = true;
         mqttErrorCounter++;
         break;
       }
@@ -962,7 +1053,7 @@ bool transmitLogViaMqtt()
       {
         LogState.lineNumber++;
         saveLogTransmissionState(LogState);
-        hasMqttLogError = false;
+        rtcStatus.hasMqttLogError = false;
       }
     }
     else
@@ -989,7 +1080,7 @@ bool transmitLogViaMqtt()
  */
 bool transmitDataViaMqtt()
 {
-  char mqtt_topic[] = "hyfive/data";
+  const char *mqtt_topic = "hyfive/data";
   bool pass = true;
 
   File dir = SD.open("/measurements/mqtt_measurements");
@@ -1041,7 +1132,44 @@ bool transmitDataViaMqtt()
     }
   }
 
-  while (currentMeasurementFile)
+  // Delta encoded samples have their own topic, the deck box decodes them with sampleCodec
+  if (String(dataState.filename).endsWith("measurement_delta.json"))
+  {
+    mqtt_topic = "hyfive/data_delta";
+  }
+
+  uint32_t startMs = millis();
+  long startLineNumber = dataState.lineNumber;
+
+  // The next lines are read on core 0 while a line is published, the loop below then only closes the file
+  UploadLine line;
+  if (currentMeasurementFile && uploadPipelineEnable && uploadPipelineStart(currentMeasurementFile, dataState.lineNumber, dataState.totalLines))
+  {
+    while (uploadPipelineNext(line))
+    {
+      if (client.publish(mqtt_topic, line.payload, false, 1) == 0)
+      {
+        uploadPipelineStop(); // The reader has to finish before the log uses the SD card
+        Log(LogCategoryMQTT, LogLevelDEBUG, "MQTT Disconnection: ", "filename: ", String(dataState.filename), " | ", String(dataState.lineNumber), "/", String(dataState.totalLines));
+        pass = false;
+        saveDataTransmissionState(dataState);
+        rtcStatus.hasMqttMeasurementError = true;
+        mqttErrorCounter++;
+        break;
+      }
+      dataState.lineNumber = line.nextLineNumber;
+      saveDataTransmissionState(dataState);
+      rtcStatus.hasMqttMeasurementError = false;
+      uploadPipelineRelease(line);
+    }
+    if (pass)
+    {
+      dataState.lineNumber = line.nextLineNumber; // Includes empty lines at the end of the file
+      saveDataTransmissionState(dataState);
+    }
+  }
+
+  while (pass && currentMeasurementFile)
   {
 
     // if (currentMeasurementFile.available() || (dataState.lineNumber != dataState.totalLines))
@@ -1064,7 +1192,7 @@ bool transmitDataViaMqtt()
         Log(LogCategoryMQTT, LogLevelDEBUG, "MQTT Disconnection: ", "filename: ", String(dataState.filename), " | ", String(dataState.lineNumber), "/", String(dataState.totalLines));
         pass = false;
         saveDataTransmissionState(dataState);
-        hasMqttMeasurementError = true;
+        rtcStatus.hasMqttMeasurementError = true;
         mqttErrorCounter++;
         break;
       }
@@ -1072,7 +1200,7 @@ bool transmitDataViaMqtt()
       {
         dataState.lineNumber++;
         saveDataTransmissionState(dataState);
-        hasMqttMeasurementError = false;
+        rtcStatus.hasMqttMeasurementError = false;
       }
     }
     else
@@ -1082,7 +1210,10 @@ bool transmitDataViaMqtt()
       {
         String basePath = "/measurements/mqtt_measurements";
         moveFileWithTimestamp("/measurements/mqtt_measurements", dataState.filename, "/backup/measurements");
-        Log(LogCategoryMQTT, LogLevelINFO, "data lines transmitted: ", "filename: ", String(dataState.filename), " | ", String(dataState.lineNumber), "/", String(dataState.totalLines));
+        uint32_t durationMs = millis() - startMs;
+        float linesPerSec = durationMs > 0 ? (dataState.lineNumber - startLineNumber) * 1000.0f / durationMs : 0;
+        Log(LogCategoryMQTT, LogLevelINFO, "data lines transmitted: ", "filename: ", String(dataState.filename), " | ", String(dataState.lineNumber), "/", String(dataState.totalLines),
+            " | ", String(durationMs), " ms, ", String(linesPerSec, 1), " lines/s", uploadPipelineEnable ? " (pipelined)" : " (serial)");
         memset(dataState.filename, '\0', sizeof(dataState.filename));
         dataState.lineNumber = 0;
         dataState.totalLines = 0;
@@ -1093,4 +1224,62 @@ bool transmitDataViaMqtt()
 
   dir.close();
   return pass;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Transmits the profile summaries via MQTT.
+ *        A summary file has one line per pressure bin, so it is sent completely in every
+ *        attempt instead of keeping a transmission state; after an interruption the
+ *        receiver may get bins twice.
+ * @return true if all summaries were transmitted, otherwise false.
+ */
+bool transmitSummaryViaMqtt()
+{
+  char mqtt_topic[] = "hyfive/summary";
+
+  File dir = SD.open("/measurements/mqtt_summary");
+  if (!dir || !dir.isDirectory())
+  {
+    Log(LogCategoryMQTT, LogLevelERROR, "mqtt_summary could not be opened");
+    return false;
+  }
+
+  bool pass = true;
+  File summaryFile = dir.openNextFile();
+  while (summaryFile && pass)
+  {
+    String filename = summaryFile.name();
+    long lines = 0;
+    while (summaryFile.available())
+    {
+      char payload[MMMS];
+      String buf = summaryFile.readStringUntil('\n');
+      if (buf.length() == 0)
+      {
+        continue;
+      }
+
+      buf.toCharArray(payload, sizeof(payload));
+      if (client.publish(mqtt_topic, payload, false, 1) == 0)
+      {
+        Log(LogCategoryMQTT, LogLevelDEBUG, "MQTT Disconnection: ", "filename: ", filename, " | ", String(lines));
+        rtcStatus.hasMqttMeasurementError = true;
+        mqttErrorCounter++;
+        pass = false;
+        break;
+      }
+      lines++;
+    }
+    summaryFile.close();
+
+    if (pass)
+    {
+      moveFileWithTimestamp("/measurements/mqtt_summary", filename.c_str(), "/backup/summary");
+      Log(LogCategoryMQTT, LogLevelINFO, "summary lines transmitted: ", "filename: ", filename, " | ", String(lines));
+      summaryFile = dir.openNextFile();
+    }
+  }
+
+  dir.close();
+  return pass;
+}
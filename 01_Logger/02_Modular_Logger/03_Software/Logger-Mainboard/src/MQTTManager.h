@@ -26,6 +26,7 @@ bool isNodeRedResponsePositive();
 bool connectToMqtt();
 bool transmitHeaderViaMqtt();
 bool transmitDataViaMqtt();
+bool transmitSummaryViaMqtt();
 bool transmitLogViaMqtt();
 
 #endif
\ No newline at end of file
@@ -13,6 +13,7 @@
 
 #include "Led.h"
 #include "SDCard.h"
+#include "phaseProfiler.h"
 
 SPIClass initSPIclass;
 
@@ -32,6 +33,7 @@ void initializeSpi()
  */
 bool initializeSdCard()
 {
+  PROFILE_SCOPE(PROFILE_PHASE_SD_MOUNT);
 
   initializeSpi();
   delay(50);
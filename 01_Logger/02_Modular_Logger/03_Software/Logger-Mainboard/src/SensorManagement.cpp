@@ -10,7 +10,6 @@
  */
 
 #include <ArduinoJson.h>
-#include <atomic>
 #include <iomanip>
 
 #include "BMS.h"
@@ -26,8 +25,14 @@
 #include "SystemVariables.h"
 #include "Utility.h"
 #include "WifiNetwork.h"
+#include "castProfiling.h"
+#include "cpuClock.h"
 #include "loggerConfig.h"
+#include "loggerConfigSchema.h"
 #include "loggerConfigValidation.h"
+#include "phaseProfiler.h"
+#include "profileSummary.h"
+#include "sampleStaging.h"
 #include "sample_cast.h"
 
 int64_t AdapterSensorRawValue[MAX_SENSOR_CREDENTIALS];
@@ -47,12 +52,23 @@ bool measurementSuccessful[MAX_SENSOR_CREDENTIALS];
 float sensorValue[MAX_SENSOR_CREDENTIALS];
 float sensorValueRaw[MAX_SENSOR_CREDENTIALS];
 
+/**
+ * @brief Waits at the low CPU clock level (sensor conversions and wake-up times).
+ * @param ms Time to wait in ms.
+ */
+static void delayAtLowClock(uint32_t ms)
+{
+  CpuClockLevel previousClock = setCpuClockLevel(CPU_CLOCK_LOW);
+  delay(ms);
+  setCpuClockLevel(previousClock);
+}
+
 /**
  * @brief Initializes the logger.
  */
 void initializeLogger()
 {
-  if (!isFirstBoot)
+  if (!rtcStatus.isFirstBoot)
   {
     delay(5000); // at least 5 seconds are required for initialization when the interface board is started for the first time
   }
@@ -94,34 +110,39 @@ float floatingPointConvert(uint32_t decimalValue)
   return converter.f;
 }
 
+/**
+ * @brief Checks whether a sensor is skipped because of an error.
+ * @param sensorNumber Index of the sensor in configRTC.sensor.
+ * @return bool True if the sensor is skipped.
+ */
+bool isSensorErrorSkipped(int sensorNumber)
+{
+  return (errorSkipSensorMask >> sensorNumber) & 1u;
+}
+
 void addSensorToErrorSkip(int sensorNumber)
 {
-  // Check whether the sensor is already in the list
-  for (int i = 0; i < errorSkipSensorSize; i++)
+  if (sensorNumber < 0 || sensorNumber >= MAX_SENSOR_CREDENTIALS)
   {
-    if (errorSkipSensor[i] == sensorNumber)
-    {
-      return; // Sensor is already in the list, nothing to do
-    }
+    Log(LogCategorySensors, LogLevelERROR, "errorSkipSensor cannot add sensor ", String(sensorNumber));
+    return;
   }
 
-  // Add the sensor to the list if there is still space
-  if (errorSkipSensorSize < MAX_SENSOR_CREDENTIALS)
-  {
-    errorSkipSensor[errorSkipSensorSize++] = sensorNumber;
-    Log(LogCategorySensors, LogLevelERROR, "sensor_id ", String(configRTC.sensor[sensorNumber].sensor_id), " added to errorSkipSensor");
-  }
-  else
+  // Check whether the sensor is already in the list
+  if (isSensorErrorSkipped(sensorNumber))
   {
-    Log(LogCategorySensors, LogLevelERROR, "errorSkipSensor is full, cannot add sensor ", String(sensorNumber));
+    return; // Sensor is already in the list, nothing to do
   }
+
+  errorSkipSensorMask |= 1u << sensorNumber;
+  Log(LogCategorySensors, LogLevelERROR, "sensor_id ", String(configRTC.sensor[sensorNumber].sensor_id), " added to errorSkipSensor");
 }
 
 void detectConnecteOxygenSensor(uint8_t sensorNumber)
 {
-  for (int i = 0; i < errorSkipSensorSize; i++)
+  for (int i = 0; i < SensorArraySize; i++)
   {
-    if (temperatureSensorBusAddress == configRTC.sensor[errorSkipSensor[i]].bus_address)
+    if (isSensorErrorSkipped(i) && temperatureSensorBusAddress == configRTC.sensor[i].bus_address)
     {
       addSensorToErrorSkip(sensorNumber);
       return;
@@ -156,6 +177,7 @@ void detectConnecteOxygenSensor(uint8_t sensorNumber)
  */
 void performSensorMeasurement(int sensorNumber)
 {
+  PROFILE_SCOPE(PROFILE_PHASE_SENSOR + sensorNumber);
   Log(LogCategorySensors, LogLevelDEBUG, "interfaceRdyErrorCounter: ", String(interfaceRdyErrorCounter));
 
   if (oxygenSensorBusAddress == configRTC.sensor[sensorNumber].bus_address)
@@ -167,6 +189,7 @@ void performSensorMeasurement(int sensorNumber)
   bool measuringTimeTooLong = true;
   bool interfaceErrorRdy2 = false;
 
+  CpuClockLevel previousClock = setCpuClockLevel(CPU_CLOCK_LOW); // Polls until the conversion is ready
   while ((esp_timer_get_time() / 1000 - start_time) < 5000)
   {
     Log(LogCategorySensors, LogLevelDEBUG, "esp_timer_get_time: ", String(esp_timer_get_time() / 1000 - start_time));
@@ -204,6 +227,7 @@ void performSensorMeasurement(int sensorNumber)
       break;
     }
   }
+  setCpuClockLevel(previousClock);
 
   if (measuringTimeTooLong && !interfaceErrorRdy2)
   {
@@ -236,30 +260,21 @@ void performSensorMeasurement(int sensorNumber)
     sensorValue[sensorNumber] = -1;
     sensorValueRaw[sensorNumber] = -1;
   }
-  Log(LogCategorySensors, LogLevelDEBUG, "sensor_id: ", String(configRTC.sensor[sensorNumber].sensor_id), " sensor value: ", String(sensorValue[sensorNumber]), " sensor value raw: ", String(sensorValueRaw[sensorNumber]), " sensor parameter: ", String(configRTC.sensor[sensorNumber].parameter));
+  Log(LogCategorySensors, LogLevelDEBUG, "sensor_id: ", String(configRTC.sensor[sensorNumber].sensor_id), " sensor value: ", String(sensorValue[sensorNumber]), " sensor value raw: ", String(sensorValueRaw[sensorNumber]), " sensor parameter: ", String(sensorParameter(sensorNumber)));
   measurementSuccessful[sensorNumber] = true;
 }
 
 /**
- * @brief Updates sensor measurements based on elapsed time.
+ * @brief Measures the sensors that are due in this wake-up (see collectDueSensors).
  */
 void updateSensorMeasurements()
 {
   for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
   {
-    if ((float)(totalOperationTime - lastSensorMeasurementTime[sensorNumber]) >= intervalSensorArray[sensorNumber])
+    if ((dueSensorMask >> sensorNumber) & 1u)
     {
-      bool shouldSkip = false;
-
       // Check whether the current sensor should be skipped
-      for (int i = 0; i < errorSkipSensorSize; i++)
-      {
-        if (sensorNumber == errorSkipSensor[i])
-        {
-          shouldSkip = true;
-          break;
-        }
-      }
+      bool shouldSkip = isSensorErrorSkipped(sensorNumber);
 
       if (shouldSkip)
       {
@@ -272,12 +287,14 @@ void updateSensorMeasurements()
 
         Log(LogCategorySensors, LogLevelDEBUG, "Skipping sensor: ", String(sensorNumber));
       }
+      else if ((autonomousSensorMask >> sensorNumber) & 1u)
+      {
+        drainAutonomousSamples(sensorNumber);
+      }
       else
       {
         performSensorMeasurement(sensorNumber);
       }
-
-      lastSensorMeasurementTime[sensorNumber] = totalOperationTime;
     }
   }
 }
@@ -289,30 +306,21 @@ void startConversionformUnderWaterOperations()
 {
   for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
   {
-    if ((float)(totalOperationTime - lastSensorMeasurementTime[sensorNumber]) >= intervalSensorArray[sensorNumber])
+    if ((dueSensorMask >> sensorNumber) & 1u)
     {
-      bool shouldSkip = false;
-
       // Check whether the current sensor should be skipped
-      for (int i = 0; i < errorSkipSensorSize; i++)
-      {
-        if (sensorNumber == errorSkipSensor[i])
-        {
-          shouldSkip = true;
-          break;
-        }
-      }
+      bool shouldSkip = isSensorErrorSkipped(sensorNumber);
 
-      if (shouldSkip)
+      if (shouldSkip || ((autonomousSensorMask >> sensorNumber) & 1u))
       {
-        continue; // Skip this sensor
+        continue; // Skip this sensor, an autonomous board has its samples ready
       }
 
       Logger.startConversionAll(configRTC.sensor[sensorNumber].bus_address);
       Log(LogCategorySensors, LogLevelDEBUG, "startConversionAll: ", String(configRTC.sensor[sensorNumber].bus_address));
     }
   }
-  delay(100);
+  delayAtLowClock(100);
 }
 
 /**
@@ -322,17 +330,8 @@ void startConversionForPerformInitialMeasurement()
 {
   for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
   {
-    bool shouldSkip = false;
-
     // Check whether the current sensor should be skipped
-    for (int i = 0; i < errorSkipSensorSize; i++)
-    {
-      if (sensorNumber == errorSkipSensor[i])
-      {
-        shouldSkip = true;
-        break;
-      }
-    }
+    bool shouldSkip = isSensorErrorSkipped(sensorNumber);
 
     if (shouldSkip)
     {
@@ -342,7 +341,42 @@ void startConversionForPerformInitialMeasurement()
     Logger.startConversionAll(configRTC.sensor[sensorNumber].bus_address);
     Log(LogCategorySensors, LogLevelDEBUG, "startConversionAll: ", String(configRTC.sensor[sensorNumber].bus_address));
   }
-  delay(100);
+  delayAtLowClock(100);
+}
+
+/**
+ * @brief Switches the 5 V and 12 V rails, only the rails that change are switched.
+ * @param rails RAIL_5V | RAIL_12V of the rails that are on afterwards.
+ */
+static void setPoweredRails(uint8_t rails)
+{
+  uint8_t switchOn = rails & ~poweredRails;
+  uint8_t switchOff = poweredRails & ~rails;
+
+  CpuClockLevel previousClock = setCpuClockLevel(CPU_CLOCK_LOW); // The switching waits for the rails to settle
+  if (switchOn & RAIL_5V)
+  {
+    enable5V();
+  }
+  if (switchOn & RAIL_12V)
+  {
+    enable12V();
+  }
+  if (switchOff & RAIL_5V)
+  {
+    disable5V();
+  }
+  if (switchOff & RAIL_12V)
+  {
+    disable12V();
+  }
+  setCpuClockLevel(previousClock);
+
+  if (switchOn || switchOff)
+  {
+    Log(LogCategorySensors, LogLevelDEBUG, "power rails 5V: ", String(rails & RAIL_5V ? "on" : "off"), " 12V: ", String(rails & RAIL_12V ? "on" : "off"));
+  }
+  poweredRails = rails;
 }
 
 /**
@@ -350,24 +384,15 @@ void startConversionForPerformInitialMeasurement()
  */
 void performInitialMeasurement()
 {
-  enable5V();
-  enable12V();
+  uint8_t previousRails = poweredRails;
+  setPoweredRails(poweredRails | needVoltage);
   Logger.sensorWakeupAll();
   startConversionForPerformInitialMeasurement();
 
   for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
   {
-    bool shouldSkip = false;
-
     // Check whether the current sensor should be skipped
-    for (int i = 0; i < errorSkipSensorSize; i++)
-    {
-      if (sensorNumber == errorSkipSensor[i])
-      {
-        shouldSkip = true;
-        break;
-      }
-    }
+    bool shouldSkip = isSensorErrorSkipped(sensorNumber);
 
     if (shouldSkip)
     {
@@ -384,33 +409,163 @@ void performInitialMeasurement()
     {
       performSensorMeasurement(sensorNumber);
     }
-
-    lastSensorMeasurementTime[sensorNumber] = totalOperationTime;
   }
 
   // if (!interfaceError){interfaceRdyErrorCounter = 0;}
 
-  disable5V();
-  disable12V();
+  setPoweredRails(previousRails);
   interfaceSleep();
 }
 
+/**
+ * @brief Returns the measurement interval of a sensor for the schedule.
+ * @param sensorNumber Index of the sensor in configRTC.sensor.
+ * @return uint32_t Interval in ms, an interval of 0 is measured every second.
+ */
+static uint32_t sensorIntervalMs(int sensorNumber)
+{
+  return intervalSensorArray[sensorNumber] > 0 ? (uint32_t)(intervalSensorArray[sensorNumber] * 1000) : 1000;
+}
+
+/**
+ * @brief Brings sensorSchedule in line with the active sensors and intervalSensorArray.
+ *        A new schedule measures all sensors at once.
+ */
+void syncSensorSchedule()
+{
+  uint32_t nowMs = getMonotonicMs();
+
+  if (sensorSchedule.count != numberOfActiveSensors)
+  {
+    tickSchedulerClear(sensorSchedule);
+    for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
+    {
+      tickSchedulerAdd(sensorSchedule, sensorNumber, sensorIntervalMs(sensorNumber), nowMs);
+    }
+    return;
+  }
+
+  for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
+  {
+    tickSchedulerSetPeriod(sensorSchedule, sensorNumber, sensorIntervalMs(sensorNumber));
+  }
+}
+
+/**
+ * @brief Takes the sensors that are due in this wake-up from sensorSchedule into dueSensorMask.
+ *        Sensors due within sensorWakeAlignMs are measured in this wake-up as well, so they share it.
+ */
+void collectDueSensors()
+{
+  syncSensorSchedule();
+
+  uint32_t nowMs = getMonotonicMs();
+  uint8_t sensorNumber;
+  dueSensorMask = 0;
+  while ((sensorNumber = tickSchedulerPopDue(sensorSchedule, nowMs, sensorWakeAlignMs)) != TICK_SCHEDULER_NO_EVENT)
+  {
+    dueSensorMask |= 1u << sensorNumber;
+  }
+}
+
 /**
  * @brief Calculates the shortest waiting time for the next sensor measurement.
- * @return float The shortest waiting time in seconds.
+ * @return uint32_t The shortest waiting time in milliseconds, 0 if a measurement is due already.
+ */
+uint32_t calculateShortestSensorWaitTime()
+{
+  int32_t shortestWaitingTime = tickSchedulerTimeUntilNext(sensorSchedule, getMonotonicMs());
+
+  // The clock is never stepped; a due time further away than the longest interval is only left
+  // from a schedule on another clock base (e.g. kept in the RTC memory over a firmware update), start over
+  uint32_t longestIntervalMs = 0;
+  for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
+  {
+    longestIntervalMs = max(longestIntervalMs, sensorIntervalMs(sensorNumber));
+  }
+  if ((uint32_t)shortestWaitingTime > longestIntervalMs)
+  {
+    Log(LogCategorySensors, LogLevelDEBUG, "sensor schedule restarted");
+    tickSchedulerRestart(sensorSchedule, getMonotonicMs());
+    shortestWaitingTime = tickSchedulerTimeUntilNext(sensorSchedule, getMonotonicMs());
+  }
+  return shortestWaitingTime;
+}
+
+/**
+ * @brief Checks the successful measurements against the quality control rules of their sensors.
+ * @param qcFlags Destination for the QC_FLAG_* bits per sensor.
  */
-float calculateShortestSensorWaitTime()
+void checkMeasurementQuality(uint8_t *qcFlags)
 {
-  float shortestWaitingTime = ULONG_MAX;
+  uint32_t nowMs = getMonotonicMs();
   for (int i = 0; i < numberOfActiveSensors; i++)
   {
-    float timeToNextMeasurement = intervalSensorArray[i] - (totalOperationTime - lastSensorMeasurementTime[i]);
-    if (timeToNextMeasurement < shortestWaitingTime)
+    qcFlags[i] = 0;
+    if (measurementSuccessful[i])
     {
-      shortestWaitingTime = timeToNextMeasurement;
+      const SensorRTC &sensor = configRTC.sensor[i];
+      QcRule rule = {sensor.qc_min, sensor.qc_max, sensor.qc_spike, sensor.qc_gradient};
+      qcFlags[i] = qcCheck(sensorQcState[i], rule, sensorValue[i], nowMs);
+    }
+  }
+}
+
+static bool isFastSampling = false; // The cast detection selected sample_cast_periode
+
+/**
+ * @brief Returns the configured sampling interval of a sensor.
+ * @param sensorNumber Index of the sensor in configRTC.sensor.
+ * @param useFastSampling True for the cast interval, false otherwise.
+ * @return float Interval in seconds.
+ */
+static float configuredSamplingInterval(int sensorNumber, bool useFastSampling)
+{
+  if (useFastSampling)
+  {
+    return configRTC.sample_cast_periode * configRTC.sensor[sensorNumber].sample_cast_periode_multiplier;
+  }
+  return configRTC.sample_periode * configRTC.sensor[sensorNumber].sample_periode_multiplier;
+}
+
+/**
+ * @brief Lengthens the interval of sensors with a steady value and shortens it again when the value changes.
+ *        Only values that passed the quality control are used. Casts and the dry confirmation keep
+ *        their intervals and start the adaptation from the configured interval again.
+ * @param qcFlags Per sensor: QC_FLAG_* bits of the value.
+ */
+static void updateAdaptiveSampling(const uint8_t *qcFlags)
+{
+  bool adaptationPaused = isFastSampling || wetDryIsPending(wetDryDetector);
+
+  for (int i = 0; i < numberOfActiveSensors; i++)
+  {
+    const SensorRTC &sensor = configRTC.sensor[i];
+    if (!(sensor.adaptive_deadband > 0))
+    {
+      continue;
+    }
+    if (adaptationPaused)
+    {
+      adaptiveReset(sensorAdaptiveState[i]);
+      continue;
+    }
+    if (!measurementSuccessful[i] || qcFlags[i] != 0)
+    {
+      continue;
+    }
+
+    uint8_t previousLevel = sensorAdaptiveState[i].level;
+    AdaptiveRule rule = {sensor.adaptive_deadband, adaptiveSamplingMaxLevel};
+    uint8_t level = adaptiveUpdate(sensorAdaptiveState[i], rule, sensorValue[i]);
+    intervalSensorArray[i] = configuredSamplingInterval(i, false) * (1 << level);
+
+    if (level != previousLevel)
+    {
+      // A shorter interval follows a change of the measured parameter, a longer one is routine
+      Log(LogCategorySensors, level < previousLevel ? LogLevelINFO : LogLevelDEBUG, "adaptive sampling: ", sensorParameter(i), " interval [s]: ", String(intervalSensorArray[i]), " level: ", String(level));
     }
   }
-  return shortestWaitingTime;
 }
 
 /**
@@ -418,53 +573,149 @@ float calculateShortestSensorWaitTime()
  */
 void writeMeasurementDataToFile()
 {
+  PROFILE_SCOPE(PROFILE_PHASE_JSON);
   bool valuePresent = false;
 
-  StaticJsonDocument<1024> doc;
-
-  doc["time"] = formatLocalTimeAsISOString();
-  doc["logger_id"] = configRTC.logger_id;
-  doc["deployment_id"] = deployment_id;
-
-  // Iterate over all sensors and add their data if the measurement was successful
+  // Iterate over all sensors and check whether a measurement was successful
   for (int i = 0; i < numberOfActiveSensors; i++)
   {
     if (measurementSuccessful[i])
     {
-      doc[configRTC.sensor[i].parameter] = String(sensorValue[i]);
-      doc[String(configRTC.sensor[i].parameter) + "_raw"] = String(sensorValueRaw[i]);
       valuePresent = true;
     }
   }
 
   if (valuePresent)
   {
-    String daten = "";
-    serializeJson(doc, daten);
+    uint8_t qcFlags[MAX_SENSOR_CREDENTIALS];
+    checkMeasurementQuality(qcFlags);
 
-    appendDataToFile("/measurements/measurement.json", daten);
+    // Staged in the RTC memory, written to measurement.json in batches
+    stageMeasurementSample(getCurrentTimeFromRTC(), measurementSuccessful, sensorValue, sensorValueRaw, qcFlags, numberOfActiveSensors);
+    addProfileSample(measurementSuccessful, sensorValue, qcFlags, numberOfActiveSensors);
+    updateAdaptiveSampling(qcFlags);
 
     // sampleCast
     for (int i = 0; i < numberOfActiveSensors; i++)
     {
-      if (configRTC.sensor[i].sensor_id == configRTC.cast_det_sensor)
+      if (configRTC.sensor[i].sensor_id == configRTC.cast_det_sensor && measurementSuccessful[i])
       {
-        if (!sensorValue[i] == 0)
-        {
-          File datei = SD.open("/measurements/sample_cast.txt", FILE_APPEND);
-          if (datei)
-          {
-            datei.print(getCurrentTimeFromRTC());
-            datei.print(",");
-            datei.println(sensorValue[i]);
-          }
-          datei.close();
-        }
+        addCastSample(getMonotonicMs(), sensorValue[i]);
       }
     }
   }
 }
 
+/**
+ * @brief Returns whether a bus address belongs to a board that samples on its own (see autonomousSensorMask).
+ */
+static bool isAutonomousBusAddress(uint8_t busAddress)
+{
+  for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
+  {
+    if (((autonomousSensorMask >> sensorNumber) & 1u) && configRTC.sensor[sensorNumber].bus_address == busAddress)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Starts the sampling of the interface boards with autonomous_sample_periode_ms for a deployment.
+ *        These boards stay awake and sample into their ring until stopAutonomousSampling; when the sensor is
+ *        due, the ring is drained instead of a conversion (see drainAutonomousSamples).
+ */
+void startAutonomousSampling()
+{
+  autonomousSensorMask = 0;
+  for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
+  {
+    const SensorRTC &sensor = configRTC.sensor[sensorNumber];
+    if (sensor.autonomous_sample_periode_ms == 0 || isSensorErrorSkipped(sensorNumber))
+    {
+      continue;
+    }
+    if (sensor.parameter_no != 1 || sensor.sensor_id == configRTC.cast_det_sensor)
+    {
+      // The ring holds the calculated values only, and the cast detection needs a value in every profiling tick
+      Log(LogCategorySensors, LogLevelWARNING, "autonomous sampling needs parameter_no 1 and no cast detection sensor, sensor_id: ", String(sensor.sensor_id));
+      continue;
+    }
+    if (Logger.setSampleInterval(sensor.bus_address, sensor.autonomous_sample_periode_ms) != 0)
+    {
+      Log(LogCategorySensors, LogLevelERROR, "autonomous sampling not started, bus address: ", String(sensor.bus_address));
+      continue;
+    }
+    autonomousSensorMask |= 1u << sensorNumber;
+    autonomousSampleTime[sensorNumber] = 0;
+
+    float drainIntervalMs = configuredSamplingInterval(sensorNumber, false) * 1000;
+    if (drainIntervalMs > (float)INTERFACE_SAMPLE_RING_SIZE * sensor.autonomous_sample_periode_ms)
+    {
+      Log(LogCategorySensors, LogLevelWARNING, "the ring of sensor_id ", String(sensor.sensor_id), " overflows before it is drained, interval [s]: ",
+          String(drainIntervalMs / 1000));
+    }
+  }
+}
+
+/**
+ * @brief Writes the samples an interface board took since the last drain.
+ *        Each sample is staged with the RTC time minus its age and passes the quality control
+ *        and the profile summary like a measured value. The RTC counts whole seconds, so a time
+ *        one second before the last drained sample is kept at the time of that sample.
+ * @param sensorNumber Index of the sensor in configRTC.sensor, set in autonomousSensorMask.
+ */
+void drainAutonomousSamples(int sensorNumber)
+{
+  const SensorRTC &sensor = configRTC.sensor[sensorNumber];
+  InterfaceSample samples[INTERFACE_SAMPLE_RING_SIZE];
+  int count = Logger.drainSamples(sensor.bus_address, samples, INTERFACE_SAMPLE_RING_SIZE);
+  if (count <= 0)
+  {
+    return;
+  }
+
+  uint32_t nowSec = getCurrentTimeFromRTC();
+  uint32_t nowMs = getMonotonicMs();
+  QcRule rule = {sensor.qc_min, sensor.qc_max, sensor.qc_spike, sensor.qc_gradient};
+  bool successful[MAX_SENSOR_CREDENTIALS] = {false};
+  float value[MAX_SENSOR_CREDENTIALS] = {0};
+  float valueRaw[MAX_SENSOR_CREDENTIALS] = {0};
+  uint8_t qcFlags[MAX_SENSOR_CREDENTIALS] = {0};
+  successful[sensorNumber] = true;
+
+  for (int k = 0; k < count; k++)
+  {
+    // Value 1 and value 2 as Measure(parameter_no 1) and Measure(parameter_no + 2) read them
+    value[sensorNumber] = floatingPointConvert(samples[k].value1);
+    valueRaw[sensorNumber] = samples[k].value2;
+    qcFlags[sensorNumber] = qcCheck(sensorQcState[sensorNumber], rule, value[sensorNumber], nowMs - samples[k].ageMs);
+
+    uint32_t sampleTime = max(nowSec - (samples[k].ageMs + 500) / 1000, autonomousSampleTime[sensorNumber]);
+    autonomousSampleTime[sensorNumber] = sampleTime;
+    stageMeasurementSample(sampleTime, successful, value, valueRaw, qcFlags, numberOfActiveSensors);
+    addProfileSample(successful, value, qcFlags, numberOfActiveSensors);
+  }
+  Log(LogCategorySensors, LogLevelDEBUG, "autonomous samples drained: ", String(count), " sensor_id: ", String(sensor.sensor_id));
+}
+
+/**
+ * @brief Writes the samples left on the autonomous boards and stops their sampling at the end of a deployment.
+ */
+void stopAutonomousSampling()
+{
+  for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
+  {
+    if ((autonomousSensorMask >> sensorNumber) & 1u)
+    {
+      drainAutonomousSamples(sensorNumber);
+      Logger.setSampleInterval(configRTC.sensor[sensorNumber].bus_address, 0);
+    }
+  }
+  autonomousSensorMask = 0;
+}
+
 /**
  * @brief Detects connected sensor devices.
  */
@@ -505,7 +756,7 @@ void detectConnectedSensorDevices()
         }
       }
 
-      if (!isFirstBoot)
+      if (!rtcStatus.isFirstBoot)
       {
         setSensorCalibCount = 0;
 
@@ -517,79 +768,20 @@ void detectConnectedSensorDevices()
         }
         else
         {
-          if (config.sensor[i].calib_coeff_1 != 0.00)
-            setSensorCalibToInterface(configRTC.sensor[i].bus_address, 1, config.sensor[i].calib_coeff_1);
-          else
-          {
-            setSensorCalibCount++;
-          }
-
-          if (config.sensor[i].calib_coeff_2 != 0.00)
-            setSensorCalibToInterface(configRTC.sensor[i].bus_address, 2, config.sensor[i].calib_coeff_2);
-          else
-          {
-            setSensorCalibCount++;
-          }
-
-          if (config.sensor[i].calib_coeff_3 != 0.00)
-            setSensorCalibToInterface(configRTC.sensor[i].bus_address, 3, config.sensor[i].calib_coeff_3);
-          else
-          {
-            setSensorCalibCount++;
-          }
-
-          if (config.sensor[i].calib_coeff_4 != 0.00)
-            setSensorCalibToInterface(configRTC.sensor[i].bus_address, 4, config.sensor[i].calib_coeff_4);
-          else
-          {
-            setSensorCalibCount++;
-          }
-
-          if (config.sensor[i].calib_coeff_5 != 0.00)
-            setSensorCalibToInterface(configRTC.sensor[i].bus_address, 5, config.sensor[i].calib_coeff_5);
-          else
-          {
-            setSensorCalibCount++;
-          }
-
-          if (config.sensor[i].calib_coeff_6 != 0.00)
-            setSensorCalibToInterface(configRTC.sensor[i].bus_address, 6, config.sensor[i].calib_coeff_6);
-          else
-          {
-            setSensorCalibCount++;
-          }
-
-          if (config.sensor[i].calib_coeff_7 != 0.00)
-            setSensorCalibToInterface(configRTC.sensor[i].bus_address, 7, config.sensor[i].calib_coeff_7);
-          else
+          for (int k = 0; k < CALIB_COEFF_COUNT; k++)
           {
-            setSensorCalibCount++;
-          }
-
-          if (config.sensor[i].calib_coeff_8 != 0.00)
-            setSensorCalibToInterface(configRTC.sensor[i].bus_address, 8, config.sensor[i].calib_coeff_8);
-          else
-          {
-            setSensorCalibCount++;
-          }
-
-          if (config.sensor[i].calib_coeff_9 != 0.00)
-            setSensorCalibToInterface(configRTC.sensor[i].bus_address, 9, config.sensor[i].calib_coeff_9);
-          else
-          {
-            setSensorCalibCount++;
-          }
-
-          if (config.sensor[i].calib_coeff_10 != 0.00)
-            setSensorCalibToInterface(configRTC.sensor[i].bus_address, 10, config.sensor[i].calib_coeff_10);
-          else
-          {
-            setSensorCalibCount++;
+            if (config.sensor[i].calib_coeff[k] != 0.00)
+              setSensorCalibToInterface(configRTC.sensor[i].bus_address, k + 1, config.sensor[i].calib_coeff[k]);
+            else
+            {
+              setSensorCalibCount++;
+            }
           }
         }
 
         Logger.getSensorWakeupTime(configRTC.sensor[i].bus_address);
         uint16_t sensorWakeupTime = AdapterSensorRawValue[configRTC.sensor[i].bus_address];
+        busSensorWakeupTime[configRTC.sensor[i].bus_address] = sensorWakeupTime;
         if (sensorWakeupTime > longestSensorWakeupTime)
         {
           longestSensorWakeupTime = sensorWakeupTime;
@@ -620,8 +812,8 @@ void detectConnectedSensorDevices()
     }
     else
     {
-      Log(LogCategorySensors, LogLevelERROR, "LoggerConfigFile | sensor not found | sensor_id: ", String(configRTC.sensor[i].sensor_id), " bus_address: ", String(configRTC.sensor[i].bus_address), " parameter: ", String(configRTC.sensor[i].parameter));
-      transmitUpdateMessage(("LoggerConfigFile | sensor not found | sensor_id: " + String(configRTC.sensor[i].sensor_id) + " bus_address: " + String(configRTC.sensor[i].bus_address) + " parameter: " + String(configRTC.sensor[i].parameter)).c_str(), "hyfive/ConfigError");
+      Log(LogCategorySensors, LogLevelERROR, "LoggerConfigFile | sensor not found | sensor_id: ", String(configRTC.sensor[i].sensor_id), " bus_address: ", String(configRTC.sensor[i].bus_address), " parameter: ", String(sensorParameter(i)));
+      transmitUpdateMessage(("LoggerConfigFile | sensor not found | sensor_id: " + String(configRTC.sensor[i].sensor_id) + " bus_address: " + String(configRTC.sensor[i].bus_address) + " parameter: " + String(sensorParameter(i))).c_str(), "hyfive/ConfigError");
       transmitUpdateMessage(("LoggerConfigFile | sensor not found | bus_address: " + String(configRTC.sensor[i].bus_address) + " nicht erreichbar").c_str(), "hyfive/ConfigError");
 
       hasSensorError = true;
@@ -688,35 +880,11 @@ void sensorCalibToInterface()
   {
     if (AdapterSensorTypeID[configRTC.sensor[i].bus_address] != 0)
     {
-      if (config.sensor[i].calib_coeff_1 != 0.00)
-        setSensorCalibToInterface(configRTC.sensor[i].bus_address, 1, config.sensor[i].calib_coeff_1);
-
-      if (config.sensor[i].calib_coeff_2 != 0.00)
-        setSensorCalibToInterface(configRTC.sensor[i].bus_address, 2, config.sensor[i].calib_coeff_2);
-
-      if (config.sensor[i].calib_coeff_3 != 0.00)
-        setSensorCalibToInterface(configRTC.sensor[i].bus_address, 3, config.sensor[i].calib_coeff_3);
-
-      if (config.sensor[i].calib_coeff_4 != 0.00)
-        setSensorCalibToInterface(configRTC.sensor[i].bus_address, 4, config.sensor[i].calib_coeff_4);
-
-      if (config.sensor[i].calib_coeff_5 != 0.00)
-        setSensorCalibToInterface(configRTC.sensor[i].bus_address, 5, config.sensor[i].calib_coeff_5);
-
-      if (config.sensor[i].calib_coeff_6 != 0.00)
-        setSensorCalibToInterface(configRTC.sensor[i].bus_address, 6, config.sensor[i].calib_coeff_6);
-
-      if (config.sensor[i].calib_coeff_7 != 0.00)
-        setSensorCalibToInterface(configRTC.sensor[i].bus_address, 7, config.sensor[i].calib_coeff_7);
-
-      if (config.sensor[i].calib_coeff_8 != 0.00)
-        setSensorCalibToInterface(configRTC.sensor[i].bus_address, 8, config.sensor[i].calib_coeff_8);
-
-      if (config.sensor[i].calib_coeff_9 != 0.00)
-        setSensorCalibToInterface(configRTC.sensor[i].bus_address, 9, config.sensor[i].calib_coeff_9);
-
-      if (config.sensor[i].calib_coeff_10 != 0.00)
-        setSensorCalibToInterface(configRTC.sensor[i].bus_address, 10, config.sensor[i].calib_coeff_10);
+      for (int k = 0; k < CALIB_COEFF_COUNT; k++)
+      {
+        if (config.sensor[i].calib_coeff[k] != 0.00)
+          setSensorCalibToInterface(configRTC.sensor[i].bus_address, k + 1, config.sensor[i].calib_coeff[k]);
+      }
     }
   }
 }
@@ -742,7 +910,7 @@ void detectDryWetCastSensors()
         waterDetectionSensorBusAddress = configRTC.sensor[i].bus_address;
         wetDetSensorParameterNo = configRTC.sensor[i].parameter_no;
         sensorFoundWetDetSensor = true;
-        Log(LogCategorySensors, LogLevelDEBUG, "LoggerConfigFile | waterDetectionSensorBusAddress detected | sensor_id: ", String(configRTC.sensor[i].sensor_id), " bus_address: ", String(configRTC.sensor[i].bus_address), " parameter: ", String(configRTC.sensor[i].parameter));
+        Log(LogCategorySensors, LogLevelDEBUG, "LoggerConfigFile | waterDetectionSensorBusAddress detected | sensor_id: ", String(configRTC.sensor[i].sensor_id), " bus_address: ", String(configRTC.sensor[i].bus_address), " parameter: ", String(sensorParameter(i)));
         break;
       }
     }
@@ -764,7 +932,7 @@ void detectDryWetCastSensors()
         dryDetectionSensorBusAddress = configRTC.sensor[i].bus_address;
         dryDetSensorParameterNo = configRTC.sensor[i].parameter_no;
         sensorFoundDryDetSensor = true;
-        Log(LogCategorySensors, LogLevelDEBUG, "LoggerConfigFile | dryDetectionSensorBusAddress detected | sensor_id: ", String(configRTC.sensor[i].sensor_id), " bus_address: ", String(configRTC.sensor[i].bus_address), " parameter: ", String(configRTC.sensor[i].parameter));
+        Log(LogCategorySensors, LogLevelDEBUG, "LoggerConfigFile | dryDetectionSensorBusAddress detected | sensor_id: ", String(configRTC.sensor[i].sensor_id), " bus_address: ", String(configRTC.sensor[i].bus_address), " parameter: ", String(sensorParameter(i)));
         break;
       }
     }
@@ -786,7 +954,7 @@ void detectDryWetCastSensors()
         castDetectionSensorBusAddress = configRTC.sensor[i].bus_address;
         castDetSensorParameterNo = configRTC.sensor[i].parameter_no;
         sensorFoundCastDetSensor = true;
-        Log(LogCategorySensors, LogLevelDEBUG, "LoggerConfigFile | castDetectionSensorBusAddress detected | sensor_id: ", String(configRTC.sensor[i].sensor_id), " bus_address: ", String(configRTC.sensor[i].bus_address), " parameter: ", String(configRTC.sensor[i].parameter));
+        Log(LogCategorySensors, LogLevelDEBUG, "LoggerConfigFile | castDetectionSensorBusAddress detected | sensor_id: ", String(configRTC.sensor[i].sensor_id), " bus_address: ", String(configRTC.sensor[i].bus_address), " parameter: ", String(sensorParameter(i)));
         break;
       }
     }
@@ -806,30 +974,82 @@ void detectDryWetCastSensors()
 void enterDeepSleepAfterMeasurement()
 {
   // if (!interfaceError){interfaceRdyErrorCounter = 0;}
-  float shortestWaitingTime = calculateShortestSensorWaitTime();
-  totalOperationTime += shortestWaitingTime;
-  float endCalculationTime = micros();
+  PROFILE_START(sleepEntryStartUs);
+  syncSensorSchedule(); // The intervals may have changed by the cast or dry detection
+  releaseIdleRails();
+  uint32_t shortestWaitingTime = calculateShortestSensorWaitTime();
 
-  bool calculationTimeOverflow = totalOperationTime * 1000000 < endCalculationTime;
-  bool calculationTimeNegative = ((shortestWaitingTime * 1000000 - micros()) / 1000000) < 0;
+  Log(LogCategorySensors, LogLevelDEBUG, "Restzeit für den Zyklus Sleep: ", String(millis()));
+  Log(LogCategorySensors, LogLevelDEBUG, "Sensor deep sleep time [ms]: ", String(shortestWaitingTime));
+  esp_sleep_enable_timer_wakeup((uint64_t)shortestWaitingTime * 1000); // Mikrosekunden
+  enterEnergyPhase(ENERGY_PHASE_SLEEP);
+  PROFILE_STOP(PROFILE_PHASE_SLEEP_ENTRY, sleepEntryStartUs);
+  esp_deep_sleep_start();
+}
 
-  if (calculationTimeOverflow || calculationTimeNegative)
+/**
+ * @brief Returns the thresholds and confirmation counts of the wet/dry detection.
+ *        The dry transition needs dry_det_verify_delay + 1 readings as before the state machine.
+ */
+static WetDryParameters wetDryParameters()
+{
+  WetDryParameters parameters;
+  parameters.wetThreshold = configRTC.wet_det_threshold;
+  parameters.dryThreshold = configRTC.dry_det_threshold;
+  parameters.hysteresis = wetDryHysteresis;
+  parameters.wetConfirmCount = wetDetConfirmCount;
+  parameters.dryConfirmCount = configRTC.dry_det_verify_delay + 1;
+  parameters.pendingLimit = wetDryPendingLimit;
+  return parameters;
+}
+
+/**
+ * @brief Feeds a reading into the wet/dry detector and logs rejected transitions.
+ * @param value Reading of the wet detection sensor (above water) or the dry detection sensor (underwater).
+ * @return WetDryState The state after the reading.
+ */
+static WetDryState updateWetDryDetection(float value)
+{
+  uint16_t rejectedWetCount = wetDryDetector.rejectedWetCount;
+  uint16_t rejectedDryCount = wetDryDetector.rejectedDryCount;
+  WetDryState state = wetDryUpdate(wetDryDetector, wetDryParameters(), value);
+  isWetDryMeasured = true;
+
+  if (wetDryDetector.rejectedWetCount != rejectedWetCount)
   {
-    Log(LogCategorySensors, LogLevelDEBUG, "Measuring time too long");
-    espDeepSleepSec(0);
+    Log(LogCategorySensors, LogLevelINFO, "Wet detection not confirmed, prevented false deployments: ", String(wetDryDetector.rejectedWetCount));
   }
-  Log(LogCategorySensors, LogLevelDEBUG, "Restzeit für den Zyklus Sleep: ", String(millis()));
-  Log(LogCategorySensors, LogLevelDEBUG, "Sensor deep sleep time: ", String((shortestWaitingTime * 1000000 - micros()) / 1000000));
-  esp_sleep_enable_timer_wakeup(shortestWaitingTime * 1000000 - micros()); // Mikrosekunden
-  esp_deep_sleep_start();
+  if (wetDryDetector.rejectedDryCount != rejectedDryCount)
+  {
+    Log(LogCategorySensors, LogLevelINFO, "Dry detection not confirmed, prevented false deployment ends: ", String(wetDryDetector.rejectedDryCount));
+  }
+  if (wetDryIsPending(wetDryDetector))
+  {
+    Log(LogCategorySensors, LogLevelDEBUG, "Wet/dry confirmation: ", String(wetDryDetector.confirmCount));
+  }
+  return state;
+}
+
+/**
+ * @brief Checks whether a wet detection waits for its confirmation.
+ * @return bool True if the wet detection sensor should be read again soon.
+ */
+bool isWetDetectionPending()
+{
+  return wetDryDetector.state == WET_DRY_WET_PENDING;
 }
 
 /**
  * @brief Checks the status of the wet sensor.
- * @return bool True if the sensor is wet, false otherwise.
+ * @return bool True if the sensor is wet or a wet detection waits for its confirmation, false otherwise.
  */
 bool checkWetSensorStatus()
 {
+  if (wetDryDetector.state != WET_DRY_DRY || isWetDryMeasured)
+  {
+    return wetDryDetector.state != WET_DRY_DRY;
+  }
+
   Logger.sensorWakeupDetection(waterDetectionSensorBusAddress);
   Logger.startConversion(waterDetectionSensorBusAddress);
 
@@ -849,7 +1069,7 @@ bool checkWetSensorStatus()
   uint32_t rawValue = AdapterSensorRawValue[waterDetectionSensorBusAddress];
   float wetSensorValue = floatingPointConvert(rawValue);
 
-  if (wetSensorValue > configRTC.wet_det_threshold)
+  if (updateWetDryDetection(wetSensorValue) != WET_DRY_DRY)
   {
     Log(LogCategorySensors, LogLevelDEBUG, "is underwater");
     return true;
@@ -868,9 +1088,7 @@ bool checkWetSensorStatus()
 void createConfigHeader()
 {
 
-  JsonFileRead("/loggerConfig/" + findLatestConfigurationFile("/loggerConfig"));
-  configureSensorsFromJson();
-  configureBasicSettingsFromJson();
+  validateAndLoadConfig(); // Loads the snapshot, the JSON file is only parsed if no valid snapshot exists
 
   File file = SD.open("/measurements/configHeader.json", FILE_APPEND);
   if (!file)
@@ -883,13 +1101,7 @@ void createConfigHeader()
   doc1["logger_id"] = configRTC.logger_id;
   doc1["deployment_id"] = deployment_id;
   doc1["parameter"] = "logger";
-  doc1["deckunit_id"] = config.deckunit_id;
-  doc1["platform_id"] = config.platform_id;
-  doc1["vessel_id"] = config.vessel_id;
-  doc1["vessel_name"] = config.vessel_name;
-  doc1["deployment_contact_id"] = config.deployment_contact_id;
-  doc1["contact_first_name"] = config.contact_first_name;
-  doc1["contact_last_name"] = config.contact_last_name;
+  writeConfigFieldsToJson(basicConfigFields, CONFIG_FIELD_COUNT(basicConfigFields), FIELD_HEADER, doc1.as<JsonObject>(), JsonObject(), &configRTC, &config);
 
   serializeJson(doc1, file);
   file.println();
@@ -898,38 +1110,10 @@ void createConfigHeader()
   for (int sensorNumber = 0; sensorNumber < Logger.AdapterNum_Sensors; sensorNumber++)
   {
 
-    doc2["sensor_id"] = configRTC.sensor[sensorNumber].sensor_id;
-    doc2["sample_periode_multiplier"] = configRTC.sensor[sensorNumber].sample_periode_multiplier;
-    doc2["sample_cast_periode_multiplier"] = configRTC.sensor[sensorNumber].sample_cast_periode_multiplier;
-    doc2["bus_address"] = configRTC.sensor[sensorNumber].bus_address;
-    doc2["serial_number"] = config.sensor[sensorNumber].serial_number;
-
-    // Calibration coefficients
-    JsonObject calib_coeff = doc2.createNestedObject("calib_coeff");
-
-    calib_coeff["1"] = config.sensor[sensorNumber].calib_coeff_1;
-    calib_coeff["2"] = config.sensor[sensorNumber].calib_coeff_2;
-    calib_coeff["3"] = config.sensor[sensorNumber].calib_coeff_3;
-    calib_coeff["4"] = config.sensor[sensorNumber].calib_coeff_4;
-    calib_coeff["5"] = config.sensor[sensorNumber].calib_coeff_5;
-    calib_coeff["6"] = config.sensor[sensorNumber].calib_coeff_6;
-    calib_coeff["7"] = config.sensor[sensorNumber].calib_coeff_7;
-    calib_coeff["8"] = config.sensor[sensorNumber].calib_coeff_8;
-    calib_coeff["9"] = config.sensor[sensorNumber].calib_coeff_9;
-    calib_coeff["10"] = config.sensor[sensorNumber].calib_coeff_10;
-
-    // Sensortyp
+    doc2.clear();
     JsonObject sensor_type = doc2.createNestedObject("sensor_type");
-    sensor_type["sensor_type_id"] = config.sensor[sensorNumber].sensor_type_id;
-    sensor_type["parameter"] = configRTC.sensor[sensorNumber].parameter;
-    sensor_type["long_name"] = config.sensor[sensorNumber].long_name;
-    sensor_type["unit"] = config.sensor[sensorNumber].unit;
-    sensor_type["manufacturer"] = config.sensor[sensorNumber].manufacturer;
-    sensor_type["model"] = config.sensor[sensorNumber].model;
-    sensor_type["parameter_no"] = configRTC.sensor[sensorNumber].parameter_no;
-
-    sensor_type["accuracy"] = config.sensor[sensorNumber].accuracy;
-    sensor_type["resolution"] = config.sensor[sensorNumber].resolution;
+    writeConfigFieldsToJson(sensorConfigFields, CONFIG_FIELD_COUNT(sensorConfigFields), FIELD_HEADER, doc2.as<JsonObject>(), sensor_type,
+                            &configRTC.sensor[sensorNumber], &config.sensor[sensorNumber]);
 
     doc2["logger_id"] = configRTC.logger_id;
     doc2["deployment_id"] = deployment_id;
@@ -1053,11 +1237,9 @@ void interfaceSensorVoltage(int bus_address)
     break;
   }
 
-  // Update maxNeedVoltage if currentNeedVoltage is greater
-  if (currentNeedVoltage > needVoltage)
-  {
-    needVoltage = currentNeedVoltage;
-  }
+  // The rails of all boards, and per board for the rail gating
+  needVoltage |= currentNeedVoltage;
+  busVoltageNeed[bus_address] = currentNeedVoltage;
 }
 
 /**
@@ -1125,80 +1307,112 @@ void setSensorCalibToInterface(uint8_t bus_address, uint8_t index, float calib)
 
 /**
  * @brief Sets the required voltage for sensors.
+ *        The rails of all boards are switched, whatever state poweredRails assumes.
  * @param enable True to enable the voltage, false to disable.
  */
 void setRequiredVoltage(bool enable)
 {
-  int64_t getVoltage = needVoltage;
-
   if (enable)
   {
-    switch (getVoltage)
+    poweredRails &= ~needVoltage;
+    setPoweredRails(needVoltage);
+  }
+  else
+  {
+    poweredRails |= needVoltage;
+    setPoweredRails(0);
+  }
+}
+
+/**
+ * @brief Returns the rails the dry detection sensor, the autonomous sensors and the sensors in sensorMask need.
+ *        The dry detection sensor is read in every wake-up of a deployment, the autonomous sensors sample in between.
+ */
+static uint8_t railsOfSensors(uint32_t sensorMask)
+{
+  uint8_t rails = busVoltageNeed[dryDetectionSensorBusAddress];
+  sensorMask |= autonomousSensorMask;
+  for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
+  {
+    if (((sensorMask >> sensorNumber) & 1u) && !isSensorErrorSkipped(sensorNumber))
     {
-    case 0:
-      break;
-    case 1:
-      Serial.println("enable 5V");
-      enable5V();
-      break;
-    case 2:
-      Serial.println("enable 12V");
-      enable12V();
-      break;
-    case 3:
-      Serial.println("enable 5V | 12V");
-      enable5V();
-      enable12V();
-      break;
-    default:
-      Serial.print("enable setVoltage Unbekannter Sensor: ");
-      break;
+      rails |= busVoltageNeed[configRTC.sensor[sensorNumber].bus_address];
     }
   }
-  else
+  return rails;
+}
+
+/**
+ * @brief Switches on the rails of the sensors that are measured next.
+ *        The boards on a rail that was off are woken up again and get their wake-up time.
+ * @param sensorMask Bit n set = sensor n is measured, e.g. dueSensorMask (see collectDueSensors).
+ */
+void powerRailsForSensors(uint32_t sensorMask)
+{
+  if (!railGatingEnable)
+  {
+    return;
+  }
+
+  uint8_t switchOn = railsOfSensors(sensorMask) & ~poweredRails;
+  if (switchOn == 0)
   {
-    switch (getVoltage)
+    return;
+  }
+  setPoweredRails(poweredRails | switchOn);
+
+  uint16_t wakeupTime = 0;
+  for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
+  {
+    uint8_t busAddress = configRTC.sensor[sensorNumber].bus_address;
+    if (busVoltageNeed[busAddress] & switchOn)
     {
-    case 0:
-      Serial.println("disabl 3.3V");
-      break;
-    case 1:
-      Serial.println("disabl 5V");
-      disable5V();
-      break;
-    case 2:
-      Serial.println("disabl 12V");
-      disable12V();
-      break;
-    case 3:
-      Serial.println("disabl 5V | 12V");
-      disable5V();
-      disable12V();
-      break;
-    default:
-      Serial.print("disable setVoltage Unbekannter Sensor: ");
-      break;
+      Logger.sensorWakeup(busAddress);
+      wakeupTime = max(wakeupTime, busSensorWakeupTime[busAddress]);
+    }
+  }
+  delayAtLowClock(wakeupTime);
+}
+
+/**
+ * @brief Switches off the rails that no sensor needs within railGatingMinOffSec.
+ *        Shorter off times do not pay for the switching and the wake-up time of the boards.
+ */
+void releaseIdleRails()
+{
+  if (!railGatingEnable || poweredRails == 0)
+  {
+    return;
+  }
+
+  uint32_t nowMs = getMonotonicMs();
+  uint32_t neededSoonMask = 0;
+  for (int k = 0; k < sensorSchedule.count; k++)
+  {
+    const TickEvent &event = sensorSchedule.heap[k];
+    if ((int32_t)(event.dueMs - nowMs) < (int32_t)(railGatingMinOffSec * 1000))
+    {
+      neededSoonMask |= 1u << event.id;
     }
   }
+  setPoweredRails(poweredRails & railsOfSensors(neededSoonMask));
 }
 
 /**
  * @brief Updates sampling intervals based on cast status.
+ *        Outside of casts the interval of a sensor with adaptive sampling is lengthened by its level.
  * @param useFastSampling True to use fast sampling, false otherwise.
  */
 void updateSamplingIntervals(bool useFastSampling)
 {
+  isFastSampling = useFastSampling;
+  bool useAdaptiveLevel = !useFastSampling && !wetDryIsPending(wetDryDetector);
   for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
   {
-    if (useFastSampling)
-    {
-      intervalSensorArray[sensorNumber] = configRTC.sample_cast_periode *
-                                          configRTC.sensor[sensorNumber].sample_cast_periode_multiplier;
-    }
-    else
+    intervalSensorArray[sensorNumber] = configuredSamplingInterval(sensorNumber, useFastSampling);
+    if (useAdaptiveLevel && configRTC.sensor[sensorNumber].adaptive_deadband > 0)
     {
-      intervalSensorArray[sensorNumber] = configRTC.sample_periode *
-                                          configRTC.sensor[sensorNumber].sample_periode_multiplier;
+      intervalSensorArray[sensorNumber] *= 1 << sensorAdaptiveState[sensorNumber].level;
     }
   }
 }
@@ -1220,10 +1434,12 @@ void updateWetSensorInterval()
 
 /**
  * @brief Checks for dry condition.
- * @return bool True if dry condition is met, false otherwise.
+ *        A dry reading is confirmed by further readings before the deployment ends (see wetDryUpdate).
+ * @return bool True while the logger counts as underwater, false once the dry condition is confirmed.
  */
 bool checkDryCondition()
 {
+  CpuClockLevel previousClock = setCpuClockLevel(CPU_CLOCK_LOW);
   for (int i = 0; i < 100; i++)
   {
     Logger.getInterfaceRDY(dryDetectionSensorBusAddress);
@@ -1234,6 +1450,7 @@ bool checkDryCondition()
     }
     delay(10); // interfaceRDY
   }
+  setCpuClockLevel(previousClock);
 
   Logger.Measure(dryDetectionSensorBusAddress, dryDetSensorParameterNo);
   uint32_t rawValue = AdapterSensorRawValue[dryDetectionSensorBusAddress];
@@ -1242,36 +1459,21 @@ bool checkDryCondition()
   Log(LogCategorySensors, LogLevelDEBUG, "drySensorValue: ", String(drySensorValue));
   Log(LogCategorySensors, LogLevelDEBUG, "configRTC.dry_det_threshold: ", String(configRTC.dry_det_threshold));
 
-  if (drySensorValue <= configRTC.dry_det_threshold)
+  if (updateWetDryDetection(drySensorValue) == WET_DRY_DRY_PENDING)
   {
-    if (thresholdValuewaterDetection && (detectionThresholdValue < configRTC.dry_det_verify_delay))
+    // Confirms the dry condition with the shortest interval
+    for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
     {
-      for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
+      if (configRTC.sensor[sensorNumber].sensor_id == configRTC.wet_det_sensor)
       {
-        if (configRTC.sensor[sensorNumber].sensor_id == configRTC.wet_det_sensor)
-        {
-          configRTC.sample_periode = 1;
-          intervalSensorArray[sensorNumber] = 1;
-        }
+        configRTC.sample_periode = 1;
+        intervalSensorArray[sensorNumber] = 1;
       }
-
-      updateWetSensorInterval();
-      ++detectionThresholdValue;
-      Log(LogCategorySensors, LogLevelDEBUG, "Over water counter: ", String(detectionThresholdValue));
-      return true;
-    }
-    else
-    {
-      detectionThresholdValue = 0;
-      thresholdValuewaterDetection = false;
-      return false;
     }
+
+    updateWetSensorInterval();
   }
-  else
-  {
-    detectionThresholdValue = 0;
-  }
-  return thresholdValuewaterDetection;
+  return wetDryIsWet(wetDryDetector);
 }
 
 /**
@@ -1286,17 +1488,21 @@ void interfaceWakeup()
       Logger.sensorWakeup(i);
     }
   }
-  delay(longestSensorWakeupTime);
+  delayAtLowClock(longestSensorWakeupTime);
 }
 
 /**
  * @brief Puts the sensor interface to sleep.
+ *        Boards that sample on their own stay awake until stopAutonomousSampling.
  */
 void interfaceSleep()
 {
-  for (int i = 0; i < 33; i++)
+  for (int i = 0; i < BUS_ADDRESS_COUNT; i++)
   {
-    Logger.sensorSleep(i);
+    if (!isAutonomousBusAddress(i))
+    {
+      Logger.sensorSleep(i);
+    }
   }
 }
 
@@ -1306,85 +1512,92 @@ void interfaceSleep()
 void initiateUnderwaterMode()
 {
   setRequiredVoltage(true);
-  createOrClearSampleFile();
+  endSampleStaging(); // Samples left from an interrupted deployment keep their deployment_id
+  resetCastDetection();
+  writeProfileSummary(); // Summary left from an interrupted deployment
+  for (int i = 0; i < MAX_SENSOR_CREDENTIALS; i++)
+  {
+    qcReset(sensorQcState[i]);
+    adaptiveReset(sensorAdaptiveState[i]);
+  }
+  resetProfileSummary(numberOfActiveSensors);
   writeDeploymentIdToFile();
   createConfigHeader();
 
-  if (!isLoggerSubmerged)
+  if (!rtcStatus.isLoggerSubmerged)
   {
     Log(LogCategoryMeasurement, LogLevelINFO, "Underwater measurement begin");
   }
 
   totalMeasurementCount = 0;
-  isLoggerSubmerged = true;
+  rtcStatus.isLoggerSubmerged = true;
   Logger.sensorWakeupAll();
+  startAutonomousSampling();
   espDeepSleepSec(0);
 }
 
 /**
  * @brief Checks if water is detected.
+ *        Above water, a wet reading only starts the deployment after it is confirmed (see wetDryUpdate).
  * @return bool True if water is detected, false otherwise.
  */
 bool isWaterDetected()
 {
-  if (thresholdValuewaterDetection)
+  if (wetDryIsWet(wetDryDetector))
   {
     configRTC.sample_periode = saveSamplePeriodeToResetAfterUnderwaterMeasurementsEnd;
     return true;
   }
 
-  if (!thresholdValuewaterDetection)
+  if (isWetDryMeasured)
   {
-    Logger.sensorWakeupDetection(waterDetectionSensorBusAddress);
-    Logger.startConversion(waterDetectionSensorBusAddress);
+    return false; // One reading per wake-up, so the confirmation readings are spread over time
+  }
 
-    uint64_t start_time = esp_timer_get_time() / 1000; // Startzeit in Millisekunden
-    while ((esp_timer_get_time() / 1000 - start_time) < 2000)
-    // for (int i = 0; i < 100; i++)
-    {
-      Logger.getInterfaceRDY(waterDetectionSensorBusAddress);
-      uint32_t interfaceRDY = AdapterSensorRawValue[waterDetectionSensorBusAddress];
-      if (interfaceRDY == 1)
-      {
-        interfaceRdyErrorCounter = 0;
-        interfaceErrorSensorId = 0;
-        Log(LogCategorySensors, LogLevelDEBUG, "wet_det_threshold interfaceRDY == OK");
-        break;
-      }
+  Logger.sensorWakeupDetection(waterDetectionSensorBusAddress);
+  Logger.startConversion(waterDetectionSensorBusAddress);
 
-      if (interfaceRDY == 2)
-      {
-        Log(LogCategorySensors, LogLevelDEBUG, "wet_det_threshold interfaceRDY == 2");
-        Logger.interfaceSoftwareReset(waterDetectionSensorBusAddress);
-        interfaceRdyErrorCounter++;
-        sensorCalibToInterfaceIfRdyErrorCounter = 4;
-        espDeepSleepSec(0);
-        // break;
-      }
+  uint64_t start_time = esp_timer_get_time() / 1000; // Startzeit in Millisekunden
+  CpuClockLevel previousClock = setCpuClockLevel(CPU_CLOCK_LOW);
+  while ((esp_timer_get_time() / 1000 - start_time) < 2000)
+  // for (int i = 0; i < 100; i++)
+  {
+    Logger.getInterfaceRDY(waterDetectionSensorBusAddress);
+    uint32_t interfaceRDY = AdapterSensorRawValue[waterDetectionSensorBusAddress];
+    if (interfaceRDY == 1)
+    {
+      interfaceRdyErrorCounter = 0;
+      interfaceErrorSensorId = 0;
+      Log(LogCategorySensors, LogLevelDEBUG, "wet_det_threshold interfaceRDY == OK");
+      break;
+    }
 
-      delay(10); // interfaceRDY
+    if (interfaceRDY == 2)
+    {
+      Log(LogCategorySensors, LogLevelDEBUG, "wet_det_threshold interfaceRDY == 2");
+      Logger.interfaceSoftwareReset(waterDetectionSensorBusAddress);
+      interfaceRdyErrorCounter++;
+      sensorCalibToInterfaceIfRdyErrorCounter = 4;
+      espDeepSleepSec(0);
+      // break;
     }
 
-    Logger.Measure(waterDetectionSensorBusAddress, wetDetSensorParameterNo);
-    uint32_t rawValue = AdapterSensorRawValue[waterDetectionSensorBusAddress];
-    float wetSensorValue = floatingPointConvert(rawValue);
+    delay(10); // interfaceRDY
+  }
+  setCpuClockLevel(previousClock);
 
-    Log(LogCategorySensors, LogLevelDEBUG, "wetSensorValue: ", String(wetSensorValue));
-    Log(LogCategorySensors, LogLevelDEBUG, "configRTC.wet_det_threshold: ", String(configRTC.wet_det_threshold));
+  Logger.Measure(waterDetectionSensorBusAddress, wetDetSensorParameterNo);
+  uint32_t rawValue = AdapterSensorRawValue[waterDetectionSensorBusAddress];
+  float wetSensorValue = floatingPointConvert(rawValue);
 
-    if (wetSensorValue >= configRTC.wet_det_threshold)
-    {
-      configRTC.sample_periode = saveSamplePeriodeToResetAfterUnderwaterMeasurementsEnd;
-      detectionThresholdValue = 0;
-      thresholdValuewaterDetection = true;
-      initiateUnderwaterMode();
-      return true;
-    }
-    else
-    {
-      interfaceSleep();
-      return false;
-    }
+  Log(LogCategorySensors, LogLevelDEBUG, "wetSensorValue: ", String(wetSensorValue));
+  Log(LogCategorySensors, LogLevelDEBUG, "configRTC.wet_det_threshold: ", String(configRTC.wet_det_threshold));
+
+  if (updateWetDryDetection(wetSensorValue) == WET_DRY_WET)
+  {
+    configRTC.sample_periode = saveSamplePeriodeToResetAfterUnderwaterMeasurementsEnd;
+    initiateUnderwaterMode();
+    return true;
   }
   else
   {
@@ -1398,12 +1611,15 @@ bool isWaterDetected()
  */
 void terminateUnderwaterMode()
 {
+  stopAutonomousSampling();
   interfaceSleep();
+  endSampleStaging();
+  writeProfileSummary();
   moveMeasurementAndData();
   bootAttemptCount = 0;
-  totalOperationTime = 0;
-  memset(lastSensorMeasurementTime, 0, sizeof(lastSensorMeasurementTime));
-  isLoggerSubmerged = false;
+  tickSchedulerClear(sensorSchedule);
+  rtcStatus.isLoggerSubmerged = false;
+  isNtpSyncRequested = true; // The next deployment starts with a synchronized RTC
   setRequiredVoltage(false);
   configRTC.sample_periode = saveSamplePeriodeToResetAfterUnderwaterMeasurementsEnd;
   Log(LogCategoryMeasurement, LogLevelINFO, "Underwater measurement end: ",
@@ -1430,13 +1646,16 @@ void checkWetSensorThreshold()
       sensorCalibToInterfaceIfRdyErrorCounter--;
       Log(LogCategorySensors, LogLevelDEBUG, "sensorCalibToInterfaceIfRdyErrorCounter ", String(sensorCalibToInterfaceIfRdyErrorCounter));
     }
-    if (isWaterDetected())
+    EnergyPhase previous = enterEnergyPhase(ENERGY_PHASE_WET_DETECTION);
+    bool isWet = isWaterDetected();
+    leaveEnergyPhase(previous);
+    if (isWet)
     {
       performUnderWaterOperations();
     }
     else
     {
-      if (isLoggerSubmerged)
+      if (rtcStatus.isLoggerSubmerged)
       {
         terminateUnderwaterMode();
       }
@@ -1444,29 +1663,31 @@ void checkWetSensorThreshold()
   }
 }
 
-std::atomic<bool> ledOff(false);
-std::atomic<bool> ledMeasurementsOff(false);
-
 /**
  * @brief Performs underwater operations.
  */
 void performUnderWaterOperations()
 {
+  enterEnergyPhase(ENERGY_PHASE_SAMPLING); // Ends with the deep sleep
   totalMeasurementCount++;
+  collectDueSensors();
+  powerRailsForSensors(dueSensorMask);
   startConversionformUnderWaterOperations();
   startLEDBlinkTaskForInitialMeasurements();
   checkDryCondition();
-  updateSamplingIntervals(configRTC.sample_cast_enable && performSampleCast());
+  bool isCast = configRTC.sample_cast_enable && performSampleCast();
+  updateSamplingIntervals(isCast);
   updateSensorMeasurements();
   writeMeasurementDataToFile();
   Log(LogCategorySensors, LogLevelDEBUG, "Remaining time for the cycle writeMeasurementDataToFile: ", String(millis()));
-  while (1) // waits until the LED-ON time has elapsed
+  CpuClockLevel previousClock = setCpuClockLevel(CPU_CLOCK_LOW);
+  waitForLEDBlinkTaskCompletion(); // waits until the LED-ON time has elapsed
+  setCpuClockLevel(previousClock);
+  if (isCast && isCastMovementDetected())
   {
-    if (ledOff.load() || ledMeasurementsOff.load())
-    {
-      enterDeepSleepAfterMeasurement();
-    }
+    runCastProfiling(); // Samples at a high rate in light sleep until the vertical movement ends
   }
+  enterDeepSleepAfterMeasurement();
 }
 
 /**
@@ -1480,6 +1701,7 @@ void sensorAvailability()
     {
       Logger.getSensorWakeupTime(configRTC.sensor[i].bus_address);
       uint16_t sensorWakeupTime = AdapterSensorRawValue[configRTC.sensor[i].bus_address];
+      busSensorWakeupTime[configRTC.sensor[i].bus_address] = sensorWakeupTime;
       if (sensorWakeupTime > longestSensorWakeupTime)
       {
         longestSensorWakeupTime = sensorWakeupTime;
@@ -1500,7 +1722,7 @@ void sensorAvailability()
     performInitialMeasurement();
   }
 
-  if (hasSensorError && isFirstBoot)
+  if (hasSensorError && rtcStatus.isFirstBoot)
   {
     generalAlarmLed();
   }
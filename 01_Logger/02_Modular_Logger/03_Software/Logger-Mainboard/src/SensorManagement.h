@@ -12,6 +12,14 @@
 #ifndef ALLEFUNKTIONEN_H
 #define ALLEFUNKTIONEN_H
 
+#include "loggerConfig.h"
+
+// Values of the latest measurement per sensor
+
+extern bool measurementSuccessful[MAX_SENSOR_CREDENTIALS];
+extern float sensorValue[MAX_SENSOR_CREDENTIALS];
+extern float sensorValueRaw[MAX_SENSOR_CREDENTIALS];
+
 // Initialization
 
 void initializeLogger();
@@ -19,6 +27,7 @@ void initializeLogger();
 // Water detection
 
 bool checkWetSensorStatus();
+bool isWetDetectionPending();
 
 // Sensor configuration and detection
 
@@ -31,19 +40,30 @@ void detectConnecteOxygenSensor(uint8_t sensorNumber);
 void updateSensorMeasurements();
 void performSensorMeasurement(int sensorNumber);
 void performInitialMeasurement();
+void startAutonomousSampling();              // Interface boards with autonomous_sample_periode_ms sample between the wake-ups
+void drainAutonomousSamples(int sensorNumber); // Writes the samples of an autonomous board with their time
+void stopAutonomousSampling();
 
 // Energy management
 
-void setRequiredVoltage(bool enable); // Activates or deactivates the required voltage for sensors
+#define RAIL_5V 0x01  // Bits of needVoltage, busVoltageNeed and poweredRails
+#define RAIL_12V 0x02
+
+void setRequiredVoltage(bool enable);           // Activates or deactivates the required voltage for sensors
+void powerRailsForSensors(uint32_t sensorMask); // Switches on the rails the sensors in sensorMask need
+void releaseIdleRails();                        // Switches off the rails that are not needed for railGatingMinOffSec
 
 // Data processing and storage
 
+void checkMeasurementQuality(uint8_t *qcFlags);
 void writeMeasurementDataToFile();
 void createConfigHeader();
 
 // Deep sleep and energy-saving mode
 
-float calculateShortestSensorWaitTime(); // Calculates the shortest waiting time until the next measurement
+void syncSensorSchedule();
+void collectDueSensors();                  // Determines the sensors that are measured in this wake-up
+uint32_t calculateShortestSensorWaitTime(); // Calculates the shortest waiting time until the next measurement
 void enterDeepSleepAfterMeasurement();
 
 // Underwater and above water mode
@@ -63,6 +83,8 @@ void sensorCalibToInterface();
 
 // Error handling
 
+bool isSensorErrorSkipped(int sensorNumber);
+
 void sensorAvailability();
 
 #endif
\ No newline at end of file
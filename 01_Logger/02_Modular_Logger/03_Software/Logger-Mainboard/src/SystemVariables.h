@@ -13,13 +13,17 @@
 #define SYSTEMVARIABLES_H
 
 #include <Arduino.h>
-#include <atomic>
 
 #include "MQTTManager.h"
+#include "WifiNetwork.h"
+#include "adaptiveSampling.h"
+#include "cpuClock.h"
+#include "energyAccounting.h"
 #include "loggerConfig.h"
-
-extern std::atomic<bool> ledOff;
-extern std::atomic<bool> ledMeasurementsOff;
+#include "qualityControl.h"
+#include "rtcDrift.h"
+#include "tickScheduler.h"
+#include "wetDryDetection.h"
 
 // Configuration variables
 
@@ -27,13 +31,30 @@ inline float fwVersionLoggerMainboard = 0.82;
 inline int maxMeasurementCountForLed = 5;           // in count
 inline int sampleCastIntervals = 3;                 // in count
 inline int waitAfterUnderwaterMeasurementTime = 30; // in seconds
-
-// Variables for the periods
-
-inline uint32_t config_update_periode = configRTC.config_update_periode;         // configRTC.config_update_periode;
-inline uint32_t status_upload_periode = configRTC.status_upload_periode;         // configRTC.status_upload_periode;
-inline uint32_t wet_det_periode = configRTC.wet_det_periode;                     // configRTC.wet_det_periode;
-inline uint32_t data_upload_retry_periode = configRTC.data_upload_retry_periode; // configRTC.data_upload_retry_periode;
+inline int castProfilingIntervalMs = 250;           // in milliseconds (4 Hz)
+inline int castProfilingMaxDuration = 600;          // in seconds
+inline int sensorWakeAlignMs = 250;                 // in milliseconds
+inline uint32_t periodicTaskCoalesceSec = 60;       // in seconds
+inline uint16_t wetDetConfirmCount = 2;             // in count
+inline uint32_t wetDetConfirmInterval = 2;          // in seconds
+inline uint16_t wetDryPendingLimit = 5;             // in count, unconfirmed readings until a pending transition is rejected
+inline float wetDryHysteresis = 0.1;                // in fraction of the threshold
+inline float profileBinSize = 1.0;                  // in dbar
+inline uint8_t adaptiveSamplingMaxLevel = 3;        // in doublings of the sampling interval
+inline bool deltaEncodedSamples = false;            // Samples go delta encoded to measurement_delta.json
+inline uint16_t sampleCodecKeyframeInterval = 60;   // in samples
+inline bool energyMeasureCurrent = true;            // BMS current at the phase boundaries, otherwise the current model
+inline bool railGatingEnable = true;                // 5 V/12 V rails only on while sensors that need them are measured
+inline uint32_t railGatingMinOffSec = 30;           // in seconds
+inline CpuClockPolicy cpuClockPolicy = CPU_CLOCK_POLICY_PHASE;
+inline uint32_t cpuFrequencyLowMhz = 40;         // in MHz, while waiting (10, 20, 40 or 80)
+inline uint32_t cpuFrequencyBoostMhz = 240;      // in MHz, for hashing, encoding and upload (80, 160 or 240)
+inline bool uploadPipelineEnable = true;         // Measurement lines are read on core 0 while core 1 publishes
+inline bool wifiFastConnectEnable = true;        // Connect to the cached access point with the cached IP first
+inline uint32_t wifiFastConnectTimeoutMs = 1500; // in milliseconds
+inline uint32_t wifiLeaseMaxAgeSec = 3600;       // in seconds, an older lease is renewed by DHCP
+inline float ntpDriftBudgetSec = 1.0;            // in seconds, predicted RTC error that makes NTP due
+inline uint32_t ntpSyncTimeoutMs = 3000;         // in milliseconds
 
 // General variables
 
@@ -47,7 +68,10 @@ inline RTC_DATA_ATTR int SensorArraySize = 0;
 
 // Sensor-specific variables
 
-inline RTC_DATA_ATTR uint8_t needVoltage = 0;
+inline RTC_DATA_ATTR uint8_t needVoltage = 0;                             // RAIL_5V | RAIL_12V of all boards
+inline RTC_DATA_ATTR uint8_t poweredRails = 0;                            // RAIL_5V | RAIL_12V that are switched on
+inline RTC_DATA_ATTR uint8_t busVoltageNeed[BUS_ADDRESS_COUNT];      // Per bus address: RAIL_5V | RAIL_12V
+inline RTC_DATA_ATTR uint16_t busSensorWakeupTime[BUS_ADDRESS_COUNT]; // Per bus address: wake-up time in ms
 inline RTC_DATA_ATTR uint8_t temperatureSensorBusAddress = 255;
 inline RTC_DATA_ATTR uint8_t temperatureSensorParameter = 255;
 inline RTC_DATA_ATTR uint8_t oxygenSensorBusAddress = 255;
@@ -58,45 +82,47 @@ inline RTC_DATA_ATTR uint8_t dryDetSensorParameterNo = 0;
 inline RTC_DATA_ATTR uint8_t castDetSensorParameterNo = 0;
 inline RTC_DATA_ATTR uint8_t wetDetSensorParameterNo = 0;
 inline RTC_DATA_ATTR uint32_t saveSamplePeriodeToResetAfterUnderwaterMeasurementsEnd = 0;
-inline RTC_DATA_ATTR uint8_t errorSkipSensor[32] = {};
-inline RTC_DATA_ATTR uint8_t errorSkipSensorSize = 0;
+inline RTC_DATA_ATTR uint32_t errorSkipSensorMask = 0; // Bit n set = sensor n is skipped
+static_assert(MAX_SENSOR_CREDENTIALS <= 32, "errorSkipSensorMask holds one bit per sensor");
+inline RTC_DATA_ATTR uint32_t autonomousSensorMask = 0; // Bit n set = the interface board of sensor n samples on its own
+inline RTC_DATA_ATTR uint32_t autonomousSampleTime[MAX_SENSOR_CREDENTIALS]; // Per sensor: Unix time of the last drained sample
 
 // Time-related variables
 
-inline RTC_DATA_ATTR uint32_t totalElapsedTime = 0;
-inline RTC_DATA_ATTR uint32_t lastConfigUpdateTime = 0;       // configRTC.config_update_periode;
-inline RTC_DATA_ATTR uint32_t lastStatusUploadTime = 0;       // configRTC.status_upload_periode;
-inline RTC_DATA_ATTR uint32_t lastWetDetectionUploadTime = 0; // configRTC.wet_det_periode;
-inline RTC_DATA_ATTR uint32_t lastDataUploadRetryTime = 0;    // data_upload_retry_periode
-inline RTC_DATA_ATTR time_t currentTimeNow = 0;
 inline RTC_DATA_ATTR time_t waitAfterUnderwaterMeasurementTimeNow = 0;
 inline uint8_t mqttErrorCounter = 0;
 inline RTC_DATA_ATTR uint8_t currentIncorrectNumberOfsensors = 0;
 
 // Status information
 
-inline RTC_DATA_ATTR bool isFirstBoot = false;
-inline RTC_DATA_ATTR bool isLoggerSubmerged = false;
-inline RTC_DATA_ATTR bool hasStatusUploadError = false;
-inline RTC_DATA_ATTR bool hasTransmissionUpdateError = false;
-inline RTC_DATA_ATTR bool hasMqttHeaderError = false;
-inline RTC_DATA_ATTR bool hasMqttLogError = false;
-inline RTC_DATA_ATTR bool hasMqttMeasurementError = false;
-inline RTC_DATA_ATTR bool isDataUploadRetryEnabled = false;
+// Status flags kept over deep sleep, packed into one word of the RTC memory
+typedef struct
+{
+  bool isFirstBoot : 1;
+  bool isLoggerSubmerged : 1;
+  bool hasStatusUploadError : 1;
+  bool hasTransmissionUpdateError : 1;
+  bool hasMqttHeaderError : 1;
+  bool hasMqttLogError : 1;
+  bool hasMqttMeasurementError : 1;
+  bool isDataUploadRetryEnabled : 1;
+  bool chargingStatus : 1;
+  bool batteryCompletlyCharged : 1;
+  bool wificonfigRtc : 1;
+  bool batteryEmpty : 1;
+} RtcStatusFlags;
+
+inline RTC_DATA_ATTR RtcStatusFlags rtcStatus = {};
+
 inline bool isNodeRedAvailable = false;
 inline bool isNodeRedLogin = false;
 inline bool isFirmwareUpdate = false;
 inline bool isfirstBootLed = false;
-inline RTC_DATA_ATTR bool chargingStatus = false;
-inline RTC_DATA_ATTR bool batteryCompletlyCharged = false;
-inline RTC_DATA_ATTR bool wificonfigRtc = false;
-inline RTC_DATA_ATTR bool batteryEmpty = false;
 inline bool interfaceError = false;
 
 // Counter variables
 
 inline RTC_DATA_ATTR int bootAttemptCount = 0;
-inline RTC_DATA_ATTR int detectionThresholdValue = 0;
 inline RTC_DATA_ATTR int numberOfActiveSensors = 0;
 inline RTC_DATA_ATTR int boot = 0;
 inline RTC_DATA_ATTR int configurationBootCount = 0;
@@ -107,18 +133,38 @@ inline RTC_DATA_ATTR uint8_t interfaceRdyErrorCounter = 0;
 inline RTC_DATA_ATTR uint8_t sensorCalibToInterfaceIfRdyErrorCounter = 0;
 inline RTC_DATA_ATTR uint8_t bmsErrorCounter = 0;
 
+// Wet/dry detection variables
+
+inline RTC_DATA_ATTR WetDryDetector wetDryDetector = {}; // Filter history, state and rejected transitions
+inline bool isWetDryMeasured = false;                    // The detector got a reading in this wake-up
+
 // Measurement data variables
 
-inline RTC_DATA_ATTR float totalOperationTime = 0;
-inline RTC_DATA_ATTR float lastSensorMeasurementTime[MAX_SENSOR_CREDENTIALS] = {};
+inline RTC_DATA_ATTR TickScheduler sensorSchedule = {}; // Next measurement per sensor, id = sensor number
+inline uint32_t dueSensorMask = 0;                      // Bit n set = sensor n is measured in this wake-up
+static_assert(MAX_SENSOR_CREDENTIALS <= TICK_SCHEDULER_CAPACITY, "sensorSchedule holds one event per sensor");
 inline RTC_DATA_ATTR float intervalSensorArray[MAX_SENSOR_CREDENTIALS];
-inline RTC_DATA_ATTR bool thresholdValuewaterDetection = false;
+inline RTC_DATA_ATTR QcState sensorQcState[MAX_SENSOR_CREDENTIALS]; // Quality control state per sensor
+inline RTC_DATA_ATTR AdaptiveState sensorAdaptiveState[MAX_SENSOR_CREDENTIALS]; // Adaptive sampling state per sensor
 inline RTC_DATA_ATTR uint32_t deployment_id = 0;
 inline RTC_DATA_ATTR uint32_t interfaceErrorSensorId = 0;
 
+// WiFi variables
+
+inline RTC_DATA_ATTR WifiFastConnectCache wifiFastConnectCache = {{0}, 0, -1, 0, 0, 0, 0, 0}; // Last access point and IP lease, network -1 = empty
+inline RTC_DATA_ATTR WifiConnectStats wifiConnectStats = {};                                  // Time-to-connect histogram
+
+// RTC drift variables
+
+inline RTC_DATA_ATTR RtcDriftModel rtcDriftModel = {}; // Drift of the DS3231 since the last NTP synchronisation
+inline RTC_DATA_ATTR bool isNtpSyncRequested = true;  // Synchronize at the next connection regardless of the drift
+
+// Energy accounting variables
+
+inline RTC_DATA_ATTR EnergyTotals energyTotals = {}; // Charge and time per phase since energyTotals.sinceTime
+
 // File processing variables
 
 inline RTC_DATA_ATTR long totalMeasurementLines = 0;
-inline RTC_DATA_ATTR bool countTotalMeasurementLines = true;
 
 #endif
\ No newline at end of file
@@ -18,7 +18,7 @@
 #include "DS3231TimeNtp.h"
 #include "DebuggingSDLog.h"
 #include "DeepSleep.h"
-#include "LED.h"
+#include "Led.h"
 #include "MQTTManager.h"
 #include "SDCard.h"
 #include "SensorManagement.h"
@@ -26,6 +26,7 @@
 #include "Utility.h"
 #include "WifiNetwork.h"
 #include "firmwareUpdate.h"
+#include "loggerConfigSnapshot.h"
 #include "loggerConfigValidation.h"
 
 int loggerIdUpdate = 0;
@@ -318,11 +319,13 @@ void createRequiredFolders()
       "/backup/log",
       "/backup/header",
       "/backup/measurements",
+      "/backup/summary",
       "/loggerConfig",
       "/log",
       "/measurements",
       "/measurements/mqtt_header",
       "/measurements/mqtt_measurements",
+      "/measurements/mqtt_summary",
       "/updateConfig",
       "/updateFW"};
   const int numFolders = sizeof(folders) / sizeof(folders[0]);
@@ -444,7 +447,7 @@ void interfaceRST()
  */
 void performFirstBootOperations()
 {
-  if (!isFirstBoot)
+  if (!rtcStatus.isFirstBoot)
   {
     createRequiredFolders();
     interfaceSleep();
@@ -457,12 +460,11 @@ void performFirstBootOperations()
     Log(LogCategoryGeneral, LogLevelINFO, "-------------------Start System initialization-------------------");
     Log(LogCategoryGeneral, LogLevelINFO, "Logger-Mainboard: FWVersion: ", String(fwVersionLoggerMainboard));
     sensorAvailability();
-    statusUploadPeriodeFunktion(0);
-    configUpdatePeriodeFunktion(0);
+    statusUploadPeriodeFunktion();
+    configUpdatePeriodeFunktion();
     isfirstBootLed = false;
     handleNtpSynchronization();
-    currentTimeNow = getCurrentTimeFromRTC();
-    isFirstBoot = true;
+    rtcStatus.isFirstBoot = true;
     Log(LogCategoryGeneral, LogLevelINFO, "---------------------End System initialization-------------------");
     espDeepSleepSec(0);
   }
@@ -638,18 +640,18 @@ void performPeriodicConfigUpdate()
   Log(LogCategoryConfiguration, LogLevelDEBUG, "current ConfigFile: ", String(findLatestConfigurationFile("/loggerConfig").c_str()));
   transmitUpdateMessage(findLatestConfigurationFile("/loggerConfig").c_str(), "hyfive/updateConfigRequest");
 
-  if (!hasTransmissionUpdateError)
+  if (!rtcStatus.hasTransmissionUpdateError)
   {
     updateConfigViaMqtt();
   }
 
-  if (!hasTransmissionUpdateError)
+  if (!rtcStatus.hasTransmissionUpdateError)
   {
     findLatestConfigFileUpdateConfig = findLatestConfigurationFile("/updateConfig");
 
     if (checkLatestConfigFileExists() && !errorInloggerIdOrTimestamp())
     {
-      if (JsonFileReadValidation("/updateConfig/" + findLatestConfigFileUpdateConfig))
+      if (JsonFileRead("/updateConfig/" + findLatestConfigFileUpdateConfig))
       {
         validateBasicConfiguration();
         validateWifiConfiguration();
@@ -672,18 +674,20 @@ void performPeriodicConfigUpdate()
       {
         Log(LogCategoryConfiguration, LogLevelINFO, "update successfull: ", String(findLatestConfigFileUpdateConfig));
         transmitUpdateMessage(("update successfull: " + findLatestConfigFileUpdateConfig).c_str(), "hyfive/updateConfigRequest");
-        if (!hasTransmissionUpdateError)
+        if (!rtcStatus.hasTransmissionUpdateError)
         {
           deleteAllFilesInFolder("/loggerConfig");
           moveFileToDestination("/updateConfig", (findLatestConfigurationFile("/updateConfig")).c_str(), "/loggerConfig");
           copyFileToDestination("/loggerConfig/", (findLatestConfigurationFile("/loggerConfig")).c_str(), "/backup/config");
+          invalidateConfigSnapshot();
+          clearWifiFastConnectCache(); // The cached network index may point to another access point in the new configuration
           ESP.restart();
         }
       }
       else
       {
         transmitUpdateMessage(("Error in: " + findLatestConfigFileUpdateConfig + " - " + "logger_id now: " + configRTC.logger_id + " | " + "logger_id update: " + logger_idValidation).c_str(), "hyfive/ConfigError");
-        if (!hasTransmissionUpdateError)
+        if (!rtcStatus.hasTransmissionUpdateError)
         {
           moveFileToDestination("/updateConfig", (findLatestConfigurationFile("/updateConfig")).c_str(), "/backup/config_error");
         }
@@ -747,44 +751,6 @@ int64_t sdCardSpaceUsed()
   return SD.usedBytes();
 }
 
-/**
- * @brief Calculates the shortest wait time until the next function execution.
- * @param totalElapsedTime Total elapsed time.
- * @param lastConfigUpdateTime Last configuration update time.
- * @param lastStatusUploadTime Last status upload time.
- * @param lastWetDetectionUploadTime Last wet detection upload time.
- * @param lastDataUploadRetryTime Last data upload retry time.
- * @param isDataUploadRetryEnabled Flag indicating if data upload retry is enabled.
- * @param config_update_periode Configuration update period.
- * @param status_upload_periode Status upload period.
- * @param wet_det_periode Wet detection period.
- * @param data_upload_retry_periode Data upload retry period.
- * @return uint32_t The shortest wait time in seconds.
- */
-uint32_t calculateShortestWaitTime(uint32_t totalElapsedTime, uint32_t lastConfigUpdateTime, uint32_t lastStatusUploadTime, uint32_t lastWetDetectionUploadTime, uint32_t lastDataUploadRetryTime, bool isDataUploadRetryEnabled, uint32_t config_update_periode, uint32_t status_upload_periode, uint32_t wet_det_periode, uint32_t data_upload_retry_periode)
-{
-  uint32_t shortestWaitTimePeriode = ULONG_MAX;
-  uint32_t intervalPeriodeArray[4] = {config_update_periode, status_upload_periode, wet_det_periode, ULONG_MAX};
-  uint32_t lastMeasurePeriode[4] = {lastConfigUpdateTime, lastStatusUploadTime, lastWetDetectionUploadTime, lastDataUploadRetryTime};
-  int numberOfActiveSensorsCalc = 3;
-
-  if (isDataUploadRetryEnabled)
-  {
-    intervalPeriodeArray[3] = data_upload_retry_periode;
-    numberOfActiveSensorsCalc = 4;
-  }
-
-  for (int i = 0; i < numberOfActiveSensorsCalc; i++)
-  {
-    uint32_t timeUntilNextMeasurement = intervalPeriodeArray[i] - (totalElapsedTime - lastMeasurePeriode[i]);
-    if (timeUntilNextMeasurement < shortestWaitTimePeriode)
-    {
-      shortestWaitTimePeriode = timeUntilNextMeasurement;
-    }
-  }
-  return shortestWaitTimePeriode;
-}
-
 bool askForConfigRequest = false;
 
 /**
@@ -795,7 +761,7 @@ bool askForConfigRequest = false;
  */
 void askForConfig()
 {
-  if (!isLoggerSubmerged)
+  if (!rtcStatus.isLoggerSubmerged)
   {
     if (digitalRead(17) == LOW)
     {
@@ -892,14 +858,14 @@ void connectionOfPowerSupplyBeginChargingOfBatteries()
 {
   pinMode(20, INPUT);
   int pin20Status = digitalRead(20);
-  if (pin20Status == LOW && (getRemainingBatteryPercentage() < 100) && !batteryCompletlyCharged)
+  if (pin20Status == LOW && (getRemainingBatteryPercentage() < 100) && !rtcStatus.batteryCompletlyCharged)
   {
     uint8_t wakeUpTime = 0;
 
-    if (!chargingStatus)
+    if (!rtcStatus.chargingStatus)
     {
-      batteryEmpty = false;
-      chargingStatus = true;
+      rtcStatus.batteryEmpty = false;
+      rtcStatus.chargingStatus = true;
       enable3V3();
     }
 
@@ -912,8 +878,8 @@ void connectionOfPowerSupplyBeginChargingOfBatteries()
   }
   if (pin20Status == HIGH)
   {
-    batteryCompletlyCharged = false;
-    chargingStatus = false;
+    rtcStatus.batteryCompletlyCharged = false;
+    rtcStatus.chargingStatus = false;
     disable3V();
   }
 }
@@ -930,13 +896,14 @@ void batteryRemainingLow(uint8_t batteryCharge)
   {
     if (getRemainingBatteryPercentage() == 0 || getTotalBatteryCellVoltage() < 11200)
     {
-      if (!batteryEmpty)
+      if (!rtcStatus.batteryEmpty)
       {
         Log(LogCategoryPowerManagement, LogLevelDEBUG, "batteryRemaining: ", String(getRemainingBatteryPercentage()), " %");
         Log(LogCategoryPowerManagement, LogLevelINFO, "Battery empty");
         enableExternalWakeup(20); // if Power supply connected = LOW
         enableExternalWakeup(17); // when reed switch is actuated
-        batteryEmpty = true;
+        rtcStatus.batteryEmpty = true;
+        enterEnergyPhase(ENERGY_PHASE_SLEEP);
         esp_deep_sleep_start();
       }
     }
@@ -964,28 +931,6 @@ void programBms()
   esp_deep_sleep_start();
 }
 
-/**
- * @brief Resets time period loop when total elapsed time exceeds the largest period.
- *
- * @param config_update_periode Configuration update period.
- * @param status_upload_periode Status upload period.
- * @param wet_det_periode Wet detection period.
- * @param data_upload_retry_periode Data upload retry period.
- */
-void resetTimePeriodeLoop(uint32_t config_update_periode, uint32_t status_upload_periode, uint32_t wet_det_periode, uint32_t data_upload_retry_periode)
-{
-  uint32_t largestNumber = max({config_update_periode, status_upload_periode, wet_det_periode, data_upload_retry_periode});
-
-  if (totalElapsedTime >= largestNumber)
-  {
-    totalElapsedTime = 0;
-    lastConfigUpdateTime = 0;
-    lastStatusUploadTime = 0;
-    lastWetDetectionUploadTime = 0;
-    lastDataUploadRetryTime = 0;
-  }
-}
-
 /**
  * @brief Checks if power supply is connected.
  * @return true if power supply is connected, false otherwise.
@@ -1021,21 +966,21 @@ void batteryCompletelyCharged()
       minTimeUntilNextFunction = wakeUpTime;
     }
 
-    if (batteryCompletlyCharged)
+    if (rtcStatus.batteryCompletlyCharged)
     {
       batteryCompletelyChargedLED();
     }
 
     Log(LogCategoryGeneral, LogLevelDEBUG, "batteryRemaining: ", String(getRemainingBatteryPercentage()), " %");
 
-    if (getRemainingBatteryPercentage() >= 100 && !batteryCompletlyCharged)
+    if (getRemainingBatteryPercentage() >= 100 && !rtcStatus.batteryCompletlyCharged)
     {
       disable3V();
       Log(LogCategoryPowerManagement, LogLevelINFO, "Battery completly charged");
-      batteryCompletlyCharged = true;
+      rtcStatus.batteryCompletlyCharged = true;
     }
 
-    if (!batteryCompletlyCharged && getRemainingBatteryPercentage() >= 90 && getCellCurrent())
+    if (!rtcStatus.batteryCompletlyCharged && getRemainingBatteryPercentage() >= 90 && getCellCurrent())
     {
       Log(LogCategoryPowerManagement, LogLevelDEBUG, "Battery completly charged > 100%");
       Log(LogCategoryGeneral, LogLevelDEBUG, "batteryRemaining: ", String(getRemainingBatteryPercentage()), " %");
@@ -1050,125 +995,103 @@ void batteryCompletelyCharged()
 }
 
 /**
- * @brief Handles configuration update period functionality.
- * @param config_update_periode Configuration update period.
+ * @brief Performs the periodic configuration update (periodic task, see periodicTasks.cpp).
  */
-void configUpdatePeriodeFunktion(uint32_t config_update_periode)
+void configUpdatePeriodeFunktion()
 {
-  if (((totalElapsedTime - lastConfigUpdateTime) >= config_update_periode) || hasTransmissionUpdateError || askForConfigRequest)
+  uint8_t errorCount = 0;
+  while (1)
   {
-    uint8_t errorCount = 0;
-    while (1)
+    Log(LogCategoryGeneral, LogLevelDEBUG, "config_update_periode");
+    if (checkWetSensorAndNodeRed())
     {
-      Log(LogCategoryGeneral, LogLevelDEBUG, "config_update_periode");
-      if (checkWetSensorAndNodeRed())
-      {
-        performPeriodicConfigUpdate();
-        getFirmwareUpdate();
+      performPeriodicConfigUpdate();
+      getFirmwareUpdate();
 
-        isDataUploadRetryEnabled = hasTransmissionUpdateError;
-      }
+      rtcStatus.isDataUploadRetryEnabled = rtcStatus.hasTransmissionUpdateError;
+    }
 
-      if (errorCount >= 10)
-      {
-        Log(LogCategoryMQTT, LogLevelERROR, "configUpdate could not be transmitted");
-        break;
-      }
+    if (errorCount >= 10)
+    {
+      Log(LogCategoryMQTT, LogLevelERROR, "configUpdate could not be transmitted");
+      break;
+    }
 
-      if (!hasTransmissionUpdateError)
-      {
-        break;
-      }
-      errorCount++;
+    if (!rtcStatus.hasTransmissionUpdateError)
+    {
+      break;
     }
-    lastConfigUpdateTime = totalElapsedTime;
+    errorCount++;
   }
 }
 
 /**
- * @brief Handles status upload period functionality.
- * @param status_upload_periode Status upload period.
+ * @brief Performs the periodic status upload (periodic task, see periodicTasks.cpp).
  */
-void statusUploadPeriodeFunktion(uint32_t status_upload_periode)
+void statusUploadPeriodeFunktion()
 {
-  if (((totalElapsedTime - lastStatusUploadTime) >= status_upload_periode) || hasStatusUploadError == true)
+  uint8_t errorCount = 0;
+  while (1)
   {
-    uint8_t errorCount = 0;
-    while (1)
+    Log(LogCategoryGeneral, LogLevelDEBUG, "status_upload_periode");
+    if (checkWetSensorAndNodeRed())
     {
-      Log(LogCategoryGeneral, LogLevelDEBUG, "status_upload_periode");
-      if (checkWetSensorAndNodeRed())
-      {
-        uploadStatus();
-        isDataUploadRetryEnabled = hasStatusUploadError;
-      }
+      EnergyPhase previous = enterEnergyPhase(ENERGY_PHASE_MQTT);
+      uploadStatus();
+      leaveEnergyPhase(previous);
+      rtcStatus.isDataUploadRetryEnabled = rtcStatus.hasStatusUploadError;
+    }
 
-      if (errorCount >= 10)
-      {
-        Log(LogCategoryMQTT, LogLevelERROR, "statusUpload could not be transmitted");
-        break;
-      }
+    if (errorCount >= 10)
+    {
+      Log(LogCategoryMQTT, LogLevelERROR, "statusUpload could not be transmitted");
+      break;
+    }
 
-      if (!hasStatusUploadError)
-      {
-        break;
-      }
-      errorCount++;
+    if (!rtcStatus.hasStatusUploadError)
+    {
+      break;
     }
-    lastStatusUploadTime = totalElapsedTime;
+    errorCount++;
   }
 }
 
 /**
- * @brief Handles wet detection period functionality.
- * @param wet_det_periode Wet detection period.
+ * @brief Performs the periodic wet detection (periodic task, see periodicTasks.cpp).
  */
-void wetDetPeriodeFunktion(uint32_t wet_det_periode)
+void wetDetPeriodeFunktion()
 {
-  if ((totalElapsedTime - lastWetDetectionUploadTime) >= wet_det_periode)
-  {
-    bootCounter++;
-    batteryRemainingLow(15); // Battery charge below 15% or 0%
-    checkWetSensorThreshold();
-    lastWetDetectionUploadTime = totalElapsedTime;
-  }
+  bootCounter++;
+  batteryRemainingLow(15); // Battery charge below 15% or 0%
+  checkWetSensorThreshold();
 }
 
 /**
- * @brief Handles data upload retry period functionality.
- * @param data_upload_retry_periode Data upload retry period.
+ * @brief Performs the data upload retry (periodic task, see periodicTasks.cpp).
+ *        The retry stays enabled while MQTT header or measurement errors are pending.
  */
-void dataUploadRetryPeriodeFunktion(uint32_t data_upload_retry_periode)
+void dataUploadRetryPeriodeFunktion()
 {
-  if ((isDataUploadRetryEnabled && (totalElapsedTime - lastDataUploadRetryTime) >= data_upload_retry_periode) || hasMqttHeaderError || hasMqttMeasurementError)
+  if (rtcStatus.hasTransmissionUpdateError)
   {
-    if (hasTransmissionUpdateError)
-    {
-      Log(LogCategoryGeneral, LogLevelERROR, "data_upload_retry_periode || timeConfigUpdatePeriode");
-    }
-
-    if (hasStatusUploadError)
-    {
-      Log(LogCategoryGeneral, LogLevelERROR, "data_upload_retry_periode || statusUpload");
-    }
-
-    if (hasMqttHeaderError)
-    {
-      Log(LogCategoryGeneral, LogLevelERROR, "data_upload_retry_periode || hasMqttHeaderError");
-      isDataUploadRetryEnabled = true;
-    }
+    Log(LogCategoryGeneral, LogLevelERROR, "data_upload_retry_periode || timeConfigUpdatePeriode");
+  }
 
-    if (hasMqttMeasurementError)
-    {
-      Log(LogCategoryGeneral, LogLevelERROR, "data_upload_retry_periode || hasMqttMeasurementError");
-      isDataUploadRetryEnabled = true;
-    }
+  if (rtcStatus.hasStatusUploadError)
+  {
+    Log(LogCategoryGeneral, LogLevelERROR, "data_upload_retry_periode || statusUpload");
+  }
 
-    lastDataUploadRetryTime = totalElapsedTime;
+  if (rtcStatus.hasMqttHeaderError)
+  {
+    Log(LogCategoryGeneral, LogLevelERROR, "data_upload_retry_periode || hasMqttHeaderError");
+    rtcStatus.isDataUploadRetryEnabled = true;
   }
-  else
+
+  if (rtcStatus.hasMqttMeasurementError)
   {
-    isDataUploadRetryEnabled = false;
+    Log(LogCategoryGeneral, LogLevelERROR, "data_upload_retry_periode || hasMqttMeasurementError");
+    rtcStatus.isDataUploadRetryEnabled = true;
   }
 }
 
@@ -1226,11 +1149,11 @@ bool checkWetSensorAndNodeRed()
  */
 void handleSensorError(uint16_t threshold)
 {
-  if (!chargingStatus)
+  if (!rtcStatus.chargingStatus)
   {
     if (bootCounter >= threshold)
     {
-      compareRtcWithJsonConfig();  //* RTC configuration comparison
+      compareRtcWithConfigSnapshot(); //* RTC configuration comparison
       performInitialMeasurement(); //* Sensor error detection
       bootCounter = 0;
     }
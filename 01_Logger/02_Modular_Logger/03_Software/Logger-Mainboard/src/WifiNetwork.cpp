@@ -11,9 +11,167 @@
 
 #include <WiFi.h>
 
+#include "DS3231TimeNtp.h"
 #include "DebuggingSDLog.h"
+#include "DeepSleep.h"
 #include "Led.h"
 #include "SystemVariables.h"
+#include "WifiNetwork.h"
+
+/**
+ * @brief Adds a time-to-connect to the histogram.
+ * @param durationMs Time from the first WiFi.begin to the connection.
+ * @param isFast True if the cache was used.
+ */
+static void recordConnectTime(uint32_t durationMs, bool isFast)
+{
+  static const uint32_t binLimitMs[WIFI_CONNECT_BINS - 1] = {250, 500, 1000, 2000, 4000};
+  uint8_t bin = 0;
+  while (bin < WIFI_CONNECT_BINS - 1 && durationMs >= binLimitMs[bin])
+  {
+    bin++;
+  }
+  wifiConnectStats.connectMs[bin]++;
+  if (isFast)
+  {
+    wifiConnectStats.fastConnects++;
+  }
+  else
+  {
+    wifiConnectStats.scanConnects++;
+  }
+}
+
+/**
+ * @brief Polls the connection state.
+ * @param timeoutMs Time to wait for the connection.
+ * @return true if connected within timeoutMs.
+ */
+static bool waitForConnection(uint32_t timeoutMs)
+{
+  uint32_t startMs = millis();
+  while (WiFi.status() != WL_CONNECTED)
+  {
+    if (millis() - startMs >= timeoutMs)
+    {
+      return false;
+    }
+    delay(50);
+  }
+  return true;
+}
+
+/**
+ * @brief Clears the cached access point and IP lease, the next connection scans and uses DHCP.
+ */
+void clearWifiFastConnectCache()
+{
+  wifiFastConnectCache.network = -1;
+}
+
+/**
+ * @brief Caches the access point and the DHCP lease of the current connection.
+ * @param network Index of the connected network in configRTC.wificonfig.
+ */
+static void storeWifiFastConnectCache(int network)
+{
+  uint8_t *bssid = WiFi.BSSID();
+  if (bssid == NULL)
+  {
+    clearWifiFastConnectCache();
+    return;
+  }
+  memcpy(wifiFastConnectCache.bssid, bssid, sizeof(wifiFastConnectCache.bssid));
+  wifiFastConnectCache.channel = WiFi.channel();
+  wifiFastConnectCache.localIp = (uint32_t)WiFi.localIP();
+  wifiFastConnectCache.gatewayIp = (uint32_t)WiFi.gatewayIP();
+  wifiFastConnectCache.subnetMask = (uint32_t)WiFi.subnetMask();
+  wifiFastConnectCache.dnsIp = (uint32_t)WiFi.dnsIP();
+  wifiFastConnectCache.leaseTime = getCurrentTimeFromRTC();
+  wifiFastConnectCache.network = network;
+}
+
+/**
+ * @brief Connects to the cached access point on its channel with the cached IP lease,
+ *        without scan and DHCP. On failure the cache is cleared and DHCP is enabled again.
+ * @return true if connected.
+ */
+static bool connectWithFastConnectCache()
+{
+  WifiFastConnectCache &cache = wifiFastConnectCache;
+  if (!wifiFastConnectEnable || cache.network < 0 || cache.network >= WifiArraySize || strlen(configRTC.wificonfig[cache.network].ssid) == 0)
+  {
+    return false;
+  }
+  if (getCurrentTimeFromRTC() - cache.leaseTime > wifiLeaseMaxAgeSec)
+  {
+    Log(LogCategoryWiFi, LogLevelDEBUG, "Cached IP lease expired, renewing by DHCP");
+    clearWifiFastConnectCache();
+    return false;
+  }
+
+  const char *ssid = configRTC.wificonfig[cache.network].ssid;
+  WiFi.config(IPAddress(cache.localIp), IPAddress(cache.gatewayIp), IPAddress(cache.subnetMask), IPAddress(cache.dnsIp));
+  WiFi.begin(ssid, configRTC.wificonfig[cache.network].pw, cache.channel, cache.bssid);
+  if (waitForConnection(wifiFastConnectTimeoutMs))
+  {
+    Log(LogCategoryWiFi, LogLevelDEBUG, "Fast connected to network: ", String(ssid), " channel ", String(cache.channel));
+    return true;
+  }
+
+  Log(LogCategoryWiFi, LogLevelDEBUG, "Fast connect failed for network: ", String(ssid));
+  WiFi.disconnect();
+  WiFi.config(IPAddress(), IPAddress(), IPAddress()); // Back to DHCP
+  clearWifiFastConnectCache();
+  return false;
+}
+
+/**
+ * @brief Tries the cached access point, then the stored networks one after the other,
+ *        and synchronizes the time with NTP if it is due.
+ * @return true if a network is connected, false otherwise.
+ */
+static bool connectToStoredNetworks()
+{
+  uint32_t startMs = millis();
+  if (connectWithFastConnectCache())
+  {
+    recordConnectTime(millis() - startMs, true);
+    hasWifiConnection = true;
+    synchronizeTimeIfDue();
+    return true;
+  }
+
+  // Search through all stored networks
+  for (int j = 0; j < WifiArraySize; ++j)
+  {
+    if (strlen(configRTC.wificonfig[j].ssid) > 0)
+    {
+      Log(LogCategoryWiFi, LogLevelDEBUG, "Trying to connect to network: ", String(configRTC.wificonfig[j].ssid));
+      for (int attempt = 0; attempt < 2; ++attempt)
+      {
+        WiFi.begin(configRTC.wificonfig[j].ssid, configRTC.wificonfig[j].pw);
+        if (waitForConnection(2000))
+        {
+          Log(LogCategoryWiFi, LogLevelDEBUG, "Connected to network: ", String(configRTC.wificonfig[j].ssid));
+          recordConnectTime(millis() - startMs, false);
+          storeWifiFastConnectCache(j);
+          hasWifiConnection = true;
+          synchronizeTimeIfDue();
+          return true;
+        }
+
+        Log(LogCategoryWiFi, LogLevelDEBUG, "Connection failed for network: ", String(configRTC.wificonfig[j].ssid));
+        hasWifiConnection = false;
+      }
+    }
+  }
+
+  Log(LogCategoryWiFi, LogLevelDEBUG, "No known network found");
+  wifiConnectStats.failures++;
+  hasWifiConnection = false;
+  return false;
+}
 
 /**
  * @brief Connects to Wi-Fi and synchronizes time with NTP.
@@ -31,12 +189,12 @@ bool connectToWifiAndSyncNTP()
   {
     Log(LogCategoryWiFi, LogLevelWARNING, "No WLAN configuration found in the RTC memory");
     hasWifiConnection = false;
-    wificonfigRtc = false;
+    rtcStatus.wificonfigRtc = false;
     return false;
   }
   else
   {
-    wificonfigRtc = true;
+    rtcStatus.wificonfigRtc = true;
   }
 
   if (WiFi.status() == WL_CONNECTED)
@@ -47,36 +205,10 @@ bool connectToWifiAndSyncNTP()
   }
   else
   {
-    // Search through all stored networks
-    for (int j = 0; j < WifiArraySize; ++j)
-    {
-      if (strlen(configRTC.wificonfig[j].ssid) > 0)
-      {
-        Log(LogCategoryWiFi, LogLevelDEBUG, "Trying to connect to network: ", String(configRTC.wificonfig[j].ssid));
-        for (int attempt = 0; attempt < 2; ++attempt)
-        {
-          WiFi.begin(configRTC.wificonfig[j].ssid, configRTC.wificonfig[j].pw);
-          for (int i = 0; i < 2; i++)
-          {
-            if (WiFi.status() == WL_CONNECTED)
-            {
-              Log(LogCategoryWiFi, LogLevelDEBUG, "Connected to network: ", String(configRTC.wificonfig[j].ssid));
-              hasWifiConnection = true;
-              synchronizeTimeWithNTP();
-              return true;
-            }
-            delay(1000);
-          }
-
-          Log(LogCategoryWiFi, LogLevelDEBUG, "Connection failed for network: ", String(configRTC.wificonfig[j].ssid));
-          hasWifiConnection = false;
-        }
-      }
-    }
-
-    Log(LogCategoryWiFi, LogLevelDEBUG, "No known network found");
-    hasWifiConnection = false;
-    return false;
+    EnergyPhase previous = enterEnergyPhase(ENERGY_PHASE_WIFI);
+    bool isConnected = connectToStoredNetworks();
+    leaveEnergyPhase(previous);
+    return isConnected;
   }
 }
 
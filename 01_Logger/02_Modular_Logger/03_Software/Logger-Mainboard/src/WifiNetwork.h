@@ -12,8 +12,35 @@
 #ifndef WIFINETWORK_H
 #define WIFINETWORK_H
 
+#include <stdint.h>
+
+#define WIFI_CONNECT_BINS 6 // Time-to-connect bins: < 250, 500, 1000, 2000, 4000 ms and longer
+
+// Access point and IP lease of the last connection, for a directed connect without scan and DHCP
+typedef struct
+{
+  uint8_t bssid[6];
+  uint8_t channel;
+  int8_t network;     // Index in configRTC.wificonfig, -1 = nothing cached
+  uint32_t localIp;   // IPv4 addresses as IPAddress stores them
+  uint32_t gatewayIp;
+  uint32_t subnetMask;
+  uint32_t dnsIp;
+  uint32_t leaseTime; // RTC time the addresses were received by DHCP
+} WifiFastConnectCache;
+
+// Time-to-connect statistics since the last reset
+typedef struct
+{
+  uint32_t connectMs[WIFI_CONNECT_BINS]; // Successful connections per bin
+  uint32_t fastConnects;                 // Connected with the cache
+  uint32_t scanConnects;                 // Connected after a scan
+  uint32_t failures;                     // No network connected
+} WifiConnectStats;
+
 void handleNtpSynchronization();
 
 bool connectToWifiAndSyncNTP();
+void clearWifiFastConnectCache();
 
 #endif
\ No newline at end of file
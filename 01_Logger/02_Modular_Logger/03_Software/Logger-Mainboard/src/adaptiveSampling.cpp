@@ -0,0 +1,70 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Adaptive sampling interval per sensor, driven by the change of its values
+ */
+
+#include <math.h>
+
+#include "adaptiveSampling.h"
+
+/**
+ * @brief Resets the state to the configured interval, e.g. at the beginning of a deployment.
+ * @param state State of one sensor.
+ */
+void adaptiveReset(AdaptiveState &state)
+{
+  state.reference = 0;
+  state.level = 0;
+  state.valid = false;
+}
+
+/**
+ * @brief Adapts the level of a sensor to the change since its previous value.
+ *        The change grows about linearly with the interval for a steady trend, so a change of
+ *        n times the deadband shrinks the level by log2(n) (rounded up) in one step instead of
+ *        walking back one level per sample. For a trend that is monotonic between two samples,
+ *        linear interpolation between the stored samples stays within the deadband.
+ * @param state State of the sensor, updated with the value.
+ * @param rule Rule of the sensor.
+ * @param value Measured value that passed the quality control.
+ * @return uint8_t New level, 0 = configured interval.
+ */
+uint8_t adaptiveUpdate(AdaptiveState &state, const AdaptiveRule &rule, float value)
+{
+  if (!(rule.deadband > 0) || !isfinite(value))
+  {
+    state.level = 0;
+    return state.level;
+  }
+
+  if (state.valid)
+  {
+    float change = fabsf(value - state.reference);
+    if (change > rule.deadband)
+    {
+      while (change > rule.deadband && state.level > 0)
+      {
+        change /= 2;
+        state.level--;
+      }
+    }
+    else if (change <= rule.deadband / 2 && state.level < rule.maxLevel)
+    {
+      state.level++;
+    }
+  }
+
+  if (state.level > rule.maxLevel)
+  {
+    state.level = rule.maxLevel; // The configuration was changed
+  }
+  state.reference = value;
+  state.valid = true;
+  return state.level;
+}
@@ -0,0 +1,39 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Adaptive sampling interval per sensor, driven by the change of its values
+ */
+
+#ifndef ADAPTIVESAMPLING_H
+#define ADAPTIVESAMPLING_H
+
+#include <stdint.h>
+
+// The interval of a sensor is its configured interval * 2^level. The level grows while the value
+// changes by at most half of the deadband between two samples and shrinks as soon as it changes
+// by more than the deadband, so the step between two stored samples stays around the deadband.
+
+// Rule of one sensor from the logger configuration
+typedef struct
+{
+  float deadband;   // Active if > 0, in sensor units
+  uint8_t maxLevel; // Largest level, the interval is at most multiplied by 2^maxLevel
+} AdaptiveRule;
+
+// State of one sensor kept between two measurements
+typedef struct
+{
+  float reference; // Latest value
+  uint8_t level;
+  bool valid;
+} AdaptiveState;
+
+void adaptiveReset(AdaptiveState &state);
+uint8_t adaptiveUpdate(AdaptiveState &state, const AdaptiveRule &rule, float value);
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: High-rate cast profiling with light sleep between the samples
+ */
+
+#include <esp_sleep.h>
+#include <esp_timer.h>
+
+#include "BMS.h"
+#include "DS3231TimeNtp.h"
+#include "DebuggingSDLog.h"
+#include "DeepSleep.h"
+#include "LoggerHER.h"
+#include "SensorManagement.h"
+#include "SystemVariables.h"
+#include "castProfiling.h"
+#include "profileSummary.h"
+#include "sampleStaging.h"
+#include "sample_cast.h"
+
+/**
+ * @brief Returns the index of the cast detection sensor in configRTC.sensor.
+ * @return int Index of the sensor, -1 if it is not configured or skipped because of an error.
+ */
+static int castDetectionSensorNumber()
+{
+  for (int i = 0; i < numberOfActiveSensors; i++)
+  {
+    if (configRTC.sensor[i].sensor_id == configRTC.cast_det_sensor)
+    {
+      return isSensorErrorSkipped(i) ? -1 : i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Measures all sensors that are due in this profiling tick.
+ *        A sensor is due every sample_cast_periode_multiplier ticks. The ring of a board that
+ *        samples on its own is drained instead, it would overflow during a long cast.
+ * @param tick Number of the profiling tick.
+ */
+static void measureCastProfilingSample(uint32_t tick)
+{
+  memset(measurementSuccessful, 0, sizeof(measurementSuccessful));
+
+  bool due[MAX_SENSOR_CREDENTIALS] = {};
+  for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
+  {
+    uint8_t multiplier = configRTC.sensor[sensorNumber].sample_cast_periode_multiplier;
+    due[sensorNumber] = !isSensorErrorSkipped(sensorNumber) && (multiplier <= 1 || tick % multiplier == 0);
+    if (due[sensorNumber] && ((autonomousSensorMask >> sensorNumber) & 1u))
+    {
+      drainAutonomousSamples(sensorNumber);
+      due[sensorNumber] = false;
+    }
+    else if (due[sensorNumber])
+    {
+      Logger.startConversionAll(configRTC.sensor[sensorNumber].bus_address);
+    }
+  }
+
+  for (int sensorNumber = 0; sensorNumber < numberOfActiveSensors; ++sensorNumber)
+  {
+    if (due[sensorNumber])
+    {
+      performSensorMeasurement(sensorNumber);
+    }
+  }
+}
+
+/**
+ * @brief Samples at a fixed rate while the logger moves vertically.
+ *        Between two samples the ESP32 is in light sleep, so RAM, I2C and SD card stay initialized
+ *        and no boot is needed per sample. The run ends when the cast detection sensor shows no
+ *        movement over CAST_PROFILING_WINDOW samples, after castProfilingMaxDuration or when the
+ *        battery is empty. The achieved jitter and the energy per sample are logged at the end.
+ */
+void runCastProfiling()
+{
+  int castSensor = castDetectionSensorNumber();
+  if (castSensor < 0)
+  {
+    return;
+  }
+
+  Log(LogCategoryUnderwater, LogLevelINFO, "Cast profiling begin, interval [ms]: ", String(castProfilingIntervalMs));
+  powerRailsForSensors(UINT32_MAX); // Every sensor is sampled during the cast
+
+  const int64_t intervalUs = (int64_t)castProfilingIntervalMs * 1000;
+  const uint32_t startTime = getCurrentTimeFromRTC();
+  const int64_t startUs = esp_timer_get_time();
+  int64_t scheduledUs = startUs;
+  int64_t lastEnergyUs = startUs;
+
+  CastProfilingStats stats = {};
+  CastSampleRing profilingSamples;
+  resetCastSampleRing(profilingSamples, CAST_PROFILING_WINDOW);
+  uint32_t tick = 0;
+
+  while (true)
+  {
+    int64_t sleepUs = scheduledUs - esp_timer_get_time();
+    if (sleepUs > 0)
+    {
+      Serial.flush();
+      esp_sleep_enable_timer_wakeup(sleepUs);
+      esp_light_sleep_start();
+    }
+
+    int64_t wakeUs = esp_timer_get_time();
+    int64_t jitterUs = wakeUs > scheduledUs ? wakeUs - scheduledUs : scheduledUs - wakeUs;
+    stats.jitterSumUs += jitterUs;
+    if (jitterUs > stats.jitterMaxUs)
+    {
+      stats.jitterMaxUs = jitterUs;
+    }
+
+    measureCastProfilingSample(tick);
+    uint32_t sampleTime = startTime + (uint32_t)((scheduledUs - startUs) / 1000000); // Time of the slot on the grid
+    uint8_t qcFlags[MAX_SENSOR_CREDENTIALS];
+    checkMeasurementQuality(qcFlags);
+    stageMeasurementSample(sampleTime, measurementSuccessful, sensorValue, sensorValueRaw, qcFlags, numberOfActiveSensors);
+    addProfileSample(measurementSuccessful, sensorValue, qcFlags, numberOfActiveSensors);
+    stats.samples++;
+
+    // Battery power in mV * mA = uW, integrated over the time since the last reading
+    int64_t nowUs = esp_timer_get_time();
+    float powerMicroWatt = (float)getTotalBatteryCellVoltage() * abs(getBatteryCurrent());
+    stats.energyMilliJoule += powerMicroWatt * (nowUs - lastEnergyUs) / 1e9f;
+    lastEnergyUs = nowUs;
+
+    // Vertical speed over the last CAST_PROFILING_WINDOW samples of the cast detection sensor,
+    // the samples also continue the cast detection of the regular schedule
+    if (measurementSuccessful[castSensor])
+    {
+      float castSpeed;
+      addCastSampleToRing(profilingSamples, (uint32_t)(wakeUs / 1000), sensorValue[castSensor]);
+      addCastSample(getMonotonicMs(), sensorValue[castSensor]);
+
+      if (estimateCastSpeed(profilingSamples, castSpeed) && castSpeed <= configRTC.cast_det_sensor_threshold)
+      {
+        Log(LogCategoryUnderwater, LogLevelDEBUG, "Cast profiling, no vertical movement: ", String(castSpeed, 2), " Units/s");
+        break;
+      }
+    }
+
+    if (nowUs - startUs >= (int64_t)castProfilingMaxDuration * 1000000 || rtcStatus.batteryEmpty)
+    {
+      break;
+    }
+
+    // Keep the schedule fixed, missed slots are skipped instead of being caught up. The tick counts
+    // every slot, so the decimation and the sample times stay on the grid of castProfilingIntervalMs
+    tick++;
+    scheduledUs += intervalUs;
+    while (scheduledUs <= esp_timer_get_time())
+    {
+      tick++;
+      scheduledUs += intervalUs;
+      stats.overruns++;
+    }
+  }
+
+  stats.durationMs = (esp_timer_get_time() - startUs) / 1000;
+
+  // Continue the regular schedule from the end of the run
+  tickSchedulerRestart(sensorSchedule, getMonotonicMs());
+
+  uint32_t samples = stats.samples > 0 ? stats.samples : 1;
+  uint32_t durationMs = stats.durationMs > 0 ? stats.durationMs : 1;
+  Log(LogCategoryUnderwater, LogLevelINFO, "Cast profiling end, samples: ", String(stats.samples),
+      " rate [Hz]: ", String(stats.samples * 1000.0f / durationMs, 2),
+      " jitter mean/max [us]: ", String((long)(stats.jitterSumUs / samples)), "/", String((long)stats.jitterMaxUs),
+      " skipped slots: ", String(stats.overruns),
+      " energy per sample [mJ]: ", String(stats.energyMilliJoule / samples, 2));
+}
@@ -0,0 +1,33 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: High-rate cast profiling with light sleep between the samples
+ */
+
+#ifndef CASTPROFILING_H
+#define CASTPROFILING_H
+
+#include <Arduino.h>
+
+// Number of cast detection samples the vertical speed is calculated over
+#define CAST_PROFILING_WINDOW 8
+
+// Statistics of one cast profiling run
+typedef struct
+{
+  uint32_t samples;       // Number of staged samples
+  uint32_t overruns;      // Sample slots skipped because a measurement took longer than the interval
+  int64_t jitterSumUs;    // Sum of the absolute wake-up deviations from the schedule
+  int64_t jitterMaxUs;    // Largest absolute wake-up deviation from the schedule
+  float energyMilliJoule; // Battery energy used during the run
+  uint32_t durationMs;    // Duration of the run
+} CastProfilingStats;
+
+void runCastProfiling();
+
+#endif
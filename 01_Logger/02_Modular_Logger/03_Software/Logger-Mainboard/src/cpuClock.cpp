@@ -0,0 +1,157 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: CPU clock policy per operating phase
+ */
+
+#include <Arduino.h>
+#include <esp_idf_version.h>
+#include <esp_pm.h>
+
+#include "DebuggingSDLog.h"
+#include "SystemVariables.h"
+#include "cpuClock.h"
+
+static CpuClockLevel currentLevel = CPU_CLOCK_BOOST; // The ESP32-S3 boots at 240 MHz
+static bool isPolicyActive = false;
+
+#ifdef CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t activeLock = NULL;
+static esp_pm_lock_handle_t boostLock = NULL;
+#endif
+
+/**
+ * @brief Returns the CPU frequency of a level in MHz.
+ */
+static uint32_t levelFrequencyMhz(CpuClockLevel level)
+{
+  switch (level)
+  {
+  case CPU_CLOCK_LOW:
+    return cpuFrequencyLowMhz;
+  case CPU_CLOCK_ACTIVE:
+    return 80;
+  default:
+    return cpuFrequencyBoostMhz;
+  }
+}
+
+/**
+ * @brief Switches from currentLevel to level.
+ *        The lock of the new level is taken before the old one is released, so the clock
+ *        does not dip to the low level in between.
+ */
+static void applyLevel(CpuClockLevel level)
+{
+#ifdef CONFIG_PM_ENABLE
+  if (level == CPU_CLOCK_BOOST)
+  {
+    esp_pm_lock_acquire(boostLock);
+  }
+  else if (level == CPU_CLOCK_ACTIVE)
+  {
+    esp_pm_lock_acquire(activeLock);
+  }
+
+  if (currentLevel == CPU_CLOCK_BOOST)
+  {
+    esp_pm_lock_release(boostLock);
+  }
+  else if (currentLevel == CPU_CLOCK_ACTIVE)
+  {
+    esp_pm_lock_release(activeLock);
+  }
+#else
+  setCpuFrequencyMhz(levelFrequencyMhz(level));
+#endif
+  currentLevel = level;
+}
+
+/**
+ * @brief Sets up the clock policy of cpuClockPolicy, called at the beginning of setup().
+ *        Invalid frequencies or a failing power management configuration keep the fixed policy.
+ */
+void beginCpuClockPolicy()
+{
+  if (cpuClockPolicy != CPU_CLOCK_POLICY_PHASE)
+  {
+    return;
+  }
+
+  bool isBoostValid = cpuFrequencyBoostMhz == 80 || cpuFrequencyBoostMhz == 160 || cpuFrequencyBoostMhz == 240;
+  bool isLowValid = cpuFrequencyLowMhz == 10 || cpuFrequencyLowMhz == 20 || cpuFrequencyLowMhz == 40 || cpuFrequencyLowMhz == 80;
+  if (!isBoostValid || !isLowValid || cpuFrequencyLowMhz > cpuFrequencyBoostMhz)
+  {
+    Log(LogCategoryPowerManagement, LogLevelERROR, "CPU clock policy: invalid frequencies [MHz]: ", String(cpuFrequencyLowMhz), " ", String(cpuFrequencyBoostMhz));
+    return;
+  }
+
+#ifdef CONFIG_PM_ENABLE
+  if (boostLock == NULL &&
+      (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "clockBoost", &boostLock) != ESP_OK ||
+       esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "clockActive", &activeLock) != ESP_OK))
+  {
+    Log(LogCategoryPowerManagement, LogLevelERROR, "CPU clock policy: locks could not be created");
+    return;
+  }
+  esp_pm_lock_acquire(boostLock); // Holds the boot frequency until the first level is set
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  esp_pm_config_t config = {};
+#else
+  esp_pm_config_esp32s3_t config = {};
+#endif
+  config.max_freq_mhz = cpuFrequencyBoostMhz;
+  config.min_freq_mhz = cpuFrequencyLowMhz;
+  config.light_sleep_enable = false; // Light sleep is entered explicitly (cast profiling)
+  esp_err_t error = esp_pm_configure(&config);
+  if (error != ESP_OK)
+  {
+    esp_pm_lock_release(boostLock);
+    Log(LogCategoryPowerManagement, LogLevelERROR, "CPU clock policy: esp_pm_configure failed: ", String(error));
+    return;
+  }
+#endif
+
+  currentLevel = CPU_CLOCK_BOOST;
+  isPolicyActive = true;
+  applyLevel(CPU_CLOCK_ACTIVE);
+}
+
+/**
+ * @brief Sets the clock level, e.g. CPU_CLOCK_LOW around a wait.
+ * @param level The new level.
+ * @return CpuClockLevel The level before, to be restored with setCpuClockLevel.
+ */
+CpuClockLevel setCpuClockLevel(CpuClockLevel level)
+{
+  CpuClockLevel previous = currentLevel;
+  if (isPolicyActive && level != currentLevel)
+  {
+    applyLevel(level);
+  }
+  return previous;
+}
+
+/**
+ * @brief Sets the clock level to at least level, a higher level is kept.
+ * @param level The lowest level the following code needs.
+ * @return CpuClockLevel The level before, to be restored with setCpuClockLevel.
+ */
+CpuClockLevel raiseCpuClockLevel(CpuClockLevel level)
+{
+  return setCpuClockLevel(level > currentLevel ? level : currentLevel);
+}
+
+/**
+ * @brief Returns the name of the policy in effect, for the status upload.
+ */
+const char *cpuClockPolicyName()
+{
+  return isPolicyActive ? "phase" : "fixed";
+}
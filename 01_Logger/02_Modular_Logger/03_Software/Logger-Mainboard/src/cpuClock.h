@@ -0,0 +1,40 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: CPU clock policy per operating phase
+ */
+
+#ifndef CPUCLOCK_H
+#define CPUCLOCK_H
+
+// With the ESP-IDF power management (CONFIG_PM_ENABLE) the levels are power management locks:
+//   CPU_CLOCK_LOW     no lock, the CPU runs at cpuFrequencyLowMhz (min_freq_mhz)
+//   CPU_CLOCK_ACTIVE  ESP_PM_APB_FREQ_MAX, 80 MHz CPU and APB for the SPI (SD card) and UART HAL
+//   CPU_CLOCK_BOOST   ESP_PM_CPU_FREQ_MAX, the CPU runs at cpuFrequencyBoostMhz (max_freq_mhz)
+// The drivers (I2C, WiFi) take their own locks, so I2C polling works at the low level.
+// Without power management the levels fall back to setCpuFrequencyMhz.
+
+typedef enum
+{
+  CPU_CLOCK_LOW,    // Waiting: sensor conversions, RDY polling, delay() loops
+  CPU_CLOCK_ACTIVE, // Everything else, SD card and log output need at least this level
+  CPU_CLOCK_BOOST   // SHA-256, sample encoding, JSON serialization and upload
+} CpuClockLevel;
+
+typedef enum
+{
+  CPU_CLOCK_POLICY_FIXED, // Always cpuFrequencyBoostMhz, as before the policy
+  CPU_CLOCK_POLICY_PHASE  // Level per phase as above
+} CpuClockPolicy;
+
+void beginCpuClockPolicy();
+CpuClockLevel setCpuClockLevel(CpuClockLevel level);
+CpuClockLevel raiseCpuClockLevel(CpuClockLevel level);
+const char *cpuClockPolicyName();
+
+#endif
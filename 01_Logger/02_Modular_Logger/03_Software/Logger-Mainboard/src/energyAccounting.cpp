@@ -0,0 +1,95 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Accounting of the battery charge per operating phase
+ */
+
+#include <string.h>
+
+#include "energyAccounting.h"
+
+// Battery side (4 cells in series), so the currents of the 3.3 V rail are divided by about 4
+const float energyModelCurrentMa[ENERGY_PHASE_COUNT] = {
+    15.0f, // Boot
+    15.0f, // Housekeeping
+    25.0f, // Wet detection, sensor powered
+    40.0f, // Sampling, all due sensors powered
+    20.0f, // SD write
+    35.0f, // WiFi
+    35.0f, // MQTT
+    0.15f, // Sleep, ESP32-S3, BMS and interface board
+};
+
+static const char *const phaseNames[ENERGY_PHASE_COUNT] = {"boot", "housekeeping", "wet_detection", "sampling",
+                                                           "sd_write", "wifi", "mqtt", "sleep"};
+
+/**
+ * @brief Returns the name of a phase, as used in the status upload.
+ */
+const char *energyPhaseName(EnergyPhase phase)
+{
+  return phase < ENERGY_PHASE_COUNT ? phaseNames[phase] : "unknown";
+}
+
+/**
+ * @brief Clears the totals and starts a phase.
+ * @param totals Totals to clear.
+ * @param phase Phase that starts at nowMs.
+ * @param nowMs Time of the boundary (monotonic, also counting in deep sleep).
+ * @param sinceTime Unix time of the reset, reported with the totals.
+ */
+void energyAccountingReset(EnergyTotals &totals, EnergyPhase phase, uint32_t nowMs, uint32_t sinceTime)
+{
+  memset(&totals, 0, sizeof(totals));
+  totals.sinceTime = sinceTime;
+  totals.phaseStartMs = nowMs;
+  totals.phaseStartCurrentMa = -1;
+  totals.phase = phase;
+  totals.count[phase] = 1;
+  totals.valid = true;
+}
+
+/**
+ * @brief Closes the current phase and starts the next one.
+ * @param totals Totals the closed phase is added to.
+ * @param next Phase that starts at nowMs.
+ * @param nowMs Time of the boundary (monotonic, also counting in deep sleep).
+ * @param dischargeCurrentMa Battery discharge current at the boundary, < 0 = not measured.
+ * @param modelCurrentMa Per phase: current model in mA.
+ * @param isEntry True if next is entered, false if an enclosing phase is resumed (not counted).
+ */
+void energyAccountingBoundary(EnergyTotals &totals, EnergyPhase next, uint32_t nowMs, float dischargeCurrentMa, const float *modelCurrentMa, bool isEntry)
+{
+  uint8_t phase = totals.phase < ENERGY_PHASE_COUNT ? totals.phase : (uint8_t)ENERGY_PHASE_HOUSEKEEPING;
+  uint32_t elapsedMs = nowMs - totals.phaseStartMs; // Wraps correctly after 49 days
+
+  float currentMa = modelCurrentMa[phase];
+  if (phase != ENERGY_PHASE_SLEEP && totals.phaseStartCurrentMa >= 0 && dischargeCurrentMa >= 0)
+  {
+    currentMa = (totals.phaseStartCurrentMa + dischargeCurrentMa) / 2;
+  }
+  else if (phase != ENERGY_PHASE_SLEEP && (totals.phaseStartCurrentMa >= 0 || dischargeCurrentMa >= 0))
+  {
+    currentMa = totals.phaseStartCurrentMa >= 0 ? totals.phaseStartCurrentMa : dischargeCurrentMa;
+  }
+  else
+  {
+    totals.modelMs += elapsedMs;
+  }
+
+  totals.durationMs[phase] += elapsedMs;
+  totals.chargeMicroAmpSec[phase] += (uint64_t)((double)currentMa * elapsedMs + 0.5); // mA * ms = uAs
+
+  totals.phase = next;
+  totals.phaseStartMs = nowMs;
+  totals.phaseStartCurrentMa = dischargeCurrentMa;
+  if (isEntry)
+  {
+    totals.count[next]++;
+  }
+}
@@ -0,0 +1,59 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Accounting of the battery charge per operating phase
+ */
+
+#ifndef ENERGYACCOUNTING_H
+#define ENERGYACCOUNTING_H
+
+#include <stdint.h>
+
+// The firmware marks the boundaries between the phases of a wake-up. At every boundary the
+// time since the previous boundary is added to the phase that ends, together with the charge
+// drawn in it: the mean of the battery discharge currents measured at both boundaries, or the
+// current model of the phase if no current was measured (while charging the BMS only sees the
+// sum of load and charge current). The sleep phase always uses the model, its boundaries are
+// measured while the logger is awake. No Arduino dependency, tools/endurancePredictor.cpp
+// links the same module.
+
+typedef enum
+{
+  ENERGY_PHASE_BOOT,          // Wake-up until the end of setup()
+  ENERGY_PHASE_HOUSEKEEPING,  // Config request, BMS, periodic tasks and sleep preparation of the loop
+  ENERGY_PHASE_WET_DETECTION, // Reading of the wet detection sensor
+  ENERGY_PHASE_SAMPLING,      // Underwater measurement including the cast profiling
+  ENERGY_PHASE_SD_WRITE,      // Flush of the staged samples to the SD card
+  ENERGY_PHASE_WIFI,          // WiFi connection and NTP synchronisation
+  ENERGY_PHASE_MQTT,          // MQTT connection and transmissions
+  ENERGY_PHASE_SLEEP,         // Deep sleep
+  ENERGY_PHASE_COUNT
+} EnergyPhase;
+
+// Totals since sinceTime, kept in the RTC memory
+typedef struct
+{
+  uint64_t durationMs[ENERGY_PHASE_COUNT];
+  uint64_t chargeMicroAmpSec[ENERGY_PHASE_COUNT]; // in uAs (1 mAh = 3600000 uAs)
+  uint32_t count[ENERGY_PHASE_COUNT];             // Number of times the phase was entered
+  uint64_t modelMs;                               // Time accounted with the current model
+  uint32_t sinceTime;                             // Unix time of the reset
+  uint32_t phaseStartMs;                          // Boundary of the current phase
+  float phaseStartCurrentMa;                      // Discharge current at that boundary, < 0 = unknown
+  uint8_t phase;                                  // Current EnergyPhase
+  bool valid;
+} EnergyTotals;
+
+// Current model in mA on the battery side, per phase (estimates, to be calibrated with the BMS)
+extern const float energyModelCurrentMa[ENERGY_PHASE_COUNT];
+
+const char *energyPhaseName(EnergyPhase phase);
+void energyAccountingReset(EnergyTotals &totals, EnergyPhase phase, uint32_t nowMs, uint32_t sinceTime);
+void energyAccountingBoundary(EnergyTotals &totals, EnergyPhase next, uint32_t nowMs, float dischargeCurrentMa, const float *modelCurrentMa, bool isEntry);
+
+#endif
@@ -13,6 +13,7 @@
 #include <SD.h>
 #include <WiFiClientSecure.h>
 
+#include "cpuClock.h"
 #include "firmwareUpdate.h"
 
 /**
@@ -35,6 +36,7 @@ String calculateCurrentHash()
   mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(md_type), 0);
   mbedtls_md_starts(&ctx);
 
+  CpuClockLevel previousClock = raiseCpuClockLevel(CPU_CLOCK_BOOST);
   while (file.available())
   {
     char buf[128];
@@ -42,6 +44,7 @@ String calculateCurrentHash()
     mbedtls_md_update(&ctx, (const unsigned char *)buf, l);
   }
   file.close();
+  setCpuClockLevel(previousClock);
 
   mbedtls_md_finish(&ctx, hash);
   mbedtls_md_free(&ctx);
@@ -154,6 +157,7 @@ bool calculateSha256(String received_sha256)
     mbedtls_md_starts(&ctx);
 
     // Read the file and calculate the hash
+    CpuClockLevel previousClock = raiseCpuClockLevel(CPU_CLOCK_BOOST);
     while (file.available())
     {
       char buf[128];
@@ -161,6 +165,7 @@ bool calculateSha256(String received_sha256)
       mbedtls_md_update(&ctx, (const unsigned char *)buf, l);
     }
     file.close();
+    setCpuClockLevel(previousClock);
 
     mbedtls_md_finish(&ctx, hash);
     mbedtls_md_free(&ctx);
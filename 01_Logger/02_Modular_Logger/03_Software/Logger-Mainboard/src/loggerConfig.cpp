@@ -18,11 +18,36 @@
 #include "SystemVariables.h"
 #include "Utility.h"
 #include "loggerConfig.h"
+#include "loggerConfigSchema.h"
+#include "loggerConfigSnapshot.h"
 #include "loggerConfigValidation.h"
+#include "phaseProfiler.h"
 
 LoggerConfig config;
 
-DynamicJsonDocument doc(40000);
+// Single document shared by loading, validation and the periodic config update
+DynamicJsonDocument configDoc(40000);
+
+// Capacity of the deserialization filter: one slot per schema key, plus "sensors" and "wifi", their single
+// array element and one "sensor_type" object per level. The slot size depends on the platform (16 bytes on
+// the ESP32, 32 bytes on a 64-bit host), JSON_OBJECT_SIZE takes care of it.
+static constexpr size_t configFilterCapacity =
+    JSON_OBJECT_SIZE(CONFIG_FIELD_COUNT(basicConfigFields) + CONFIG_FIELD_COUNT(sensorConfigFields) + CONFIG_FIELD_COUNT(wifiConfigFields)) +
+    JSON_OBJECT_SIZE(2) + JSON_ARRAY_SIZE(2) + JSON_OBJECT_SIZE(3);
+
+/**
+ * @brief Builds the deserialization filter with all keys the logger uses.
+ *        Unknown keys of the configuration file are skipped while parsing and use no memory.
+ * @param filter Filter document.
+ */
+static void buildConfigFilter(JsonDocument &filter)
+{
+  addConfigFieldsToFilter(basicConfigFields, CONFIG_FIELD_COUNT(basicConfigFields), filter.to<JsonObject>());
+
+  // The filter of the first array element applies to all elements
+  addConfigFieldsToFilter(sensorConfigFields, CONFIG_FIELD_COUNT(sensorConfigFields), filter["sensors"].createNestedObject());
+  addConfigFieldsToFilter(wifiConfigFields, CONFIG_FIELD_COUNT(wifiConfigFields), filter["wifi"].createNestedObject());
+}
 
 /**
  * @brief Moves a configuration file from source to destination.
@@ -82,7 +107,17 @@ bool JsonFileRead(const String &pfad)
     return false;
   }
 
-  DeserializationError error = deserializeJson(doc, file);
+  StaticJsonDocument<configFilterCapacity> filter;
+  buildConfigFilter(filter);
+  if (filter.overflowed())
+  {
+    // A truncated filter would silently drop configuration keys
+    Log(LogCategoryConfiguration, LogLevelERROR, "JSON filter of the configuration overflowed");
+    file.close();
+    return false;
+  }
+
+  DeserializationError error = deserializeJson(configDoc, file, DeserializationOption::Filter(filter));
   if (error)
   {
     Serial.println(F("JSON deserialisation failed!"));
@@ -98,45 +133,19 @@ bool JsonFileRead(const String &pfad)
  */
 void configureSensorsFromJson()
 {
-  JsonArray sensorsArray = doc["sensors"].as<JsonArray>();
+  JsonArray sensorsArray = configDoc["sensors"].as<JsonArray>();
   SensorArraySize = sensorsArray.size();
 
   if (SensorArraySize > MAX_SENSOR_CREDENTIALS)
     SensorArraySize = MAX_SENSOR_CREDENTIALS; // Limit the size of the arrays
 
+  memset(configRTC.parameter_pool, 0, sizeof(configRTC.parameter_pool));
+
   // Fill the array with the sensor data from the JSON document
   int i = 0;
-  for (JsonVariant sensor : sensorsArray)
+  for (JsonObject sensor : sensorsArray)
   {
-    configRTC.sensor[i].sensor_id = sensor["sensor_id"];
-    configRTC.sensor[i].sample_periode_multiplier = sensor["sample_periode_multiplier"];
-    configRTC.sensor[i].sample_cast_periode_multiplier = sensor["sample_cast_periode_multiplier"];
-    configRTC.sensor[i].bus_address = sensor["bus_address"];
-
-    // config.sensor[i].calib_coeff_0 = sensor["calib_coeff"]["0"];
-    config.sensor[i].calib_coeff_1 = sensor["calib_coeff"]["1"];
-    config.sensor[i].calib_coeff_2 = sensor["calib_coeff"]["2"];
-    config.sensor[i].calib_coeff_3 = sensor["calib_coeff"]["3"];
-    config.sensor[i].calib_coeff_4 = sensor["calib_coeff"]["4"];
-    config.sensor[i].calib_coeff_5 = sensor["calib_coeff"]["5"];
-    config.sensor[i].calib_coeff_6 = sensor["calib_coeff"]["6"];
-    config.sensor[i].calib_coeff_7 = sensor["calib_coeff"]["7"];
-    config.sensor[i].calib_coeff_8 = sensor["calib_coeff"]["8"];
-    config.sensor[i].calib_coeff_9 = sensor["calib_coeff"]["9"];
-    config.sensor[i].calib_coeff_10 = sensor["calib_coeff"]["10"];
-
-    strlcpy(config.sensor[i].serial_number, sensor["serial_number"], sizeof(config.sensor[i].serial_number));
-
-    JsonObject sensorType = sensor["sensor_type"];
-    config.sensor[i].sensor_type_id = sensorType["sensor_type_id"];
-    strlcpy(configRTC.sensor[i].parameter, sensorType["parameter"], sizeof(configRTC.sensor[i].parameter));
-    strlcpy(config.sensor[i].long_name, sensorType["long_name"], sizeof(config.sensor[i].long_name));
-    strlcpy(config.sensor[i].unit, sensorType["unit"], sizeof(config.sensor[i].unit));
-    strlcpy(config.sensor[i].manufacturer, sensorType["manufacturer"], sizeof(config.sensor[i].manufacturer));
-    strlcpy(config.sensor[i].model, sensorType["model"], sizeof(config.sensor[i].model));
-    configRTC.sensor[i].parameter_no = sensorType["parameter_no"];
-    config.sensor[i].accuracy = sensorType["accuracy"];
-    config.sensor[i].resolution = sensorType["resolution"];
+    readConfigFieldsFromJson(sensorConfigFields, CONFIG_FIELD_COUNT(sensorConfigFields), sensor, &configRTC.sensor[i], &config.sensor[i]);
 
     if (++i >= SensorArraySize)
       break; // Prevent more data from being written than the array can hold
@@ -148,7 +157,7 @@ void configureSensorsFromJson()
  */
 void configureWifiFromJson()
 {
-  JsonArray wifiArray = doc["wifi"].as<JsonArray>();
+  JsonArray wifiArray = configDoc["wifi"].as<JsonArray>();
   WifiArraySize = wifiArray.size();
 
   if (WifiArraySize > MAX_WIFI_CREDENTIALS)
@@ -156,102 +165,87 @@ void configureWifiFromJson()
 
   // Fill the array with the WLAN data from the JSON document
   int i = 0;
-  for (JsonVariant wifi : wifiArray)
+  for (JsonObject wifi : wifiArray)
   {
-    if (wifi.is<JsonObject>())
-    {
-      JsonObject wifiObject = wifi.as<JsonObject>();
-      strlcpy(configRTC.wificonfig[i].ssid, wifi["ssid"], sizeof(configRTC.wificonfig[i].ssid));
-      strlcpy(configRTC.wificonfig[i].pw, wifi["pw"], sizeof(configRTC.wificonfig[i].pw));
-    }
+    readConfigFieldsFromJson(wifiConfigFields, CONFIG_FIELD_COUNT(wifiConfigFields), wifi, &configRTC.wificonfig[i], nullptr);
+
     if (++i >= WifiArraySize)
       break; // Prevent more data from being written than the array can hold
   }
 }
 
 /**
- * @brief Configures basic settings from JSON data.
+ * @brief Stores a parameter name once in the parameter pool.
+ * @param pool Parameter pool of PARAMETER_POOL_SIZE bytes, pool[0] is the empty name.
+ * @param name Parameter name.
+ * @return int Offset of the name in the pool, -1 if the pool is full.
  */
-void configureBasicSettingsFromJson()
+int internParameterName(char *pool, const char *name)
 {
-  configRTC.logger_id = doc["logger_id"];
-
-  if (!doc["operation_mode"].isNull())
+  if (name == nullptr || name[0] == '\0')
   {
-    strlcpy(config.operation_mode, doc["operation_mode"], sizeof(config.operation_mode));
-  }
-  else
-  {
-    config.operation_mode[0] = '\0';
+    return 0;
   }
 
-  if (!doc["fw_version"].isNull())
-  {
-    strlcpy(config.fw_version, doc["fw_version"], sizeof(config.fw_version));
-  }
-  else
+  int offset = 1;
+  while (offset < PARAMETER_POOL_SIZE && pool[offset] != '\0')
   {
-    config.fw_version[0] = '\0';
+    if (strcmp(pool + offset, name) == 0)
+    {
+      return offset;
+    }
+    offset += strlen(pool + offset) + 1;
   }
 
-  configRTC.num_sensors = doc["num_sensors"];
-  configRTC.config_update_periode = doc["config_update_periode"];
-  configRTC.status_upload_periode = doc["status_upload_periode"];
-  configRTC.sample_periode = doc["sample_periode"];
-  configRTC.sample_cast_enable = doc["sample_cast_enable"];
-  configRTC.sample_cast_periode = doc["sample_cast_periode"];
-  configRTC.cast_det_sensor = doc["cast_det_sensor"];
-  configRTC.cast_det_sensor_threshold = doc["cast_det_sensor_threshold"];
-  configRTC.wet_det_sensor = doc["wet_det_sensor"];
-  configRTC.wet_det_periode = doc["wet_det_periode"];
-  configRTC.wet_det_threshold = doc["wet_det_threshold"];
-  configRTC.dry_det_sensor = doc["dry_det_sensor"];
-  configRTC.dry_det_threshold = doc["dry_det_threshold"];
-  configRTC.dry_det_verify_delay = doc["dry_det_verify_delay"];
-  configRTC.data_upload_retry_periode = doc["data_upload_retry_periode"];
-  config.deckunit_id = doc["deckunit_id"];
-  config.platform_id = doc["platform_id"];
-  config.vessel_id = doc["vessel_id"];
-  config.deployment_contact_id = doc["deployment_contact_id"];
-
-  if (!doc["contact_first_name"].isNull())
+  size_t length = strnlen(name, PARAMETER_NAME_SIZE - 1);
+  if (offset + length + 1 > PARAMETER_POOL_SIZE)
   {
-    strlcpy(config.contact_first_name, doc["contact_first_name"], sizeof(config.contact_first_name));
-  }
-  else
-  {
-    config.contact_first_name[0] = '\0';
+    return -1;
   }
 
-  if (!doc["contact_last_name"].isNull())
-  {
-    strlcpy(config.contact_last_name, doc["contact_last_name"], sizeof(config.contact_last_name));
-  }
-  else
-  {
-    config.contact_last_name[0] = '\0';
-  }
+  memcpy(pool + offset, name, length);
+  pool[offset + length] = '\0';
+  return offset;
+}
 
-  if (!doc["vessel_name"].isNull())
-  {
-    strlcpy(config.vessel_name, doc["vessel_name"], sizeof(config.vessel_name));
-  }
-  else
-  {
-    config.vessel_name[0] = '\0';
-  }
+/**
+ * @brief Returns the parameter name of a sensor.
+ * @param sensorNumber Index of the sensor in configRTC.sensor.
+ * @return const char* Parameter name from the parameter pool.
+ */
+const char *sensorParameter(int sensorNumber)
+{
+  return configRTC.parameter_pool + configRTC.sensor[sensorNumber].parameter_id;
+}
 
+/**
+ * @brief Reads the basic settings that are kept in the RTC memory from JSON data.
+ * @param rtc Destination for the basic settings.
+ */
+void readBasicSettingsFromJson(LoggerConfigRTC &rtc)
+{
+  readConfigFieldsFromJson(basicConfigFields, CONFIG_FIELD_COUNT(basicConfigFields), configDoc.as<JsonObjectConst>(), &rtc, nullptr);
+}
+
+/**
+ * @brief Configures basic settings from JSON data.
+ */
+void configureBasicSettingsFromJson()
+{
+  readConfigFieldsFromJson(basicConfigFields, CONFIG_FIELD_COUNT(basicConfigFields), configDoc.as<JsonObjectConst>(), &configRTC, &config);
   saveSamplePeriodeToResetAfterUnderwaterMeasurementsEnd = configRTC.sample_periode;
 }
 
 /**
- * @brief Compares RTC configuration with JSON configuration file.
- * @return bool True if configurations match, false otherwise.
+ * @brief Compares the RTC configuration with the stored configuration.
+ *        The snapshot is used if available, otherwise the JSON configuration file is parsed.
+ * @return bool True if configurations do not match, false otherwise.
  */
-bool compareRtcWithJsonConfig()
+bool compareRtcWithConfigSnapshot()
 {
 
   bool compareRtcError = false;
+  static LoggerConfigRTC storedRTC;
 
   // Read the latest configuration file from the /loggerConfig folder
   String latestConfigFile = findLatestConfigurationFile("/loggerConfig");
@@ -262,77 +256,25 @@ bool compareRtcWithJsonConfig()
     generalAlarmLed();
   }
 
-  // Open the latest configuration file
-  File configFile = SD.open("/loggerConfig/" + latestConfigFile);
-  if (!configFile)
-  {
-    Log(LogCategoryGeneral, LogLevelERROR, "Error when opening the configuration file: ", String(latestConfigFile));
-    compareRtcError = true;
-    generalAlarmLed();
-  }
-
-  DeserializationError error = deserializeJson(doc, configFile);
-  configFile.close();
-
-  if (error)
-  {
-    Log(LogCategoryConfiguration, LogLevelERROR, "Error parsing the configuration file: ", String(latestConfigFile));
-    compareRtcError = true;
-    generalAlarmLed();
-  }
-
-  if (configRTC.logger_id != doc["logger_id"])
-  {
-    Log(LogCategoryConfiguration, LogLevelERROR, "logger_id does not match.");
-    compareRtcError = true;
-  }
-
-  if (configRTC.num_sensors != doc["num_sensors"])
-  {
-    Log(LogCategoryConfiguration, LogLevelERROR, "num_sensors does not match.");
-    compareRtcError = true;
-  }
-
-  if (configRTC.config_update_periode != doc["config_update_periode"])
-  {
-    Log(LogCategoryConfiguration, LogLevelERROR, "config_update_periode does not match.");
-    compareRtcError = true;
-  }
-
-  if (configRTC.status_upload_periode != doc["status_upload_periode"])
-  {
-    Log(LogCategoryConfiguration, LogLevelERROR, "status_upload_periode does not match.");
-    compareRtcError = true;
-  }
-
-  if (configRTC.sample_periode != doc["sample_periode"])
-  {
-    Log(LogCategoryConfiguration, LogLevelERROR, "sample_periode does not match.");
-    compareRtcError = true;
-  }
-
-  if (configRTC.sample_cast_enable != doc["sample_cast_enable"])
-  {
-    Log(LogCategoryConfiguration, LogLevelERROR, "sample_cast_enable does not match.");
-    compareRtcError = true;
-  }
-
-  if (configRTC.sample_cast_periode != doc["sample_cast_periode"])
-  {
-    Log(LogCategoryConfiguration, LogLevelERROR, "sample_cast_periode does not match.");
-    compareRtcError = true;
-  }
-
-  if (configRTC.cast_det_sensor != doc["cast_det_sensor"])
+  if (!loadConfigSnapshotRTC(latestConfigFile, storedRTC))
   {
-    Log(LogCategoryConfiguration, LogLevelERROR, "cast_det_sensor does not match.");
-    compareRtcError = true;
+    if (!JsonFileRead("/loggerConfig/" + latestConfigFile))
+    {
+      Log(LogCategoryConfiguration, LogLevelERROR, "Error parsing the configuration file: ", String(latestConfigFile));
+      compareRtcError = true;
+      generalAlarmLed();
+    }
+    readBasicSettingsFromJson(storedRTC);
   }
 
-  if (configRTC.cast_det_sensor_threshold != doc["cast_det_sensor_threshold"])
+  for (const ConfigField &field : basicConfigFields)
   {
-    Log(LogCategoryConfiguration, LogLevelERROR, "cast_det_sensor_threshold does not match.");
-    compareRtcError = true;
+    if ((field.flags & FIELD_COMPARE) &&
+        memcmp(configFieldAddress(field, &configRTC, nullptr), configFieldAddress(field, &storedRTC, nullptr), field.size) != 0)
+    {
+      Log(LogCategoryConfiguration, LogLevelERROR, field.key, " does not match.");
+      compareRtcError = true;
+    }
   }
 
   if (!compareRtcError)
@@ -351,11 +293,21 @@ bool compareRtcWithJsonConfig()
 
 /**
  * @brief Validates and loads the configuration.
+ *        Warm boots load the snapshot, the JSON file is only parsed once after a configuration change.
+ *        Only a configuration without validation errors is stored as snapshot.
  */
 void validateAndLoadConfig()
 {
+  PROFILE_SCOPE(PROFILE_PHASE_CONFIG);
   findLatestConfigFileUpdateConfig = findLatestConfigurationFile("/loggerConfig");
-  if (JsonFileReadValidation("/loggerConfig/" + findLatestConfigFileUpdateConfig))
+  if (loadConfigSnapshot(findLatestConfigFileUpdateConfig))
+  {
+    Log(LogCategoryConfiguration, LogLevelDEBUG, "ConfigSnapshot loaded");
+    return;
+  }
+
+  bool configRead = JsonFileRead("/loggerConfig/" + findLatestConfigFileUpdateConfig);
+  if (configRead)
   {
     validateBasicConfiguration();
     validateWifiConfiguration();
@@ -368,9 +320,14 @@ void validateAndLoadConfig()
     generalAlarmLed();
   }
 
-  JsonFileRead("/loggerConfig/" + findLatestConfigurationFile("/loggerConfig"));
   configureSensorsFromJson();
   configureWifiFromJson();
   configureBasicSettingsFromJson();
   Log(LogCategoryConfiguration, LogLevelDEBUG, "ConfigFile loaded");
-}
\ No newline at end of file
+
+  // An invalid configuration is not cached, so every boot parses it again and raises the alarm
+  if (configRead && !configUpdateError)
+  {
+    saveConfigSnapshot(findLatestConfigFileUpdateConfig);
+  }
+}
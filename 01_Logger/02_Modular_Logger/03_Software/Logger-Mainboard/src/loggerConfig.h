@@ -12,24 +12,31 @@
 #ifndef LOGGERCONFIG_H
 #define LOGGERCONFIG_H
 
-// Maximum number of SENSOR
+#include <ArduinoJson.h>
+
+// Maximum number of SENSOR, can be lowered with -D MAX_SENSOR_CREDENTIALS=n to save RTC memory
+#ifndef MAX_SENSOR_CREDENTIALS
 #define MAX_SENSOR_CREDENTIALS 32
+#endif
+
+// Number of bus addresses of the interface boards (0 to 32), independent of MAX_SENSOR_CREDENTIALS
+#define BUS_ADDRESS_COUNT 33
 
 // Maximum number of WIFI SENSORs
 #define MAX_WIFI_CREDENTIALS 5
 
+// Number of calibration coefficients per sensor
+#define CALIB_COEFF_COUNT 10
+
+// Size of the pool holding the distinct sensor parameter names in the RTC memory
+#define PARAMETER_POOL_SIZE 256
+
+// Buffer size of a sensor parameter name (45 characters)
+#define PARAMETER_NAME_SIZE 46
+
 typedef struct
 {
-  float calib_coeff_1;
-  float calib_coeff_2;
-  float calib_coeff_3;
-  float calib_coeff_4;
-  float calib_coeff_5;
-  float calib_coeff_6;
-  float calib_coeff_7;
-  float calib_coeff_8;
-  float calib_coeff_9;
-  float calib_coeff_10;
+  float calib_coeff[CALIB_COEFF_COUNT]; // calib_coeff[0] holds the JSON key "1"
   uint8_t sensor_type_id;
   char long_name[101];
   char unit[46];
@@ -37,7 +44,6 @@ typedef struct
   char model[46];
   char serial_number[46];
   float accuracy;
-  float resolution;
 } Sensor;
 
 typedef struct
@@ -54,13 +60,21 @@ typedef struct
   Sensor sensor[MAX_SENSOR_CREDENTIALS];
 } LoggerConfig;
 
+// Members are ordered by size to avoid padding in the RTC memory
 typedef struct
 {
+  float qc_min; // Quality control rules, see qualityControl.h
+  float qc_max;
+  float qc_spike;
+  float qc_gradient;
+  float adaptive_deadband; // Adaptive sampling, see adaptiveSampling.h
+  float resolution;        // Quantisation of the delta encoding, see sampleCodec.h
   uint16_t sensor_id;
+  uint16_t autonomous_sample_periode_ms; // Sampling of the interface board between the wake-ups, 0 = off (see startAutonomousSampling)
   uint8_t sample_periode_multiplier;
   uint8_t sample_cast_periode_multiplier;
   uint8_t bus_address;
-  char parameter[46];
+  uint8_t parameter_id; // Offset of the parameter name in LoggerConfigRTC::parameter_pool
   uint8_t parameter_no;
 } SensorRTC;
 
@@ -70,37 +84,43 @@ typedef struct
   char pw[17];
 } WifiConfigRTC;
 
+// Members are ordered by size to avoid padding in the RTC memory
 typedef struct
 {
-  uint16_t logger_id;
-  uint8_t num_sensors;
   uint32_t config_update_periode;
   uint32_t status_upload_periode;
+  float cast_det_sensor_threshold;
+  float wet_det_threshold;
+  float dry_det_threshold;
+  uint16_t logger_id;
   uint16_t sample_periode;
-  bool sample_cast_enable;
-  uint8_t sample_cast_periode;
   uint16_t cast_det_sensor;
-  float cast_det_sensor_threshold;
   uint16_t wet_det_sensor;
   uint16_t wet_det_periode;
-  float wet_det_threshold;
   uint16_t dry_det_sensor;
-  float dry_det_threshold;
   uint16_t dry_det_verify_delay;
   uint16_t data_upload_retry_periode;
+  uint8_t num_sensors;
+  uint8_t sample_cast_periode;
+  bool sample_cast_enable;
   SensorRTC sensor[MAX_SENSOR_CREDENTIALS];
   WifiConfigRTC wificonfig[MAX_WIFI_CREDENTIALS];
+  char parameter_pool[PARAMETER_POOL_SIZE]; // Distinct parameter names, pool[0] is the empty name
 } LoggerConfigRTC;
 
 extern LoggerConfigRTC configRTC;
 extern LoggerConfig config;
+extern DynamicJsonDocument configDoc;
 
-bool compareRtcWithJsonConfig();
+bool compareRtcWithConfigSnapshot();
 bool JsonFileRead(const String &pfad);
 
 void configureSensorsFromJson();
 void configureWifiFromJson();
 void configureBasicSettingsFromJson();
+void readBasicSettingsFromJson(LoggerConfigRTC &rtc);
+int internParameterName(char *pool, const char *name);
+const char *sensorParameter(int sensorNumber);
 void validateAndLoadConfig();
 
 #endif
\ No newline at end of file
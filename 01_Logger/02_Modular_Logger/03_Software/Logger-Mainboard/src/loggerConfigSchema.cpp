@@ -0,0 +1,180 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Schema of the logger configuration file
+ */
+
+#include <ArduinoJson.h>
+#include <math.h>
+
+#include "loggerConfigSchema.h"
+
+/**
+ * @brief Returns the JSON value of a field, either from the object or from its "sensor_type" object.
+ * @param field Schema entry of the field.
+ * @param obj JSON object of the structure.
+ * @param sensorType "sensor_type" object of a sensor (null for the other structures).
+ * @return JsonVariantConst JSON value of the field.
+ */
+static JsonVariantConst configFieldValue(const ConfigField &field, JsonObjectConst obj, JsonObjectConst sensorType)
+{
+  return (field.flags & FIELD_SENSOR_TYPE) ? sensorType[field.key] : obj[field.key];
+}
+
+/**
+ * @brief Fills a structure from JSON data according to the schema.
+ *        Missing values are stored as 0 or empty string, floats with FIELD_UNSET_NAN as NAN.
+ * @param fields Schema of the structure.
+ * @param count Number of schema entries.
+ * @param obj JSON object of the structure.
+ * @param rtcBase Address of the RTC structure.
+ * @param configBase Address of the config structure (nullptr = only the RTC fields are read).
+ */
+void readConfigFieldsFromJson(const ConfigField *fields, size_t count, JsonObjectConst obj, void *rtcBase, void *configBase)
+{
+  JsonObjectConst sensorType = obj["sensor_type"].as<JsonObjectConst>();
+
+  for (size_t f = 0; f < count; f++)
+  {
+    const ConfigField &field = fields[f];
+    if (field.target == TARGET_CONFIG && configBase == nullptr)
+    {
+      continue;
+    }
+
+    JsonVariantConst value = configFieldValue(field, obj, sensorType);
+    uint8_t *address = configFieldAddress(field, rtcBase, configBase);
+
+    switch (field.type)
+    {
+    case CONFIG_U8:
+      *(uint8_t *)address = value.as<uint8_t>();
+      break;
+    case CONFIG_U16:
+      *(uint16_t *)address = value.as<uint16_t>();
+      break;
+    case CONFIG_U32:
+      *(uint32_t *)address = value.as<uint32_t>();
+      break;
+    case CONFIG_BOOL:
+      *(bool *)address = value.as<bool>();
+      break;
+    case CONFIG_FLOAT:
+      *(float *)address = (value.isNull() && (field.flags & FIELD_UNSET_NAN)) ? NAN : value.as<float>();
+      break;
+    case CONFIG_STRING:
+      if (!value.isNull())
+      {
+        strlcpy((char *)address, value.as<const char *>(), field.size);
+      }
+      else
+      {
+        address[0] = '\0';
+      }
+      break;
+    case CONFIG_CALIB:
+      for (int k = 0; k < CALIB_COEFF_COUNT; k++)
+      {
+        ((float *)address)[k] = value[calibCoeffKeys[k]].as<float>();
+      }
+      break;
+    case CONFIG_PARAMETER:
+    {
+      int offset = internParameterName(configRTC.parameter_pool, value.as<const char *>());
+      *address = offset < 0 ? 0 : offset;
+      break;
+    }
+    }
+  }
+}
+
+/**
+ * @brief Writes the fields with the given flag from a structure to JSON according to the schema.
+ * @param fields Schema of the structure.
+ * @param count Number of schema entries.
+ * @param flag Only fields with this flag are written.
+ * @param obj JSON object of the structure.
+ * @param sensorType "sensor_type" object for fields with FIELD_SENSOR_TYPE (null for the other structures).
+ * @param rtcBase Address of the RTC structure.
+ * @param configBase Address of the config structure.
+ */
+void writeConfigFieldsToJson(const ConfigField *fields, size_t count, uint8_t flag, JsonObject obj, JsonObject sensorType, const void *rtcBase, const void *configBase)
+{
+  for (size_t f = 0; f < count; f++)
+  {
+    const ConfigField &field = fields[f];
+    if (!(field.flags & flag))
+    {
+      continue;
+    }
+
+    JsonObject target = (field.flags & FIELD_SENSOR_TYPE) ? sensorType : obj;
+    const uint8_t *address = configFieldAddress(field, (void *)rtcBase, (void *)configBase);
+
+    switch (field.type)
+    {
+    case CONFIG_U8:
+      target[field.key] = *(const uint8_t *)address;
+      break;
+    case CONFIG_U16:
+      target[field.key] = *(const uint16_t *)address;
+      break;
+    case CONFIG_U32:
+      target[field.key] = *(const uint32_t *)address;
+      break;
+    case CONFIG_BOOL:
+      target[field.key] = *(const bool *)address;
+      break;
+    case CONFIG_FLOAT:
+      target[field.key] = *(const float *)address;
+      break;
+    case CONFIG_STRING:
+      target[field.key] = (const char *)address;
+      break;
+    case CONFIG_PARAMETER:
+      target[field.key] = (const char *)configRTC.parameter_pool + *address;
+      break;
+    case CONFIG_CALIB:
+    {
+      JsonObject calib = target.createNestedObject(field.key);
+      for (int k = 0; k < CALIB_COEFF_COUNT; k++)
+      {
+        calib[calibCoeffKeys[k]] = ((const float *)address)[k];
+      }
+      break;
+    }
+    }
+  }
+}
+
+/**
+ * @brief Adds the keys of the schema to a deserialization filter.
+ * @param fields Schema of the structure.
+ * @param count Number of schema entries.
+ * @param filter Filter object of the structure.
+ */
+void addConfigFieldsToFilter(const ConfigField *fields, size_t count, JsonObject filter)
+{
+  for (size_t f = 0; f < count; f++)
+  {
+    const ConfigField &field = fields[f];
+    if (field.flags & FIELD_SENSOR_TYPE)
+    {
+      JsonObject sensorType = filter["sensor_type"].as<JsonObject>();
+      if (sensorType.isNull())
+      {
+        sensorType = filter.createNestedObject("sensor_type");
+      }
+      sensorType[field.key] = true;
+    }
+    else
+    {
+      filter[field.key] = true;
+    }
+  }
+}
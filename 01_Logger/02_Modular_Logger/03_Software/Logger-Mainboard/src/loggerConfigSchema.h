@@ -0,0 +1,159 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Schema of the logger configuration file
+ */
+
+#ifndef LOGGERCONFIGSCHEMA_H
+#define LOGGERCONFIGSCHEMA_H
+
+#include <ArduinoJson.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "loggerConfig.h"
+
+// Storage type of a configuration field
+enum ConfigFieldType : uint8_t
+{
+  CONFIG_U8,
+  CONFIG_U16,
+  CONFIG_U32,
+  CONFIG_BOOL,
+  CONFIG_FLOAT,
+  CONFIG_STRING,
+  CONFIG_CALIB,     // Object with the keys "1".."CALIB_COEFF_COUNT" stored as float array
+  CONFIG_PARAMETER, // String stored once in configRTC.parameter_pool, the field holds its offset
+};
+
+// Check applied to the JSON value of a configuration field
+enum ConfigFieldCheck : uint8_t
+{
+  CHECK_NUMBER,  // Unsigned integer within min..max
+  CHECK_FLOAT,   // Any number, no string
+  CHECK_BOOLEAN, // 0 or 1
+  CHECK_ASCII,   // ASCII string with at most size - 1 characters
+  CHECK_CALIB,   // All calibration coefficients are numbers
+};
+
+// Structure the field is stored in
+enum ConfigFieldTarget : uint8_t
+{
+  TARGET_RTC,    // LoggerConfigRTC, SensorRTC or WifiConfigRTC
+  TARGET_CONFIG, // LoggerConfig or Sensor
+};
+
+// Flags of a configuration field
+#define FIELD_SENSOR_TYPE 0x01 // Key is located in the "sensor_type" object of a sensor
+#define FIELD_COMPARE 0x02     // Compared with the stored configuration by compareRtcWithConfigSnapshot
+#define FIELD_HEADER 0x04      // Written to the configuration header of a deployment
+#define FIELD_UNSET_NAN 0x08   // A missing float value is stored as NAN (not set) instead of 0
+
+typedef struct
+{
+  const char *key;
+  ConfigFieldType type;
+  ConfigFieldCheck check;
+  ConfigFieldTarget target;
+  uint8_t flags;
+  uint16_t offset;
+  uint16_t size;
+  uint32_t min;
+  uint32_t max;
+} ConfigField;
+
+#define RTC_FIELD(strct, key, type, check, flags, min, max) \
+  {#key, type, check, TARGET_RTC, flags, offsetof(strct, key), sizeof(strct::key), min, max}
+#define CFG_FIELD(strct, key, type, check, flags, min, max) \
+  {#key, type, check, TARGET_CONFIG, flags, offsetof(strct, key), sizeof(strct::key), min, max}
+
+// Top level keys, stored in LoggerConfigRTC / LoggerConfig
+inline constexpr ConfigField basicConfigFields[] = {
+    RTC_FIELD(LoggerConfigRTC, logger_id, CONFIG_U16, CHECK_NUMBER, FIELD_COMPARE, 0, 65535),
+    CFG_FIELD(LoggerConfig, operation_mode, CONFIG_STRING, CHECK_ASCII, 0, 0, 0),
+    CFG_FIELD(LoggerConfig, fw_version, CONFIG_STRING, CHECK_ASCII, 0, 0, 0),
+    RTC_FIELD(LoggerConfigRTC, num_sensors, CONFIG_U8, CHECK_NUMBER, FIELD_COMPARE, 0, 255),
+    RTC_FIELD(LoggerConfigRTC, config_update_periode, CONFIG_U32, CHECK_NUMBER, FIELD_COMPARE, 0, 65535),
+    RTC_FIELD(LoggerConfigRTC, status_upload_periode, CONFIG_U32, CHECK_NUMBER, FIELD_COMPARE, 0, 65535),
+    RTC_FIELD(LoggerConfigRTC, sample_periode, CONFIG_U16, CHECK_NUMBER, FIELD_COMPARE, 0, 65535),
+    RTC_FIELD(LoggerConfigRTC, sample_cast_enable, CONFIG_BOOL, CHECK_BOOLEAN, FIELD_COMPARE, 0, 1),
+    RTC_FIELD(LoggerConfigRTC, sample_cast_periode, CONFIG_U8, CHECK_NUMBER, FIELD_COMPARE, 0, 255),
+    RTC_FIELD(LoggerConfigRTC, cast_det_sensor, CONFIG_U16, CHECK_NUMBER, FIELD_COMPARE, 0, 65535),
+    RTC_FIELD(LoggerConfigRTC, cast_det_sensor_threshold, CONFIG_FLOAT, CHECK_NUMBER, FIELD_COMPARE, 0, 65535),
+    RTC_FIELD(LoggerConfigRTC, wet_det_sensor, CONFIG_U16, CHECK_NUMBER, 0, 0, 65535),
+    RTC_FIELD(LoggerConfigRTC, wet_det_periode, CONFIG_U16, CHECK_NUMBER, 0, 0, 65535),
+    RTC_FIELD(LoggerConfigRTC, wet_det_threshold, CONFIG_FLOAT, CHECK_FLOAT, 0, 0, 0),
+    RTC_FIELD(LoggerConfigRTC, dry_det_sensor, CONFIG_U16, CHECK_NUMBER, 0, 0, 65535),
+    RTC_FIELD(LoggerConfigRTC, dry_det_threshold, CONFIG_FLOAT, CHECK_NUMBER, 0, 0, 65535),
+    RTC_FIELD(LoggerConfigRTC, dry_det_verify_delay, CONFIG_U16, CHECK_NUMBER, 0, 0, 65535),
+    RTC_FIELD(LoggerConfigRTC, data_upload_retry_periode, CONFIG_U16, CHECK_NUMBER, 0, 0, 65535),
+    CFG_FIELD(LoggerConfig, deckunit_id, CONFIG_U16, CHECK_NUMBER, FIELD_HEADER, 0, 65535),
+    CFG_FIELD(LoggerConfig, platform_id, CONFIG_U16, CHECK_NUMBER, FIELD_HEADER, 0, 65535),
+    CFG_FIELD(LoggerConfig, vessel_id, CONFIG_U16, CHECK_NUMBER, FIELD_HEADER, 0, 65535),
+    CFG_FIELD(LoggerConfig, vessel_name, CONFIG_STRING, CHECK_ASCII, FIELD_HEADER, 0, 0),
+    CFG_FIELD(LoggerConfig, deployment_contact_id, CONFIG_U16, CHECK_NUMBER, FIELD_HEADER, 0, 65535),
+    CFG_FIELD(LoggerConfig, contact_first_name, CONFIG_STRING, CHECK_ASCII, FIELD_HEADER, 0, 0),
+    CFG_FIELD(LoggerConfig, contact_last_name, CONFIG_STRING, CHECK_ASCII, FIELD_HEADER, 0, 0),
+};
+
+// Keys of an element of the "sensors" array, stored in SensorRTC / Sensor
+inline constexpr ConfigField sensorConfigFields[] = {
+    RTC_FIELD(SensorRTC, sensor_id, CONFIG_U16, CHECK_NUMBER, FIELD_HEADER, 0, 65535),
+    RTC_FIELD(SensorRTC, sample_periode_multiplier, CONFIG_U8, CHECK_NUMBER, FIELD_HEADER, 0, 255),
+    RTC_FIELD(SensorRTC, sample_cast_periode_multiplier, CONFIG_U8, CHECK_NUMBER, FIELD_HEADER, 0, 255),
+    RTC_FIELD(SensorRTC, bus_address, CONFIG_U8, CHECK_NUMBER, FIELD_HEADER, 0, BUS_ADDRESS_COUNT - 1),
+    CFG_FIELD(Sensor, serial_number, CONFIG_STRING, CHECK_ASCII, FIELD_HEADER, 0, 0),
+    CFG_FIELD(Sensor, calib_coeff, CONFIG_CALIB, CHECK_CALIB, FIELD_HEADER, 0, 0),
+    CFG_FIELD(Sensor, sensor_type_id, CONFIG_U8, CHECK_NUMBER, FIELD_SENSOR_TYPE | FIELD_HEADER, 0, 255),
+    {"parameter", CONFIG_PARAMETER, CHECK_ASCII, TARGET_RTC, FIELD_SENSOR_TYPE | FIELD_HEADER, offsetof(SensorRTC, parameter_id), PARAMETER_NAME_SIZE, 0, 0},
+    CFG_FIELD(Sensor, long_name, CONFIG_STRING, CHECK_ASCII, FIELD_SENSOR_TYPE | FIELD_HEADER, 0, 0),
+    CFG_FIELD(Sensor, unit, CONFIG_STRING, CHECK_ASCII, FIELD_SENSOR_TYPE | FIELD_HEADER, 0, 0),
+    CFG_FIELD(Sensor, manufacturer, CONFIG_STRING, CHECK_ASCII, FIELD_SENSOR_TYPE | FIELD_HEADER, 0, 0),
+    CFG_FIELD(Sensor, model, CONFIG_STRING, CHECK_ASCII, FIELD_SENSOR_TYPE | FIELD_HEADER, 0, 0),
+    RTC_FIELD(SensorRTC, parameter_no, CONFIG_U8, CHECK_NUMBER, FIELD_SENSOR_TYPE | FIELD_HEADER, 0, 255),
+    CFG_FIELD(Sensor, accuracy, CONFIG_FLOAT, CHECK_FLOAT, FIELD_SENSOR_TYPE | FIELD_HEADER, 0, 0),
+    RTC_FIELD(SensorRTC, resolution, CONFIG_FLOAT, CHECK_FLOAT, FIELD_SENSOR_TYPE | FIELD_HEADER, 0, 0),
+    RTC_FIELD(SensorRTC, qc_min, CONFIG_FLOAT, CHECK_FLOAT, FIELD_HEADER | FIELD_UNSET_NAN, 0, 0),
+    RTC_FIELD(SensorRTC, qc_max, CONFIG_FLOAT, CHECK_FLOAT, FIELD_HEADER | FIELD_UNSET_NAN, 0, 0),
+    RTC_FIELD(SensorRTC, qc_spike, CONFIG_FLOAT, CHECK_FLOAT, FIELD_HEADER, 0, 0),
+    RTC_FIELD(SensorRTC, qc_gradient, CONFIG_FLOAT, CHECK_FLOAT, FIELD_HEADER, 0, 0),
+    RTC_FIELD(SensorRTC, adaptive_deadband, CONFIG_FLOAT, CHECK_FLOAT, FIELD_HEADER, 0, 0),
+    RTC_FIELD(SensorRTC, autonomous_sample_periode_ms, CONFIG_U16, CHECK_NUMBER, FIELD_HEADER, 0, 65535),
+};
+
+// Keys of an element of the "wifi" array, stored in WifiConfigRTC
+inline constexpr ConfigField wifiConfigFields[] = {
+    RTC_FIELD(WifiConfigRTC, ssid, CONFIG_STRING, CHECK_ASCII, 0, 0, 0),
+    RTC_FIELD(WifiConfigRTC, pw, CONFIG_STRING, CHECK_ASCII, 0, 0, 0),
+};
+
+#undef RTC_FIELD
+#undef CFG_FIELD
+
+// JSON keys of the calibration coefficients
+inline constexpr const char *calibCoeffKeys[CALIB_COEFF_COUNT] = {"1", "2", "3", "4", "5", "6", "7", "8", "9", "10"};
+
+#define CONFIG_FIELD_COUNT(fields) (sizeof(fields) / sizeof(fields[0]))
+
+/**
+ * @brief Returns the address of a field inside the structure it is stored in.
+ * @param field Schema entry of the field.
+ * @param rtcBase Address of the RTC structure (LoggerConfigRTC, SensorRTC or WifiConfigRTC).
+ * @param configBase Address of the config structure (LoggerConfig or Sensor).
+ * @return uint8_t* Address of the field.
+ */
+inline uint8_t *configFieldAddress(const ConfigField &field, void *rtcBase, void *configBase)
+{
+  return (uint8_t *)(field.target == TARGET_RTC ? rtcBase : configBase) + field.offset;
+}
+
+void readConfigFieldsFromJson(const ConfigField *fields, size_t count, JsonObjectConst obj, void *rtcBase, void *configBase);
+void writeConfigFieldsToJson(const ConfigField *fields, size_t count, uint8_t flag, JsonObject obj, JsonObject sensorType, const void *rtcBase, const void *configBase);
+void addConfigFieldsToFilter(const ConfigField *fields, size_t count, JsonObject filter);
+
+#endif
@@ -0,0 +1,267 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: CRC-protected binary snapshot of the loaded logger configuration
+ */
+
+#include <Preferences.h>
+#include <SD.h>
+#include <esp_rom_crc.h>
+#include <stddef.h>
+
+#include "DebuggingSDLog.h"
+#include "SystemVariables.h"
+#include "loggerConfig.h"
+#include "loggerConfigSnapshot.h"
+
+#define CONFIG_SNAPSHOT_NAMESPACE "cfgsnap"
+#define CONFIG_SNAPSHOT_MAGIC 0x48464353 // "HFCS"
+#define CONFIG_SNAPSHOT_VERSION 6 // 6: configFileLastWrite instead of the CRC of the file
+
+typedef struct
+{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t rtcSize;
+  uint16_t sensorSize;
+  uint8_t sensorArraySize;
+  uint8_t wifiArraySize;
+  char configFile[64];
+  uint32_t configFileSize;
+  uint32_t configFileLastWrite; // Modification time of the file, detects a file edited in place under the same name
+  uint32_t rtcCrc;
+  uint32_t configCrc;
+} ConfigSnapshotHeader;
+
+/**
+ * @brief Returns the number of bytes of the LoggerConfig that are stored in the snapshot.
+ *        Only the configured sensors are stored, the unused sensor slots are skipped.
+ * @param sensorCount Number of configured sensors.
+ * @return size_t Number of bytes.
+ */
+static size_t configSnapshotLength(uint8_t sensorCount)
+{
+  return offsetof(LoggerConfig, sensor) + sensorCount * sizeof(Sensor);
+}
+
+/**
+ * @brief Reads the size and the modification time of a configuration file from its directory entry.
+ *        The contents are not read, a configuration written by the logger invalidates the snapshot
+ *        (see invalidateConfigSnapshot), this detects a file edited on another computer.
+ * @param configFile Name of the configuration file in /loggerConfig.
+ * @param size Size of the file in bytes.
+ * @param lastWrite Modification time of the file.
+ * @return bool True if the file exists.
+ */
+static bool readConfigFileIdentity(const String &configFile, uint32_t &size, uint32_t &lastWrite)
+{
+  File file = SD.open(("/loggerConfig/" + configFile).c_str(), FILE_READ);
+  if (!file)
+  {
+    return false;
+  }
+
+  size = file.size();
+  lastWrite = (uint32_t)file.getLastWrite();
+  file.close();
+  return true;
+}
+
+/**
+ * @brief Reads and checks the snapshot header.
+ * @param prefs Opened preferences namespace.
+ * @param configFile Name of the configuration file the snapshot must belong to.
+ * @param header Read header.
+ * @return bool True if the header is valid and belongs to the current contents of the configuration file.
+ */
+static bool readSnapshotHeader(Preferences &prefs, const String &configFile, ConfigSnapshotHeader &header)
+{
+  if (prefs.getBytes("hdr", &header, sizeof(header)) != sizeof(header))
+  {
+    return false;
+  }
+
+  if (header.magic != CONFIG_SNAPSHOT_MAGIC || header.version != CONFIG_SNAPSHOT_VERSION ||
+      header.rtcSize != sizeof(LoggerConfigRTC) || header.sensorSize != sizeof(Sensor) ||
+      header.sensorArraySize > MAX_SENSOR_CREDENTIALS || header.wifiArraySize > MAX_WIFI_CREDENTIALS)
+  {
+    Log(LogCategoryConfiguration, LogLevelDEBUG, "config snapshot has an incompatible layout");
+    return false;
+  }
+
+  header.configFile[sizeof(header.configFile) - 1] = '\0';
+  if (configFile != header.configFile)
+  {
+    Log(LogCategoryConfiguration, LogLevelDEBUG, "config snapshot belongs to ", String(header.configFile));
+    return false;
+  }
+
+  uint32_t fileSize, fileLastWrite;
+  if (!readConfigFileIdentity(configFile, fileSize, fileLastWrite) || fileSize != header.configFileSize ||
+      fileLastWrite != header.configFileLastWrite)
+  {
+    Log(LogCategoryConfiguration, LogLevelDEBUG, "config snapshot is outdated, the file has changed: ", configFile);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Reads the RTC part of the snapshot and checks its CRC.
+ * @param prefs Opened preferences namespace.
+ * @param header Valid snapshot header.
+ * @param rtc Destination for the RTC configuration.
+ * @return bool True if the RTC configuration was read and is intact.
+ */
+static bool readSnapshotRTC(Preferences &prefs, const ConfigSnapshotHeader &header, LoggerConfigRTC &rtc)
+{
+  if (prefs.getBytes("rtc", &rtc, sizeof(rtc)) != sizeof(rtc))
+  {
+    return false;
+  }
+
+  if (esp_rom_crc32_le(0, (const uint8_t *)&rtc, sizeof(rtc)) != header.rtcCrc)
+  {
+    Log(LogCategoryConfiguration, LogLevelERROR, "config snapshot RTC CRC mismatch");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Loads configRTC and config from the snapshot without parsing the JSON file.
+ * @param configFile Name of the configuration file in /loggerConfig the snapshot must belong to.
+ * @return bool True if the snapshot was valid and has been loaded.
+ */
+bool loadConfigSnapshot(const String &configFile)
+{
+  Preferences prefs;
+  if (!prefs.begin(CONFIG_SNAPSHOT_NAMESPACE, true))
+  {
+    return false;
+  }
+
+  ConfigSnapshotHeader header;
+  static LoggerConfigRTC rtc;
+  bool loaded = readSnapshotHeader(prefs, configFile, header) && readSnapshotRTC(prefs, header, rtc);
+
+  if (loaded)
+  {
+    size_t configLength = configSnapshotLength(header.sensorArraySize);
+    memset(&config, 0, sizeof(config));
+    loaded = prefs.getBytes("cfg", &config, configLength) == configLength &&
+             esp_rom_crc32_le(0, (const uint8_t *)&config, configLength) == header.configCrc;
+    if (!loaded)
+    {
+      Log(LogCategoryConfiguration, LogLevelERROR, "config snapshot CRC mismatch");
+    }
+  }
+  prefs.end();
+
+  if (!loaded)
+  {
+    return false;
+  }
+
+  configRTC = rtc;
+  SensorArraySize = header.sensorArraySize;
+  WifiArraySize = header.wifiArraySize;
+  saveSamplePeriodeToResetAfterUnderwaterMeasurementsEnd = configRTC.sample_periode;
+  return true;
+}
+
+/**
+ * @brief Reads only the RTC part of the snapshot, e.g. to compare it with the RTC memory.
+ * @param configFile Name of the configuration file in /loggerConfig the snapshot must belong to.
+ * @param storedRTC Destination for the stored RTC configuration.
+ * @return bool True if the snapshot was valid and has been read.
+ */
+bool loadConfigSnapshotRTC(const String &configFile, LoggerConfigRTC &storedRTC)
+{
+  Preferences prefs;
+  if (!prefs.begin(CONFIG_SNAPSHOT_NAMESPACE, true))
+  {
+    return false;
+  }
+
+  ConfigSnapshotHeader header;
+  bool loaded = readSnapshotHeader(prefs, configFile, header) && readSnapshotRTC(prefs, header, storedRTC);
+  prefs.end();
+  return loaded;
+}
+
+/**
+ * @brief Stores the currently loaded configRTC and config as snapshot.
+ *        The header is removed first and written last, so an interrupted write leaves no valid snapshot.
+ * @param configFile Name of the configuration file in /loggerConfig the configuration was loaded from.
+ */
+void saveConfigSnapshot(const String &configFile)
+{
+  ConfigSnapshotHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = CONFIG_SNAPSHOT_MAGIC;
+  header.version = CONFIG_SNAPSHOT_VERSION;
+  header.rtcSize = sizeof(LoggerConfigRTC);
+  header.sensorSize = sizeof(Sensor);
+  header.sensorArraySize = SensorArraySize;
+  header.wifiArraySize = WifiArraySize;
+  strlcpy(header.configFile, configFile.c_str(), sizeof(header.configFile));
+  if (!readConfigFileIdentity(configFile, header.configFileSize, header.configFileLastWrite))
+  {
+    Log(LogCategoryConfiguration, LogLevelERROR, "config snapshot not saved, the file could not be read: ", configFile);
+    return;
+  }
+
+  size_t configLength = configSnapshotLength(header.sensorArraySize);
+  header.rtcCrc = esp_rom_crc32_le(0, (const uint8_t *)&configRTC, sizeof(configRTC));
+  header.configCrc = esp_rom_crc32_le(0, (const uint8_t *)&config, configLength);
+
+  Preferences prefs;
+  if (!prefs.begin(CONFIG_SNAPSHOT_NAMESPACE, false))
+  {
+    Log(LogCategoryConfiguration, LogLevelERROR, "config snapshot could not be opened");
+    return;
+  }
+
+  // Avoid flash wear if the same configuration is stored already
+  ConfigSnapshotHeader storedHeader;
+  if (prefs.getBytes("hdr", &storedHeader, sizeof(storedHeader)) == sizeof(storedHeader) &&
+      memcmp(&storedHeader, &header, sizeof(header)) == 0)
+  {
+    prefs.end();
+    return;
+  }
+
+  prefs.remove("hdr");
+  bool written = prefs.putBytes("rtc", &configRTC, sizeof(configRTC)) == sizeof(configRTC) &&
+                 prefs.putBytes("cfg", &config, configLength) == configLength &&
+                 prefs.putBytes("hdr", &header, sizeof(header)) == sizeof(header);
+  prefs.end();
+
+  if (written)
+  {
+    Log(LogCategoryConfiguration, LogLevelDEBUG, "config snapshot saved: ", configFile);
+  }
+  else
+  {
+    Log(LogCategoryConfiguration, LogLevelERROR, "config snapshot could not be saved");
+  }
+}
+
+/**
+ * @brief Invalidates the snapshot, the next boot loads the configuration from the JSON file again.
+ */
+void invalidateConfigSnapshot()
+{
+  Preferences prefs;
+  if (prefs.begin(CONFIG_SNAPSHOT_NAMESPACE, false))
+  {
+    prefs.remove("hdr");
+    prefs.end();
+  }
+}
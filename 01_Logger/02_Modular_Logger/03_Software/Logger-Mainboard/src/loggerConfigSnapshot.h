@@ -0,0 +1,24 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: CRC-protected binary snapshot of the loaded logger configuration
+ */
+
+#ifndef LOGGERCONFIGSNAPSHOT_H
+#define LOGGERCONFIGSNAPSHOT_H
+
+#include <Arduino.h>
+
+#include "loggerConfig.h"
+
+bool loadConfigSnapshot(const String &configFile);
+bool loadConfigSnapshotRTC(const String &configFile, LoggerConfigRTC &storedRTC);
+void saveConfigSnapshot(const String &configFile);
+void invalidateConfigSnapshot();
+
+#endif
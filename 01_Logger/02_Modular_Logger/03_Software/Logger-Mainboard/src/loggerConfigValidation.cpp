@@ -16,46 +16,13 @@
 #include "SDCard.h"
 #include "SystemVariables.h"
 #include "Utility.h"
+#include "loggerConfig.h"
+#include "loggerConfigSchema.h"
 #include "loggerConfigValidation.h"
 
-DynamicJsonDocument docValidation(40000);
 int logger_idValidation;
 bool configUpdateError = false;
 
-/**
- * @brief Reads and validates a JSON configuration file.
- * @param pfad Path to the JSON file.
- * @return bool True if file was read and validated successfully, false otherwise.
- */
-bool JsonFileReadValidation(const String &pfad)
-{
-  File file = SD.open(pfad.c_str(), FILE_READ);
-  if (!file)
-  {
-    Serial.println(F("/loggerConfig/Config.json could not be found on the SD card."));
-    return false;
-  }
-
-  // Determine the file size
-  size_t fileSize = file.size();
-  if (fileSize == 0)
-  {
-    Serial.println(F("/loggerConfig/Config.json is empty!"));
-    file.close();
-    return false;
-  }
-
-  DeserializationError error = deserializeJson(docValidation, file);
-  if (error)
-  {
-    Serial.println(F("Validation JSON deserialization failed!"));
-    file.close();
-    return false;
-  }
-  file.close();
-  return true;
-}
-
 /**
  * @brief Checks whether a value in the JSON object is a valid ASCII string.
  * @param obj The JSON object.
@@ -297,13 +264,9 @@ void checkCalibrationCoefficients(JsonObject sensorObj, int sensorArray = -1)
   // Path to the `calib_coeff` object in the sensor object
   JsonObject calibCoeffs = sensorObj["calib_coeff"].as<JsonObject>();
 
-  // Number of coefficients to be checked
-  const int coeffAnzahl = 10; // Change this according to the actual number
-
-  for (int i = 0; i < coeffAnzahl; ++i)
+  for (int i = 0; i < CALIB_COEFF_COUNT; ++i)
   {
-    // Generate the key dynamically
-    String key = String(i);
+    const char *key = calibCoeffKeys[i];
 
     // Check whether the current calib_coeff exists and is a number
     if (calibCoeffs.containsKey(key))
@@ -391,30 +354,64 @@ void checkBooleanValue(JsonVariant var, const char *key)
   }
 }
 
+/**
+ * @brief Validates the JSON values of a structure according to the schema.
+ * @param fields Schema of the structure.
+ * @param count Number of schema entries.
+ * @param obj JSON object of the structure.
+ * @param sensorArray Sensor arrays (-1 = no arrays).
+ */
+static void validateConfigFields(const ConfigField *fields, size_t count, JsonObject obj, int sensorArray = -1)
+{
+  JsonObject sensorType = obj["sensor_type"].as<JsonObject>();
+
+  for (size_t f = 0; f < count; f++)
+  {
+    const ConfigField &field = fields[f];
+    JsonObject target = (field.flags & FIELD_SENSOR_TYPE) ? sensorType : obj;
+
+    switch (field.check)
+    {
+    case CHECK_NUMBER:
+      validateNumericValue(target, field.key, field.min, field.max, sensorArray);
+      break;
+    case CHECK_FLOAT:
+      isStringFloatingPoint(target, field.key, sensorArray);
+      break;
+    case CHECK_BOOLEAN:
+      checkBooleanValue(target, field.key);
+      break;
+    case CHECK_ASCII:
+      isValidAsciiString(target, field.key, field.size - 1, sensorArray);
+      break;
+    case CHECK_CALIB:
+      checkCalibrationCoefficients(target, sensorArray);
+      break;
+    }
+  }
+}
+
 /**
  * @brief Validates the sensors configuration.
  */
 void validateSensorsConfiguration()
 {
   int i = 0;
-  JsonArray sensorsArray = docValidation["sensors"].as<JsonArray>();
+  char parameterPool[PARAMETER_POOL_SIZE] = {};
+  JsonArray sensorsArray = configDoc["sensors"].as<JsonArray>();
   for (JsonObject sensorObj : sensorsArray)
   {
-    validateNumericValue(sensorObj, "sensor_id", 0, 65535, i);
-    validateNumericValue(sensorObj, "sample_periode_multiplier", 0, 255, i);
-    validateNumericValue(sensorObj, "sample_cast_periode_multiplier", 0, 255, i);
-    validateNumericValue(sensorObj, "bus_address", 0, 255, i);
-    checkCalibrationCoefficients(sensorObj, i);
-    isValidAsciiString(sensorObj, "serial_number", 45, i);
-    JsonObject sensorType = sensorObj["sensor_type"].as<JsonObject>();
-    isValidAsciiString(sensorType, "parameter", 45, i);
-    isValidAsciiString(sensorType, "long_name", 100, i);
-    isValidAsciiString(sensorType, "unit", 45, i);
-    isValidAsciiString(sensorType, "manufacturer", 45, i);
-    isValidAsciiString(sensorType, "model", 45, i);
-    validateNumericValue(sensorType, "parameter_no", 0, 255, i);
-    isStringFloatingPoint(sensorType, "accuracy", i);
-    isStringFloatingPoint(sensorType, "resolution", i);
+    validateConfigFields(sensorConfigFields, CONFIG_FIELD_COUNT(sensorConfigFields), sensorObj, i);
+
+    // The distinct parameter names must fit into the parameter pool of the RTC memory
+    const char *parameter = sensorObj["sensor_type"]["parameter"];
+    if (parameter != nullptr && internParameterName(parameterPool, parameter) < 0)
+    {
+      String error = "too many different parameter names";
+      transmitUpdateMessage(("Error in: " + findLatestConfigFileUpdateConfig + " - " + "key: parameter | " + "sensor array: " + i + " | " + error).c_str(), "hyfive/ConfigError");
+      Log(LogCategoryConfiguration, LogLevelERROR, "Error in: ", findLatestConfigFileUpdateConfig, " - ", "key: parameter | ", "sensor array: ", String(i), " | ", error);
+      configUpdateError = true;
+    }
     i++;
   }
 }
@@ -425,14 +422,13 @@ void validateSensorsConfiguration()
 void validateWifiConfiguration()
 {
   int i = 0;
-  JsonArray wifiArray = docValidation["wifi"].as<JsonArray>();
+  JsonArray wifiArray = configDoc["wifi"].as<JsonArray>();
   for (JsonObject wifiObj : wifiArray)
   {
-    isValidAsciiString(wifiObj, "ssid", 15, i);
-    isValidAsciiString(wifiObj, "pw", 16, i);
+    validateConfigFields(wifiConfigFields, CONFIG_FIELD_COUNT(wifiConfigFields), wifiObj, i);
     i++;
   }
-  if (i == 0 && wificonfigRtc)
+  if (i == 0 && rtcStatus.wificonfigRtc)
   {
     transmitUpdateMessage(("LoggerConfigFile | configUpdate has no wifi data available "), "hyfive/ConfigError");
     Log(LogCategoryConfiguration, LogLevelERROR, "no wifi data available");
@@ -445,30 +441,6 @@ void validateWifiConfiguration()
  */
 void validateBasicConfiguration()
 {
-  logger_idValidation = docValidation["logger_id"].as<int>();
-  validateNumericValue(docValidation, "logger_id", 0, 65535);
-  isValidAsciiString(docValidation, "operation_mode", 45);
-  isValidAsciiString(docValidation, "fw_version", 100);
-  validateNumericValue(docValidation, "num_sensors", 0, 255);
-  validateNumericValue(docValidation, "config_update_periode", 0, 65535);
-  validateNumericValue(docValidation, "status_upload_periode", 0, 65535);
-  validateNumericValue(docValidation, "sample_periode", 0, 65535);
-  checkBooleanValue(docValidation, "sample_cast_enable");
-  validateNumericValue(docValidation, "sample_cast_periode", 0, 255);
-  validateNumericValue(docValidation, "cast_det_sensor", 0, 65535);
-  validateNumericValue(docValidation, "cast_det_sensor_threshold", 0, 65535);
-  validateNumericValue(docValidation, "wet_det_sensor", 0, 65535);
-  validateNumericValue(docValidation, "wet_det_periode", 0, 65535);
-  isStringFloatingPoint(docValidation, "wet_det_threshold");
-  validateNumericValue(docValidation, "dry_det_sensor", 0, 65535);
-  validateNumericValue(docValidation, "dry_det_threshold", 0, 65535);
-  validateNumericValue(docValidation, "dry_det_verify_delay", 0, 65535);
-  validateNumericValue(docValidation, "data_upload_retry_periode", 0, 65535);
-  validateNumericValue(docValidation, "deckunit_id", 0, 65535);
-  validateNumericValue(docValidation, "platform_id", 0, 65535);
-  validateNumericValue(docValidation, "vessel_id", 0, 65535);
-  isValidAsciiString(docValidation, "vessel_name", 45);
-  validateNumericValue(docValidation, "deployment_contact_id", 0, 65535);
-  isValidAsciiString(docValidation, "contact_first_name", 45);
-  isValidAsciiString(docValidation, "contact_last_name", 45);
-}
\ No newline at end of file
+  logger_idValidation = configDoc["logger_id"].as<int>();
+  validateConfigFields(basicConfigFields, CONFIG_FIELD_COUNT(basicConfigFields), configDoc.as<JsonObject>());
+}
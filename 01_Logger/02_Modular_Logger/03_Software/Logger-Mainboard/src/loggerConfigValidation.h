@@ -15,8 +15,6 @@
 extern int logger_idValidation;
 extern bool configUpdateError;
 
-bool JsonFileReadValidation(const String &pfad);
-
 void validateSensorsConfiguration();
 void validateWifiConfiguration();
 void validateBasicConfiguration();
@@ -14,57 +14,60 @@
 #include "BMS.h"
 #include "DS3231TimeNtp.h"
 #include "DebuggingSDLog.h"
+#include "DeepSleep.h"
 #include "Led.h"
 #include "MQTTManager.h"
 #include "SDCard.h"
 #include "SensorManagement.h"
 #include "SystemVariables.h"
 #include "Utility.h"
+#include "cpuClock.h"
+#include "periodicTasks.h"
+#include "phaseProfiler.h"
 
 void setup()
 {
   Serial.begin(115200);
+  beginCpuClockPolicy(); //* Clock level per phase, before the first SD card access
+  PROFILE_START(i2cInitStartUs);
   initializeLogger();
   initBmsAndRtc();
+  PROFILE_STOP(PROFILE_PHASE_I2C_INIT, i2cInitStartUs);
+  beginEnergyAccounting(); //* Energy per phase, the boot phase started at the wake-up
   initializeSdCard();
   // programBms(); //* Optional (should only be activated if you want to program BMS, reason: BMS and RTC would use the interface at the same time!)
   performFirstBootOperations();
+  PROFILE_RECORD(PROFILE_PHASE_BOOT, esp_timer_get_time()); //* esp_timer starts with the application
 }
 
 void loop()
 {
+  enterEnergyPhase(ENERGY_PHASE_HOUSEKEEPING);
   askForConfig();                      //* Configuration request
   checkWetSensorThreshold();           //* Underwater/surface water detection and operations
   logBmsStatus();                      //* BMS status logging
   handleSensorError(30);               //* Sensor and config error detection
   processAndTransmitMeasurementData(); //* MQTT, data processing and transmission
 
-  //* The variable totalElapsedTime += difftime(getCurrentTimeFromRTC(), currentTimeNow); is used to,
-  //* update the total time since the start of the program by adding the elapsed
-  //* time elapsed since the last run of the loop is added to the previous total time.
-  totalElapsedTime += difftime(getCurrentTimeFromRTC(), currentTimeNow);
-
-  //* Execution of the various periodic actions
-  wetDetPeriodeFunktion(wet_det_periode);
-  statusUploadPeriodeFunktion(status_upload_periode);
-  configUpdatePeriodeFunktion(config_update_periode);
-  dataUploadRetryPeriodeFunktion(data_upload_retry_periode);
-
-  //* Determines the largest number from a series of time periods to restart the time loop
-  resetTimePeriodeLoop(config_update_periode, status_upload_periode, wet_det_periode, data_upload_retry_periode);
+  //* Execution of the periodic tasks that are due (registry in periodicTasks.cpp)
+  runPeriodicTasks();
 
   //* Calculation of the minimum waiting time
-  minTimeUntilNextFunction = calculateShortestWaitTime(totalElapsedTime, lastConfigUpdateTime, lastStatusUploadTime, lastWetDetectionUploadTime, lastDataUploadRetryTime, isDataUploadRetryEnabled, config_update_periode, status_upload_periode, wet_det_periode, data_upload_retry_periode);
+  minTimeUntilNextFunction = calculateShortestWaitTime();
+  if (isWetDetectionPending() && minTimeUntilNextFunction > wetDetConfirmInterval)
+  {
+    minTimeUntilNextFunction = wetDetConfirmInterval; // The next reading confirms or rejects the wet detection
+  }
 
   //* Battery management
   batteryCompletelyCharged();
   connectionOfPowerSupplyBeginChargingOfBatteries();
 
   //* Deep Sleep
-  //* The variable currentTimeNow = getCurrentTimeFromRTC(); updates the variable currentTimeNow with the
-  //* current time from the real-time clock (RTC) directly before the ESP32 goes into deep sleep.
+  PROFILE_START(sleepEntryStartUs);
   interfaceSleep();
-  currentTimeNow = getCurrentTimeFromRTC();
-  esp_sleep_enable_timer_wakeup((minTimeUntilNextFunction) * 1000000);
+  esp_sleep_enable_timer_wakeup((uint64_t)minTimeUntilNextFunction * 1000000);
+  enterEnergyPhase(ENERGY_PHASE_SLEEP);
+  PROFILE_STOP(PROFILE_PHASE_SLEEP_ENTRY, sleepEntryStartUs);
   esp_deep_sleep_start();
 }
@@ -0,0 +1,205 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Derived oceanographic variables (salinity, depth, oxygen concentration)
+ */
+
+#include <math.h>
+
+#include "oceanography.h"
+
+// PSS-78 coefficients (UNESCO 1983, Technical Papers in Marine Science 44)
+static const float a0 = 0.0080f, a1 = -0.1692f, a2 = 25.3851f, a3 = 14.0941f, a4 = -7.0261f, a5 = 2.7081f;
+static const float b0 = 0.0005f, b1 = -0.0056f, b2 = -0.0066f, b3 = -0.0375f, b4 = 0.0636f, b5 = -0.0144f;
+static const float c0 = 0.6766097f, c1 = 2.00564e-2f, c2 = 1.104259e-4f, c3 = -6.9698e-7f, c4 = 1.0031e-9f;
+static const float d1 = 3.426e-2f, d2 = 4.464e-4f, d3 = 4.215e-1f, d4 = -3.107e-3f;
+static const float e1 = 2.070e-5f, e2 = -6.370e-10f, e3 = 3.989e-15f;
+static const float k = 0.0162f;
+
+/**
+ * @brief PSS-78 salinity from the conductivity ratio Rt at the temperature t68 (valid for 2 <= S <= 42).
+ */
+static inline float salinityFromRt(float rt, float t68)
+{
+  float sqrtRt = sqrtf(rt);
+  float ft = (t68 - 15.0f) / (1.0f + k * (t68 - 15.0f));
+  float sa = a0 + (a1 + (a2 + (a3 + (a4 + a5 * sqrtRt) * sqrtRt) * sqrtRt) * sqrtRt) * sqrtRt;
+  float sb = b0 + (b1 + (b2 + (b3 + (b4 + b5 * sqrtRt) * sqrtRt) * sqrtRt) * sqrtRt) * sqrtRt;
+  return sa + ft * sb;
+}
+
+/**
+ * @brief Conductivity ratio Rt of the sample to standard seawater at the same temperature and p = 0.
+ */
+static inline float conductivityRatioRt(float conductivity, float t68, float pressure)
+{
+  float r = conductivity / PSS78_C35_15_0;
+  float rtTemperature = c0 + (c1 + (c2 + (c3 + c4 * t68) * t68) * t68) * t68;
+  float rp = 1.0f + pressure * (e1 + (e2 + e3 * pressure) * pressure) / (1.0f + (d1 + d2 * t68) * t68 + (d3 + d4 * t68) * r);
+  return r / (rp * rtTemperature);
+}
+
+/**
+ * @brief Extension of PSS-78 below S = 2 by Hill et al. (1986) without the correction to S = 2.
+ */
+static float hillSalinityRaw(float rt, float t68)
+{
+  float ft = (t68 - 15.0f) / (1.0f + k * (t68 - 15.0f));
+  float x = 400.0f * rt;
+  float sqrtY = 10.0f * sqrtf(rt);
+  return salinityFromRt(rt, t68) - a0 / (1.0f + x * (1.5f + x)) - b0 * ft / (1.0f + sqrtY * (1.0f + sqrtY * (1.0f + sqrtY)));
+}
+
+/**
+ * @brief Salinity below S = 2 (Hill et al. 1986), scaled so that it matches PSS-78 at S = 2.
+ */
+static float lowSalinity(float rt, float t68)
+{
+  // Rt at which PSS-78 gives S = 2, found with the secant method
+  float rtLow = 0.04f, rtHigh = 0.08f;
+  float sLow = salinityFromRt(rtLow, t68) - 2.0f, sHigh = salinityFromRt(rtHigh, t68) - 2.0f;
+  for (int i = 0; i < 8 && sHigh != sLow; i++)
+  {
+    float rtNext = rtHigh - sHigh * (rtHigh - rtLow) / (sHigh - sLow);
+    rtLow = rtHigh;
+    sLow = sHigh;
+    rtHigh = rtNext;
+    sHigh = salinityFromRt(rtHigh, t68) - 2.0f;
+  }
+
+  float hillRatio = 2.0f / hillSalinityRaw(rtHigh, t68);
+  return hillRatio * hillSalinityRaw(rt, t68);
+}
+
+/**
+ * @brief Converts an absolute pressure (e.g. of the pressure sensor) into sea pressure.
+ * @param absolutePressureMbar Absolute pressure in mbar.
+ * @return float Sea pressure in dbar.
+ */
+float seaPressureFromAbsolute(float absolutePressureMbar)
+{
+  return (absolutePressureMbar - STANDARD_ATMOSPHERE_MBAR) / 100.0f;
+}
+
+/**
+ * @brief Calculates the practical salinity (PSS-78, extended below S = 2 by Hill et al. 1986).
+ * @param conductivity Conductivity in mS/cm.
+ * @param temperature Temperature in degrees Celsius (ITS-90).
+ * @param pressure Sea pressure in dbar.
+ * @return float Practical salinity, 0 for conductivities <= 0.
+ */
+float practicalSalinity(float conductivity, float temperature, float pressure)
+{
+  float t68 = temperature * 1.00024f;
+  float rt = conductivityRatioRt(conductivity, t68, pressure);
+  if (!(rt > 0))
+  {
+    return 0;
+  }
+  float salinity = salinityFromRt(rt, t68);
+  return salinity < 2.0f ? lowSalinity(rt, t68) : salinity;
+}
+
+/**
+ * @brief Calculates the depth from the pressure (UNESCO 1983, Fofonoff and Millard).
+ * @param pressure Sea pressure in dbar.
+ * @param latitude Latitude in degrees.
+ * @return float Depth in m.
+ */
+float depthFromPressure(float pressure, float latitude)
+{
+  float x = sinf(latitude * (float)M_PI / 180.0f);
+  x = x * x;
+  float gravity = 9.780318f * (1.0f + (5.2788e-3f + 2.36e-5f * x) * x) + 1.092e-6f * pressure;
+  return (((-1.82e-15f * pressure + 2.279e-10f) * pressure - 2.2512e-5f) * pressure + 9.72659f) * pressure / gravity;
+}
+
+/**
+ * @brief Converts the oxygen partial pressure into the molar oxygen concentration
+ *        (SCOR WG 142, same calculation as function_convert_oxygen.py of the visualisation).
+ * @param oxygenPartialPressure Oxygen partial pressure in mbar.
+ * @param temperature Temperature in degrees Celsius.
+ * @param salinity Practical salinity.
+ * @param pressure Sea pressure in dbar.
+ * @return float Oxygen concentration in umol/L (divide by OXYGEN_UMOL_PER_ML for ml/L).
+ */
+float oxygenConcentration(float oxygenPartialPressure, float temperature, float salinity, float pressure)
+{
+  const float xO2 = 0.20946f; // Mole fraction of oxygen in dry air (Glueckauf 1951)
+  const float vm = 0.317f;    // Molar volume of oxygen in m3 mol-1 Pa dbar-1 (Enns et al. 1965)
+  const float r = 8.314f;     // Universal gas constant in J mol-1 K-1
+
+  float kelvin = temperature + 273.15f;
+  float waterVapour = STANDARD_ATMOSPHERE_MBAR * expf(24.4543f - 67.4509f * (100.0f / kelvin) - 4.8489f * logf(kelvin / 100.0f) - 0.000544f * salinity);
+  float scaledT = logf((298.15f - temperature) / kelvin);
+  float temperatureCorrection = OXYGEN_UMOL_PER_ML * expf(2.00907f + scaledT * (3.22014f + scaledT * (4.05010f + scaledT * (4.94457f + scaledT * (-2.56847e-1f + scaledT * 3.88767f)))));
+  float salinityCorrection = expf(salinity * (-6.24523e-3f + scaledT * (-7.37614e-3f + scaledT * (-1.03410e-2f - 8.17083e-3f * scaledT))) - 4.88682e-7f * salinity * salinity);
+
+  return oxygenPartialPressure / (xO2 * (STANDARD_ATMOSPHERE_MBAR - waterVapour)) * temperatureCorrection * salinityCorrection / expf(vm * pressure / (r * kelvin));
+}
+
+/**
+ * @brief Batch version of seaPressureFromAbsolute.
+ */
+void seaPressureFromAbsoluteBatch(const float *absolutePressureMbar, float *pressure, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+  {
+    pressure[i] = (absolutePressureMbar[i] - STANDARD_ATMOSPHERE_MBAR) / 100.0f;
+  }
+}
+
+/**
+ * @brief Batch version of practicalSalinity.
+ *        The first loop has no branches, so the compiler can vectorize it; values below S = 2
+ *        (fresh water, conductivity <= 0) are corrected in a second loop.
+ */
+void practicalSalinityBatch(const float *conductivity, const float *temperature, const float *pressure, float *salinity, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+  {
+    float t68 = temperature[i] * 1.00024f;
+    float rt = conductivityRatioRt(conductivity[i], t68, pressure[i]);
+    salinity[i] = salinityFromRt(rt > 0 ? rt : 0, t68);
+  }
+
+  for (size_t i = 0; i < n; i++)
+  {
+    if (salinity[i] < 2.0f)
+    {
+      salinity[i] = practicalSalinity(conductivity[i], temperature[i], pressure[i]);
+    }
+  }
+}
+
+/**
+ * @brief Batch version of depthFromPressure for one latitude.
+ */
+void depthFromPressureBatch(const float *pressure, float latitude, float *depth, size_t n)
+{
+  float x = sinf(latitude * (float)M_PI / 180.0f);
+  x = x * x;
+  float surfaceGravity = 9.780318f * (1.0f + (5.2788e-3f + 2.36e-5f * x) * x);
+
+  for (size_t i = 0; i < n; i++)
+  {
+    float p = pressure[i];
+    depth[i] = (((-1.82e-15f * p + 2.279e-10f) * p - 2.2512e-5f) * p + 9.72659f) * p / (surfaceGravity + 1.092e-6f * p);
+  }
+}
+
+/**
+ * @brief Batch version of oxygenConcentration.
+ */
+void oxygenConcentrationBatch(const float *oxygenPartialPressure, const float *temperature, const float *salinity, const float *pressure, float *concentration, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+  {
+    concentration[i] = oxygenConcentration(oxygenPartialPressure[i], temperature[i], salinity[i], pressure[i]);
+  }
+}
@@ -0,0 +1,40 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Derived oceanographic variables (salinity, depth, oxygen concentration)
+ */
+
+#ifndef OCEANOGRAPHY_H
+#define OCEANOGRAPHY_H
+
+#include <stddef.h>
+
+// The library has no Arduino dependency, so the deck box and server tools can link it as well.
+// The batch functions take arrays of n values and write n results; input and output must not overlap.
+// Units: conductivity in mS/cm, temperature in degrees Celsius (ITS-90), pressure in dbar
+// (sea pressure, 0 at the surface), oxygen partial pressure in mbar, salinity as PSS-78.
+
+#define STANDARD_ATMOSPHERE_MBAR 1013.25f
+
+// Conductivity of standard seawater (S = 35, t68 = 15 degrees Celsius, p = 0) in mS/cm
+#define PSS78_C35_15_0 42.914f
+
+// Factor from umol/L to ml/L (molar volume of oxygen at STP)
+#define OXYGEN_UMOL_PER_ML 44.6596f
+
+float seaPressureFromAbsolute(float absolutePressureMbar);
+float practicalSalinity(float conductivity, float temperature, float pressure);
+float depthFromPressure(float pressure, float latitude);
+float oxygenConcentration(float oxygenPartialPressure, float temperature, float salinity, float pressure);
+
+void seaPressureFromAbsoluteBatch(const float *absolutePressureMbar, float *pressure, size_t n);
+void practicalSalinityBatch(const float *conductivity, const float *temperature, const float *pressure, float *salinity, size_t n);
+void depthFromPressureBatch(const float *pressure, float latitude, float *depth, size_t n);
+void oxygenConcentrationBatch(const float *oxygenPartialPressure, const float *temperature, const float *salinity, const float *pressure, float *concentration, size_t n);
+
+#endif
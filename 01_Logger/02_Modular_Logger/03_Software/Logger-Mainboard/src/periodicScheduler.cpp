@@ -0,0 +1,131 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Due time calculation and wake-up coalescing for periodic tasks
+ */
+
+#include "periodicScheduler.h"
+
+/**
+ * @brief Returns the first due time of a task after the given time.
+ * @param timing Timing of the task.
+ * @param afterSec Time the due time has to follow.
+ * @return uint32_t Due time phaseSec + n * periodSec, afterSec for a task without period.
+ */
+uint32_t periodicTaskNextDue(const PeriodicTaskTiming &timing, uint32_t afterSec)
+{
+  if (timing.periodSec == 0)
+  {
+    return afterSec;
+  }
+
+  uint32_t phase = timing.phaseSec % timing.periodSec;
+  if (afterSec < phase)
+  {
+    return phase;
+  }
+  return afterSec - (afterSec - phase) % timing.periodSec + timing.periodSec;
+}
+
+/**
+ * @brief Checks the stored due time of a task and recalculates it if it cannot be valid,
+ *        e.g. after the first boot, after the clock was set back or after the period was shortened.
+ * @param timing Timing of the task.
+ * @param dueSec Stored due time, updated if necessary.
+ * @param nowSec Current time.
+ */
+void periodicTaskCheckDue(const PeriodicTaskTiming &timing, uint32_t &dueSec, uint32_t nowSec)
+{
+  if (dueSec == 0 || (dueSec > nowSec && dueSec - nowSec > timing.periodSec))
+  {
+    dueSec = periodicTaskNextDue(timing, nowSec);
+  }
+}
+
+/**
+ * @brief Selects the tasks that run in this wake-up.
+ *        A task runs if it is due. If tasks run anyway, a task due within coalesceSec joins them
+ *        if its cost class is not higher than the highest class of the due tasks, so it does not
+ *        need a wake-up of its own.
+ * @param timings Timing per task.
+ * @param dueSec Due time per task.
+ * @param count Number of tasks.
+ * @param nowSec Current time.
+ * @param coalesceSec Time a task may run before its due time.
+ * @return uint32_t Bit n set = task n runs.
+ */
+uint32_t selectPeriodicTasks(const PeriodicTaskTiming *timings, const uint32_t *dueSec, uint8_t count, uint32_t nowSec, uint32_t coalesceSec)
+{
+  uint32_t taskMask = 0;
+  bool isAnyTaskDue = false;
+  TaskCostClass highestCost = TASK_COST_LOW;
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    if (timings[i].enabled && timings[i].periodSec > 0 && dueSec[i] <= nowSec)
+    {
+      taskMask |= 1u << i;
+      isAnyTaskDue = true;
+      highestCost = timings[i].cost > highestCost ? timings[i].cost : highestCost;
+    }
+  }
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    if (!timings[i].enabled || (taskMask & (1u << i)))
+    {
+      continue;
+    }
+
+    bool joins = isAnyTaskDue && timings[i].cost <= highestCost && dueSec[i] - nowSec <= coalesceSec;
+    if (timings[i].periodSec == 0 || joins)
+    {
+      taskMask |= 1u << i;
+    }
+  }
+  return taskMask;
+}
+
+/**
+ * @brief Sets the next due time of a task that has run. A task that ran early
+ *        because of coalescing keeps its grid and is due again one period later.
+ * @param timing Timing of the task.
+ * @param dueSec Due time of the task, updated.
+ * @param nowSec Current time.
+ */
+void completePeriodicTask(const PeriodicTaskTiming &timing, uint32_t &dueSec, uint32_t nowSec)
+{
+  dueSec = periodicTaskNextDue(timing, dueSec > nowSec ? dueSec : nowSec);
+}
+
+/**
+ * @brief Returns the time until the next task is due.
+ * @param timings Timing per task.
+ * @param dueSec Due time per task.
+ * @param count Number of tasks.
+ * @param nowSec Current time.
+ * @return uint32_t Time in seconds, 0 if a task is due, UINT32_MAX if no task has a period.
+ */
+uint32_t periodicTasksTimeUntilNext(const PeriodicTaskTiming *timings, const uint32_t *dueSec, uint8_t count, uint32_t nowSec)
+{
+  uint32_t shortestWaitTime = UINT32_MAX;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    if (!timings[i].enabled || timings[i].periodSec == 0)
+    {
+      continue;
+    }
+
+    uint32_t waitTime = dueSec[i] > nowSec ? dueSec[i] - nowSec : 0;
+    if (waitTime < shortestWaitTime)
+    {
+      shortestWaitTime = waitTime;
+    }
+  }
+  return shortestWaitTime;
+}
@@ -0,0 +1,43 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Due time calculation and wake-up coalescing for periodic tasks
+ */
+
+#ifndef PERIODICSCHEDULER_H
+#define PERIODICSCHEDULER_H
+
+#include <stdint.h>
+
+// Maximum number of periodic tasks, one bit per task in a task mask
+#define PERIODIC_TASK_CAPACITY 32
+
+// Energy cost of one task execution, a task may join a wake-up of a task with the same or a higher class
+enum TaskCostClass : uint8_t
+{
+  TASK_COST_LOW,    // Sensor access only
+  TASK_COST_MEDIUM, // SD card access
+  TASK_COST_HIGH,   // WiFi connection and MQTT transfer
+};
+
+// Timing of a periodic task, all times are in seconds of the DS3231 Unix time
+typedef struct
+{
+  uint32_t periodSec; // 0 = runs in every wake-up but never causes one
+  uint32_t phaseSec;  // Due times are phaseSec + n * periodSec
+  TaskCostClass cost;
+  bool enabled;
+} PeriodicTaskTiming;
+
+uint32_t periodicTaskNextDue(const PeriodicTaskTiming &timing, uint32_t afterSec);
+void periodicTaskCheckDue(const PeriodicTaskTiming &timing, uint32_t &dueSec, uint32_t nowSec);
+uint32_t selectPeriodicTasks(const PeriodicTaskTiming *timings, const uint32_t *dueSec, uint8_t count, uint32_t nowSec, uint32_t coalesceSec);
+void completePeriodicTask(const PeriodicTaskTiming &timing, uint32_t &dueSec, uint32_t nowSec);
+uint32_t periodicTasksTimeUntilNext(const PeriodicTaskTiming *timings, const uint32_t *dueSec, uint8_t count, uint32_t nowSec);
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Registry of the periodic tasks of the surface loop
+ */
+
+#include "DS3231TimeNtp.h"
+#include "DebuggingSDLog.h"
+#include "SystemVariables.h"
+#include "Utility.h"
+#include "periodicTasks.h"
+
+static uint32_t wetDetPeriode() { return configRTC.wet_det_periode; }
+static uint32_t statusUploadPeriode() { return configRTC.status_upload_periode; }
+static uint32_t configUpdatePeriode() { return configRTC.config_update_periode; }
+static uint32_t dataUploadRetryPeriode() { return configRTC.data_upload_retry_periode; }
+
+static bool isStatusUploadForced() { return rtcStatus.hasStatusUploadError; }
+static bool isConfigUpdateForced() { return rtcStatus.hasTransmissionUpdateError || askForConfigRequest; }
+static bool isDataUploadRetryForced() { return rtcStatus.hasMqttHeaderError || rtcStatus.hasMqttMeasurementError; }
+static bool isDataUploadRetryEnabled() { return rtcStatus.isDataUploadRetryEnabled; }
+static void disableDataUploadRetry() { rtcStatus.isDataUploadRetryEnabled = false; }
+
+// The tasks run in this order, a new task only needs an entry here
+static const PeriodicTask periodicTasks[] = {
+    {"wet detection", wetDetPeriode, 0, TASK_COST_LOW, nullptr, nullptr, wetDetPeriodeFunktion, nullptr},
+    {"status upload", statusUploadPeriode, 0, TASK_COST_HIGH, nullptr, isStatusUploadForced, statusUploadPeriodeFunktion, nullptr},
+    {"config update", configUpdatePeriode, 0, TASK_COST_HIGH, nullptr, isConfigUpdateForced, configUpdatePeriodeFunktion, nullptr},
+    {"data upload retry", dataUploadRetryPeriode, 0, TASK_COST_HIGH, isDataUploadRetryEnabled, isDataUploadRetryForced, dataUploadRetryPeriodeFunktion, disableDataUploadRetry},
+};
+
+#define PERIODIC_TASK_COUNT (sizeof(periodicTasks) / sizeof(periodicTasks[0]))
+static_assert(PERIODIC_TASK_COUNT <= PERIODIC_TASK_CAPACITY, "one bit per task in the task mask");
+
+RTC_DATA_ATTR uint32_t periodicTaskDue[PERIODIC_TASK_COUNT]; // Next due time per task (DS3231 Unix time)
+
+/**
+ * @brief Reads the current timing of all tasks and checks their stored due times.
+ * @param timings Destination for the timing per task.
+ * @param nowSec Current time.
+ */
+static void readPeriodicTaskTimings(PeriodicTaskTiming *timings, uint32_t nowSec)
+{
+  for (size_t i = 0; i < PERIODIC_TASK_COUNT; i++)
+  {
+    const PeriodicTask &task = periodicTasks[i];
+    timings[i].periodSec = task.period();
+    timings[i].phaseSec = task.phaseSec;
+    timings[i].cost = task.cost;
+    timings[i].enabled = task.isEnabled == nullptr || task.isEnabled();
+    periodicTaskCheckDue(timings[i], periodicTaskDue[i], nowSec);
+  }
+}
+
+/**
+ * @brief Runs the periodic tasks that are due, forced, or can join this wake-up (see selectPeriodicTasks).
+ */
+void runPeriodicTasks()
+{
+  uint32_t nowSec = getCurrentTimeFromRTC();
+  PeriodicTaskTiming timings[PERIODIC_TASK_COUNT];
+  readPeriodicTaskTimings(timings, nowSec);
+  uint32_t taskMask = selectPeriodicTasks(timings, periodicTaskDue, PERIODIC_TASK_COUNT, nowSec, periodicTaskCoalesceSec);
+
+  for (size_t i = 0; i < PERIODIC_TASK_COUNT; i++)
+  {
+    const PeriodicTask &task = periodicTasks[i];
+
+    // A task can be enabled by a task that ran before it in this wake-up
+    bool isEnabled = task.isEnabled == nullptr || task.isEnabled();
+    bool isDue = ((taskMask >> i) & 1u) || (isEnabled && periodicTaskDue[i] <= nowSec);
+    bool isForced = task.isForced != nullptr && task.isForced();
+
+    if (isDue || isForced)
+    {
+      Log(LogCategoryGeneral, LogLevelDEBUG, "periodic task: ", task.name);
+      task.run();
+      if (isDue)
+      {
+        completePeriodicTask(timings[i], periodicTaskDue[i], nowSec);
+      }
+    }
+    else if (task.notRun != nullptr)
+    {
+      task.notRun();
+    }
+  }
+}
+
+/**
+ * @brief Calculates the time until the next periodic task is due.
+ * @return uint32_t The shortest wait time in seconds, at most one day.
+ */
+uint32_t calculateShortestWaitTime()
+{
+  uint32_t nowSec = getCurrentTimeFromRTC();
+  PeriodicTaskTiming timings[PERIODIC_TASK_COUNT];
+  readPeriodicTaskTimings(timings, nowSec);
+
+  uint32_t shortestWaitTime = periodicTasksTimeUntilNext(timings, periodicTaskDue, PERIODIC_TASK_COUNT, nowSec);
+  return shortestWaitTime < 86400 ? shortestWaitTime : 86400;
+}
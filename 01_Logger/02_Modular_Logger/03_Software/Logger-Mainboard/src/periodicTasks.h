@@ -0,0 +1,35 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Registry of the periodic tasks of the surface loop
+ */
+
+#ifndef PERIODICTASKS_H
+#define PERIODICTASKS_H
+
+#include <Arduino.h>
+
+#include "periodicScheduler.h"
+
+// Entry of the periodic task registry
+typedef struct
+{
+  const char *name;
+  uint32_t (*period)();   // Period in seconds, read from the configuration on every wake-up
+  uint32_t phaseSec;      // Offset of the due times
+  TaskCostClass cost;     // Energy cost class of one execution
+  bool (*isEnabled)();    // nullptr = always enabled
+  bool (*isForced)();     // Runs the task in every wake-up, e.g. to retry after an error (nullptr = never)
+  void (*run)();          // Task function
+  void (*notRun)();       // Called in every wake-up the task does not run (nullptr = nothing)
+} PeriodicTask;
+
+void runPeriodicTasks();
+uint32_t calculateShortestWaitTime();
+
+#endif
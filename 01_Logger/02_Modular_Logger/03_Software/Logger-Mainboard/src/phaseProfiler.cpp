@@ -0,0 +1,149 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Histograms of the durations of the wake-up phases
+ */
+
+#include "phaseProfiler.h"
+
+#ifdef PHASE_PROFILER
+
+#include <ArduinoJson.h>
+
+RTC_DATA_ATTR PhaseHistogram phaseHistograms[PROFILE_PHASE_COUNT];
+
+/**
+ * @brief Returns the name of a phase, as used in the upload and the dump.
+ */
+static String phaseName(int phase)
+{
+  static const char *const names[PROFILE_PHASE_SENSOR] = {"boot", "i2c_init", "sd_mount", "config", "json", "sd_write", "sleep_entry"};
+  if (phase < PROFILE_PHASE_SENSOR)
+  {
+    return names[phase];
+  }
+  return "sensor_" + String(phase - PROFILE_PHASE_SENSOR);
+}
+
+/**
+ * @brief Adds a duration to the histogram of a phase.
+ * @param phase ProfilePhase, sensors beyond PHASE_PROFILER_SENSORS are ignored.
+ * @param durationUs Duration in microseconds.
+ */
+void phaseProfilerRecord(int phase, int64_t durationUs)
+{
+  if (phase < 0 || phase >= PROFILE_PHASE_COUNT || durationUs < 0)
+  {
+    return;
+  }
+
+  uint32_t durationMs = (uint32_t)(durationUs / 1000);
+  uint8_t bucket = 0;
+  while (bucket < PHASE_PROFILER_BUCKETS - 1 && durationMs >= (1u << bucket))
+  {
+    bucket++;
+  }
+
+  PhaseHistogram &histogram = phaseHistograms[phase];
+  if (histogram.buckets[bucket] < UINT16_MAX)
+  {
+    histogram.buckets[bucket]++;
+  }
+  histogram.totalMs += durationMs;
+  histogram.maxMs = max((uint32_t)histogram.maxMs, min(durationMs, (uint32_t)UINT16_MAX));
+}
+
+/**
+ * @brief Clears the histograms, after they were uploaded.
+ */
+void phaseProfilerClear()
+{
+  memset(phaseHistograms, 0, sizeof(phaseHistograms));
+}
+
+/**
+ * @brief Returns the number of recorded durations of a histogram.
+ */
+static uint32_t histogramCount(const PhaseHistogram &histogram)
+{
+  uint32_t count = 0;
+  for (int bucket = 0; bucket < PHASE_PROFILER_BUCKETS; bucket++)
+  {
+    count += histogram.buckets[bucket];
+  }
+  return count;
+}
+
+/**
+ * @brief Prints the histograms to the serial interface.
+ */
+void phaseProfilerDump()
+{
+  Serial.println("phase              n   mean ms    max ms  buckets (<1, <2, <4 ... <1024, >=1024 ms)");
+  for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++)
+  {
+    const PhaseHistogram &histogram = phaseHistograms[phase];
+    uint32_t count = histogramCount(histogram);
+    if (count == 0)
+    {
+      continue;
+    }
+
+    char line[160];
+    int length = snprintf(line, sizeof(line), "%-12s %7lu %9.1f %9u ", phaseName(phase).c_str(), (unsigned long)count,
+                          (float)histogram.totalMs / count, histogram.maxMs);
+    for (int bucket = 0; bucket < PHASE_PROFILER_BUCKETS && length < (int)sizeof(line); bucket++)
+    {
+      length += snprintf(line + length, sizeof(line) - length, " %u", histogram.buckets[bucket]);
+    }
+    Serial.println(line);
+  }
+}
+
+/**
+ * @brief Serializes the phases with durations as {"phase": [n, total ms, max ms, buckets...]},
+ *        zero buckets at the end are left out.
+ * @param payload Buffer for the JSON text.
+ * @param size Size of the buffer.
+ * @return size_t Length of the JSON text, 0 if nothing was recorded or the buffer is too small.
+ */
+size_t phaseProfilerToJson(char *payload, size_t size)
+{
+  DynamicJsonDocument doc(4096);
+  for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++)
+  {
+    const PhaseHistogram &histogram = phaseHistograms[phase];
+    uint32_t count = histogramCount(histogram);
+    if (count == 0)
+    {
+      continue;
+    }
+
+    JsonArray entry = doc.createNestedArray(phaseName(phase));
+    entry.add(count);
+    entry.add(histogram.totalMs);
+    entry.add(histogram.maxMs);
+    int used = PHASE_PROFILER_BUCKETS;
+    while (used > 0 && histogram.buckets[used - 1] == 0)
+    {
+      used--;
+    }
+    for (int bucket = 0; bucket < used; bucket++)
+    {
+      entry.add(histogram.buckets[bucket]);
+    }
+  }
+
+  if (doc.size() == 0 || doc.overflowed() || measureJson(doc) >= size)
+  {
+    return 0;
+  }
+  return serializeJson(doc, payload, size);
+}
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Histograms of the durations of the wake-up phases
+ */
+
+#ifndef PHASEPROFILER_H
+#define PHASEPROFILER_H
+
+#include <Arduino.h>
+
+// Compiled in with -D PHASE_PROFILER (build_flags in platformio.ini). Without it the macros
+// below expand to nothing, so the instrumented code has no overhead.
+//
+// Every phase has a histogram of power of two buckets in ms in the RTC memory:
+// bucket 0 < 1 ms, bucket b from 2^(b-1) ms to below 2^b ms, the last bucket from 1024 ms.
+// The histograms are published with the status upload (topic hyfive/profile) and cleared then.
+
+// Sensors with an own histogram, can be changed with -D PHASE_PROFILER_SENSORS=n
+#ifndef PHASE_PROFILER_SENSORS
+#define PHASE_PROFILER_SENSORS 8
+#endif
+
+#define PHASE_PROFILER_BUCKETS 12
+
+typedef enum
+{
+  PROFILE_PHASE_BOOT,        // Application start until the end of setup()
+  PROFILE_PHASE_I2C_INIT,    // Interface board, BMS and DS3231
+  PROFILE_PHASE_SD_MOUNT,    // SPI and SD card
+  PROFILE_PHASE_CONFIG,      // Configuration snapshot or JSON file
+  PROFILE_PHASE_JSON,        // Measurement JSON of a sample and its staging
+  PROFILE_PHASE_SD_WRITE,    // Flush of the staged samples
+  PROFILE_PHASE_SLEEP_ENTRY, // Sleep preparation until esp_deep_sleep_start
+  PROFILE_PHASE_SENSOR,      // First sensor, sensor n is PROFILE_PHASE_SENSOR + n
+  PROFILE_PHASE_COUNT = PROFILE_PHASE_SENSOR + PHASE_PROFILER_SENSORS
+} ProfilePhase;
+
+#ifdef PHASE_PROFILER
+
+typedef struct
+{
+  uint16_t buckets[PHASE_PROFILER_BUCKETS]; // Saturating counts
+  uint32_t totalMs;
+  uint16_t maxMs;
+} PhaseHistogram;
+
+void phaseProfilerRecord(int phase, int64_t durationUs);
+void phaseProfilerClear();
+void phaseProfilerDump();
+size_t phaseProfilerToJson(char *payload, size_t size);
+
+// Records the time until the end of the enclosing scope
+class PhaseProfilerScope
+{
+public:
+  explicit PhaseProfilerScope(int phase) : phase(phase), startUs(esp_timer_get_time()) {}
+  ~PhaseProfilerScope() { phaseProfilerRecord(phase, esp_timer_get_time() - startUs); }
+
+private:
+  int phase;
+  int64_t startUs;
+};
+
+#define PHASE_PROFILER_CONCAT2(a, b) a##b
+#define PHASE_PROFILER_CONCAT(a, b) PHASE_PROFILER_CONCAT2(a, b)
+#define PROFILE_SCOPE(phase) PhaseProfilerScope PHASE_PROFILER_CONCAT(phaseProfilerScope, __LINE__)(phase)
+#define PROFILE_START(name) int64_t name = esp_timer_get_time()
+#define PROFILE_STOP(phase, name) phaseProfilerRecord(phase, esp_timer_get_time() - (name))
+#define PROFILE_RECORD(phase, durationUs) phaseProfilerRecord(phase, durationUs)
+
+#else
+
+#define PROFILE_SCOPE(phase)
+#define PROFILE_START(name)
+#define PROFILE_STOP(phase, name)
+#define PROFILE_RECORD(phase, durationUs)
+
+#endif
+
+#endif
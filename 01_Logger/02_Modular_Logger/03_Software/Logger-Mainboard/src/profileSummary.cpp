@@ -0,0 +1,233 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Pressure-binned summary of a deployment for the quick-look
+ */
+
+#include <ArduinoJson.h>
+#include <SD.h>
+
+#include "DebuggingSDLog.h"
+#include "SystemVariables.h"
+#include "loggerConfig.h"
+#include "oceanography.h"
+#include "profileSummary.h"
+
+// Cell of bin b and sensor s: index b * sensorCount + s
+typedef struct
+{
+  float binSize;       // in dbar, doubled when the profile gets deeper than the bins
+  uint8_t sensorCount; // 0 = no summary for this deployment
+  uint8_t binCount;    // Number of bins that fit into the cells
+  float lastPressure;  // in dbar, of the latest sample with a pressure, NAN = none yet
+  uint16_t count[PROFILE_SUMMARY_CELLS];
+  float sum[PROFILE_SUMMARY_CELLS];
+  float minimum[PROFILE_SUMMARY_CELLS];
+  float maximum[PROFILE_SUMMARY_CELLS];
+} ProfileSummary;
+
+RTC_DATA_ATTR ProfileSummary profileSummary;
+
+/**
+ * @brief Empties the summary at the beginning of a deployment.
+ * @param sensorCount Number of sensors of the deployment.
+ */
+void resetProfileSummary(int sensorCount)
+{
+  memset(&profileSummary, 0, sizeof(profileSummary));
+  profileSummary.binSize = profileBinSize > 0 ? profileBinSize : 1.0f;
+  profileSummary.lastPressure = NAN;
+
+  if (sensorCount > 0 && PROFILE_SUMMARY_CELLS / sensorCount >= 2)
+  {
+    profileSummary.sensorCount = sensorCount;
+    profileSummary.binCount = min(PROFILE_SUMMARY_CELLS / sensorCount, 255);
+  }
+  else
+  {
+    Log(LogCategoryMeasurement, LogLevelERROR, "profile summary: not enough cells for sensors: ", String(sensorCount));
+  }
+}
+
+/**
+ * @brief Merges the cell source into the cell destination.
+ */
+static void mergeCell(int destination, int source)
+{
+  if (profileSummary.count[source] == 0)
+  {
+    return;
+  }
+  if (profileSummary.count[destination] == 0)
+  {
+    profileSummary.minimum[destination] = profileSummary.minimum[source];
+    profileSummary.maximum[destination] = profileSummary.maximum[source];
+  }
+  else
+  {
+    profileSummary.minimum[destination] = min(profileSummary.minimum[destination], profileSummary.minimum[source]);
+    profileSummary.maximum[destination] = max(profileSummary.maximum[destination], profileSummary.maximum[source]);
+  }
+  profileSummary.count[destination] += profileSummary.count[source];
+  profileSummary.sum[destination] += profileSummary.sum[source];
+}
+
+/**
+ * @brief Doubles the bin size: bins 2b and 2b + 1 become bin b.
+ */
+static void doubleBinSize()
+{
+  int sensors = profileSummary.sensorCount;
+  for (int bin = 0; bin < profileSummary.binCount; bin++)
+  {
+    for (int s = 0; s < sensors; s++)
+    {
+      int destination = (bin / 2) * sensors + s;
+      int source = bin * sensors + s;
+      if (destination != source)
+      {
+        if (bin % 2 == 0)
+        {
+          profileSummary.count[destination] = 0;
+          profileSummary.sum[destination] = 0;
+        }
+        mergeCell(destination, source);
+      }
+    }
+  }
+
+  int usedCells = (profileSummary.binCount + 1) / 2 * sensors;
+  memset(&profileSummary.count[usedCells], 0, (PROFILE_SUMMARY_CELLS - usedCells) * sizeof(profileSummary.count[0]));
+  profileSummary.binSize *= 2;
+  Log(LogCategoryMeasurement, LogLevelDEBUG, "profile summary bin size [dbar]: ", String(profileSummary.binSize));
+}
+
+/**
+ * @brief Adds the values of a sample to the bin of its pressure.
+ *        The pressure is taken from the cast detection sensor (absolute pressure in mbar). A sample
+ *        without a pressure, e.g. drained from an autonomous board, goes into the bin of the latest one.
+ *        Values with failed quality checks are left out, as is the whole sample if its pressure is not
+ *        finite or above PROFILE_MAX_PRESSURE_DBAR.
+ * @param measurementSuccessful Per sensor: the measurement was successful.
+ * @param sensorValue Per sensor: converted value.
+ * @param qcFlags Per sensor: QC_FLAG_* bits of the value.
+ * @param sensorCount Number of sensors.
+ */
+void addProfileSample(const bool *measurementSuccessful, const float *sensorValue, const uint8_t *qcFlags, int sensorCount)
+{
+  int sensors = profileSummary.sensorCount;
+  if (sensors == 0 || sensorCount != sensors)
+  {
+    return;
+  }
+
+  int pressureSensor = -1;
+  for (int i = 0; i < sensors; i++)
+  {
+    if (configRTC.sensor[i].sensor_id == configRTC.cast_det_sensor && measurementSuccessful[i] && qcFlags[i] == 0)
+    {
+      pressureSensor = i;
+      break;
+    }
+  }
+  float pressure = pressureSensor >= 0 ? seaPressureFromAbsolute(sensorValue[pressureSensor]) : profileSummary.lastPressure;
+  if (!isfinite(pressure) || pressure > PROFILE_MAX_PRESSURE_DBAR)
+  {
+    return;
+  }
+  profileSummary.lastPressure = pressure;
+  uint32_t bin = pressure > 0 ? (uint32_t)(pressure / profileSummary.binSize) : 0;
+  while (bin >= profileSummary.binCount)
+  {
+    doubleBinSize();
+    bin /= 2;
+  }
+
+  for (int s = 0; s < sensors; s++)
+  {
+    int cell = bin * sensors + s;
+    if (!measurementSuccessful[s] || qcFlags[s] != 0 || profileSummary.count[cell] == UINT16_MAX)
+    {
+      continue;
+    }
+    if (profileSummary.count[cell] == 0)
+    {
+      profileSummary.sum[cell] = 0;
+      profileSummary.minimum[cell] = sensorValue[s];
+      profileSummary.maximum[cell] = sensorValue[s];
+    }
+    profileSummary.count[cell]++;
+    profileSummary.sum[cell] += sensorValue[s];
+    profileSummary.minimum[cell] = min(profileSummary.minimum[cell], sensorValue[s]);
+    profileSummary.maximum[cell] = max(profileSummary.maximum[cell], sensorValue[s]);
+  }
+}
+
+/**
+ * @brief Writes the summary as JSON lines (one per bin) to /measurements/summary.json and empties it.
+ *        Each line holds the bin center pressure and per parameter the mean, minimum, maximum and count.
+ */
+void writeProfileSummary()
+{
+  int sensors = profileSummary.sensorCount;
+  if (sensors == 0)
+  {
+    return;
+  }
+
+  File file;
+  StaticJsonDocument<1024> doc;
+  int binsWritten = 0;
+
+  for (int bin = 0; bin < profileSummary.binCount; bin++)
+  {
+    doc.clear();
+    for (int s = 0; s < sensors; s++)
+    {
+      int cell = bin * sensors + s;
+      if (profileSummary.count[cell] == 0)
+      {
+        continue;
+      }
+      String parameter = sensorParameter(s);
+      doc[parameter] = String(profileSummary.sum[cell] / profileSummary.count[cell]);
+      doc[parameter + "_min"] = String(profileSummary.minimum[cell]);
+      doc[parameter + "_max"] = String(profileSummary.maximum[cell]);
+      doc[parameter + "_count"] = profileSummary.count[cell];
+    }
+    if (doc.isNull())
+    {
+      continue;
+    }
+
+    if (!file)
+    {
+      file = SD.open("/measurements/summary.json", FILE_APPEND);
+      if (!file)
+      {
+        Log(LogCategorySDCard, LogLevelERROR, "summary.json could not be opened");
+        return;
+      }
+    }
+
+    doc["logger_id"] = configRTC.logger_id;
+    doc["deployment_id"] = deployment_id;
+    doc["pressure"] = String((bin + 0.5f) * profileSummary.binSize); // Bin center in dbar
+    doc["bin_size"] = String(profileSummary.binSize);
+    serializeJson(doc, file);
+    file.println();
+    binsWritten++;
+  }
+
+  if (file)
+  {
+    file.close();
+  }
+  Log(LogCategoryMeasurement, LogLevelINFO, "profile summary bins written: ", String(binsWritten), " bin size [dbar]: ", String(profileSummary.binSize));
+  profileSummary.sensorCount = 0;
+}
@@ -0,0 +1,29 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Pressure-binned summary of a deployment for the quick-look
+ */
+
+#ifndef PROFILESUMMARY_H
+#define PROFILESUMMARY_H
+
+#include <Arduino.h>
+
+// Number of bin/sensor cells in the RTC memory, can be lowered with -D PROFILE_SUMMARY_CELLS=n
+#ifndef PROFILE_SUMMARY_CELLS
+#define PROFILE_SUMMARY_CELLS 64
+#endif
+
+// Sea pressure in dbar deeper than any ocean, a larger pressure is a sensor fault
+#define PROFILE_MAX_PRESSURE_DBAR 11000.0f
+
+void resetProfileSummary(int sensorCount);
+void addProfileSample(const bool *measurementSuccessful, const float *sensorValue, const uint8_t *qcFlags, int sensorCount);
+void writeProfileSummary();
+
+#endif
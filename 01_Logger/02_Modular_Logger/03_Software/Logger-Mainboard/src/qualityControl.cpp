@@ -0,0 +1,81 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Streaming quality control of the measured values
+ */
+
+#include <math.h>
+
+#include "qualityControl.h"
+
+/**
+ * @brief Resets the state, e.g. at the beginning of a deployment.
+ * @param state State of one sensor.
+ */
+void qcReset(QcState &state)
+{
+  state.reference = 0;
+  state.last = 0;
+  state.lastMs = 0;
+  state.spikeCount = 0;
+  state.valid = false;
+}
+
+/**
+ * @brief Checks a measured value against the rules of its sensor.
+ *        The spike check compares the value with the latest value that was not a spike, so a
+ *        single outlier does not flag the following values. After QC_SPIKE_MAX_COUNT spikes in a
+ *        row the value is accepted as new reference (a real step of the measured parameter).
+ * @param state State of the sensor, updated with the value.
+ * @param rule Rules of the sensor.
+ * @param value Measured value.
+ * @param timeMs Time of the measurement in ms.
+ * @return uint8_t QC_FLAG_* bits, 0 = all checks passed.
+ */
+uint8_t qcCheck(QcState &state, const QcRule &rule, float value, uint32_t timeMs)
+{
+  uint8_t flags = 0;
+
+  if (!isfinite(value) || (isfinite(rule.min) && value < rule.min) || (isfinite(rule.max) && value > rule.max))
+  {
+    flags |= QC_FLAG_RANGE;
+  }
+
+  if (state.valid)
+  {
+    if (rule.spike > 0 && fabsf(value - state.reference) > rule.spike && state.spikeCount < QC_SPIKE_MAX_COUNT)
+    {
+      flags |= QC_FLAG_SPIKE;
+    }
+
+    float seconds = (uint32_t)(timeMs - state.lastMs) / 1000.0f;
+    if (rule.gradient > 0 && seconds > 0 && fabsf(value - state.last) / seconds > rule.gradient)
+    {
+      flags |= QC_FLAG_GRADIENT;
+    }
+  }
+
+  if (flags & QC_FLAG_RANGE)
+  {
+    return flags; // An invalid value does not change the state
+  }
+
+  if (flags & QC_FLAG_SPIKE)
+  {
+    state.spikeCount++;
+  }
+  else
+  {
+    state.reference = value;
+    state.spikeCount = 0;
+  }
+  state.last = value;
+  state.lastMs = timeMs;
+  state.valid = true;
+  return flags;
+}
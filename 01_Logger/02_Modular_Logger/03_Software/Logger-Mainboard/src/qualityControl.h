@@ -0,0 +1,47 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Streaming quality control of the measured values
+ */
+
+#ifndef QUALITYCONTROL_H
+#define QUALITYCONTROL_H
+
+#include <stdint.h>
+
+// Quality flags of a measured value, 0 = all checks passed
+#define QC_FLAG_RANGE 0x01    // Outside of qc_min..qc_max
+#define QC_FLAG_SPIKE 0x02    // Differs by more than qc_spike from the reference value
+#define QC_FLAG_GRADIENT 0x04 // Changes faster than qc_gradient per second
+
+// Number of consecutive spike values after which a step is accepted as new reference
+#define QC_SPIKE_MAX_COUNT 2
+
+// Rules of one sensor from the logger configuration
+typedef struct
+{
+  float min;      // Lower bound, not checked if NAN (qc_min not set)
+  float max;      // Upper bound, not checked if NAN (qc_max not set)
+  float spike;    // Active if > 0, in sensor units
+  float gradient; // Active if > 0, in sensor units per second
+} QcRule;
+
+// State of one sensor kept between two measurements
+typedef struct
+{
+  float reference; // Latest value that was not flagged as spike
+  float last;      // Latest value
+  uint32_t lastMs; // Time of the latest value
+  uint8_t spikeCount;
+  bool valid;
+} QcState;
+
+void qcReset(QcState &state);
+uint8_t qcCheck(QcState &state, const QcRule &rule, float value, uint32_t timeMs);
+
+#endif
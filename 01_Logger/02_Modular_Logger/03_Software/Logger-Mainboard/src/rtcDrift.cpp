@@ -0,0 +1,98 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Drift model of the DS3231 between the NTP synchronisations
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "rtcDrift.h"
+
+/**
+ * @brief Clears the model, the next synchronisation only sets syncTime.
+ */
+void rtcDriftReset(RtcDriftModel &model)
+{
+  memset(&model, 0, sizeof(model));
+  model.uncertaintyPpm = RTC_DRIFT_PRIOR_PPM;
+}
+
+/**
+ * @brief Adds the offset measured at a synchronisation to the drift estimate.
+ * @param model Drift model.
+ * @param offsetSec RTC minus NTP time, measured before the RTC is set.
+ * @param ntpTime Unix time the RTC is set to.
+ */
+void rtcDriftSynchronized(RtcDriftModel &model, float offsetSec, uint32_t ntpTime)
+{
+  if (model.valid && ntpTime > model.syncTime)
+  {
+    float elapsedSec = (float)(ntpTime - model.syncTime);
+    float samplePpm = offsetSec / elapsedSec * 1e6f;
+    float sampleUncertaintyPpm = RTC_DRIFT_READ_RESOLUTION_SEC / elapsedSec * 1e6f;
+
+    if (fabsf(samplePpm) > RTC_DRIFT_OUTLIER_PPM)
+    {
+      rtcDriftReset(model); // The RTC was not running freely, start again
+    }
+    else if (sampleUncertaintyPpm < RTC_DRIFT_PRIOR_PPM) // Short intervals tell nothing about the drift
+    {
+      // Inverse variance weighting of the estimate and the sample
+      float estimateWeight = 1 / (model.uncertaintyPpm * model.uncertaintyPpm);
+      float sampleWeight = 1 / (sampleUncertaintyPpm * sampleUncertaintyPpm);
+      model.driftPpm = (model.driftPpm * estimateWeight + samplePpm * sampleWeight) / (estimateWeight + sampleWeight);
+      model.uncertaintyPpm = fmaxf(1 / sqrtf(estimateWeight + sampleWeight), RTC_DRIFT_MIN_UNCERTAINTY_PPM);
+      model.samples++;
+    }
+  }
+  else if (!model.valid)
+  {
+    rtcDriftReset(model);
+  }
+
+  model.lastOffsetSec = offsetSec;
+  model.syncTime = ntpTime;
+  model.valid = true;
+}
+
+/**
+ * @brief Corrects an RTC time with the estimated drift since the last synchronisation.
+ * @return uint32_t Corrected unix time, rtcTime without a model.
+ */
+uint32_t rtcDriftCorrect(const RtcDriftModel &model, uint32_t rtcTime)
+{
+  if (!model.valid || rtcTime <= model.syncTime)
+  {
+    return rtcTime;
+  }
+  float elapsedSec = (float)(rtcTime - model.syncTime);
+  return rtcTime - (int32_t)lroundf(elapsedSec * model.driftPpm * 1e-6f);
+}
+
+/**
+ * @brief Returns the predicted error of the corrected time.
+ * @return float Error in s, INFINITY without a synchronisation.
+ */
+float rtcDriftPredictedErrorSec(const RtcDriftModel &model, uint32_t rtcTime)
+{
+  if (!model.valid)
+  {
+    return INFINITY;
+  }
+  float elapsedSec = rtcTime > model.syncTime ? (float)(rtcTime - model.syncTime) : 0;
+  return elapsedSec * model.uncertaintyPpm * 1e-6f;
+}
+
+/**
+ * @brief Returns true if the predicted error exceeds the budget.
+ */
+bool rtcDriftIsSyncDue(const RtcDriftModel &model, uint32_t rtcTime, float budgetSec)
+{
+  return rtcDriftPredictedErrorSec(model, rtcTime) > budgetSec;
+}
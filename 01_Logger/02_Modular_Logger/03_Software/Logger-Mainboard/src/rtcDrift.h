@@ -0,0 +1,45 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Drift model of the DS3231 between the NTP synchronisations
+ */
+
+#ifndef RTCDRIFT_H
+#define RTCDRIFT_H
+
+#include <stdint.h>
+
+// At every NTP synchronisation the offset of the RTC (RTC minus NTP) is measured before the
+// RTC is set. Divided by the time since the previous synchronisation it gives a drift sample,
+// the samples are combined weighted by their resolution. Between the synchronisations the RTC
+// time is corrected with the estimated drift, the uncertainty of the drift gives the predicted
+// error, and a synchronisation is due when it exceeds the error budget. No Arduino dependency,
+// tools/rtcDriftSimulation.cpp links the same module.
+
+#define RTC_DRIFT_PRIOR_PPM 5.0f           // Uncertainty without a drift sample (DS3231M: +-5 ppm)
+#define RTC_DRIFT_MIN_UNCERTAINTY_PPM 1.0f // Floor, the drift changes with the temperature and the aging
+#define RTC_DRIFT_OUTLIER_PPM 100.0f       // Larger samples are no drift (RTC battery, manual setting)
+#define RTC_DRIFT_READ_RESOLUTION_SEC 0.5f // The RTC is read in whole seconds
+
+typedef struct
+{
+  uint32_t syncTime;    // Unix time the RTC was set to at the last synchronisation
+  float driftPpm;       // Estimated drift, > 0 = the RTC runs fast
+  float uncertaintyPpm; // Uncertainty of driftPpm
+  float lastOffsetSec;  // RTC minus NTP measured at the last synchronisation
+  uint16_t samples;     // Drift samples since the reset
+  bool valid;           // syncTime is set
+} RtcDriftModel;
+
+void rtcDriftReset(RtcDriftModel &model);
+void rtcDriftSynchronized(RtcDriftModel &model, float offsetSec, uint32_t ntpTime);
+uint32_t rtcDriftCorrect(const RtcDriftModel &model, uint32_t rtcTime);
+float rtcDriftPredictedErrorSec(const RtcDriftModel &model, uint32_t rtcTime);
+bool rtcDriftIsSyncDue(const RtcDriftModel &model, uint32_t rtcTime, float budgetSec);
+
+#endif
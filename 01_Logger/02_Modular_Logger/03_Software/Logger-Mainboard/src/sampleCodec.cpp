@@ -0,0 +1,386 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Delta encoding of measurement samples (quantised zig-zag varint deltas with keyframes)
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "sampleCodec.h"
+
+static const char base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static uint32_t floatBits(float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static float bitsFloat(uint32_t bits)
+{
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+/**
+ * @brief Quantises a value to its resolution, INT32_MIN stands for a value that is not finite.
+ */
+static int32_t quantise(float value, float resolution)
+{
+  if (!(resolution > 0))
+  {
+    return (int32_t)floatBits(value);
+  }
+  if (!isfinite(value))
+  {
+    return INT32_MIN;
+  }
+
+  float steps = roundf(value / resolution);
+  if (steps >= 2147483520.0f) // Largest float below 2^31
+  {
+    return INT32_MAX;
+  }
+  if (steps <= -2147483520.0f)
+  {
+    return INT32_MIN + 1;
+  }
+  return (int32_t)steps;
+}
+
+static float dequantise(int32_t steps, float resolution)
+{
+  if (!(resolution > 0))
+  {
+    return bitsFloat((uint32_t)steps);
+  }
+  return steps == INT32_MIN ? NAN : steps * resolution;
+}
+
+static uint32_t zigZag(int32_t value)
+{
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unZigZag(uint32_t value)
+{
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// Difference a - b with wrap-around, so every pair of int32 values has a delta
+static int32_t delta(int32_t a, int32_t b)
+{
+  return (int32_t)((uint32_t)a - (uint32_t)b);
+}
+
+static size_t writeVarint(uint8_t *out, uint32_t value)
+{
+  size_t n = 0;
+  while (value >= 0x80)
+  {
+    out[n++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[n++] = (uint8_t)value;
+  return n;
+}
+
+static bool readVarint(const uint8_t *data, size_t size, size_t &offset, uint32_t &value)
+{
+  value = 0;
+  for (int shift = 0; shift < 35; shift += 7)
+  {
+    if (offset >= size)
+    {
+      return false;
+    }
+    uint8_t byte = data[offset++];
+    value |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+    {
+      return true;
+    }
+  }
+  return false; // More than 5 bytes
+}
+
+/**
+ * @brief Resets the encoder, the next record is a keyframe.
+ * @param state Encoder state.
+ */
+void sampleCodecReset(SampleCodecState &state)
+{
+  memset(&state, 0, sizeof(state));
+}
+
+/**
+ * @brief Encodes a sample as one record.
+ * @param state Encoder state, only updated if the record fits into out.
+ * @param sample Sample to encode; sensors above SAMPLE_CODEC_MAX_SENSORS are ignored.
+ * @param resolution Per sensor: resolution of the value, <= 0 codes the value lossless.
+ * @param keyframeInterval Number of records from one keyframe to the next.
+ * @param out Buffer for the record.
+ * @param capacity Free bytes in out.
+ * @return size_t Size of the record, 0 if it does not fit into out.
+ */
+size_t sampleCodecEncode(SampleCodecState &state, const CodecSample &sample, const float *resolution, uint16_t keyframeInterval, uint8_t *out, size_t capacity)
+{
+  uint8_t record[SAMPLE_CODEC_MAX_RECORD_SIZE];
+  bool keyframe = state.samplesSinceKeyframe == 0 || state.samplesSinceKeyframe >= keyframeInterval;
+  uint32_t present = sample.sensorMask;
+  uint32_t absolute = keyframe ? present : present & ~state.knownMask;
+
+  uint8_t flags = keyframe ? SAMPLE_CODEC_KEYFRAME : 0;
+  for (int i = 0; i < SAMPLE_CODEC_MAX_SENSORS; i++)
+  {
+    if ((present >> i & 1) && sample.qc[i] != 0)
+    {
+      flags |= SAMPLE_CODEC_QC;
+    }
+  }
+  if (!keyframe && absolute != 0)
+  {
+    flags |= SAMPLE_CODEC_ABSOLUTE;
+  }
+
+  size_t n = 0;
+  record[n++] = flags;
+  n += writeVarint(record + n, keyframe ? sample.time : zigZag(delta((int32_t)sample.time, (int32_t)state.time)));
+  n += writeVarint(record + n, present);
+  if (flags & SAMPLE_CODEC_ABSOLUTE)
+  {
+    n += writeVarint(record + n, absolute);
+  }
+
+  int32_t value[SAMPLE_CODEC_MAX_SENSORS];
+  int32_t raw[SAMPLE_CODEC_MAX_SENSORS];
+  for (int i = 0; i < SAMPLE_CODEC_MAX_SENSORS; i++)
+  {
+    if (!(present >> i & 1))
+    {
+      continue;
+    }
+    value[i] = quantise(sample.value[i], resolution[i]);
+    raw[i] = (int32_t)floatBits(sample.raw[i]);
+
+    if (absolute >> i & 1)
+    {
+      uint32_t bits = floatBits(resolution[i]);
+      for (int b = 0; b < 4; b++)
+      {
+        record[n++] = (uint8_t)(bits >> (8 * b));
+      }
+      n += writeVarint(record + n, zigZag(value[i]));
+      n += writeVarint(record + n, zigZag(raw[i]));
+    }
+    else
+    {
+      n += writeVarint(record + n, zigZag(delta(value[i], state.value[i])));
+      n += writeVarint(record + n, zigZag(delta(raw[i], state.raw[i])));
+    }
+  }
+
+  if (flags & SAMPLE_CODEC_QC)
+  {
+    for (int i = 0; i < SAMPLE_CODEC_MAX_SENSORS; i++)
+    {
+      if (present >> i & 1)
+      {
+        record[n++] = sample.qc[i];
+      }
+    }
+  }
+
+  if (n > capacity)
+  {
+    return 0;
+  }
+  memcpy(out, record, n);
+
+  for (int i = 0; i < SAMPLE_CODEC_MAX_SENSORS; i++)
+  {
+    if (present >> i & 1)
+    {
+      state.value[i] = value[i];
+      state.raw[i] = raw[i];
+    }
+  }
+  state.time = sample.time;
+  state.knownMask = keyframe ? present : state.knownMask | present;
+  state.samplesSinceKeyframe = keyframe ? 1 : state.samplesSinceKeyframe + 1;
+  return n;
+}
+
+/**
+ * @brief Resets the decoder, it skips records until the next keyframe.
+ * @param decoder Decoder state.
+ */
+void sampleCodecDecoderReset(SampleCodecDecoder &decoder)
+{
+  memset(&decoder, 0, sizeof(decoder));
+}
+
+/**
+ * @brief Decodes one record.
+ * @param decoder Decoder state.
+ * @param data Encoded records.
+ * @param size Number of bytes in data.
+ * @param sample Decoded sample, valid if decoded is true.
+ * @param decoded False for records before the first keyframe.
+ * @return int Size of the record, 0 at the end of data, -1 if the record is damaged.
+ */
+int sampleCodecDecode(SampleCodecDecoder &decoder, const uint8_t *data, size_t size, CodecSample &sample, bool &decoded)
+{
+  decoded = false;
+  if (size == 0)
+  {
+    return 0;
+  }
+
+  size_t offset = 0;
+  uint8_t flags = data[offset++];
+  bool keyframe = flags & SAMPLE_CODEC_KEYFRAME;
+  uint32_t time, present, absolute = 0;
+  if (!readVarint(data, size, offset, time) || !readVarint(data, size, offset, present) ||
+      ((flags & SAMPLE_CODEC_ABSOLUTE) && !readVarint(data, size, offset, absolute)))
+  {
+    return -1;
+  }
+  if (keyframe)
+  {
+    absolute = present;
+    decoder.synchronized = true;
+    decoder.previous.knownMask = 0;
+  }
+  bool usable = decoder.synchronized && (present & ~absolute & ~decoder.previous.knownMask) == 0;
+
+  memset(&sample, 0, sizeof(sample));
+  sample.time = keyframe ? time : decoder.previous.time + (uint32_t)unZigZag(time);
+  sample.sensorMask = present;
+
+  for (int i = 0; i < SAMPLE_CODEC_MAX_SENSORS; i++)
+  {
+    if (!(present >> i & 1))
+    {
+      continue;
+    }
+
+    uint32_t value, raw;
+    if (absolute >> i & 1)
+    {
+      if (offset + 4 > size)
+      {
+        return -1;
+      }
+      uint32_t bits = 0;
+      for (int b = 0; b < 4; b++)
+      {
+        bits |= (uint32_t)data[offset++] << (8 * b);
+      }
+      if (!readVarint(data, size, offset, value) || !readVarint(data, size, offset, raw))
+      {
+        return -1;
+      }
+      decoder.resolution[i] = bitsFloat(bits);
+      decoder.previous.value[i] = unZigZag(value);
+      decoder.previous.raw[i] = unZigZag(raw);
+    }
+    else
+    {
+      if (!readVarint(data, size, offset, value) || !readVarint(data, size, offset, raw))
+      {
+        return -1;
+      }
+      decoder.previous.value[i] = (int32_t)((uint32_t)decoder.previous.value[i] + (uint32_t)unZigZag(value));
+      decoder.previous.raw[i] = (int32_t)((uint32_t)decoder.previous.raw[i] + (uint32_t)unZigZag(raw));
+    }
+    sample.value[i] = dequantise(decoder.previous.value[i], decoder.resolution[i]);
+    sample.raw[i] = bitsFloat((uint32_t)decoder.previous.raw[i]);
+  }
+
+  if (flags & SAMPLE_CODEC_QC)
+  {
+    for (int i = 0; i < SAMPLE_CODEC_MAX_SENSORS; i++)
+    {
+      if (present >> i & 1)
+      {
+        if (offset >= size)
+        {
+          return -1;
+        }
+        sample.qc[i] = data[offset++];
+      }
+    }
+  }
+
+  decoder.previous.time = sample.time;
+  decoder.previous.knownMask |= present;
+  decoded = usable;
+  return (int)offset;
+}
+
+/**
+ * @brief Encodes bytes as base64 text (RFC 4648) with a terminating zero.
+ * @return size_t Length of the text, 0 if it does not fit into out.
+ */
+size_t sampleCodecBase64Encode(const uint8_t *data, size_t size, char *out, size_t capacity)
+{
+  size_t length = (size + 2) / 3 * 4;
+  if (length + 1 > capacity)
+  {
+    return 0;
+  }
+
+  size_t n = 0;
+  for (size_t i = 0; i < size; i += 3)
+  {
+    uint32_t block = (uint32_t)data[i] << 16;
+    block |= i + 1 < size ? (uint32_t)data[i + 1] << 8 : 0;
+    block |= i + 2 < size ? data[i + 2] : 0;
+    out[n++] = base64Alphabet[block >> 18 & 0x3F];
+    out[n++] = base64Alphabet[block >> 12 & 0x3F];
+    out[n++] = i + 1 < size ? base64Alphabet[block >> 6 & 0x3F] : '=';
+    out[n++] = i + 2 < size ? base64Alphabet[block & 0x3F] : '=';
+  }
+  out[n] = '\0';
+  return n;
+}
+
+/**
+ * @brief Decodes base64 text (RFC 4648), characters outside of the alphabet are skipped.
+ * @return size_t Number of decoded bytes, 0 if they do not fit into out.
+ */
+size_t sampleCodecBase64Decode(const char *text, size_t length, uint8_t *out, size_t capacity)
+{
+  uint32_t block = 0;
+  int bits = 0;
+  size_t n = 0;
+  for (size_t i = 0; i < length && text[i] != '='; i++)
+  {
+    const char *position = (const char *)memchr(base64Alphabet, text[i], 64);
+    if (!position)
+    {
+      continue;
+    }
+    block = block << 6 | (uint32_t)(position - base64Alphabet);
+    bits += 6;
+    if (bits >= 8)
+    {
+      bits -= 8;
+      if (n >= capacity)
+      {
+        return 0;
+      }
+      out[n++] = (uint8_t)(block >> bits);
+    }
+  }
+  return n;
+}
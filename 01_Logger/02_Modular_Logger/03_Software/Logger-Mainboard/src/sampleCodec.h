@@ -0,0 +1,79 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Delta encoding of measurement samples (quantised zig-zag varint deltas with keyframes)
+ */
+
+#ifndef SAMPLECODEC_H
+#define SAMPLECODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The codec has no Arduino dependency, so the deck box links the same decoder (tools/sampleCodecTool.cpp).
+//
+// A stream is a sequence of records, one per sample:
+//   flags         1 byte, SAMPLE_CODEC_KEYFRAME | SAMPLE_CODEC_QC | SAMPLE_CODEC_ABSOLUTE
+//   time          varint: unix time in a keyframe, otherwise zig-zag delta to the previous record
+//   present mask  varint, bit n = sensor n was measured
+//   absolute mask varint, only with SAMPLE_CODEC_ABSOLUTE (a keyframe codes all sensors absolute)
+//   per present sensor, in ascending order:
+//     absolute: resolution (float, 4 bytes little endian), zig-zag varint value, zig-zag varint raw
+//     delta:    zig-zag varint value delta, zig-zag varint raw delta
+//   per present sensor a QC_FLAG_* byte, only with SAMPLE_CODEC_QC
+// The value is quantised to round(value / resolution); with a resolution <= 0 the bit pattern of the
+// float is coded instead (lossless, like the raw value). Every record can be parsed without the
+// previous records, so a decoder can start at any keyframe.
+
+#define SAMPLE_CODEC_VERSION 1
+#define SAMPLE_CODEC_MAX_SENSORS 32
+
+#define SAMPLE_CODEC_KEYFRAME 0x01 // All sensors are coded absolute, the decoder can start here
+#define SAMPLE_CODEC_QC 0x02       // QC bytes follow the values
+#define SAMPLE_CODEC_ABSOLUTE 0x04 // Some sensors are coded absolute, the absolute mask follows
+
+// Largest record: flags, 3 varints and per sensor resolution, 2 varints and the QC byte
+#define SAMPLE_CODEC_MAX_RECORD_SIZE (1 + 3 * 5 + SAMPLE_CODEC_MAX_SENSORS * (4 + 2 * 5 + 1))
+
+typedef struct
+{
+  uint32_t time;
+  uint32_t sensorMask; // Bit n = sensor n is present
+  float value[SAMPLE_CODEC_MAX_SENSORS];
+  float raw[SAMPLE_CODEC_MAX_SENSORS];
+  uint8_t qc[SAMPLE_CODEC_MAX_SENSORS];
+} CodecSample;
+
+// Encoder state kept between two records
+typedef struct
+{
+  int32_t value[SAMPLE_CODEC_MAX_SENSORS]; // Previous quantised value
+  int32_t raw[SAMPLE_CODEC_MAX_SENSORS];   // Previous bit pattern of the raw value
+  uint32_t time;
+  uint32_t knownMask;            // Sensors with a previous value since the latest keyframe
+  uint16_t samplesSinceKeyframe; // 0 = the next record is a keyframe
+} SampleCodecState;
+
+// Decoder state, the resolutions come with the absolute values
+typedef struct
+{
+  SampleCodecState previous;
+  float resolution[SAMPLE_CODEC_MAX_SENSORS];
+  bool synchronized; // A keyframe was decoded
+} SampleCodecDecoder;
+
+void sampleCodecReset(SampleCodecState &state);
+size_t sampleCodecEncode(SampleCodecState &state, const CodecSample &sample, const float *resolution, uint16_t keyframeInterval, uint8_t *out, size_t capacity);
+
+void sampleCodecDecoderReset(SampleCodecDecoder &decoder);
+int sampleCodecDecode(SampleCodecDecoder &decoder, const uint8_t *data, size_t size, CodecSample &sample, bool &decoded);
+
+size_t sampleCodecBase64Encode(const uint8_t *data, size_t size, char *out, size_t capacity);
+size_t sampleCodecBase64Decode(const char *text, size_t length, uint8_t *out, size_t capacity);
+
+#endif
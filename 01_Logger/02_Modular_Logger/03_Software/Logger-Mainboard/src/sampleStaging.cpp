@@ -0,0 +1,386 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Staging of measurement samples in the RTC memory
+ */
+
+#include <ArduinoJson.h>
+#include <SD.h>
+#include <esp_rom_crc.h>
+#include <esp_system.h>
+
+#include "DS3231TimeNtp.h"
+#include "DebuggingSDLog.h"
+#include "DeepSleep.h"
+#include "SystemVariables.h"
+#include "cpuClock.h"
+#include "loggerConfig.h"
+#include "phaseProfiler.h"
+#include "sampleCodec.h"
+#include "sampleStaging.h"
+
+#define SAMPLE_STAGE_MAGIC 0x53535447 // "SSTG"
+
+// A staged sample is a StagedSampleHeader followed by count StagedSensorValue records
+typedef struct __attribute__((packed))
+{
+  uint32_t time; // Unix time from the DS3231
+  uint8_t count; // Number of successful measured sensors
+} StagedSampleHeader;
+
+typedef struct __attribute__((packed))
+{
+  uint8_t sensorNumber;
+  float value;
+  float raw;
+  uint8_t qc; // QC_FLAG_* bits
+} StagedSensorValue;
+
+typedef struct
+{
+  uint32_t magic;
+  uint32_t crc; // CRC32 over data[0..used]
+  uint16_t used;
+  uint16_t samples;
+  bool writeThrough; // Brown-out policy: every sample is written directly
+  uint32_t dropped;  // Samples discarded because the buffer was full and could not be written
+  uint8_t data[SAMPLE_STAGE_SIZE];
+} SampleStage;
+
+RTC_DATA_ATTR SampleStage sampleStage;
+RTC_DATA_ATTR SampleCodecState sampleCodecState; // Encoder of measurement_delta.json, continues across flushes
+
+// Encoded bytes per line of measurement_delta.json, the base64 text and the keys fit into one MQTT message
+#define SAMPLE_CODEC_LINE_SIZE 600
+static_assert(SAMPLE_CODEC_MAX_RECORD_SIZE <= SAMPLE_CODEC_LINE_SIZE, "a line must hold at least one record");
+
+// Largest possible staged sample, the buffer is flushed if less space is left
+static const size_t maxStagedSampleSize = sizeof(StagedSampleHeader) + MAX_SENSOR_CREDENTIALS * sizeof(StagedSensorValue);
+static_assert(maxStagedSampleSize <= SAMPLE_STAGE_SIZE, "SAMPLE_STAGE_SIZE must hold at least one sample");
+
+/**
+ * @brief Checks the staging buffer after a wake-up.
+ *        A buffer corrupted by a brown-out is discarded, and after a brown-out every sample
+ *        is written directly, so at most SAMPLE_STAGE_FLUSH_COUNT samples can be lost once.
+ */
+static void validateSampleStage()
+{
+  static bool validated = false;
+  if (validated)
+  {
+    return;
+  }
+  validated = true;
+
+  bool valid = sampleStage.magic == SAMPLE_STAGE_MAGIC && sampleStage.used <= SAMPLE_STAGE_SIZE &&
+               esp_rom_crc32_le(0, sampleStage.data, sampleStage.used) == sampleStage.crc;
+  if (!valid)
+  {
+    if (sampleStage.magic == SAMPLE_STAGE_MAGIC)
+    {
+      Log(LogCategoryMeasurement, LogLevelERROR, "staged samples corrupted, discarded: ", String(sampleStage.samples));
+    }
+    memset(&sampleStage, 0, sizeof(sampleStage) - sizeof(sampleStage.data));
+    sampleStage.magic = SAMPLE_STAGE_MAGIC;
+    sampleStage.crc = esp_rom_crc32_le(0, sampleStage.data, 0);
+    sampleCodecReset(sampleCodecState);
+  }
+
+  if (esp_reset_reason() == ESP_RST_BROWNOUT && !sampleStage.writeThrough)
+  {
+    Log(LogCategoryMeasurement, LogLevelERROR, "brown-out reset, staged samples are written directly");
+    sampleStage.writeThrough = true;
+    sampleCodecReset(sampleCodecState); // The encoder state may be damaged as well
+  }
+}
+
+/**
+ * @brief Discards the oldest staged samples until a number of bytes is free.
+ *        Only used if the buffer is full and could not be written to the SD card.
+ * @param sampleSize Number of bytes that must be free.
+ */
+static void dropOldestStagedSamples(size_t sampleSize)
+{
+  size_t offset = 0;
+  uint16_t droppedSamples = 0;
+  while (offset + sizeof(StagedSampleHeader) <= sampleStage.used && sampleStage.used - offset + sampleSize > SAMPLE_STAGE_SIZE)
+  {
+    StagedSampleHeader header;
+    memcpy(&header, sampleStage.data + offset, sizeof(header));
+    offset += sizeof(header) + header.count * sizeof(StagedSensorValue);
+    droppedSamples++;
+  }
+  offset = std::min<size_t>(offset, sampleStage.used);
+
+  memmove(sampleStage.data, sampleStage.data + offset, sampleStage.used - offset);
+  sampleStage.used -= offset;
+  sampleStage.samples = droppedSamples < sampleStage.samples ? sampleStage.samples - droppedSamples : 0;
+  sampleStage.crc = esp_rom_crc32_le(0, sampleStage.data, sampleStage.used);
+  sampleStage.dropped += droppedSamples;
+
+  // Write every further sample directly, so no more samples pile up in the buffer
+  sampleStage.writeThrough = true;
+  Log(LogCategoryMeasurement, LogLevelERROR, "staging buffer full and not written, oldest samples dropped: ", String(droppedSamples),
+      " total: ", String(sampleStage.dropped));
+}
+
+/**
+ * @brief Stores a sample as binary record in the RTC memory.
+ *        The buffer is written to the SD card every SAMPLE_STAGE_FLUSH_COUNT samples, when it is nearly full,
+ *        and after every sample if a brown-out occurred or the battery is empty. If the buffer is full and
+ *        cannot be written, the oldest samples are dropped and every further sample is written directly.
+ * @param time Unix time of the sample.
+ * @param measurementSuccessful Per sensor: the measurement was successful.
+ * @param sensorValue Per sensor: converted value.
+ * @param sensorValueRaw Per sensor: raw value.
+ * @param qcFlags Per sensor: QC_FLAG_* bits of the value.
+ * @param sensorCount Number of sensors.
+ */
+void stageMeasurementSample(uint32_t time, const bool *measurementSuccessful, const float *sensorValue, const float *sensorValueRaw, const uint8_t *qcFlags, int sensorCount)
+{
+  validateSampleStage();
+
+  StagedSampleHeader header = {time, 0};
+  for (int i = 0; i < sensorCount; i++)
+  {
+    if (measurementSuccessful[i])
+    {
+      header.count++;
+    }
+  }
+
+  if (header.count == 0)
+  {
+    return;
+  }
+
+  size_t sampleSize = sizeof(header) + header.count * sizeof(StagedSensorValue);
+  if (sampleStage.used + sampleSize > SAMPLE_STAGE_SIZE)
+  {
+    flushStagedSamples();
+  }
+  if (sampleStage.used + sampleSize > SAMPLE_STAGE_SIZE)
+  {
+    dropOldestStagedSamples(sampleSize); // The SD card could not be written
+  }
+
+  uint8_t *record = sampleStage.data + sampleStage.used;
+  memcpy(record, &header, sizeof(header));
+  record += sizeof(header);
+  for (int i = 0; i < sensorCount; i++)
+  {
+    if (measurementSuccessful[i])
+    {
+      StagedSensorValue sensor = {(uint8_t)i, sensorValue[i], sensorValueRaw[i], qcFlags[i]};
+      memcpy(record, &sensor, sizeof(sensor));
+      record += sizeof(sensor);
+    }
+  }
+
+  sampleStage.crc = esp_rom_crc32_le(sampleStage.crc, sampleStage.data + sampleStage.used, sampleSize);
+  sampleStage.used += sampleSize;
+  sampleStage.samples++;
+
+  if (sampleStage.samples >= SAMPLE_STAGE_FLUSH_COUNT || (size_t)(SAMPLE_STAGE_SIZE - sampleStage.used) < maxStagedSampleSize ||
+      sampleStage.writeThrough || rtcStatus.batteryEmpty)
+  {
+    flushStagedSamples();
+  }
+}
+
+/**
+ * @brief Writes one line of encoded records to measurement_delta.json.
+ */
+static void writeEncodedLine(File &file, const uint8_t *records, size_t size, int samples)
+{
+  char text[(SAMPLE_CODEC_LINE_SIZE + 2) / 3 * 4 + 1];
+  sampleCodecBase64Encode(records, size, text, sizeof(text));
+
+  StaticJsonDocument<256> doc;
+  doc["logger_id"] = configRTC.logger_id;
+  doc["deployment_id"] = deployment_id;
+  doc["codec"] = SAMPLE_CODEC_VERSION;
+  doc["samples"] = samples;
+  doc["data"] = (const char *)text;
+  serializeJson(doc, file);
+  file.println();
+}
+
+/**
+ * @brief Writes all staged samples delta encoded (see sampleCodec.h) to /measurements/measurement_delta.json.
+ *        Each line holds the base64 text of up to SAMPLE_CODEC_LINE_SIZE bytes of records; the encoder
+ *        continues across lines, so a reader decodes the lines in order from a keyframe on.
+ * @return bool True if the samples were written.
+ */
+static bool writeEncodedSamples()
+{
+  File file = SD.open("/measurements/measurement_delta.json", FILE_APPEND);
+  if (!file)
+  {
+    Log(LogCategorySDCard, LogLevelERROR, "measurement_delta.json could not be opened, staged samples kept: ", String(sampleStage.samples));
+    return false;
+  }
+
+  float resolution[SAMPLE_CODEC_MAX_SENSORS];
+  for (int i = 0; i < SAMPLE_CODEC_MAX_SENSORS; i++)
+  {
+    resolution[i] = i < MAX_SENSOR_CREDENTIALS ? configRTC.sensor[i].resolution : 0;
+  }
+
+  uint8_t records[SAMPLE_CODEC_LINE_SIZE];
+  size_t used = 0;
+  int lineSamples = 0;
+  size_t offset = 0;
+  while (offset + sizeof(StagedSampleHeader) <= sampleStage.used)
+  {
+    StagedSampleHeader header;
+    memcpy(&header, sampleStage.data + offset, sizeof(header));
+    offset += sizeof(header);
+
+    CodecSample sample = {};
+    sample.time = header.time;
+    for (uint8_t n = 0; n < header.count && offset + sizeof(StagedSensorValue) <= sampleStage.used; n++)
+    {
+      StagedSensorValue sensor;
+      memcpy(&sensor, sampleStage.data + offset, sizeof(sensor));
+      offset += sizeof(sensor);
+      if (sensor.sensorNumber < SAMPLE_CODEC_MAX_SENSORS)
+      {
+        sample.sensorMask |= 1UL << sensor.sensorNumber;
+        sample.value[sensor.sensorNumber] = sensor.value;
+        sample.raw[sensor.sensorNumber] = sensor.raw;
+        sample.qc[sensor.sensorNumber] = sensor.qc;
+      }
+    }
+
+    size_t size = sampleCodecEncode(sampleCodecState, sample, resolution, sampleCodecKeyframeInterval, records + used, sizeof(records) - used);
+    if (size == 0)
+    {
+      writeEncodedLine(file, records, used, lineSamples);
+      used = 0;
+      lineSamples = 0;
+      size = sampleCodecEncode(sampleCodecState, sample, resolution, sampleCodecKeyframeInterval, records, sizeof(records));
+    }
+    used += size;
+    lineSamples++;
+  }
+
+  if (lineSamples > 0)
+  {
+    writeEncodedLine(file, records, used, lineSamples);
+  }
+  file.close();
+  return true;
+}
+
+/**
+ * @brief Writes all staged samples as JSON lines to /measurements/measurement.json and empties the buffer.
+ *        Values with failed quality checks get a "<parameter>_qc" key, every sample a combined "qc" key.
+ *        With deltaEncodedSamples the samples go delta encoded to measurement_delta.json instead.
+ */
+static void writeStagedSamples()
+{
+  if (deltaEncodedSamples)
+  {
+    if (writeEncodedSamples())
+    {
+      Log(LogCategoryMeasurement, LogLevelDEBUG, "staged samples encoded: ", String(sampleStage.samples));
+      sampleStage.used = 0;
+      sampleStage.samples = 0;
+      sampleStage.crc = esp_rom_crc32_le(0, sampleStage.data, 0);
+    }
+    return;
+  }
+
+  File file = SD.open("/measurements/measurement.json", FILE_APPEND);
+  if (!file)
+  {
+    Log(LogCategorySDCard, LogLevelERROR, "measurement.json could not be opened, staged samples kept: ", String(sampleStage.samples));
+    return;
+  }
+
+  StaticJsonDocument<1024> doc;
+  size_t offset = 0;
+  while (offset + sizeof(StagedSampleHeader) <= sampleStage.used)
+  {
+    StagedSampleHeader header;
+    memcpy(&header, sampleStage.data + offset, sizeof(header));
+    offset += sizeof(header);
+
+    doc.clear();
+    doc["time"] = formatTimeAsISOString(header.time);
+    doc["logger_id"] = configRTC.logger_id;
+    doc["deployment_id"] = deployment_id;
+
+    uint8_t sampleQc = 0;
+    for (uint8_t n = 0; n < header.count && offset + sizeof(StagedSensorValue) <= sampleStage.used; n++)
+    {
+      StagedSensorValue sensor;
+      memcpy(&sensor, sampleStage.data + offset, sizeof(sensor));
+      offset += sizeof(sensor);
+
+      doc[sensorParameter(sensor.sensorNumber)] = String(sensor.value);
+      doc[String(sensorParameter(sensor.sensorNumber)) + "_raw"] = String(sensor.raw);
+      if (sensor.qc != 0)
+      {
+        doc[String(sensorParameter(sensor.sensorNumber)) + "_qc"] = sensor.qc;
+      }
+      sampleQc |= sensor.qc;
+    }
+    doc["qc"] = sampleQc; // Combined QC_FLAG_* bits of all values, 0 = all checks passed
+
+    serializeJson(doc, file);
+    file.println();
+  }
+  file.close();
+
+  Log(LogCategoryMeasurement, LogLevelDEBUG, "staged samples written: ", String(sampleStage.samples));
+  sampleStage.used = 0;
+  sampleStage.samples = 0;
+  sampleStage.crc = esp_rom_crc32_le(0, sampleStage.data, 0);
+}
+
+/**
+ * @brief Writes the staged samples to the SD card (energy phase SD write).
+ */
+void flushStagedSamples()
+{
+  validateSampleStage();
+
+  if (sampleStage.samples == 0)
+  {
+    return;
+  }
+
+  PROFILE_SCOPE(PROFILE_PHASE_SD_WRITE);
+  EnergyPhase previous = enterEnergyPhase(ENERGY_PHASE_SD_WRITE);
+  CpuClockLevel previousClock = raiseCpuClockLevel(CPU_CLOCK_BOOST); // JSON serialization or encoding
+  writeStagedSamples();
+  setCpuClockLevel(previousClock);
+  leaveEnergyPhase(previous);
+}
+
+/**
+ * @brief Writes the remaining staged samples at the end of a deployment and resets the brown-out policy and the encoder.
+ */
+void endSampleStaging()
+{
+  flushStagedSamples();
+  sampleStage.writeThrough = false;
+  sampleCodecReset(sampleCodecState); // Every deployment starts with a keyframe
+}
+
+/**
+ * @brief Returns the number of samples waiting in the staging buffer.
+ * @return uint16_t Number of staged samples.
+ */
+uint16_t stagedSampleCount()
+{
+  validateSampleStage();
+  return sampleStage.samples;
+}
@@ -0,0 +1,28 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Staging of measurement samples in the RTC memory
+ */
+
+#ifndef SAMPLESTAGING_H
+#define SAMPLESTAGING_H
+
+#include <Arduino.h>
+
+// Size of the staging buffer in the RTC memory in bytes
+#define SAMPLE_STAGE_SIZE 2048
+
+// Number of staged samples after which the buffer is written to the SD card
+#define SAMPLE_STAGE_FLUSH_COUNT 10
+
+void stageMeasurementSample(uint32_t time, const bool *measurementSuccessful, const float *sensorValue, const float *sensorValueRaw, const uint8_t *qcFlags, int sensorCount);
+void flushStagedSamples();
+void endSampleStaging();
+uint16_t stagedSampleCount();
+
+#endif
@@ -9,145 +9,165 @@
  * Description: Sample casting and analysis functions
  */
 
-#include <SD.h>
-#include <vector>
+#include <Arduino.h>
 
 #include "DebuggingSDLog.h"
 #include "SystemVariables.h"
 #include "loggerConfig.h"
 #include "sample_cast.h"
 
+// Times are rebased once the oldest sample is older than this, to keep the sums precise
+#define CAST_SAMPLE_REBASE_MS (1UL << 24)
+
+RTC_DATA_ATTR CastSampleRing castSamples;     // Samples of the current deployment
+static bool castMovementDetected = false;     // Result of the latest performSampleCast calculation
+
 /**
- * @brief Keeps the latest sample cast lines in the file.
+ * @brief Empties the ring.
+ * @param ring Ring to reset.
+ * @param window Number of samples the speed is estimated over (2..CAST_SAMPLE_CAPACITY).
  */
-void keepLatestSampleCastLines()
+void resetCastSampleRing(CastSampleRing &ring, uint8_t window)
 {
-  const char *filePath = "/measurements/sample_cast.txt";
-  int maxLines = sampleCastIntervals + 10;
-  int linesToKeep = sampleCastIntervals + 5;
+  memset(&ring, 0, sizeof(ring));
+  ring.window = constrain(window, 2, CAST_SAMPLE_CAPACITY);
+}
 
-  File file = SD.open(filePath, FILE_READ);
-  if (!file)
-  {
-    Serial.println("Error opening the file.");
-    return;
-  }
+/**
+ * @brief Adds the sample at ring index to the sums (sign = 1) or removes it (sign = -1).
+ */
+static void updateCastSums(CastSampleRing &ring, uint8_t index, double sign)
+{
+  double time = ring.timeMs[index];
+  double pressure = ring.pressure[index];
+  ring.sumTime += sign * time;
+  ring.sumTimeSquared += sign * time * time;
+  ring.sumPressure += sign * pressure;
+  ring.sumTimePressure += sign * time * pressure;
+}
 
-  // Count the lines
-  int lineCount = 0;
-  long fileSize = file.size();
-  long positions[linesToKeep] = {0};
+/**
+ * @brief Moves the time base to the oldest sample and recalculates the sums.
+ */
+static void rebaseCastSampleRing(CastSampleRing &ring)
+{
+  int32_t offset = ring.timeMs[ring.head];
+  ring.baseMs += offset;
+  ring.sumTime = ring.sumTimeSquared = ring.sumPressure = ring.sumTimePressure = 0;
 
-  for (long i = fileSize - 1; i >= 0; i--)
+  for (uint8_t n = 0; n < ring.count; n++)
   {
-    file.seek(i);
-    if (file.read() == '\n' || i == 0)
-    {
-      lineCount++;
-      if (lineCount <= linesToKeep)
-      {
-        positions[linesToKeep - lineCount] = (i == 0 && lineCount > 1) ? 0 : i + 1;
-      }
-    }
+    uint8_t index = (ring.head + n) % ring.window;
+    ring.timeMs[index] -= offset;
+    updateCastSums(ring, index, 1);
   }
+}
 
-  // If sampleCastIntervals + 1 or less lines, nothing to do
-  if (lineCount <= maxLines)
+/**
+ * @brief Adds a sample; if the window is full, the oldest sample is removed.
+ * @param ring Ring the sample is added to.
+ * @param timeMs Time of the sample in ms.
+ * @param pressure Value of the cast detection sensor.
+ */
+void addCastSampleToRing(CastSampleRing &ring, uint32_t timeMs, float pressure)
+{
+  if (ring.count == 0)
   {
-    file.close();
-    return;
+    ring.baseMs = timeMs;
   }
 
-  // Save the last lines
-  String lastLines = "";
-  file.seek(positions[0]);
-  while (file.available())
+  if (ring.count == ring.window)
   {
-    lastLines += (char)file.read();
+    updateCastSums(ring, ring.head, -1);
+    ring.head = (ring.head + 1) % ring.window;
+    ring.count--;
   }
-  file.close();
 
-  file = SD.open(filePath, FILE_WRITE);
-  if (!file)
+  uint8_t index = (ring.head + ring.count) % ring.window;
+  ring.timeMs[index] = (int32_t)(timeMs - ring.baseMs);
+  ring.pressure[index] = pressure;
+  ring.count++;
+  updateCastSums(ring, index, 1);
+
+  if ((uint32_t)ring.timeMs[ring.head] > CAST_SAMPLE_REBASE_MS)
   {
-    Log(LogCategorySDCard, LogLevelERROR, "sample_cast.txt, Error opening the file.");
-    return;
+    rebaseCastSampleRing(ring);
   }
-
-  // Write the last lines back into the file
-  file.print(lastLines);
-  file.close();
-
-  Log(LogCategorySDCard, LogLevelDEBUG, "File has been updated. Only the last lines were kept.");
 }
 
 /**
- * @brief Performs sample cast analysis.
- * @return bool True if cast average speed is above threshold, false otherwise.
+ * @brief Estimates the vertical speed as slope of a least-squares line through the samples of the ring.
+ * @param ring Ring with the samples.
+ * @param speed Absolute speed in sensor units per second.
+ * @return bool False if the window is not filled yet or all samples have the same time.
  */
-bool performSampleCast()
+bool estimateCastSpeed(const CastSampleRing &ring, float &speed)
 {
-  if (configRTC.sample_cast_enable == 0)
+  if (ring.count < ring.window)
   {
-    return true;
+    return false;
   }
 
-  const char *filePath = "/measurements/sample_cast.txt";
-
-  File file = SD.open(filePath, FILE_READ);
-  if (!file)
+  double n = ring.count;
+  double denominator = n * ring.sumTimeSquared - ring.sumTime * ring.sumTime;
+  if (denominator <= 0)
   {
-    Serial.println("Error opening the file.");
-    Log(LogCategoryGeneral, LogLevelERROR, "Error opening the file. SampleCast");
     return false;
   }
 
-  // Log entries
-  std::vector<LogEntry> entries;
-  while (file.available())
+  double slopePerMs = (n * ring.sumTimePressure - ring.sumTime * ring.sumPressure) / denominator;
+  speed = fabs(slopePerMs * 1000.0);
+  return true;
+}
+
+/**
+ * @brief Starts the cast detection of a new deployment.
+ */
+void resetCastDetection()
+{
+  resetCastSampleRing(castSamples, sampleCastIntervals + 1);
+  castMovementDetected = false;
+}
+
+/**
+ * @brief Adds a sample of the cast detection sensor to the ring of the current deployment.
+ * @param timeMs Time of the sample in ms (getMonotonicMs).
+ * @param pressure Value of the cast detection sensor.
+ */
+void addCastSample(uint32_t timeMs, float pressure)
+{
+  if (castSamples.window == 0)
   {
-    String line = file.readStringUntil('\n');
-    int commaIndex = line.indexOf(',');
-    if (commaIndex != -1)
-    {
-      // Extracts the timestamp and print value from the line
-      long timestamp = line.substring(0, commaIndex).toInt();
-      int pressure = line.substring(commaIndex + 1).toInt(); // Skip comma and space
-      entries.push_back({String(timestamp), pressure});
-    }
+    resetCastDetection();
   }
-  file.close();
-  keepLatestSampleCastLines();
+  addCastSampleToRing(castSamples, timeMs, pressure);
+}
 
-  // Check whether at least sampleCastIntervals + 1 entries are present
-  if (entries.size() < sampleCastIntervals + 1)
+/**
+ * @brief Performs sample cast analysis.
+ * @return bool True if cast average speed is above threshold, false otherwise.
+ */
+bool performSampleCast()
+{
+  castMovementDetected = false;
+
+  if (configRTC.sample_cast_enable == 0)
   {
-    Serial.println("Not enough data available for the calculation.");
     return true;
   }
 
-  // Calculate the average speed of the pressure change over the last sampleCastIntervals lines
-  long startTime = entries[entries.size() - sampleCastIntervals - 1].time.toInt();
-  long endTime = entries[entries.size() - 1].time.toInt();
-  double timeDiff = abs(endTime - startTime);
-
-  int startPressure = entries[entries.size() - sampleCastIntervals - 1].pressure;
-  int endPressure = entries[entries.size() - 1].pressure;
-  double pressureChange = abs(endPressure - startPressure);
-
-  double castAverageSpeed = 0;
-  if (timeDiff > 0)
+  float castAverageSpeed;
+  if (!estimateCastSpeed(castSamples, castAverageSpeed))
   {
-    castAverageSpeed = pressureChange / timeDiff;
+    Log(LogCategorySensors, LogLevelDEBUG, "Not enough data available for the calculation.");
+    return true;
   }
 
-  // Output of the formula with the actual values
-  String formula = "castAverageSpeed = abs((" + String(endPressure) + " - " + String(startPressure) + ") / (" + String(endTime) + " - " + String(startTime) + "))";
-  Log(LogCategoryGeneral, LogLevelDEBUG, "Formel: ", formula);
-  Log(LogCategorySensors, LogLevelDEBUG, "Average speed of the last sampleCastIntervals rows: ", String(castAverageSpeed, 2), " Units/s");
+  Log(LogCategorySensors, LogLevelDEBUG, "Vertical speed of the last ", String(castSamples.count), " samples: ", String(castAverageSpeed, 2), " Units/s");
 
   if (castAverageSpeed > configRTC.cast_det_sensor_threshold)
   {
+    castMovementDetected = true;
     return true;
   }
   else
@@ -157,15 +177,11 @@ bool performSampleCast()
 }
 
 /**
- * @brief Creates or clears the sample file.
+ * @brief Checks whether the latest performSampleCast call measured a vertical movement.
+ *        In contrast to performSampleCast, missing data does not count as movement.
+ * @return bool True if the cast average speed was above the threshold.
  */
-void createOrClearSampleFile()
+bool isCastMovementDetected()
 {
-  File file = SD.open("/measurements/sample_cast.txt", FILE_WRITE);
-  if (!file)
-  {
-    Serial.println("Error when creating the file.");
-  }
-  file.close();
-  Serial.println("File 'sample_cast.txt' created.");
-}
\ No newline at end of file
+  return castMovementDetected;
+}
@@ -12,15 +12,34 @@
 #ifndef SAMPLE_CAST_H
 #define SAMPLE_CAST_H
 
-// Data structure for log entries
-struct LogEntry
+#include <stdint.h>
+
+// Maximum number of samples the vertical speed is estimated over
+#define CAST_SAMPLE_CAPACITY 16
+
+// Ring of the latest samples of the cast detection sensor with the sums of a least-squares line fit.
+// The times are kept relative to baseMs, the sums are updated with every added and removed sample.
+typedef struct
 {
-  String time;
-  int pressure;
-};
+  uint32_t baseMs;
+  int32_t timeMs[CAST_SAMPLE_CAPACITY];
+  float pressure[CAST_SAMPLE_CAPACITY];
+  uint8_t window; // Number of samples the speed is estimated over
+  uint8_t head;   // Index of the oldest sample
+  uint8_t count;
+  double sumTime;
+  double sumTimeSquared;
+  double sumPressure;
+  double sumTimePressure;
+} CastSampleRing;
 
-void createOrClearSampleFile();
+void resetCastSampleRing(CastSampleRing &ring, uint8_t window);
+void addCastSampleToRing(CastSampleRing &ring, uint32_t timeMs, float pressure);
+bool estimateCastSpeed(const CastSampleRing &ring, float &speed);
 
+void resetCastDetection();
+void addCastSample(uint32_t timeMs, float pressure);
 bool performSampleCast();
+bool isCastMovementDetected();
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,207 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Min-heap of periodic events with integer millisecond ticks
+ */
+
+#include "tickScheduler.h"
+
+/**
+ * @brief Compares two times, also across a wrap-around of the millisecond counter.
+ * @return bool True if a is earlier than b.
+ */
+static bool isEarlier(uint32_t a, uint32_t b)
+{
+  return (int32_t)(a - b) < 0;
+}
+
+static void swapEvents(TickEvent &a, TickEvent &b)
+{
+  TickEvent temp = a;
+  a = b;
+  b = temp;
+}
+
+static void siftUp(TickScheduler &scheduler, uint8_t index)
+{
+  while (index > 0)
+  {
+    uint8_t parent = (index - 1) / 2;
+    if (!isEarlier(scheduler.heap[index].dueMs, scheduler.heap[parent].dueMs))
+    {
+      break;
+    }
+    swapEvents(scheduler.heap[index], scheduler.heap[parent]);
+    index = parent;
+  }
+}
+
+static void siftDown(TickScheduler &scheduler, uint8_t index)
+{
+  while (true)
+  {
+    uint8_t earliest = index;
+    uint8_t left = 2 * index + 1;
+    uint8_t right = left + 1;
+
+    if (left < scheduler.count && isEarlier(scheduler.heap[left].dueMs, scheduler.heap[earliest].dueMs))
+    {
+      earliest = left;
+    }
+    if (right < scheduler.count && isEarlier(scheduler.heap[right].dueMs, scheduler.heap[earliest].dueMs))
+    {
+      earliest = right;
+    }
+    if (earliest == index)
+    {
+      break;
+    }
+    swapEvents(scheduler.heap[index], scheduler.heap[earliest]);
+    index = earliest;
+  }
+}
+
+/**
+ * @brief Removes all events.
+ * @param scheduler Scheduler to clear.
+ */
+void tickSchedulerClear(TickScheduler &scheduler)
+{
+  scheduler.count = 0;
+}
+
+/**
+ * @brief Adds a periodic event.
+ * @param scheduler Scheduler the event is added to.
+ * @param id Caller defined id of the event.
+ * @param periodMs Distance between two due times in ms (at least 1 ms).
+ * @param dueMs Time the event is due first.
+ * @return bool True if the event was added, false if the scheduler is full.
+ */
+bool tickSchedulerAdd(TickScheduler &scheduler, uint8_t id, uint32_t periodMs, uint32_t dueMs)
+{
+  if (scheduler.count >= TICK_SCHEDULER_CAPACITY)
+  {
+    return false;
+  }
+
+  TickEvent &event = scheduler.heap[scheduler.count];
+  event.dueMs = dueMs;
+  event.periodMs = periodMs > 0 ? periodMs : 1;
+  event.id = id;
+  siftUp(scheduler, scheduler.count++);
+  return true;
+}
+
+/**
+ * @brief Changes the period of an event. The next due time is moved so that it
+ *        keeps the new distance to the last due time.
+ * @param scheduler Scheduler containing the event.
+ * @param id Id of the event.
+ * @param periodMs New period in ms (at least 1 ms).
+ */
+void tickSchedulerSetPeriod(TickScheduler &scheduler, uint8_t id, uint32_t periodMs)
+{
+  if (periodMs == 0)
+  {
+    periodMs = 1;
+  }
+
+  for (uint8_t i = 0; i < scheduler.count; i++)
+  {
+    TickEvent &event = scheduler.heap[i];
+    if (event.id == id && event.periodMs != periodMs)
+    {
+      event.dueMs = event.dueMs - event.periodMs + periodMs;
+      event.periodMs = periodMs;
+      siftUp(scheduler, i);
+      siftDown(scheduler, i);
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Lets every event start a new period at the given time, e.g. after a phase without scheduling.
+ * @param scheduler Scheduler to restart.
+ * @param nowMs Current time.
+ */
+void tickSchedulerRestart(TickScheduler &scheduler, uint32_t nowMs)
+{
+  for (uint8_t i = 0; i < scheduler.count; i++)
+  {
+    scheduler.heap[i].dueMs = nowMs + scheduler.heap[i].periodMs;
+  }
+  for (int i = scheduler.count / 2 - 1; i >= 0; i--)
+  {
+    siftDown(scheduler, i);
+  }
+}
+
+/**
+ * @brief Takes the next event that is due at nowMs + alignMs at the latest and schedules its next due time.
+ *        Events that are due shortly after each other are handled in one wake-up this way.
+ *        The next due time is advanced in whole periods from the last one, so no drift accumulates,
+ *        and periods that have been missed completely are skipped.
+ * @param scheduler Scheduler to take the event from.
+ * @param nowMs Current time.
+ * @param alignMs Events due within this time after nowMs are taken as well.
+ * @return uint8_t Id of the event, TICK_SCHEDULER_NO_EVENT if no event is due.
+ */
+uint8_t tickSchedulerPopDue(TickScheduler &scheduler, uint32_t nowMs, uint32_t alignMs)
+{
+  if (scheduler.count == 0 || isEarlier(nowMs + alignMs, scheduler.heap[0].dueMs))
+  {
+    return TICK_SCHEDULER_NO_EVENT;
+  }
+
+  TickEvent &event = scheduler.heap[0];
+  uint8_t id = event.id;
+
+  event.dueMs += event.periodMs;
+  if (!isEarlier(nowMs, event.dueMs))
+  {
+    uint32_t missedPeriods = (nowMs - event.dueMs) / event.periodMs + 1;
+    event.dueMs += missedPeriods * event.periodMs;
+  }
+  siftDown(scheduler, 0);
+  return id;
+}
+
+/**
+ * @brief Returns the time the next event is due.
+ * @param scheduler Scheduler to check.
+ * @param dueMs Due time of the next event.
+ * @return bool False if the scheduler has no events.
+ */
+bool tickSchedulerNextDue(const TickScheduler &scheduler, uint32_t &dueMs)
+{
+  if (scheduler.count == 0)
+  {
+    return false;
+  }
+  dueMs = scheduler.heap[0].dueMs;
+  return true;
+}
+
+/**
+ * @brief Returns the time until the next event is due.
+ * @param scheduler Scheduler to check.
+ * @param nowMs Current time.
+ * @return int32_t Time in ms, 0 if an event is already due, INT32_MAX if the scheduler has no events.
+ */
+int32_t tickSchedulerTimeUntilNext(const TickScheduler &scheduler, uint32_t nowMs)
+{
+  uint32_t dueMs;
+  if (!tickSchedulerNextDue(scheduler, dueMs))
+  {
+    return INT32_MAX;
+  }
+  int32_t timeUntilNext = (int32_t)(dueMs - nowMs);
+  return timeUntilNext > 0 ? timeUntilNext : 0;
+}
@@ -0,0 +1,47 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Min-heap of periodic events with integer millisecond ticks
+ */
+
+#ifndef TICKSCHEDULER_H
+#define TICKSCHEDULER_H
+
+#include <stdint.h>
+
+// Maximum number of events in one scheduler
+#ifndef TICK_SCHEDULER_CAPACITY
+#define TICK_SCHEDULER_CAPACITY 32
+#endif
+
+#define TICK_SCHEDULER_NO_EVENT 0xFF
+
+// The scheduler has no clock of its own, every call gets the current time as nowMs.
+// Times are compared as signed differences, so the millisecond counter may wrap around.
+typedef struct
+{
+  uint32_t dueMs;    // Time the event is due next
+  uint32_t periodMs; // Distance between two due times
+  uint8_t id;        // Caller defined id, e.g. the sensor number
+} TickEvent;
+
+typedef struct
+{
+  uint8_t count;
+  TickEvent heap[TICK_SCHEDULER_CAPACITY]; // heap[0] is the event that is due first
+} TickScheduler;
+
+void tickSchedulerClear(TickScheduler &scheduler);
+bool tickSchedulerAdd(TickScheduler &scheduler, uint8_t id, uint32_t periodMs, uint32_t dueMs);
+void tickSchedulerSetPeriod(TickScheduler &scheduler, uint8_t id, uint32_t periodMs);
+void tickSchedulerRestart(TickScheduler &scheduler, uint32_t nowMs);
+uint8_t tickSchedulerPopDue(TickScheduler &scheduler, uint32_t nowMs, uint32_t alignMs);
+bool tickSchedulerNextDue(const TickScheduler &scheduler, uint32_t &dueMs);
+int32_t tickSchedulerTimeUntilNext(const TickScheduler &scheduler, uint32_t nowMs);
+
+#endif
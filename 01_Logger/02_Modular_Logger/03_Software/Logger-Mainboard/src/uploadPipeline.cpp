@@ -0,0 +1,200 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Reading of the lines of an upload file on the other core
+ */
+
+#include <Arduino.h>
+
+#include "uploadPipeline.h"
+
+#define UPLOAD_PIPELINE_END 0xFF // Buffer index of the item that ends the file
+
+typedef struct
+{
+  uint8_t buffer;      // Index of the filled buffer, UPLOAD_PIPELINE_END after the last line
+  long nextLineNumber; // Line number after the line in the buffer
+} ReadyLine;
+
+typedef struct
+{
+  File *file;      // Open file, positioned at the beginning of line lineNumber
+  long lineNumber; // Number of the next line of the file
+  long totalLines; // Number of lines to read up to
+} ReaderStart;
+
+static char *ring = NULL;                // UPLOAD_PIPELINE_DEPTH buffers
+static QueueHandle_t freeBuffers = NULL; // Indices of the buffers the reader may fill (created once)
+static QueueHandle_t readyLines = NULL;  // Filled buffers in the order of the file (created once)
+static ReaderStart readerStart;          // Handed to the reader task as its parameter
+static volatile bool isStopRequested = false;
+static bool isRunning = false;
+
+/**
+ * @brief Reads one line into a buffer, the rest of a line longer than the buffer is skipped.
+ * @return size_t Length of the line without '\n'.
+ */
+static size_t readLine(File &file, char *buffer)
+{
+  size_t length = file.readBytesUntil('\n', buffer, UPLOAD_PIPELINE_LINE_SIZE - 1);
+  if (length == UPLOAD_PIPELINE_LINE_SIZE - 1)
+  {
+    int c;
+    while ((c = file.read()) >= 0 && c != '\n')
+    {
+    }
+  }
+  buffer[length] = '\0';
+  return length;
+}
+
+/**
+ * @brief Reader task: fills free buffers with the lines of the file until the end of the
+ *        file, totalLines or a stop request, then sends the end item and deletes itself.
+ * @param pvParameters Pointer to the ReaderStart with the file and the line numbers.
+ */
+static void uploadReaderTask(void *pvParameters)
+{
+  const ReaderStart &start = *(const ReaderStart *)pvParameters;
+  File &file = *start.file;
+  long lineNumber = start.lineNumber;
+  uint8_t buffer = UPLOAD_PIPELINE_END;
+
+  while (!isStopRequested && file.available() && lineNumber < start.totalLines)
+  {
+    if (buffer == UPLOAD_PIPELINE_END && xQueueReceive(freeBuffers, &buffer, pdMS_TO_TICKS(100)) != pdTRUE)
+    {
+      continue; // All buffers wait for the network, check the stop request again
+    }
+
+    size_t length = readLine(file, ring + buffer * UPLOAD_PIPELINE_LINE_SIZE);
+    lineNumber++;
+    if (length == 0)
+    {
+      continue; // Empty lines are skipped, the buffer is used for the next line
+    }
+
+    ReadyLine ready = {buffer, lineNumber};
+    xQueueSend(readyLines, &ready, portMAX_DELAY); // The queue holds all buffers, never blocks
+    buffer = UPLOAD_PIPELINE_END;
+  }
+
+  ReadyLine end = {UPLOAD_PIPELINE_END, lineNumber};
+  xQueueSend(readyLines, &end, portMAX_DELAY);
+  vTaskDelete(NULL);
+}
+
+/**
+ * @brief Frees the ring. The queues are kept, the reader may still be inside xQueueSend
+ *        of the end item when the caller receives it.
+ */
+static void freePipeline()
+{
+  free(ring);
+  ring = NULL;
+  isRunning = false;
+}
+
+/**
+ * @brief Starts the reader task on the current position of the file.
+ * @param file Open file, positioned at the beginning of line lineNumber.
+ * @param lineNumber Number of the next line of the file.
+ * @param totalLines Number of lines to read up to.
+ * @return true if the reader runs, false if there was not enough memory (read the file directly).
+ */
+bool uploadPipelineStart(File &file, long lineNumber, long totalLines)
+{
+  if (isRunning)
+  {
+    return false;
+  }
+
+  if (freeBuffers == NULL)
+  {
+    freeBuffers = xQueueCreate(UPLOAD_PIPELINE_DEPTH, sizeof(uint8_t));
+  }
+  if (readyLines == NULL)
+  {
+    readyLines = xQueueCreate(UPLOAD_PIPELINE_DEPTH + 1, sizeof(ReadyLine)); // + the end item
+  }
+  ring = (char *)malloc(UPLOAD_PIPELINE_DEPTH * UPLOAD_PIPELINE_LINE_SIZE);
+  if (ring == NULL || freeBuffers == NULL || readyLines == NULL)
+  {
+    freePipeline();
+    return false;
+  }
+  xQueueReset(freeBuffers);
+  xQueueReset(readyLines);
+  for (uint8_t buffer = 0; buffer < UPLOAD_PIPELINE_DEPTH; buffer++)
+  {
+    xQueueSend(freeBuffers, &buffer, 0);
+  }
+
+  readerStart = {&file, lineNumber, totalLines};
+  isStopRequested = false;
+  isRunning = true;
+
+  // Core 0 (WiFi and lwIP run there too), the caller publishes on core 1
+  if (xTaskCreatePinnedToCore(uploadReaderTask, "uploadReader", 4096, &readerStart, 1, NULL, 0) != pdPASS)
+  {
+    freePipeline();
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Waits for the next line of the file.
+ * @param line Next line; at the end only nextLineNumber is set.
+ * @return true if line holds a line to publish, false at the end (the reader has finished).
+ */
+bool uploadPipelineNext(UploadLine &line)
+{
+  if (!isRunning)
+  {
+    return false;
+  }
+
+  ReadyLine ready;
+  xQueueReceive(readyLines, &ready, portMAX_DELAY);
+  line.nextLineNumber = ready.nextLineNumber;
+  line.buffer = ready.buffer;
+  if (ready.buffer == UPLOAD_PIPELINE_END)
+  {
+    line.payload = NULL;
+    freePipeline();
+    return false;
+  }
+  line.payload = ring + ready.buffer * UPLOAD_PIPELINE_LINE_SIZE;
+  return true;
+}
+
+/**
+ * @brief Returns the buffer of a published line to the reader.
+ */
+void uploadPipelineRelease(const UploadLine &line)
+{
+  if (isRunning && line.buffer != UPLOAD_PIPELINE_END)
+  {
+    xQueueSend(freeBuffers, &line.buffer, 0);
+  }
+}
+
+/**
+ * @brief Stops the reader (e.g. after a failed publish) and waits until it has finished.
+ *        Lines that were read but not taken are discarded, the file position is undefined.
+ */
+void uploadPipelineStop()
+{
+  isStopRequested = true;
+  UploadLine line;
+  while (uploadPipelineNext(line))
+  {
+    uploadPipelineRelease(line);
+  }
+}
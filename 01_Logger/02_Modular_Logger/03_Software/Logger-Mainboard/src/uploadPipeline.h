@@ -0,0 +1,39 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Reading of the lines of an upload file on the other core
+ */
+
+#ifndef UPLOADPIPELINE_H
+#define UPLOADPIPELINE_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+// A reader task on core 0 reads the lines of the file into a ring of UPLOAD_PIPELINE_DEPTH
+// buffers, the caller on core 1 takes them with uploadPipelineNext, publishes them and returns
+// them with uploadPipelineRelease. The reader blocks while all buffers are waiting to be sent,
+// so the memory stays at UPLOAD_PIPELINE_DEPTH * UPLOAD_PIPELINE_LINE_SIZE. The file must not
+// be used by the caller until uploadPipelineNext returned false or uploadPipelineStop returned.
+
+#define UPLOAD_PIPELINE_DEPTH 4         // Buffers in the ring
+#define UPLOAD_PIPELINE_LINE_SIZE 1024  // Bytes per buffer (MMMS), longer lines are cut off
+
+typedef struct
+{
+  const char *payload;  // Line without '\n', valid until uploadPipelineRelease
+  long nextLineNumber;  // Line number after this line (skipped empty lines included)
+  uint8_t buffer;       // Index of the buffer in the ring
+} UploadLine;
+
+bool uploadPipelineStart(File &file, long lineNumber, long totalLines);
+bool uploadPipelineNext(UploadLine &line);
+void uploadPipelineRelease(const UploadLine &line);
+void uploadPipelineStop();
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Filtered wet/dry state machine with hysteresis and confirmation count
+ */
+
+#include <math.h>
+
+#include "wetDryDetection.h"
+
+/**
+ * @brief Adds a reading to the history and returns the median of the history.
+ *        With an even number of readings the mean of the two middle readings is returned.
+ */
+static float filterReading(WetDryDetector &detector, float value)
+{
+  detector.history[detector.historyIndex] = value;
+  detector.historyIndex = (detector.historyIndex + 1) % WET_DRY_MEDIAN_LENGTH;
+  if (detector.historyCount < WET_DRY_MEDIAN_LENGTH)
+  {
+    detector.historyCount++;
+  }
+
+  float sorted[WET_DRY_MEDIAN_LENGTH];
+  for (uint8_t i = 0; i < detector.historyCount; i++)
+  {
+    uint8_t j = i;
+    for (; j > 0 && sorted[j - 1] > detector.history[i]; j--)
+    {
+      sorted[j] = sorted[j - 1];
+    }
+    sorted[j] = detector.history[i];
+  }
+
+  uint8_t middle = detector.historyCount / 2;
+  return detector.historyCount % 2 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2;
+}
+
+/**
+ * @brief Changes to a confirmed state. The history is cleared because the other sensor is read in the new state.
+ */
+static void confirmState(WetDryDetector &detector, WetDryState state)
+{
+  detector.state = state;
+  detector.confirmCount = 0;
+  detector.unconfirmedCount = 0;
+  detector.historyCount = 0;
+  detector.historyIndex = 0;
+}
+
+/**
+ * @brief Resets the detector to above water, the counters of the rejected transitions are kept.
+ * @param detector Detector to reset.
+ */
+void wetDryReset(WetDryDetector &detector)
+{
+  confirmState(detector, WET_DRY_DRY);
+}
+
+/**
+ * @brief Processes the next reading.
+ *        A raw reading beyond the threshold starts a pending transition, every median filtered
+ *        reading beyond the threshold confirms it. The transition is rejected once the raw and
+ *        the filtered reading are back by more than the hysteresis band, or after pendingLimit
+ *        readings that did not confirm it, so readings inside the band cannot keep it pending.
+ * @param detector Detector with the state of the previous readings.
+ * @param parameters Thresholds and confirmation counts.
+ * @param value Reading of the wet detection sensor (above water) or the dry detection sensor (underwater).
+ * @return WetDryState The state after the reading.
+ */
+WetDryState wetDryUpdate(WetDryDetector &detector, const WetDryParameters &parameters, float value)
+{
+  float filtered = filterReading(detector, value);
+
+  if (detector.state == WET_DRY_DRY || detector.state == WET_DRY_WET_PENDING)
+  {
+    float band = parameters.hysteresis * fabsf(parameters.wetThreshold);
+
+    if (detector.state == WET_DRY_DRY && value >= parameters.wetThreshold)
+    {
+      detector.state = WET_DRY_WET_PENDING;
+      detector.confirmCount = 0;
+      detector.unconfirmedCount = 0;
+    }
+
+    if (detector.state == WET_DRY_WET_PENDING)
+    {
+      if (filtered >= parameters.wetThreshold)
+      {
+        detector.confirmCount++;
+        if (detector.confirmCount >= parameters.wetConfirmCount)
+        {
+          confirmState(detector, WET_DRY_WET);
+        }
+      }
+      else
+      {
+        detector.unconfirmedCount++;
+        bool isBack = value < parameters.wetThreshold - band && filtered < parameters.wetThreshold - band;
+        if (isBack || detector.unconfirmedCount >= parameters.pendingLimit)
+        {
+          detector.state = WET_DRY_DRY;
+          detector.confirmCount = 0;
+          detector.rejectedWetCount++;
+        }
+      }
+    }
+  }
+  else
+  {
+    float band = parameters.hysteresis * fabsf(parameters.dryThreshold);
+
+    if (detector.state == WET_DRY_WET && value <= parameters.dryThreshold)
+    {
+      detector.state = WET_DRY_DRY_PENDING;
+      detector.confirmCount = 0;
+      detector.unconfirmedCount = 0;
+    }
+
+    if (detector.state == WET_DRY_DRY_PENDING)
+    {
+      if (filtered <= parameters.dryThreshold)
+      {
+        detector.confirmCount++;
+        if (detector.confirmCount >= parameters.dryConfirmCount)
+        {
+          confirmState(detector, WET_DRY_DRY);
+        }
+      }
+      else
+      {
+        detector.unconfirmedCount++;
+        bool isBack = value > parameters.dryThreshold + band && filtered > parameters.dryThreshold + band;
+        if (isBack || detector.unconfirmedCount >= parameters.pendingLimit)
+        {
+          detector.state = WET_DRY_WET;
+          detector.confirmCount = 0;
+          detector.rejectedDryCount++;
+        }
+      }
+    }
+  }
+
+  return detector.state;
+}
+
+/**
+ * @brief Checks whether the logger is underwater, a pending dry transition still counts as underwater.
+ * @param detector Detector to check.
+ * @return bool True if the state is WET_DRY_WET or WET_DRY_DRY_PENDING.
+ */
+bool wetDryIsWet(const WetDryDetector &detector)
+{
+  return detector.state == WET_DRY_WET || detector.state == WET_DRY_DRY_PENDING;
+}
+
+/**
+ * @brief Checks whether a transition waits for its confirmation.
+ * @param detector Detector to check.
+ * @return bool True if the state is WET_DRY_WET_PENDING or WET_DRY_DRY_PENDING.
+ */
+bool wetDryIsPending(const WetDryDetector &detector)
+{
+  return detector.state == WET_DRY_WET_PENDING || detector.state == WET_DRY_DRY_PENDING;
+}
@@ -0,0 +1,57 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Filtered wet/dry state machine with hysteresis and confirmation count
+ */
+
+#ifndef WETDRYDETECTION_H
+#define WETDRYDETECTION_H
+
+#include <stdint.h>
+
+// Number of readings the median filter is calculated over
+#define WET_DRY_MEDIAN_LENGTH 3
+
+enum WetDryState : uint8_t
+{
+  WET_DRY_DRY,         // Above water
+  WET_DRY_WET_PENDING, // Above water, a wet reading waits for its confirmation
+  WET_DRY_WET,         // Underwater
+  WET_DRY_DRY_PENDING, // Underwater, a dry reading waits for its confirmation
+};
+
+typedef struct
+{
+  float wetThreshold;       // A filtered reading at or above counts as wet
+  float dryThreshold;       // A filtered reading at or below counts as dry
+  float hysteresis;         // Band beyond the threshold (fraction of the threshold) that keeps a pending transition up to pendingLimit
+  uint16_t wetConfirmCount; // Filtered wet readings needed to change to WET_DRY_WET
+  uint16_t dryConfirmCount; // Filtered dry readings needed to change to WET_DRY_DRY
+  uint16_t pendingLimit;    // Readings without confirmation after which a pending transition is rejected
+} WetDryParameters;
+
+// The detector has no clock and no sensor access of its own, every call gets the next reading.
+// Above water it is fed with the wet detection sensor, underwater with the dry detection sensor.
+typedef struct
+{
+  float history[WET_DRY_MEDIAN_LENGTH]; // Latest readings of the sensor of the current state
+  uint8_t historyCount;
+  uint8_t historyIndex;
+  WetDryState state;
+  uint16_t confirmCount;     // Filtered readings that confirmed the pending transition so far
+  uint16_t unconfirmedCount; // Readings that did not confirm the pending transition so far
+  uint16_t rejectedWetCount; // Wet transitions that were not confirmed (prevented false deployments)
+  uint16_t rejectedDryCount; // Dry transitions that were not confirmed (prevented false deployment ends)
+} WetDryDetector;
+
+void wetDryReset(WetDryDetector &detector);
+WetDryState wetDryUpdate(WetDryDetector &detector, const WetDryParameters &parameters, float value);
+bool wetDryIsWet(const WetDryDetector &detector);
+bool wetDryIsPending(const WetDryDetector &detector);
+
+#endif
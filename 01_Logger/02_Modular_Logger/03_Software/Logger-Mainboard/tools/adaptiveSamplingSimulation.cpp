@@ -0,0 +1,94 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host replay of a sensor trace through the adaptive sampling
+ *
+ * Build and run on the host (from the Logger-Mainboard directory):
+ *   g++ -std=c++17 -Isrc tools/adaptiveSamplingSimulation.cpp src/adaptiveSampling.cpp -o adaptiveSamplingSimulation
+ *   ./adaptiveSamplingSimulation [trace.csv] [deadband] [maxLevel]
+ *
+ * The trace has one value per configured interval and line. The values that the adaptive sampling
+ * would measure are interpolated linearly and compared with the full trace. Without a trace file a
+ * synthetic bottom trawl (slow temperature drift with a front crossing) is replayed.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "adaptiveSampling.h"
+
+static std::vector<float> syntheticTrace()
+{
+  std::vector<float> trace;
+  for (int i = 0; i < 7200; i++)
+  {
+    float drift = 8.0f + 0.0002f * i;                     // Two hours at the bottom
+    float front = 1.5f / (1.0f + expf(-(i - 4000) / 30.0f)); // Front crossing after about 67 minutes
+    float noise = 0.004f * ((rand() % 1000) / 1000.0f - 0.5f);
+    trace.push_back(drift + front + noise);
+  }
+  return trace;
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<float> trace;
+  if (argc > 1)
+  {
+    std::ifstream file(argv[1]);
+    std::string line;
+    while (std::getline(file, line))
+    {
+      if (!line.empty())
+      {
+        trace.push_back(strtof(line.c_str(), nullptr));
+      }
+    }
+  }
+  else
+  {
+    srand(1);
+    trace = syntheticTrace();
+  }
+  AdaptiveRule rule = {argc > 2 ? strtof(argv[2], nullptr) : 0.02f, (uint8_t)(argc > 3 ? atoi(argv[3]) : 3)};
+
+  AdaptiveState state;
+  adaptiveReset(state);
+  std::vector<size_t> measured;
+  for (size_t i = 0; i < trace.size(); i += (size_t)1 << state.level)
+  {
+    measured.push_back(i);
+    uint8_t previousLevel = state.level;
+    adaptiveUpdate(state, rule, trace[i]);
+    if (state.level != previousLevel)
+    {
+      printf("sample %6zu value %8.4f level %u -> %u\n", i, trace[i], previousLevel, state.level);
+    }
+  }
+
+  // Largest difference between the trace and the interpolation of the measured values
+  float largestError = 0;
+  for (size_t m = 1; m < measured.size(); m++)
+  {
+    size_t a = measured[m - 1], b = measured[m];
+    for (size_t i = a + 1; i < b; i++)
+    {
+      float interpolated = trace[a] + (trace[b] - trace[a]) * (i - a) / (float)(b - a);
+      largestError = fmaxf(largestError, fabsf(trace[i] - interpolated));
+    }
+  }
+
+  printf("deadband %.4f, max level %u\n", rule.deadband, rule.maxLevel);
+  printf("measured %zu of %zu values (%.1f%%), largest interpolation error %.4f\n", measured.size(), trace.size(),
+         100.0 * measured.size() / trace.size(), largestError);
+  return 0;
+}
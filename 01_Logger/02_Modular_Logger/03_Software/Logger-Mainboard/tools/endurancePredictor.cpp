@@ -0,0 +1,199 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host prediction of the deployment endurance from the energy totals per phase
+ *
+ * Build and run on the host (from the Logger-Mainboard directory):
+ *   g++ -std=c++17 -Isrc tools/endurancePredictor.cpp src/energyAccounting.cpp -o endurancePredictor
+ *   ./endurancePredictor <status.json|-> <loggerConfig.json|-> <capacity mAh> [underwater h/day] [deployments/day]
+ *
+ * status.json is a message of the topic hyfive/status; its "energy" object gives the charge and
+ * the duration of one entry of every phase. Phases without entries (and "-") fall back to the
+ * current model of src/energyAccounting.cpp with the assumed durations below. The periods are
+ * read from the logger configuration file.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "energyAccounting.h"
+
+// Assumed duration of one entry in s, if the status has no entries of the phase
+static const double defaultDurationSec[ENERGY_PHASE_COUNT] = {0.3, 0.5, 0.2, 3.0, 0.1, 4.0, 3.0, 0.0};
+
+typedef struct
+{
+  double chargeMilliAmpHour; // per entry
+  double durationSec;        // per entry
+  bool measured;
+} PhaseCost;
+
+/**
+ * @brief Reads a number (also quoted, as the firmware writes floats as strings) that follows a key.
+ * @param json JSON text.
+ * @param from Position to search the key from.
+ * @param key Key of the number.
+ * @param value Read number, unchanged if the key is missing.
+ */
+static void readJsonNumber(const std::string &json, size_t from, const char *key, double &value)
+{
+  std::string quotedKey = std::string("\"") + key + "\"";
+  size_t position = json.find(quotedKey, from);
+  if (position == std::string::npos)
+  {
+    return;
+  }
+  position = json.find(':', position + quotedKey.size());
+  if (position == std::string::npos)
+  {
+    return;
+  }
+  position = json.find_first_not_of(" \t\"", position + 1);
+  if (position != std::string::npos)
+  {
+    value = strtod(json.c_str() + position, nullptr);
+  }
+}
+
+static std::string readFile(const char *path)
+{
+  if (std::string(path) == "-")
+  {
+    return "";
+  }
+  std::ifstream file(path);
+  if (!file)
+  {
+    fprintf(stderr, "%s could not be opened\n", path);
+    exit(1);
+  }
+  std::stringstream text;
+  text << file.rdbuf();
+  return text.str();
+}
+
+/**
+ * @brief Returns the cost of one entry of a phase, from the status if it has entries of it.
+ */
+static PhaseCost phaseCost(const std::string &status, EnergyPhase phase)
+{
+  PhaseCost cost = {energyModelCurrentMa[phase] * defaultDurationSec[phase] / 3600, defaultDurationSec[phase], false};
+
+  size_t energy = status.find("\"energy\"");
+  std::string quotedName = std::string("\"") + energyPhaseName(phase) + "\"";
+  size_t position = energy == std::string::npos ? energy : status.find(quotedName, energy);
+  if (position == std::string::npos)
+  {
+    return cost;
+  }
+
+  double seconds = 0, chargeMilliAmpHour = 0, count = 0;
+  readJsonNumber(status, position, "s", seconds);
+  readJsonNumber(status, position, "mAh", chargeMilliAmpHour);
+  readJsonNumber(status, position, "n", count);
+  if (count > 0 && seconds > 0)
+  {
+    cost = {chargeMilliAmpHour / count, seconds / count, true};
+  }
+  return cost;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 4)
+  {
+    fprintf(stderr, "usage: %s <status.json|-> <loggerConfig.json|-> <capacity mAh> [underwater h/day] [deployments/day]\n", argv[0]);
+    return 1;
+  }
+  std::string status = readFile(argv[1]);
+  std::string config = readFile(argv[2]);
+  double capacityMilliAmpHour = strtod(argv[3], nullptr);
+  double underwaterHours = argc > 4 ? strtod(argv[4], nullptr) : 12;
+  double deploymentsPerDay = argc > 5 ? strtod(argv[5], nullptr) : 24;
+
+  double samplePeriode = 10, wetDetPeriode = 60, statusUploadPeriode = 3600; // Defaults if the keys are missing
+  readJsonNumber(config, 0, "sample_periode", samplePeriode);
+  readJsonNumber(config, 0, "wet_det_periode", wetDetPeriode);
+  readJsonNumber(config, 0, "status_upload_periode", statusUploadPeriode);
+
+  PhaseCost cost[ENERGY_PHASE_COUNT];
+  for (int phase = 0; phase < ENERGY_PHASE_COUNT; phase++)
+  {
+    cost[phase] = phaseCost(status, (EnergyPhase)phase);
+  }
+
+  // Sleep current from the measured totals of the sleep phase
+  double sleepSeconds = 0, sleepMilliAmpHour = 0;
+  size_t sleep = status.find("\"sleep\"", status.find("\"energy\""));
+  if (sleep != std::string::npos)
+  {
+    readJsonNumber(status, sleep, "s", sleepSeconds);
+    readJsonNumber(status, sleep, "mAh", sleepMilliAmpHour);
+  }
+  double sleepCurrentMa = sleepSeconds > 0 ? sleepMilliAmpHour * 3600 / sleepSeconds : energyModelCurrentMa[ENERGY_PHASE_SLEEP];
+
+  // SD writes per sampling wake-up, the staging buffer collects several samples per write
+  double sdWritesPerSample = 0.1;
+  if (cost[ENERGY_PHASE_SD_WRITE].measured && cost[ENERGY_PHASE_SAMPLING].measured)
+  {
+    double sdCount = 0, samplingCount = 0;
+    size_t energy = status.find("\"energy\"");
+    readJsonNumber(status, status.find("\"sd_write\"", energy), "n", sdCount);
+    readJsonNumber(status, status.find("\"sampling\"", energy), "n", samplingCount);
+    sdWritesPerSample = samplingCount > 0 ? sdCount / samplingCount : sdWritesPerSample;
+  }
+
+  // Entries per day of every phase
+  double underwaterWakes = underwaterHours * 3600 / samplePeriode;
+  double surfaceWakes = (24 - underwaterHours) * 3600 / wetDetPeriode;
+  double uploads = 86400 / statusUploadPeriode + deploymentsPerDay;
+  double entries[ENERGY_PHASE_COUNT] = {};
+  entries[ENERGY_PHASE_BOOT] = underwaterWakes + surfaceWakes;
+  entries[ENERGY_PHASE_HOUSEKEEPING] = underwaterWakes + surfaceWakes;
+  entries[ENERGY_PHASE_WET_DETECTION] = underwaterWakes + surfaceWakes;
+  entries[ENERGY_PHASE_SAMPLING] = underwaterWakes;
+  entries[ENERGY_PHASE_SD_WRITE] = underwaterWakes * sdWritesPerSample;
+  entries[ENERGY_PHASE_WIFI] = uploads;
+  entries[ENERGY_PHASE_MQTT] = uploads;
+
+  double chargePerDay[ENERGY_PHASE_COUNT] = {};
+  double awakeSeconds = 0, totalPerDay = 0;
+  for (int phase = 0; phase < ENERGY_PHASE_SLEEP; phase++)
+  {
+    chargePerDay[phase] = entries[phase] * cost[phase].chargeMilliAmpHour;
+    awakeSeconds += entries[phase] * cost[phase].durationSec;
+  }
+  if (awakeSeconds > 86400)
+  {
+    fprintf(stderr, "warning: the phases take %.0f s per day, the configuration cannot be kept\n", awakeSeconds);
+    awakeSeconds = 86400;
+  }
+  chargePerDay[ENERGY_PHASE_SLEEP] = (86400 - awakeSeconds) * sleepCurrentMa / 3600;
+  for (int phase = 0; phase < ENERGY_PHASE_COUNT; phase++)
+  {
+    totalPerDay += chargePerDay[phase];
+  }
+
+  printf("sample_periode %.0f s, wet_det_periode %.0f s, status_upload_periode %.0f s\n", samplePeriode, wetDetPeriode, statusUploadPeriode);
+  printf("%.1f h underwater and %.0f deployments per day, %.0f mAh\n\n", underwaterHours, deploymentsPerDay, capacityMilliAmpHour);
+  printf("%-14s %10s %12s %12s %8s %8s\n", "phase", "source", "mAh/entry", "entries/day", "mAh/day", "share");
+  for (int phase = 0; phase < ENERGY_PHASE_COUNT; phase++)
+  {
+    bool isSleep = phase == ENERGY_PHASE_SLEEP;
+    printf("%-14s %10s %12.5f %12.1f %8.2f %7.1f%%\n", energyPhaseName((EnergyPhase)phase),
+           (isSleep ? sleepSeconds > 0 : cost[phase].measured) ? "status" : "model", isSleep ? 0.0 : cost[phase].chargeMilliAmpHour,
+           isSleep ? 1.0 : entries[phase], chargePerDay[phase], 100 * chargePerDay[phase] / totalPerDay);
+  }
+  printf("\nawake %.0f s per day, sleep current %.3f mA\n", awakeSeconds, sleepCurrentMa);
+  printf("consumption %.1f mAh per day, mean current %.3f mA\n", totalPerDay, totalPerDay / 24);
+  printf("endurance %.1f days\n", capacityMilliAmpHour / totalPerDay);
+  return 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host check of the energy accounting across SNTP steps of the system time
+ *
+ * Build and run on the host (from the Logger-Mainboard directory):
+ *   g++ -std=c++17 -Isrc tools/energyClockStepCheck.cpp src/energyAccounting.cpp -o energyClockStepCheck
+ *   ./energyClockStepCheck
+ *
+ * Replays wake-ups with the phase sequence of the firmware. SNTP steps the system time in the WiFi
+ * phase: from 1970 to the real time after the power-on, and back by a few seconds in a later
+ * correction. The boundaries are taken once from the RTC counter (getMonotonicMs, started close
+ * to its 32 bit wrap-around) and once from the system time (gettimeofday). Only the
+ * RTC counter must give the true phase durations; the exit code is 1 if it does not.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "energyAccounting.h"
+
+typedef struct
+{
+  EnergyPhase phase;
+  uint32_t durationMs;
+  int64_t stepMs; // Step of the system time at the end of the phase (SNTP), 0 = none
+} PhaseStep;
+
+// One wake-up at the surface: status upload with time synchronisation, then deep sleep
+static const PhaseStep wakeUp[] = {
+    {ENERGY_PHASE_BOOT, 300, 0},
+    {ENERGY_PHASE_HOUSEKEEPING, 500, 0},
+    {ENERGY_PHASE_WIFI, 4000, 0}, // The step of the wake-up is applied at the end of this phase
+    {ENERGY_PHASE_MQTT, 3000, 0},
+    {ENERGY_PHASE_HOUSEKEEPING, 200, 0},
+    {ENERGY_PHASE_SLEEP, 600000, 0},
+};
+static const int wakeUpPhases = sizeof(wakeUp) / sizeof(wakeUp[0]);
+
+// Step per wake-up: the first synchronisation after the power-on, one without and one backward correction
+static const int64_t wakeUpStepMs[] = {1780000000000LL, 0, -1500};
+static const int wakeUps = sizeof(wakeUpStepMs) / sizeof(wakeUpStepMs[0]);
+
+/**
+ * @brief Replays the wake-ups with the boundaries taken from one clock.
+ * @param useSystemTime True: system time stepped by SNTP, false: RTC counter.
+ * @param totals Resulting totals.
+ */
+static void replay(bool useSystemTime, EnergyTotals &totals)
+{
+  uint32_t rtcCounterMs = 0xFFFFFFFFu - 5000; // Wraps during the first wake-up
+  int64_t systemTimeMs = 0;                   // 1970 until the first synchronisation
+
+  auto nowMs = [&]() { return useSystemTime ? (uint32_t)systemTimeMs : rtcCounterMs; };
+
+  energyAccountingReset(totals, ENERGY_PHASE_BOOT, nowMs(), 0);
+  for (int w = 0; w < wakeUps; w++)
+  {
+    for (int p = 0; p < wakeUpPhases; p++)
+    {
+      rtcCounterMs += wakeUp[p].durationMs;
+      systemTimeMs += wakeUp[p].durationMs;
+      if (wakeUp[p].phase == ENERGY_PHASE_WIFI)
+      {
+        systemTimeMs += wakeUpStepMs[w];
+      }
+      EnergyPhase next = p + 1 < wakeUpPhases ? wakeUp[p + 1].phase : wakeUp[0].phase;
+      energyAccountingBoundary(totals, next, nowMs(), -1, energyModelCurrentMa, true);
+    }
+  }
+}
+
+int main()
+{
+  uint64_t expectedMs[ENERGY_PHASE_COUNT] = {};
+  for (int p = 0; p < wakeUpPhases; p++)
+  {
+    expectedMs[wakeUp[p].phase] += (uint64_t)wakeUp[p].durationMs * wakeUps;
+  }
+
+  EnergyTotals monotonic, systemTime;
+  replay(false, monotonic);
+  replay(true, systemTime);
+
+  bool passed = true;
+  printf("%-14s %12s %14s %14s\n", "phase", "expected ms", "RTC counter", "system time");
+  for (int phase = 0; phase < ENERGY_PHASE_COUNT; phase++)
+  {
+    bool matches = monotonic.durationMs[phase] == expectedMs[phase];
+    passed = passed && matches;
+    printf("%-14s %12llu %14llu %14llu%s\n", energyPhaseName((EnergyPhase)phase), (unsigned long long)expectedMs[phase],
+           (unsigned long long)monotonic.durationMs[phase], (unsigned long long)systemTime.durationMs[phase], matches ? "" : "  <- wrong");
+  }
+
+  printf("%s\n", passed ? "passed: the RTC counter is not affected by the SNTP steps" : "FAILED");
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,141 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host check of the oceanography library against reference values, and throughput of the batch functions
+ *
+ * Build and run on the host (from the Logger-Mainboard directory):
+ *   g++ -std=c++17 -O3 -fno-math-errno -fno-trapping-math -Isrc tools/oceanographyCheck.cpp src/oceanography.cpp -o oceanographyCheck
+ *   ./oceanographyCheck [samples]
+ *
+ * The exit code is 1 if a value is outside of its tolerance. -fno-math-errno and -fno-trapping-math
+ * let the compiler vectorize the batch loops; the results are the same without them.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "oceanography.h"
+
+static int failures = 0;
+
+static void checkValue(const char *name, float value, double reference, double tolerance)
+{
+  bool passed = fabs(value - reference) <= tolerance;
+  failures += !passed;
+  printf("%-44s %12.6f  reference %12.6f  %s\n", name, value, reference, passed ? "ok" : "FAILED");
+}
+
+/**
+ * @brief Compares the results with published check values.
+ */
+static void checkReferenceValues()
+{
+  // PSS-78 check values (UNESCO 1983), the temperature of the table is IPTS-68
+  const float t90 = 1.0f / 1.00024f;
+  checkValue("salinity R=1 t68=15 p=0", practicalSalinity(1.0f * PSS78_C35_15_0, 15 * t90, 0), 35.000000, 1e-4);
+  checkValue("salinity R=1.2 t68=20 p=2000", practicalSalinity(1.2f * PSS78_C35_15_0, 20 * t90, 2000), 37.245628, 2e-4);
+  checkValue("salinity R=0.65 t68=5 p=1500", practicalSalinity(0.65f * PSS78_C35_15_0, 5 * t90, 1500), 27.995347, 2e-4);
+
+  // The Hill et al. extension continues PSS-78 below S = 2 without a jump
+  float largestStep = 0;
+  float previous = practicalSalinity(1.0f, 15, 0);
+  for (float conductivity = 1.0001f; conductivity < 5.0f; conductivity += 0.0001f)
+  {
+    float salinity = practicalSalinity(conductivity, 15, 0);
+    largestStep = fmaxf(largestStep, fabsf(salinity - previous));
+    previous = salinity;
+  }
+  checkValue("salinity largest step, C=1..5 in 0.0001", largestStep, 0, 5e-4);
+  checkValue("salinity C=0", practicalSalinity(0, 10, 0), 0, 1e-6);
+
+  // Depth check values (UNESCO 1983)
+  checkValue("depth p=10000 lat=30", depthFromPressure(10000, 30), 9712.653, 0.05);
+  checkValue("depth p=500 lat=0", depthFromPressure(500, 0), 496.653, 0.01);
+
+  checkValue("sea pressure 2013.25 mbar", seaPressureFromAbsolute(2013.25f), 10.0, 1e-5);
+
+  // Oxygen reference values calculated with function_convert_oxygen.py (umol/L)
+  checkValue("oxygen pO2=210 t=10 S=35 p=0", oxygenConcentration(210, 10, 35, 0), 282.398842, 0.01);
+  checkValue("oxygen pO2=200 t=2 S=30 p=100", oxygenConcentration(200, 2, 30, 100), 329.192680, 0.01);
+  checkValue("oxygen pO2=150 t=20 S=7 p=50", oxygenConcentration(150, 20, 7, 50), 195.960341, 0.01);
+  checkValue("oxygen pO2=50 t=5 S=15 p=500", oxygenConcentration(50, 5, 15, 500), 80.115771, 0.01);
+}
+
+/**
+ * @brief Checks that the batch functions give the same results as the scalar functions.
+ */
+static void checkBatchFunctions(const std::vector<float> &c, const std::vector<float> &t, const std::vector<float> &p, const std::vector<float> &o)
+{
+  size_t n = c.size();
+  std::vector<float> salinity(n), depth(n), oxygen(n);
+  practicalSalinityBatch(c.data(), t.data(), p.data(), salinity.data(), n);
+  depthFromPressureBatch(p.data(), 54.2f, depth.data(), n);
+  oxygenConcentrationBatch(o.data(), t.data(), salinity.data(), p.data(), oxygen.data(), n);
+
+  double largestDifference = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    largestDifference = fmax(largestDifference, fabs(salinity[i] - practicalSalinity(c[i], t[i], p[i])));
+    largestDifference = fmax(largestDifference, fabs(depth[i] - depthFromPressure(p[i], 54.2f)));
+    largestDifference = fmax(largestDifference, fabs(oxygen[i] - oxygenConcentration(o[i], t[i], salinity[i], p[i])));
+  }
+  checkValue("batch vs. scalar, largest difference", largestDifference, 0, 1e-3);
+}
+
+template <typename Function>
+static void measureThroughput(const char *name, size_t n, Function function)
+{
+  function(); // Warm-up
+  const int rounds = 20;
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; round++)
+  {
+    function();
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("%-44s %10.1f Msamples/s\n", name, n * rounds / seconds / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+  size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+  if (n == 0)
+  {
+    n = 1;
+  }
+
+  // Profile values of the Baltic Sea and the North Sea, including fresh water
+  std::vector<float> c(n), t(n), p(n), o(n), salinity(n), depth(n), oxygen(n);
+  srand(1);
+  for (size_t i = 0; i < n; i++)
+  {
+    c[i] = (rand() % 60000) / 1000.0f;
+    t[i] = (rand() % 2500) / 100.0f;
+    p[i] = (rand() % 30000) / 100.0f;
+    o[i] = (rand() % 30000) / 100.0f;
+  }
+
+  checkReferenceValues();
+  checkBatchFunctions(c, t, p, o);
+
+  measureThroughput("practicalSalinityBatch", n, [&]() { practicalSalinityBatch(c.data(), t.data(), p.data(), salinity.data(), n); });
+  measureThroughput("depthFromPressureBatch", n, [&]() { depthFromPressureBatch(p.data(), 54.2f, depth.data(), n); });
+  measureThroughput("oxygenConcentrationBatch", n, [&]() { oxygenConcentrationBatch(o.data(), t.data(), salinity.data(), p.data(), oxygen.data(), n); });
+  measureThroughput("practicalSalinity (scalar loop)", n, [&]() {
+    for (size_t i = 0; i < n; i++)
+    {
+      salinity[i] = practicalSalinity(c[i], t[i], p[i]);
+    }
+  });
+
+  printf("%s\n", failures ? "reference check FAILED" : "reference check passed");
+  return failures ? 1 : 0;
+}
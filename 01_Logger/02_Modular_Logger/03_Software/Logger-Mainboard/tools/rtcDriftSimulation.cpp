@@ -0,0 +1,82 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation of the NTP synchronisations with the RTC drift model
+ *
+ * Build and run on the host (from the Logger-Mainboard directory):
+ *   g++ -std=c++17 -Isrc tools/rtcDriftSimulation.cpp src/rtcDrift.cpp -o rtcDriftSimulation
+ *   ./rtcDriftSimulation [drift ppm] [temperature swing ppm] [budget s] [connection interval h] [days]
+ *
+ * The simulated DS3231 drifts by the given ppm plus a daily swing (deck and sea temperature).
+ * The logger connects to WiFi every connection interval and synchronizes when the model says so.
+ * Every minute the error of the corrected timestamp is compared with an uncorrected RTC that is
+ * synchronized at every connection (the behaviour before the drift model).
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "rtcDrift.h"
+
+int main(int argc, char **argv)
+{
+  double driftPpm = argc > 1 ? strtod(argv[1], nullptr) : 2.0;
+  double swingPpm = argc > 2 ? strtod(argv[2], nullptr) : 1.0;
+  float budgetSec = argc > 3 ? strtof(argv[3], nullptr) : 1.0f;
+  double connectionHours = argc > 4 ? strtod(argv[4], nullptr) : 1.0;
+  double days = argc > 5 ? strtod(argv[5], nullptr) : 90;
+
+  const double startTime = 1700000000.0;
+  double trueTime = startTime;
+  double rtcTime = startTime + 0.4; // RTC before the first synchronisation
+  double nextConnection = trueTime;
+
+  RtcDriftModel model = {};
+  uint32_t syncs = 0, connections = 0;
+  double maxError = 0, sumError = 0, maxBaselineError = 0;
+  uint64_t minutes = 0;
+
+  while (trueTime < startTime + days * 86400)
+  {
+    if (trueTime >= nextConnection)
+    {
+      connections++;
+      nextConnection += connectionHours * 3600;
+      uint32_t rawRtcTime = (uint32_t)floor(rtcTime);
+      if (rtcDriftIsSyncDue(model, rawRtcTime, budgetSec))
+      {
+        // Same steps as synchronizeTimeWithNTP: offset of the whole-second reading, set on a full second
+        float offsetSec = (float)(rawRtcTime + 0.5 - trueTime);
+        trueTime = ceil(trueTime);
+        rtcTime = trueTime;
+        rtcDriftSynchronized(model, offsetSec, (uint32_t)trueTime);
+        syncs++;
+      }
+    }
+
+    // One minute of drift, the temperature swings with a period of a day
+    double ppm = driftPpm + swingPpm * sin(2 * M_PI * (trueTime - startTime) / 86400);
+    trueTime += 60;
+    rtcTime += 60 * (1 + ppm * 1e-6);
+
+    double error = fabs(rtcDriftCorrect(model, (uint32_t)floor(rtcTime)) - trueTime);
+    maxError = fmax(maxError, error);
+    sumError += error;
+    // Uncorrected RTC synchronized at every connection: drift since the last connection plus the whole-second reading
+    double sinceConnection = fmod(trueTime - startTime, connectionHours * 3600);
+    maxBaselineError = fmax(maxBaselineError, fabs(sinceConnection * ppm * 1e-6) + 1.0);
+    minutes++;
+  }
+
+  printf("drift %.2f ppm +- %.2f ppm, budget %.2f s, connection every %.1f h, %.0f days\n", driftPpm, swingPpm, budgetSec, connectionHours, days);
+  printf("estimated drift %.2f ppm +- %.2f ppm after %u samples\n", model.driftPpm, model.uncertaintyPpm, model.samples);
+  printf("NTP synchronisations %u of %u connections (%.1f per 30 days)\n", syncs, connections, syncs * 30 / days);
+  printf("timestamp error: max %.2f s, mean %.2f s (sync at every connection: max %.2f s)\n", maxError, sumError / minutes, maxBaselineError);
+  return 0;
+}
@@ -0,0 +1,362 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Decoder of measurement_delta.json for the deck box, and compression figures of measurement.json files
+ *
+ * Build on the host or the deck box (from the Logger-Mainboard directory):
+ *   g++ -std=c++17 -O2 -Isrc tools/sampleCodecTool.cpp src/sampleCodec.cpp -o sampleCodecTool
+ *
+ * Decode delta encoded lines (file or MQTT payloads of hyfive/data_delta) into measurement.json lines:
+ *   ./sampleCodecTool decode measurement_delta.json [parameter,parameter,...]
+ *   The parameters name the sensor numbers in the order of the config header, default "sensor_<n>".
+ *
+ * Compression figures of measurement.json files (without a file: a synthetic deployment):
+ *   ./sampleCodecTool ratio [measurement.json ...] [parameter=resolution ...]
+ *   The default resolution is 0.01, the precision of the values in measurement.json.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "sampleCodec.h"
+
+// Values of the logger in SystemVariables.h and sampleStaging.cpp
+static const uint16_t sampleCodecKeyframeInterval = 60;
+static const size_t sampleCodecLineSize = 600;
+static const int sampleStageFlushCount = 10;
+
+/**
+ * @brief Returns the value of a key of a flat JSON line, without the quotes of a string.
+ */
+static bool jsonValue(const std::string &line, const std::string &key, std::string &value)
+{
+  size_t position = line.find("\"" + key + "\":");
+  if (position == std::string::npos)
+  {
+    return false;
+  }
+  position += key.size() + 3;
+  if (line[position] == '"')
+  {
+    size_t end = line.find('"', position + 1);
+    value = line.substr(position + 1, end - position - 1);
+  }
+  else
+  {
+    size_t end = line.find_first_of(",}", position);
+    value = line.substr(position, end - position);
+  }
+  return true;
+}
+
+/**
+ * @brief Returns all keys of a flat JSON line in their order.
+ */
+static std::vector<std::string> jsonKeys(const std::string &line)
+{
+  std::vector<std::string> keys;
+  bool inString = false;
+  size_t start = 0;
+  for (size_t i = 0; i < line.size(); i++)
+  {
+    if (line[i] != '"')
+    {
+      continue;
+    }
+    if (!inString)
+    {
+      start = i + 1;
+    }
+    else if (i + 1 < line.size() && line[i + 1] == ':')
+    {
+      keys.push_back(line.substr(start, i - start));
+    }
+    inString = !inString;
+  }
+  return keys;
+}
+
+static bool endsWith(const std::string &text, const char *suffix)
+{
+  size_t length = strlen(suffix);
+  return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+static std::string isoTime(uint32_t unixTime)
+{
+  time_t t = unixTime;
+  char buffer[30];
+  strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", gmtime(&t));
+  return buffer;
+}
+
+static uint32_t unixTime(const std::string &iso)
+{
+  struct tm time = {};
+  sscanf(iso.c_str(), "%d-%d-%dT%d:%d:%d", &time.tm_year, &time.tm_mon, &time.tm_mday, &time.tm_hour, &time.tm_min, &time.tm_sec);
+  time.tm_year -= 1900;
+  time.tm_mon -= 1;
+  return (uint32_t)timegm(&time);
+}
+
+static int decode(const char *path, const std::vector<std::string> &parameters)
+{
+  std::ifstream file(path);
+  if (!file)
+  {
+    fprintf(stderr, "%s could not be opened\n", path);
+    return 1;
+  }
+
+  SampleCodecDecoder decoder;
+  sampleCodecDecoderReset(decoder);
+  std::string line;
+  long skipped = 0, damaged = 0;
+  while (std::getline(file, line))
+  {
+    std::string data, loggerId, deploymentId;
+    if (!jsonValue(line, "data", data))
+    {
+      continue;
+    }
+    jsonValue(line, "logger_id", loggerId);
+    jsonValue(line, "deployment_id", deploymentId);
+
+    std::vector<uint8_t> records(data.size());
+    size_t size = sampleCodecBase64Decode(data.c_str(), data.size(), records.data(), records.size());
+    size_t offset = 0;
+    CodecSample sample;
+    bool decoded;
+    int length;
+    while ((length = sampleCodecDecode(decoder, records.data() + offset, size - offset, sample, decoded)) > 0)
+    {
+      offset += length;
+      if (!decoded)
+      {
+        skipped++;
+        continue;
+      }
+
+      uint8_t sampleQc = 0;
+      printf("{\"time\":\"%s\",\"logger_id\":%s,\"deployment_id\":%s", isoTime(sample.time).c_str(), loggerId.c_str(), deploymentId.c_str());
+      for (int i = 0; i < SAMPLE_CODEC_MAX_SENSORS; i++)
+      {
+        if (sample.sensorMask >> i & 1)
+        {
+          std::string name = i < (int)parameters.size() ? parameters[i] : "sensor_" + std::to_string(i);
+          printf(",\"%s\":\"%.*f\",\"%s_raw\":\"%.2f\"", name.c_str(), decoder.resolution[i] > 0 ? std::max(0, (int)ceil(-log10(decoder.resolution[i]))) : 6,
+                 sample.value[i], name.c_str(), sample.raw[i]);
+          if (sample.qc[i] != 0)
+          {
+            printf(",\"%s_qc\":%u", name.c_str(), sample.qc[i]);
+          }
+          sampleQc |= sample.qc[i];
+        }
+      }
+      printf(",\"qc\":%u}\n", sampleQc);
+    }
+    if (length < 0)
+    {
+      damaged++;
+      sampleCodecDecoderReset(decoder); // Continues at the next keyframe
+    }
+  }
+
+  if (skipped || damaged)
+  {
+    fprintf(stderr, "records before the first keyframe: %ld, damaged lines: %ld\n", skipped, damaged);
+  }
+  return damaged ? 1 : 0;
+}
+
+/**
+ * @brief A synthetic deployment: 6 h of 1 s samples, temperature, pressure, conductivity and oxygen with casts.
+ */
+static std::vector<std::string> syntheticDeployment()
+{
+  std::vector<std::string> lines;
+  srand(1);
+  for (int t = 0; t < 6 * 3600; t++)
+  {
+    float depth = 20 + 15 * sinf(t / 600.0f);
+    float temperature = 12 - 0.2f * depth + 0.002f * ((rand() % 100) - 50);
+    float pressure = 1013.25f + 100 * depth + 0.5f * ((rand() % 100) - 50) / 50.0f;
+    float conductivity = 30 + 0.05f * depth + 0.001f * ((rand() % 100) - 50);
+    float oxygen = 200 - depth + 0.05f * ((rand() % 100) - 50);
+    char line[512];
+    snprintf(line, sizeof(line),
+             "{\"time\":\"%s\",\"logger_id\":17,\"deployment_id\":42,\"temperature\":\"%.2f\",\"temperature_raw\":\"%.2f\",\"pressure\":\"%.2f\","
+             "\"pressure_raw\":\"%.2f\",\"conductivity\":\"%.2f\",\"conductivity_raw\":\"%.2f\",\"oxygen\":\"%.2f\",\"oxygen_raw\":\"%.2f\",\"qc\":0}",
+             isoTime(1717200000 + t).c_str(), temperature, roundf(temperature * 1000), pressure, roundf(pressure * 100), conductivity,
+             roundf(conductivity * 1000), oxygen, roundf(oxygen * 10));
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+static int ratio(const std::vector<std::string> &lines, const std::map<std::string, float> &resolutions, const char *name)
+{
+  std::vector<std::string> parameters;
+  SampleCodecState state;
+  sampleCodecReset(state);
+  float resolution[SAMPLE_CODEC_MAX_SENSORS];
+  size_t jsonBytes = 0, recordBytes = 0, lineBytes = 0, lineUsed = 0;
+  long samples = 0, lineSamples = 0;
+  double largestError = 0;
+
+  for (const std::string &line : lines)
+  {
+    std::string value;
+    if (!jsonValue(line, "time", value))
+    {
+      continue;
+    }
+    jsonBytes += line.size() + 2; // println writes CR LF
+
+    CodecSample sample = {};
+    sample.time = unixTime(value);
+    for (const std::string &key : jsonKeys(line))
+    {
+      if (key == "time" || key == "logger_id" || key == "deployment_id" || key == "qc" || endsWith(key, "_raw") || endsWith(key, "_qc"))
+      {
+        continue;
+      }
+      size_t sensor = 0;
+      while (sensor < parameters.size() && parameters[sensor] != key)
+      {
+        sensor++;
+      }
+      if (sensor == parameters.size())
+      {
+        if (sensor == SAMPLE_CODEC_MAX_SENSORS)
+        {
+          continue;
+        }
+        parameters.push_back(key);
+        resolution[sensor] = resolutions.count(key) ? resolutions.at(key) : 0.01f;
+      }
+      sample.sensorMask |= 1UL << sensor;
+      jsonValue(line, key, value);
+      sample.value[sensor] = strtof(value.c_str(), nullptr);
+      if (jsonValue(line, key + "_raw", value))
+      {
+        sample.raw[sensor] = strtof(value.c_str(), nullptr);
+      }
+      if (jsonValue(line, key + "_qc", value))
+      {
+        sample.qc[sensor] = (uint8_t)atoi(value.c_str());
+      }
+      if (resolution[sensor] > 0)
+      {
+        largestError = fmax(largestError, fabs(sample.value[sensor] - roundf(sample.value[sensor] / resolution[sensor]) * resolution[sensor]));
+      }
+    }
+
+    uint8_t record[SAMPLE_CODEC_MAX_RECORD_SIZE];
+    size_t size = sampleCodecEncode(state, sample, resolution, sampleCodecKeyframeInterval, record, sizeof(record));
+    recordBytes += size;
+    samples++;
+
+    // Lines of measurement_delta.json: one per flush, or earlier when sampleCodecLineSize is reached
+    const size_t envelope = strlen("{\"logger_id\":17,\"deployment_id\":42,\"codec\":1,\"samples\":10,\"data\":\"\"}\r\n");
+    if (lineUsed + size > sampleCodecLineSize)
+    {
+      lineBytes += envelope + (lineUsed + 2) / 3 * 4;
+      lineUsed = 0;
+      lineSamples = 0;
+    }
+    lineUsed += size;
+    if (++lineSamples == sampleStageFlushCount)
+    {
+      lineBytes += envelope + (lineUsed + 2) / 3 * 4;
+      lineUsed = 0;
+      lineSamples = 0;
+    }
+    if (lineSamples > 0 && &line == &lines.back())
+    {
+      lineBytes += envelope + (lineUsed + 2) / 3 * 4;
+    }
+  }
+
+  if (samples == 0)
+  {
+    fprintf(stderr, "%s: no samples\n", name);
+    return 1;
+  }
+  printf("%s: %ld samples, %zu parameters\n", name, samples, parameters.size());
+  printf("  measurement.json       %10zu bytes  %7.1f bytes/sample\n", jsonBytes, (double)jsonBytes / samples);
+  printf("  measurement_delta.json %10zu bytes  %7.1f bytes/sample  ratio %5.1f\n", lineBytes, (double)lineBytes / samples, (double)jsonBytes / lineBytes);
+  printf("  records only           %10zu bytes  %7.1f bytes/sample  ratio %5.1f\n", recordBytes, (double)recordBytes / samples, (double)jsonBytes / recordBytes);
+  printf("  largest quantisation error %.6f\n", largestError);
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc >= 3 && strcmp(argv[1], "decode") == 0)
+  {
+    std::vector<std::string> parameters;
+    if (argc >= 4)
+    {
+      std::string list = argv[3];
+      for (size_t start = 0, end; start <= list.size(); start = end + 1)
+      {
+        end = list.find(',', start);
+        end = end == std::string::npos ? list.size() : end;
+        parameters.push_back(list.substr(start, end - start));
+      }
+    }
+    return decode(argv[2], parameters);
+  }
+
+  if (argc >= 2 && strcmp(argv[1], "ratio") == 0)
+  {
+    std::map<std::string, float> resolutions;
+    std::vector<const char *> files;
+    for (int i = 2; i < argc; i++)
+    {
+      const char *equals = strchr(argv[i], '=');
+      if (equals)
+      {
+        resolutions[std::string(argv[i], equals - argv[i])] = strtof(equals + 1, nullptr);
+      }
+      else
+      {
+        files.push_back(argv[i]);
+      }
+    }
+
+    if (files.empty())
+    {
+      return ratio(syntheticDeployment(), resolutions, "synthetic deployment");
+    }
+    int result = 0;
+    for (const char *path : files)
+    {
+      std::ifstream file(path);
+      std::vector<std::string> lines;
+      std::string line;
+      while (std::getline(file, line))
+      {
+        lines.push_back(line);
+      }
+      result |= ratio(lines, resolutions, path);
+    }
+    return result;
+  }
+
+  fprintf(stderr, "usage: %s decode measurement_delta.json [parameter,...]\n       %s ratio [measurement.json ...] [parameter=resolution ...]\n", argv[0], argv[0]);
+  return 2;
+}
@@ -0,0 +1,226 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host simulation of the surface wake-ups caused by the periodic tasks
+ *
+ * Build and run on the host (from the Logger-Mainboard directory):
+ *   g++ -std=c++17 -Isrc tools/wakeSimulation.cpp src/periodicScheduler.cpp -o wakeSimulation
+ *   ./wakeSimulation [loggerConfig.json] [days] [coalesceSec]
+ *
+ * The periods are read from the logger configuration file, the other values of the tasks
+ * have to match the registry in src/periodicTasks.cpp.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "periodicScheduler.h"
+
+typedef struct
+{
+  const char *name;
+  const char *configKey;
+  uint32_t periodSec; // Default if the key is missing in the configuration
+  TaskCostClass cost;
+  uint32_t durationSec; // Assumed run time of one execution
+} SimulatedTask;
+
+static SimulatedTask tasks[] = {
+    {"wet detection", "wet_det_periode", 60, TASK_COST_LOW, 3},
+    {"status upload", "status_upload_periode", 3600, TASK_COST_HIGH, 20},
+    {"config update", "config_update_periode", 21600, TASK_COST_HIGH, 30},
+};
+
+#define TASK_COUNT (sizeof(tasks) / sizeof(tasks[0]))
+
+/**
+ * @brief Reads a number from the top level of a JSON text, enough for the flat logger configuration.
+ * @param json JSON text.
+ * @param key Key of the number.
+ * @param value Read number, unchanged if the key is missing.
+ */
+static void readJsonNumber(const std::string &json, const char *key, uint32_t &value)
+{
+  std::string quotedKey = std::string("\"") + key + "\"";
+  size_t position = json.find(quotedKey);
+  if (position == std::string::npos)
+  {
+    return;
+  }
+  position = json.find(':', position + quotedKey.size());
+  if (position != std::string::npos)
+  {
+    value = strtoul(json.c_str() + position + 1, nullptr, 10);
+  }
+}
+
+typedef struct
+{
+  uint32_t wakeUps;
+  uint32_t runs[TASK_COUNT];
+  uint32_t awakeSec;
+} SimulationResult;
+
+/**
+ * @brief Simulates the surface loop: run the selected tasks, sleep until the next due time.
+ * @param days Simulated time in days.
+ * @param coalesceSec Coalescing window, 0 = every task is only run when it is due.
+ * @return SimulationResult Number of wake-ups and task executions.
+ */
+static SimulationResult simulate(uint32_t days, uint32_t coalesceSec)
+{
+  SimulationResult result = {};
+  PeriodicTaskTiming timings[TASK_COUNT];
+  uint32_t dueSec[TASK_COUNT] = {};
+
+  const uint32_t startSec = 1700000000; // Any Unix time, the due times are aligned to the period grid
+  const uint32_t endSec = startSec + days * 86400;
+  uint32_t nowSec = startSec;
+
+  for (size_t i = 0; i < TASK_COUNT; i++)
+  {
+    timings[i] = {tasks[i].periodSec, 0, tasks[i].cost, true};
+    periodicTaskCheckDue(timings[i], dueSec[i], nowSec);
+  }
+
+  while (true)
+  {
+    uint32_t sleepSec = periodicTasksTimeUntilNext(timings, dueSec, TASK_COUNT, nowSec);
+    if (sleepSec == UINT32_MAX || nowSec + sleepSec >= endSec)
+    {
+      break;
+    }
+    nowSec += sleepSec;
+    result.wakeUps++;
+
+    uint32_t taskMask = selectPeriodicTasks(timings, dueSec, TASK_COUNT, nowSec, coalesceSec);
+    uint32_t awakeSec = 0;
+    for (size_t i = 0; i < TASK_COUNT; i++)
+    {
+      if ((taskMask >> i) & 1u)
+      {
+        result.runs[i]++;
+        awakeSec += tasks[i].durationSec;
+        completePeriodicTask(timings[i], dueSec[i], nowSec);
+      }
+    }
+    result.awakeSec += awakeSec;
+    nowSec += awakeSec;
+  }
+  return result;
+}
+
+/**
+ * @brief Simulates the former surface loop for comparison: every period counts from the
+ *        elapsed time of the wake-up the task last ran in, so the tasks drift apart.
+ * @param days Simulated time in days.
+ * @return SimulationResult Number of wake-ups and task executions.
+ */
+static SimulationResult simulateElapsedTimeLoop(uint32_t days)
+{
+  SimulationResult result = {};
+  uint32_t lastRunSec[TASK_COUNT] = {};
+  uint32_t elapsedSec = 0;
+  uint32_t largestPeriodSec = 0;
+  for (size_t i = 0; i < TASK_COUNT; i++)
+  {
+    largestPeriodSec = tasks[i].periodSec > largestPeriodSec ? tasks[i].periodSec : largestPeriodSec;
+  }
+
+  uint64_t simulatedSec = 0;
+  while (true)
+  {
+    uint32_t sleepSec = UINT32_MAX;
+    for (size_t i = 0; i < TASK_COUNT; i++)
+    {
+      uint32_t waitSec = tasks[i].periodSec - (elapsedSec - lastRunSec[i]);
+      sleepSec = waitSec < sleepSec ? waitSec : sleepSec;
+    }
+    if (simulatedSec + sleepSec >= (uint64_t)days * 86400)
+    {
+      break;
+    }
+    simulatedSec += sleepSec;
+    elapsedSec += sleepSec;
+    result.wakeUps++;
+
+    uint32_t awakeSec = 0;
+    for (size_t i = 0; i < TASK_COUNT; i++)
+    {
+      if (elapsedSec - lastRunSec[i] >= tasks[i].periodSec)
+      {
+        result.runs[i]++;
+        awakeSec += tasks[i].durationSec;
+        lastRunSec[i] = elapsedSec;
+      }
+    }
+
+    if (elapsedSec >= largestPeriodSec)
+    {
+      elapsedSec = 0;
+      memset(lastRunSec, 0, sizeof(lastRunSec));
+    }
+    result.awakeSec += awakeSec;
+    simulatedSec += awakeSec;
+    elapsedSec += awakeSec;
+  }
+  return result;
+}
+
+static void printResult(const char *title, const SimulationResult &result, uint32_t days)
+{
+  printf("%s\n", title);
+  printf("  wake-ups per day: %.1f\n", (double)result.wakeUps / days);
+  printf("  awake per day:    %.0f s\n", (double)result.awakeSec / days);
+  for (size_t i = 0; i < TASK_COUNT; i++)
+  {
+    printf("  %-18s %.1f runs per day\n", tasks[i].name, (double)result.runs[i] / days);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t days = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1;
+  uint32_t coalesceSec = argc > 3 ? strtoul(argv[3], nullptr, 10) : 60;
+  if (days == 0)
+  {
+    days = 1;
+  }
+
+  if (argc > 1)
+  {
+    std::ifstream file(argv[1]);
+    if (!file)
+    {
+      fprintf(stderr, "%s could not be opened\n", argv[1]);
+      return 1;
+    }
+    std::stringstream json;
+    json << file.rdbuf();
+    for (size_t i = 0; i < TASK_COUNT; i++)
+    {
+      readJsonNumber(json.str(), tasks[i].configKey, tasks[i].periodSec);
+    }
+  }
+
+  for (size_t i = 0; i < TASK_COUNT; i++)
+  {
+    printf("%-18s period %u s\n", tasks[i].name, tasks[i].periodSec);
+  }
+
+  printResult("elapsed time loop (former scheduling):", simulateElapsedTimeLoop(days), days);
+  printResult("registry without coalescing:", simulate(days, 0), days);
+  char title[64];
+  snprintf(title, sizeof(title), "registry with coalescing window %u s:", coalesceSec);
+  printResult(title, simulate(days, coalesceSec), days);
+  return 0;
+}
@@ -0,0 +1,259 @@
+/*
+ * CopyrightText: (C) 2024 Hensel Elektronik GmbH
+ *
+ * License-Identifier: MPL-2.0
+ *
+ * Project: Hydrography on Fishing Vessels
+ * Project URL: <https://github.com/HyFiVeUser/HyFiVe>, <https://hyfive.info>
+ *
+ * Description: Host replay of wet/dry sensor traces through the wet/dry state machine
+ *
+ * Build and run on the host (from the Logger-Mainboard directory):
+ *   g++ -std=c++17 -Isrc tools/wetDrySimulation.cpp src/wetDryDetection.cpp -o wetDrySimulation
+ *   ./wetDrySimulation [trace.csv] [wetThreshold] [dryThreshold] [dryVerifyDelay]
+ *
+ * The trace has one reading per line, either "value" or "time,value" (the time is ignored).
+ * The same trace feeds the wet and the dry detection. Without a trace file a synthetic trace
+ * with spray at the surface and three casts is replayed. A wet transition followed by readings
+ * just below the wet threshold must be rejected after wetDryPendingLimit readings; the exit code
+ * is 1 if it is not.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "wetDryDetection.h"
+
+// Values of the configuration variables in SystemVariables.h
+static const uint16_t wetDetConfirmCount = 2;
+static const float wetDryHysteresis = 0.1f;
+static const uint16_t wetDryPendingLimit = 5;
+
+// A deployment with fewer readings counts as false deployment
+static const size_t minimumDeploymentReadings = 10;
+
+typedef struct
+{
+  uint32_t deployments;
+  uint32_t shortDeployments;
+  uint32_t rejectedWet;
+  uint32_t rejectedDry;
+} ReplayResult;
+
+/**
+ * @brief Reads the trace file.
+ * @param path Path of the CSV file.
+ * @param trace Destination for the readings.
+ * @return bool False if the file could not be opened.
+ */
+static bool readTrace(const char *path, std::vector<float> &trace)
+{
+  std::ifstream file(path);
+  if (!file)
+  {
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(file, line))
+  {
+    size_t comma = line.rfind(',');
+    const char *value = line.c_str() + (comma == std::string::npos ? 0 : comma + 1);
+    char *end;
+    float reading = strtof(value, &end);
+    if (end != value)
+    {
+      trace.push_back(reading);
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Appends readings inside the hysteresis band below the wet threshold with a single
+ *        reading above the threshold, e.g. a sensor with a drifting offset at the surface.
+ */
+static void appendReadingsInsideBand(std::vector<float> &trace, float wetThreshold)
+{
+  for (int i = 0; i < 30; i++)
+  {
+    trace.push_back(wetThreshold * (i == 10 ? 1.05f : 0.95f));
+  }
+}
+
+/**
+ * @brief Creates a trace with spray at the surface (single and double spikes), readings inside
+ *        the hysteresis band and three casts with readings close to the thresholds at the
+ *        beginning and the end.
+ */
+static void createSyntheticTrace(std::vector<float> &trace, float wetThreshold)
+{
+  srand(42);
+  appendReadingsInsideBand(trace, wetThreshold);
+  for (int cast = 0; cast < 3; cast++)
+  {
+    for (int i = 0; i < 600; i++)
+    {
+      float reading = (rand() % 100) / 100.0f;
+      int chance = rand() % 100;
+      if (chance < 4 || (chance < 6 && !trace.empty() && trace.back() > wetThreshold))
+      {
+        reading = wetThreshold * (1.0f + (rand() % 200) / 100.0f); // Spray
+      }
+      trace.push_back(reading);
+    }
+    for (int i = 0; i < 8; i++)
+    {
+      trace.push_back(i % 2 ? wetThreshold * 1.5f : wetThreshold * 0.5f); // Surf while the logger goes into the water
+    }
+    for (int i = 0; i < 300; i++)
+    {
+      trace.push_back(wetThreshold * 4.0f + (rand() % 100) / 50.0f);
+    }
+  }
+}
+
+/**
+ * @brief Replays the former detection: a single wet reading starts the deployment, the
+ *        deployment ends after dryVerifyDelay + 1 consecutive dry readings.
+ */
+static ReplayResult replaySingleThreshold(const std::vector<float> &trace, float wetThreshold, float dryThreshold, uint16_t dryVerifyDelay)
+{
+  ReplayResult result = {};
+  bool isWet = false;
+  uint16_t dryCount = 0;
+  size_t deploymentStart = 0;
+
+  for (size_t i = 0; i < trace.size(); i++)
+  {
+    if (!isWet)
+    {
+      if (trace[i] >= wetThreshold)
+      {
+        isWet = true;
+        deploymentStart = i;
+        result.deployments++;
+      }
+    }
+    else if (trace[i] <= dryThreshold)
+    {
+      if (dryCount < dryVerifyDelay)
+      {
+        dryCount++;
+      }
+      else
+      {
+        isWet = false;
+        dryCount = 0;
+        result.shortDeployments += i - deploymentStart < minimumDeploymentReadings;
+      }
+    }
+    else
+    {
+      dryCount = 0;
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Replays the trace through the wet/dry state machine.
+ */
+static ReplayResult replayStateMachine(const std::vector<float> &trace, const WetDryParameters &parameters)
+{
+  ReplayResult result = {};
+  WetDryDetector detector = {};
+  size_t deploymentStart = 0;
+
+  for (size_t i = 0; i < trace.size(); i++)
+  {
+    bool wasWet = wetDryIsWet(detector);
+    wetDryUpdate(detector, parameters, trace[i]);
+    if (!wasWet && wetDryIsWet(detector))
+    {
+      deploymentStart = i;
+      result.deployments++;
+    }
+    else if (wasWet && !wetDryIsWet(detector))
+    {
+      result.shortDeployments += i - deploymentStart < minimumDeploymentReadings;
+    }
+  }
+  result.rejectedWet = detector.rejectedWetCount;
+  result.rejectedDry = detector.rejectedDryCount;
+  return result;
+}
+
+/**
+ * @brief Checks that a wet transition followed by readings inside the hysteresis band is
+ *        rejected after pendingLimit readings instead of staying pending.
+ * @return bool True if the transition was rejected in time and counted as rejected.
+ */
+static bool checkPendingIsBounded(const WetDryParameters &parameters)
+{
+  std::vector<float> trace;
+  appendReadingsInsideBand(trace, parameters.wetThreshold);
+
+  WetDryDetector detector = {};
+  size_t pendingReadings = 0;
+  size_t longestPending = 0;
+  for (float reading : trace)
+  {
+    wetDryUpdate(detector, parameters, reading);
+    pendingReadings = detector.state == WET_DRY_WET_PENDING ? pendingReadings + 1 : 0;
+    longestPending = pendingReadings > longestPending ? pendingReadings : longestPending;
+  }
+
+  printf("pending readings inside band:  %zu (limit %u)\n", longestPending, parameters.pendingLimit);
+  return detector.state == WET_DRY_DRY && detector.rejectedWetCount == 1 && longestPending <= parameters.pendingLimit;
+}
+
+static void printResult(const char *title, const ReplayResult &result)
+{
+  printf("%s\n", title);
+  printf("  deployments:                 %u\n", result.deployments);
+  printf("  deployments < %zu readings:   %u\n", minimumDeploymentReadings, result.shortDeployments);
+}
+
+int main(int argc, char **argv)
+{
+  float wetThreshold = argc > 2 ? strtof(argv[2], nullptr) : 10.0f;
+  float dryThreshold = argc > 3 ? strtof(argv[3], nullptr) : 5.0f;
+  uint16_t dryVerifyDelay = argc > 4 ? strtoul(argv[4], nullptr, 10) : 2;
+
+  std::vector<float> trace;
+  if (argc > 1 && strcmp(argv[1], "-") != 0)
+  {
+    if (!readTrace(argv[1], trace))
+    {
+      fprintf(stderr, "%s could not be opened\n", argv[1]);
+      return 1;
+    }
+  }
+  else
+  {
+    createSyntheticTrace(trace, wetThreshold);
+  }
+
+  WetDryParameters parameters = {wetThreshold, dryThreshold, wetDryHysteresis, wetDetConfirmCount, (uint16_t)(dryVerifyDelay + 1),
+                                 wetDryPendingLimit};
+
+  printf("readings: %zu, wet threshold: %.2f, dry threshold: %.2f, dry verify delay: %u\n",
+         trace.size(), wetThreshold, dryThreshold, dryVerifyDelay);
+
+  ReplayResult former = replaySingleThreshold(trace, wetThreshold, dryThreshold, dryVerifyDelay);
+  ReplayResult filtered = replayStateMachine(trace, parameters);
+  printResult("single threshold (former detection):", former);
+  printResult("wet/dry state machine:", filtered);
+  printf("  rejected wet transitions:    %u\n", filtered.rejectedWet);
+  printf("  rejected dry transitions:    %u\n", filtered.rejectedDry);
+  printf("prevented false deployments:   %d\n", (int)former.deployments - (int)filtered.deployments);
+
+  bool bounded = checkPendingIsBounded(parameters);
+  printf("%s\n", bounded ? "passed: a pending wet transition is rejected after the limit" : "FAILED: the wet transition stays pending");
+  return bounded ? EXIT_SUCCESS : EXIT_FAILURE;
+}